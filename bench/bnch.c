@@ -0,0 +1,600 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-12
+ */
+
+/*! @uses fprintf, printf, stderr, fopen, fclose, fwrite, fgets, sscanf, snprintf. */
+#include <stdio.h>
+
+/*! @uses calloc, malloc, free, qsort, strtoull, mkstemp. */
+#include <stdlib.h>
+
+/*! @uses memcpy, memset, strncmp. */
+#include <string.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses atomic_size_t, atomic_fetch_add, atomic_load, atomic_store. */
+#include <stdatomic.h>
+
+/*! @uses clock_gettime, CLOCK_MONOTONIC. */
+#include <time.h>
+
+/*! @uses getopt, optarg, optind, write, close, unlink. */
+#include <unistd.h>
+
+/*! @uses stat. */
+#include <sys/stat.h>
+
+/*! @uses ELF_SHT_*, ELF_SHF_*, ELF_MACH_X86_64, elf_parse, elf_free. */
+#include "elfx.h"
+
+/*! @uses emit_ctx_t, emit_load, emit_scan_text, emit_split_ranges, emit_count_rows, emit_all. */
+#include "emit.h"
+
+/*! @uses ux_page_msg_t, ux_set_sink, insn_chunk_free. */
+#include "ux.h"
+
+/*! @uses wrk_pool_t, wrk_pool_create, wrk_pool_post, wrk_pool_post_batch, wrk_pool_drain. */
+#include "wrk.h"
+
+/*! @uses ring_t, ring_init, ring_push, ring_pop, ring_free. */
+#include "ring.h"
+
+/*! @uses syms_t, syms_free. */
+#include "syms.h"
+
+/*! @uses strs_t, strs_free. */
+#include "strs.h"
+
+/*! @uses ui_model_t. */
+#include "ui.h"
+
+/*! @uses internal, _foreach. */
+#include "dyna.h"
+
+/* the objects of lzd reference the model of the tui, which the driver never creates. */
+ui_model_t* g_ui_model = 0x0;
+
+/* runs of every benchmark, the median is reported. */
+#define BNCH_RUNS 5u
+
+/* sizes of the generated binaries (their .text). */
+#define BNCH_SMALL (1u << 20)
+#define BNCH_LARGE (16u << 20)
+
+/* items pushed through the ring and jobs posted to the pool per run. */
+#define BNCH_RING (1u << 22)
+#define BNCH_JOBS (1u << 18)
+
+/* a file of the corpus, generated or given. */
+typedef struct {
+    const char* path; /* the path to the elf binary. */
+    const char* name; /* the name it is reported as. */
+    size_t size; /* size of the file. */
+} bnch_file_t;
+
+/* what one run measured. */
+typedef struct {
+    uint64_t ns; /* time spent in the measured code. */
+    size_t bytes; /* bytes it went through. */
+    size_t items; /* items it produced (instructions, ranges, strings, ...). */
+} bnch_run_t;
+
+/* a benchmark, one run of it over a file (or 0x0 for the ones without). */
+typedef bool (*bnch_fn_t)(const bnch_file_t* file, wrk_pool_t* pool, bnch_run_t* run);
+
+/* instructions decoded by emit_all, counted by the sink. */
+static atomic_size_t g_instructions;
+
+/**
+ * @brief read the monotonic clock.
+ *
+ * @return the time in nanoseconds.
+ */
+internal uint64_t
+now_ns(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t) time.tv_sec * 1000000000ull + (uint64_t) time.tv_nsec;
+}
+
+/**
+ * @brief reset the peak resident set size of the process, so each benchmark reports its own.
+ */
+internal void
+rss_reset(void) {
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+    if (!file) return;
+    fputs("5", file);
+    fclose(file);
+}
+
+/**
+ * @brief get the peak resident set size of the process since the last reset.
+ *
+ * @return the peak in kilobytes, 0 if it is unknown.
+ */
+internal size_t
+rss_peak(void) {
+    FILE* file = fopen("/proc/self/status", "r");
+    if (!file) return 0u;
+    char line[256u];
+    size_t peak = 0u;
+    while (fgets(line, sizeof line, file))
+        if (!strncmp(line, "VmHWM:", 6u)) sscanf(line + 6u, "%zu", &peak);
+    fclose(file);
+    return peak;
+}
+
+/**
+ * @brief a xorshift generator, so the generated binaries are the same on every run.
+ *
+ * @param state the state of the generator.
+ * @return the next number.
+ */
+internal uint64_t
+xorshift(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13u;
+    x ^= x >> 7u;
+    x ^= x << 17u;
+    return *state = x;
+}
+
+/* instructions the generated functions are made of, each as its bytes. */
+static const struct { uint8_t size; uint8_t bytes[8]; } g_insns[] = {
+    { 4u, { 0x48, 0x83, 0xec, 0x20 } }, /* sub rsp, 0x20 */
+    { 3u, { 0x89, 0x7d, 0xfc } }, /* mov [rbp-4], edi */
+    { 3u, { 0x8b, 0x45, 0xfc } }, /* mov eax, [rbp-4] */
+    { 7u, { 0x48, 0x8d, 0x05, 0x00, 0x10, 0x00, 0x00 } }, /* lea rax, [rip+0x1000] */
+    { 5u, { 0xe8, 0x00, 0x00, 0x00, 0x00 } }, /* call next */
+    { 5u, { 0x0f, 0x1f, 0x44, 0x00, 0x00 } }, /* nop dword [rax+rax] */
+    { 5u, { 0xc5, 0xf9, 0x6f, 0x04, 0x24 } }, /* vmovdqa xmm0, [rsp] */
+    { 3u, { 0x48, 0x01, 0xd8 } }, /* add rax, rbx */
+    { 2u, { 0x31, 0xc0 } }, /* xor eax, eax */
+    { 2u, { 0x74, 0x02 } }, /* je +2 */
+    { 8u, { 0x48, 0x8b, 0x84, 0x24, 0x80, 0x00, 0x00, 0x00 } }, /* mov rax, [rsp+0x80] */
+};
+
+/* section headers of a generated binary, in order. */
+enum { GEN_NULL = 0, GEN_TEXT, GEN_RODATA, GEN_SYMTAB, GEN_STRTAB, GEN_SHSTRTAB, GEN_COUNT };
+
+/**
+ * @brief write a synthetic x86_64 elf executable: a .text of functions made of common
+ *  instructions with int3 padding between them, a .rodata of strings, and a .symtab with a
+ *  function symbol for each of them.
+ *
+ * @param path the path to write to.
+ * @param text the size of .text.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+generate(const char* path, size_t text) {
+    size_t rodata = text / 4u, functions = 0u, upper = text / 32u + 1u;
+    uint8_t* code = malloc(text), *strings = malloc(rodata);
+    uint8_t* symbols = calloc(upper + 1u, 24u), *names = malloc(upper * 16u + 1u);
+    if (!code || !strings || !symbols || !names) {
+        fprintf(stderr, "lzd, generate; malloc failed; could not allocate the binary.\n");
+        free(code);
+        free(strings);
+        free(symbols);
+        free(names);
+        return -1;
+    }
+
+    /* functions of 32 to 2048 bytes, ending in a ret and padded to 16 bytes. */
+    uint64_t state = 0x9e3779b97f4a7c15ull;
+    size_t at = 0u, named = 1u;
+    names[0] = 0u;
+    while (at + 64u < text && functions < upper) {
+        size_t start = at, body = 32u + (size_t) (xorshift(&state) % 2016u);
+        if (start + body + 32u > text) body = text - start - 32u;
+        code[at++] = 0x55; /* push rbp */
+        memcpy(code + at, "\x48\x89\xe5", 3u); /* mov rbp, rsp */
+        at += 3u;
+        while (at < start + body) {
+            size_t k = (size_t) (xorshift(&state) % (sizeof g_insns / sizeof *g_insns));
+            memcpy(code + at, g_insns[k].bytes, g_insns[k].size);
+            at += g_insns[k].size;
+        }
+        code[at++] = 0xc9; /* leave */
+        code[at++] = 0xc3; /* ret */
+
+        /* its symbol, st_name st_info st_other st_shndx st_value st_size. */
+        uint8_t* symbol = symbols + (++functions) * 24u;
+        uint32_t name = (uint32_t) named;
+        uint16_t shndx = GEN_TEXT;
+        uint64_t value = 0x401000u + start, size = at - start;
+        memcpy(symbol, &name, 4u);
+        symbol[4] = 0x12u; /* global, func. */
+        memcpy(symbol + 6u, &shndx, 2u);
+        memcpy(symbol + 8u, &value, 8u);
+        memcpy(symbol + 16u, &size, 8u);
+        named += (size_t) snprintf((char*) names + named, 16u, "fn_%zu", functions) + 1u;
+        while (at % 16u) code[at++] = 0xcc; /* int3 */
+    }
+    memset(code + at, 0xcc, text - at);
+
+    /* printable words of 4 to 24 characters, each terminated. */
+    for (size_t i = 0; i < rodata; ) {
+        size_t length = 4u + (size_t) (xorshift(&state) % 21u);
+        for (size_t j = 0; j < length && i < rodata - 1u; j++)
+            strings[i++] = (uint8_t) ('a' + xorshift(&state) % 26u);
+        strings[i++] = 0u;
+    }
+
+    /* the layout: header, .text at 0x1000, then the rest back to back, section headers last. */
+    static const char shstrtab[] = "\0.text\0.rodata\0.symtab\0.strtab\0.shstrtab";
+    size_t offsets[GEN_COUNT] = { 0u, 0x1000u };
+    size_t sizes[GEN_COUNT] = { 0u, text, rodata, (functions + 1u) * 24u, named, sizeof shstrtab };
+    for (size_t i = GEN_RODATA; i < GEN_COUNT; i++)
+        offsets[i] = (offsets[i - 1u] + sizes[i - 1u] + 7u) & ~7ull;
+    size_t shoff = (offsets[GEN_SHSTRTAB] + sizes[GEN_SHSTRTAB] + 7u) & ~7ull;
+    uint8_t* image = calloc(1u, shoff + GEN_COUNT * 64u);
+    if (!image) {
+        fprintf(stderr, "lzd, generate; calloc failed; could not allocate the image.\n");
+        free(code);
+        free(strings);
+        free(symbols);
+        free(names);
+        return -1;
+    }
+    memcpy(image + offsets[GEN_TEXT], code, text);
+    memcpy(image + offsets[GEN_RODATA], strings, rodata);
+    memcpy(image + offsets[GEN_SYMTAB], symbols, sizes[GEN_SYMTAB]);
+    memcpy(image + offsets[GEN_STRTAB], names, named);
+    memcpy(image + offsets[GEN_SHSTRTAB], shstrtab, sizeof shstrtab);
+
+    /* the elf64 header. */
+    uint16_t half[] = { ELF_TYPE_EXEC, ELF_MACH_X86_64 };
+    uint32_t version = 1u;
+    uint64_t entry = 0x401000u;
+    uint16_t sizes16[] = { 64u, 56u, 0u, 64u, GEN_COUNT, GEN_SHSTRTAB };
+    memcpy(image, "\x7f" "ELF\x02\x01\x01", 7u);
+    memcpy(image + 16u, half, sizeof half);
+    memcpy(image + 20u, &version, 4u);
+    memcpy(image + 24u, &entry, 8u);
+    memcpy(image + 40u, &shoff, 8u);
+    memcpy(image + 52u, sizes16, sizeof sizes16);
+
+    /* the section headers, name type flags addr offset size link info addralign entsize. */
+    static const uint32_t names_at[GEN_COUNT] = { 0u, 1u, 7u, 15u, 23u, 31u };
+    static const uint32_t types[GEN_COUNT] = { ELF_SHT_NULL, ELF_SHT_PROGBITS, ELF_SHT_PROGBITS, \
+        ELF_SHT_SYMTAB, ELF_SHT_STRTAB, ELF_SHT_STRTAB };
+    for (size_t i = 1u; i < GEN_COUNT; i++) {
+        uint8_t* header = image + shoff + i * 64u;
+        uint64_t flags = i == GEN_TEXT ? ELF_SHF_ALLOC | ELF_SHF_EXECINSTR : \
+            i == GEN_RODATA ? ELF_SHF_ALLOC : 0u;
+        uint64_t addr = i == GEN_TEXT || i == GEN_RODATA ? 0x400000u + offsets[i] : 0u;
+        uint64_t offset = offsets[i], size = sizes[i], align = 8u, entsize = i == GEN_SYMTAB ? 24u : 0u;
+        uint32_t link = i == GEN_SYMTAB ? GEN_STRTAB : 0u, info = i == GEN_SYMTAB ? 1u : 0u;
+        memcpy(header, &names_at[i], 4u);
+        memcpy(header + 4u, &types[i], 4u);
+        memcpy(header + 8u, &flags, 8u);
+        memcpy(header + 16u, &addr, 8u);
+        memcpy(header + 24u, &offset, 8u);
+        memcpy(header + 32u, &size, 8u);
+        memcpy(header + 40u, &link, 4u);
+        memcpy(header + 44u, &info, 4u);
+        memcpy(header + 48u, &align, 8u);
+        memcpy(header + 56u, &entsize, 8u);
+    }
+
+    FILE* file = fopen(path, "wb");
+    bool ok = file && fwrite(image, 1u, shoff + GEN_COUNT * 64u, file) == shoff + GEN_COUNT * 64u;
+    if (file && fclose(file) != 0) ok = false;
+    if (!ok) fprintf(stderr, "lzd, generate; could not write %s.\n", path);
+    free(image);
+    free(code);
+    free(strings);
+    free(symbols);
+    free(names);
+    return ok ? 0 : -1;
+}
+
+/**
+ * @brief count the instructions of a decoded page and drop it (the sink of emit_all).
+ *
+ * @param message the page (owned).
+ * @param arg unused.
+ */
+internal void
+count_sink(ux_page_msg_t* message, void* arg) {
+    (void) arg;
+    if (message->chunk) {
+        atomic_fetch_add(&g_instructions, message->chunk->count);
+        insn_chunk_free(message->chunk);
+    }
+    free(message);
+}
+
+/**
+ * @brief load a binary and find its code ranges, the setup most benchmarks share (untimed).
+ *
+ * @param file the file.
+ * @param split if the ranges are split for decoding too.
+ * @return the emit context, or 0x0 on failure.
+ */
+internal emit_ctx_t*
+load(const bnch_file_t* file, bool split) {
+    emit_ctx_t* ctx = emit_load(file->path, (tup_arch_t) { 0, 0 });
+    if (!ctx || !split) return ctx;
+    if (emit_scan_text(ctx) != 0 || emit_split_ranges(ctx, 0x0, EMIT_SPLIT_TARGET) != 0) {
+        emit_free(ctx);
+        return 0x0;
+    }
+    return ctx;
+}
+
+/**
+ * @brief get the number of bytes in the executable regions of a binary.
+ *
+ * @param ctx the emit context.
+ * @return the number of bytes.
+ */
+internal size_t
+region_bytes(const emit_ctx_t* ctx) {
+    size_t bytes = 0u;
+    for (size_t i = 0; i < ctx->region_count; i++) bytes += ctx->regions[i].size;
+    return bytes;
+}
+
+/** @brief time elf_parse (and elf_free) over a file. */
+internal bool
+bench_elf_parse(const bnch_file_t* file, wrk_pool_t* pool, bnch_run_t* run) {
+    (void) pool;
+    uint64_t start = now_ns();
+    elf_t* elf = elf_parse(file->path);
+    if (!elf) return false;
+    run->items = elf->shnum;
+    elf_free(elf);
+    run->ns = now_ns() - start;
+    run->bytes = file->size;
+    return true;
+}
+
+/** @brief time emit_scan_text over the executable regions of a file. */
+internal bool
+bench_scan_text(const bnch_file_t* file, wrk_pool_t* pool, bnch_run_t* run) {
+    (void) pool;
+    emit_ctx_t* ctx = load(file, false);
+    if (!ctx) return false;
+    uint64_t start = now_ns();
+    bool ok = emit_scan_text(ctx) == 0;
+    run->ns = now_ns() - start;
+    run->bytes = region_bytes(ctx);
+    run->items = ctx->code_ranges->length;
+    emit_free(ctx);
+    return ok;
+}
+
+/** @brief time emit_count_rows (the length decoder) over the code ranges of a file. */
+internal bool
+bench_count_rows(const bnch_file_t* file, wrk_pool_t* pool, bnch_run_t* run) {
+    emit_ctx_t* ctx = load(file, true);
+    if (!ctx) return false;
+    uint64_t start = now_ns();
+    bool ok = emit_count_rows(ctx, pool) == 0;
+    run->ns = now_ns() - start;
+    run->bytes = region_bytes(ctx);
+    _foreach(ctx->code_ranges, code_range_t*, range)
+        run->items += range->rows;
+    _endforeach;
+    emit_free(ctx);
+    return ok;
+}
+
+/** @brief time emit_all and the drain of the pool, decoding every code range of a file. */
+internal bool
+bench_emit_all(const bnch_file_t* file, wrk_pool_t* pool, bnch_run_t* run) {
+    emit_ctx_t* ctx = load(file, true);
+    if (!ctx) return false;
+    atomic_store(&g_instructions, 0u);
+    ux_set_sink(count_sink, 0x0);
+    uint64_t start = now_ns();
+    bool ok = emit_all(ctx, pool) == 0;
+    wrk_pool_drain(pool);
+    run->ns = now_ns() - start;
+    ux_set_sink(0x0, 0x0);
+    run->bytes = region_bytes(ctx);
+    run->items = atomic_load(&g_instructions);
+    emit_free(ctx);
+    return ok;
+}
+
+/** @brief time emit_extract_strings over the data sections of a file. */
+internal bool
+bench_strings(const bnch_file_t* file, wrk_pool_t* pool, bnch_run_t* run) {
+    emit_ctx_t* ctx = load(file, false);
+    if (!ctx) return false;
+    uint64_t start = now_ns();
+    strs_t* strings = emit_extract_strings(ctx, pool, 4u);
+    run->ns = now_ns() - start;
+    run->bytes = file->size;
+    run->items = strings ? strings->count : 0u;
+    strs_free(strings);
+    emit_free(ctx);
+    return strings != 0x0;
+}
+
+/** @brief time emit_extract_symbols over the symbol tables of a file. */
+internal bool
+bench_symbols(const bnch_file_t* file, wrk_pool_t* pool, bnch_run_t* run) {
+    emit_ctx_t* ctx = load(file, false);
+    if (!ctx) return false;
+    uint64_t start = now_ns();
+    syms_t* symbols = emit_extract_symbols(ctx, pool);
+    run->ns = now_ns() - start;
+    run->bytes = file->size;
+    run->items = symbols ? symbols->count : 0u;
+    syms_free(symbols);
+    emit_free(ctx);
+    return symbols != 0x0;
+}
+
+/** @brief time pushing and popping items through a ring, in bursts of 256. */
+internal bool
+bench_ring(const bnch_file_t* file, wrk_pool_t* pool, bnch_run_t* run) {
+    (void) file;
+    (void) pool;
+    ring_t* ring = ring_init();
+    if (!ring) return false;
+    bool ok = true;
+    uint64_t start = now_ns();
+    for (size_t i = 0; ok && i < BNCH_RING; i += 256u) {
+        for (size_t j = 0; ok && j < 256u; j++) ok = ring_push(ring, (void*) (i + j + 1u)) == 0;
+        for (size_t j = 0; ok && j < 256u; j++) ok = ring_pop(ring) != 0x0;
+    }
+    run->ns = now_ns() - start;
+    run->items = BNCH_RING;
+    ring_free(ring);
+    free(ring);
+    return ok;
+}
+
+/**
+ * @brief an empty job, it only counts itself.
+ *
+ * @param arg the counter.
+ */
+internal void
+count_job(void* arg) {
+    atomic_fetch_add((atomic_size_t*) arg, 1u);
+}
+
+/** @brief time posting empty jobs to the pool one at a time, and draining it. */
+internal bool
+bench_pool_post(const bnch_file_t* file, wrk_pool_t* pool, bnch_run_t* run) {
+    (void) file;
+    atomic_size_t done = 0u;
+    bool ok = true;
+    uint64_t start = now_ns();
+    for (size_t i = 0; ok && i < BNCH_JOBS; i++) ok = wrk_pool_post(pool, count_job, &done) == 0;
+    wrk_pool_drain(pool);
+    run->ns = now_ns() - start;
+    run->items = atomic_load(&done);
+    return ok && run->items == BNCH_JOBS;
+}
+
+/** @brief time posting empty jobs to the pool in batches of 256, and draining it. */
+internal bool
+bench_pool_batch(const bnch_file_t* file, wrk_pool_t* pool, bnch_run_t* run) {
+    (void) file;
+    atomic_size_t done = 0u;
+    job_t jobs[256u];
+    for (size_t i = 0; i < 256u; i++) jobs[i] = (job_t) { count_job, &done };
+    bool ok = true;
+    uint64_t start = now_ns();
+    for (size_t i = 0; ok && i < BNCH_JOBS; i += 256u)
+        ok = wrk_pool_post_batch(pool, jobs, 256u, WRK_PRIO_HIGH) == 0;
+    wrk_pool_drain(pool);
+    run->ns = now_ns() - start;
+    run->items = atomic_load(&done);
+    return ok && run->items == BNCH_JOBS;
+}
+
+/**
+ * @brief compare two runs by time, for qsort.
+ *
+ * @param a pointer to the first run.
+ * @param b pointer to the second run.
+ * @return <0, 0, >0 like strcmp.
+ */
+internal int
+run_compare(const void* a, const void* b) {
+    uint64_t x = ((const bnch_run_t*) a)->ns, y = ((const bnch_run_t*) b)->ns;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief run a benchmark a number of times and print its median as a json object (one line).
+ *
+ * @param name the name of the benchmark.
+ * @param fn the benchmark.
+ * @param file the file it runs over (or 0x0).
+ * @param pool the worker pool.
+ * @param runs the number of runs.
+ * @return -1 if a run failed, 0 o.w.
+ */
+internal ssize_t
+measure(const char* name, bnch_fn_t fn, const bnch_file_t* file, wrk_pool_t* pool, size_t runs) {
+    bnch_run_t results[64u];
+    if (runs > 64u) runs = 64u;
+    rss_reset();
+    for (size_t i = 0; i < runs; i++) {
+        results[i] = (bnch_run_t) { 0u, 0u, 0u };
+        if (!fn(file, pool, &results[i])) {
+            fprintf(stderr, "lzd, measure; %s failed on %s.\n", name, file ? file->name : "-");
+            return -1;
+        }
+    }
+    size_t peak = rss_peak();
+    qsort(results, runs, sizeof *results, run_compare);
+    const bnch_run_t* median = &results[runs / 2u];
+    double ns = (double) (median->ns ? median->ns : 1u);
+    printf("{\"bench\":\"%s\",\"file\":\"%s\",\"threads\":%zu,\"runs\":%zu,\"ns\":%llu,\"min_ns\":%llu," \
+        "\"bytes\":%zu,\"ns_per_byte\":%.4f,\"items\":%zu,\"items_per_s\":%.0f,\"peak_rss_kb\":%zu}\n", \
+        name, file ? file->name : "-", pool->count, runs, (unsigned long long) median->ns, \
+        (unsigned long long) results[0].ns, median->bytes, \
+        median->bytes ? ns / (double) median->bytes : 0.0, median->items, \
+        (double) median->items * 1e9 / ns, peak);
+    fflush(stdout);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    /* lzd-bench [-n <runs>] [-t <threads>] [<elf>...], the generated binaries always run. */
+    size_t runs = BNCH_RUNS, threads = 0u;
+    int option;
+    while ((option = getopt(argc, argv, "n:t:")) != -1) {
+        if (option == 'n') runs = (size_t) strtoull(optarg, 0x0, 10);
+        else if (option == 't') threads = (size_t) strtoull(optarg, 0x0, 10);
+        else {
+            fprintf(stderr, "usage: %s [-n <runs>] [-t <threads>] [<elf>...]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (runs == 0u) runs = BNCH_RUNS;
+    wrk_pool_t* pool = wrk_pool_create(threads ? threads : wrk_cpu_count());
+    if (!pool) return 1;
+
+    /* the corpus, the generated binaries first. */
+    size_t count = 2u + (size_t) (argc - optind);
+    bnch_file_t* files = calloc(count, sizeof *files);
+    char small[] = "/tmp/lzd-bench-1m-XXXXXX", large[] = "/tmp/lzd-bench-16m-XXXXXX";
+    int a = mkstemp(small), b = mkstemp(large);
+    bool ok = files && a >= 0 && b >= 0 && generate(small, BNCH_SMALL) == 0 && \
+        generate(large, BNCH_LARGE) == 0;
+    if (a >= 0) close(a);
+    if (b >= 0) close(b);
+    if (ok) {
+        files[0] = (bnch_file_t) { small, "generated-1m", 0u };
+        files[1] = (bnch_file_t) { large, "generated-16m", 0u };
+        for (int i = optind; i < argc; i++) files[2 + i - optind] = (bnch_file_t) { argv[i], argv[i], 0u };
+        for (size_t i = 0; i < count; i++) {
+            struct stat st;
+            files[i].size = stat(files[i].path, &st) == 0 ? (size_t) st.st_size : 0u;
+        }
+    }
+
+    /* every benchmark over every file, then the queues on their own. */
+    static const struct { const char* name; bnch_fn_t fn; } per_file[] = {
+        { "elf_parse", bench_elf_parse }, { "emit_scan_text", bench_scan_text },
+        { "emit_count_rows", bench_count_rows }, { "emit_all", bench_emit_all },
+        { "emit_extract_strings", bench_strings }, { "emit_extract_symbols", bench_symbols },
+    };
+    for (size_t i = 0; ok && i < count; i++)
+        for (size_t j = 0; j < sizeof per_file / sizeof *per_file; j++)
+            if (measure(per_file[j].name, per_file[j].fn, &files[i], pool, runs) != 0) ok = false;
+    if (ok) ok = measure("ring", bench_ring, 0x0, pool, runs) == 0 && \
+        measure("wrk_pool_post", bench_pool_post, 0x0, pool, runs) == 0 && \
+        measure("wrk_pool_post_batch", bench_pool_batch, 0x0, pool, runs) == 0;
+
+    if (a >= 0) unlink(small);
+    if (b >= 0) unlink(large);
+    free(files);
+    wrk_pool_destroy(pool);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-09
+ */
+#include "aren.h"
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses calloc, free. */
+#include <stdlib.h>
+
+/*! @uses uint8_t. */
+#include <stdint.h>
+
+/*! @uses mmap, munmap, PROT_READ, PROT_WRITE, MAP_PRIVATE, MAP_ANONYMOUS, MAP_NORESERVE. */
+#include <sys/mman.h>
+
+/*! @uses internal. */
+#include "dyna.h"
+
+/* size of the block header, rounded up so the first allocation is aligned. */
+#define BLOCK_HEADER ((sizeof(aren_block_t) + AREN_ALIGN - 1u) & ~(size_t) (AREN_ALIGN - 1u))
+
+/**
+ * @brief map a new block, the kernel hands it out zeroed.
+ *
+ * @param size the number of bytes to map, the header included.
+ * @return the block if successful, 0x0 o.w.
+ */
+internal aren_block_t*
+block_map(size_t size) {
+    void* data = mmap(0x0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | \
+        MAP_NORESERVE, -1, 0);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "lzd, block_map; mmap failed; could not map %zu bytes for arena.\n", size);
+        return 0x0;
+    }
+    aren_block_t* block = data;
+    block->size = size;
+    block->used = BLOCK_HEADER;
+    return block;
+}
+
+/**
+ * @brief create a new empty arena, the first block is mapped by the first allocation.
+ *
+ * @return an allocated arena if successful, 0x0 o.w.
+ */
+aren_t*
+aren_create() {
+    aren_t* arena = calloc(1u, sizeof *arena);
+    if (!arena) {
+        fprintf(stderr, "lzd, aren_create; calloc failed; could not allocate memory for arena.\n");
+        return 0x0;
+    }
+    pthread_mutex_init(&arena->lock, 0x0);
+    return arena;
+}
+
+/**
+ * @brief unmap every block of an arena and free it; whatever was allocated out of it is gone.
+ *
+ * @param arena the arena to be destroyed.
+ */
+void
+aren_destroy(aren_t* arena) {
+    if (!arena) return;
+    aren_block_t* block = arena->head;
+    while (block) {
+        aren_block_t* next = block->next;
+        munmap(block, block->size);
+        block = next;
+    }
+    pthread_mutex_destroy(&arena->lock);
+    free(arena);
+}
+
+/**
+ * @brief allocate zeroed memory out of an arena, aligned to AREN_ALIGN; from any thread.
+ *
+ * @param arena the arena.
+ * @param size the number of bytes.
+ * @return the memory if successful (freed along with the arena), 0x0 o.w.
+ */
+void*
+aren_alloc(aren_t* arena, size_t size) {
+    if (!arena || size > ((size_t) -1) / 2u) return 0x0;
+    size = size ? (size + AREN_ALIGN - 1u) & ~(size_t) (AREN_ALIGN - 1u) : AREN_ALIGN;
+    pthread_mutex_lock(&arena->lock);
+
+    /* a large allocation gets a block of its own, behind the one we are bumping out of. */
+    aren_block_t* block = arena->head;
+    if (size > AREN_BLOCK / 4u) {
+        aren_block_t* own = block_map(BLOCK_HEADER + size);
+        if (!own) {
+            pthread_mutex_unlock(&arena->lock);
+            return 0x0;
+        }
+        own->used = own->size;
+        if (block) {
+            own->next = block->next;
+            block->next = own;
+        } else arena->head = own;
+        arena->mapped += own->size;
+        arena->used += size;
+        pthread_mutex_unlock(&arena->lock);
+        return (uint8_t*) own + BLOCK_HEADER;
+    }
+
+    /* bump, mapping a fresh block when this one is full (its tail is left unused). */
+    if (!block || block->size - block->used < size) {
+        aren_block_t* fresh = block_map(AREN_BLOCK);
+        if (!fresh) {
+            pthread_mutex_unlock(&arena->lock);
+            return 0x0;
+        }
+        fresh->next = block;
+        arena->head = block = fresh;
+        arena->mapped += fresh->size;
+    }
+    void* memory = (uint8_t*) block + block->used;
+    block->used += size;
+    arena->used += size;
+    pthread_mutex_unlock(&arena->lock);
+    return memory;
+}
+
+/**
+ * @brief get the bytes an arena has mapped so far, from any thread.
+ *
+ * @param arena the arena (or 0x0).
+ * @return the bytes mapped over every block.
+ */
+size_t
+aren_mapped(aren_t* arena) {
+    if (!arena) return 0u;
+    pthread_mutex_lock(&arena->lock);
+    size_t mapped = arena->mapped;
+    pthread_mutex_unlock(&arena->lock);
+    return mapped;
+}
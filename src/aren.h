@@ -0,0 +1,74 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-09
+ */
+#ifndef LZD_AREN_H
+#define LZD_AREN_H
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/*! @uses pthread_mutex_t. */
+#include <pthread.h>
+
+/* bytes an arena maps at a time, an allocation over a quarter of this gets a block of its own. */
+#define AREN_BLOCK (8u << 20)
+
+/* alignment of every allocation out of an arena. */
+#define AREN_ALIGN 16u
+
+/* a block of an arena, mapped on its own; allocations follow the header. */
+typedef struct aren_block {
+    struct aren_block* next; /* the block mapped before this one. */
+    size_t size; /* bytes mapped, the header included. */
+    size_t used; /* bytes handed out, the header included. */
+} aren_block_t;
+
+/**
+ * a region allocator for everything that lives exactly as long as one opened binary; every
+ *  allocation is bumped out of a block mapped straight from the kernel and none is ever freed
+ *  on its own, the whole arena goes back to the kernel at once (one munmap per block) when the
+ *  binary is closed. so tearing down a binary doesn't walk what was allocated, and leaves no
+ *  holes behind in the heap.
+ */
+typedef struct {
+    aren_block_t* head; /* the block allocations are bumped out of, its next ones are full. */
+    size_t mapped, used; /* bytes mapped over every block, and bytes handed out. */
+    pthread_mutex_t lock; /* chunks are packed into it on the worker threads. */
+} aren_t;
+
+/**
+ * @brief create a new empty arena, the first block is mapped by the first allocation.
+ *
+ * @return an allocated arena if successful, 0x0 o.w.
+ */
+aren_t*
+aren_create();
+
+/**
+ * @brief unmap every block of an arena and free it; whatever was allocated out of it is gone.
+ *
+ * @param arena the arena to be destroyed.
+ */
+void
+aren_destroy(aren_t* arena);
+
+/**
+ * @brief allocate zeroed memory out of an arena, aligned to AREN_ALIGN; from any thread.
+ *
+ * @param arena the arena.
+ * @param size the number of bytes.
+ * @return the memory if successful (freed along with the arena), 0x0 o.w.
+ */
+void*
+aren_alloc(aren_t* arena, size_t size);
+
+/**
+ * @brief get the bytes an arena has mapped so far, from any thread.
+ *
+ * @param arena the arena (or 0x0).
+ * @return the bytes mapped over every block.
+ */
+size_t
+aren_mapped(aren_t* arena);
+#endif /* LZD_AREN_H */
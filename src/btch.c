@@ -0,0 +1,528 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-10
+ */
+#include "btch.h"
+
+/*! @uses fprintf, stderr, sprintf. */
+#include <stdio.h>
+
+/*! @uses calloc, malloc, realloc, free, getenv, strtoul. */
+#include <stdlib.h>
+
+/*! @uses memcpy, strlen, strcmp. */
+#include <string.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses errno, EINTR. */
+#include <errno.h>
+
+/*! @uses write, read, close. */
+#include <unistd.h>
+
+/*! @uses poll, pollfd, POLLIN. */
+#include <poll.h>
+
+/*! @uses eventfd, EFD_NONBLOCK, EFD_CLOEXEC. */
+#include <sys/eventfd.h>
+
+/*! @uses atomic_load. */
+#include <stdatomic.h>
+
+/*! @uses internal, _get. */
+#include "dyna.h"
+
+/*! @uses wrk_pool_t, wrk_pool_create, wrk_pool_pin, wrk_pool_drain, wrk_pool_destroy. */
+#include "wrk.h"
+
+/*! @uses emit_ctx_t, emit_load, emit_scan_text, emit_split_ranges, emit_range, code_range_t. */
+#include "emit.h"
+
+/*! @uses insn_store_t, insn_store_insert, insn_store_reserve, insn_chunk_get. */
+#include "insn.h"
+
+/*! @uses flow_t, flow_create, flow_explore, flow_code_ranges, flow_free. */
+#include "flow.h"
+
+/*! @uses syms_t, syms_index, syms_at. */
+#include "syms.h"
+
+/*! @uses ux_page_msg_t, ux_set_sink, ux_format_insn. */
+#include "ux.h"
+
+/*! @uses msgq_t, msgq_init, msgq_push, msgq_pop. */
+#include "msgq.h"
+
+/*! @uses stat_snapshot_t, stat_snapshot, stat_write_json, stat_now, stat_record. */
+#include "stat.h"
+
+/* the formatted text of a decoded chunk, written once the chunk is stitched to its neighbours. */
+typedef struct {
+    char* text; /* the text of every instruction, one after another. */
+    uint32_t* lines; /* offset of the text of every instruction, count + 1 of them. */
+    const uint32_t* offsets; /* offsets column of the chunk when it was formatted; stitching
+                              *  only moves the views of a packed chunk, so this tells how many
+                              *  instructions it dropped at the front. */
+} btch_slot_t;
+
+/* state of a batch run, shared by the writer and the sinks on the worker threads. */
+typedef struct {
+    emit_ctx_t* ctx;
+    const syms_t* symbols; /* (indexed) symbols the instructions are labelled with, or 0x0. */
+    btch_format_t format;
+    btch_slot_t* slots; /* one per code range, filled by the sink before the page is pushed. */
+    msgq_t inbox; /* pages on their way to the writer. */
+    int wakeup; /* eventfd the writer waits on, bumped for every page. */
+    int fd; /* file descriptor to write to. */
+    char* buffer; /* output buffer, BTCH_BUFFER bytes. */
+    size_t used; /* bytes in the output buffer. */
+    bool failed; /* a write failed, or a code range could not be decoded. */
+} btch_t;
+
+/* lookup table for hex digits. */
+static const char g_hex[] = "0123456789abcdef";
+
+/**
+ * @brief write all of a buffer to a file descriptor.
+ *
+ * @param fd the file descriptor.
+ * @param data the buffer.
+ * @param size the number of bytes.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+write_all(int fd, const char* data, size_t size) {
+    while (size > 0u) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        data += n;
+        size -= (size_t) n;
+    }
+    return 0;
+}
+
+/**
+ * @brief flush the output buffer of a batch run.
+ *
+ * @param batch the batch run.
+ */
+internal void
+batch_flush(btch_t* batch) {
+    if (batch->used > 0u && !batch->failed && write_all(batch->fd, batch->buffer, batch->used) != 0) {
+        fprintf(stderr, "lzd, batch_flush; write failed; could not write the disassembly.\n");
+        batch->failed = true;
+    }
+    batch->used = 0u;
+}
+
+/**
+ * @brief append bytes to the output of a batch run, anything as large as the buffer is written
+ *  straight through.
+ *
+ * @param batch the batch run.
+ * @param data the bytes.
+ * @param size the number of bytes.
+ */
+internal void
+batch_write(btch_t* batch, const char* data, size_t size) {
+    if (batch->used + size > BTCH_BUFFER) batch_flush(batch);
+    if (size >= BTCH_BUFFER) {
+        if (!batch->failed && write_all(batch->fd, data, size) != 0) {
+            fprintf(stderr, "lzd, batch_write; write failed; could not write the disassembly.\n");
+            batch->failed = true;
+        }
+        return;
+    }
+    memcpy(batch->buffer + batch->used, data, size);
+    batch->used += size;
+}
+
+/**
+ * @brief escape a string into a json string body (without the quotes).
+ *
+ * @param out the buffer, at least 6 bytes for every byte of the string.
+ * @param text the string.
+ * @return the number of bytes written.
+ */
+internal size_t
+json_escape(char* out, const char* text) {
+    size_t n = 0u;
+    for (const unsigned char* p = (const unsigned char*) text; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            out[n++] = '\\';
+            out[n++] = (char) *p;
+        } else if (*p < 0x20u) {
+            memcpy(out + n, "\\u00", 4u);
+            out[n + 4u] = g_hex[*p >> 4];
+            out[n + 5u] = g_hex[*p & 0xf];
+            n += 6u;
+        } else out[n++] = (char) *p;
+    }
+    return n;
+}
+
+/**
+ * @brief format an instruction for a batch run.
+ *
+ * @param batch the batch run.
+ * @param insn the instruction.
+ * @param label the function starting at the instruction (or 0x0).
+ * @param out the buffer, with room for the bound format_chunk makes for it.
+ * @return the number of bytes written.
+ */
+internal size_t
+format_insn(const btch_t* batch, const ux_insn_t* insn, const char* label, char* out) {
+    size_t n = 0u;
+    if (batch->format == BTCH_FORMAT_TEXT) {
+        /* the line of the disassembly view, after a blank line and the label of a function. */
+        if (label) n += (size_t) sprintf(out, "\n<%s>:\n", label);
+        n += ux_format_insn(insn, batch->symbols, out + n, 512u);
+        out[n++] = '\n';
+        return n;
+    }
+
+    /* {"address":"0x401136","symbol":"main","bytes":"55","mnemonic":"push","operands":"rbp"} */
+    n += (size_t) sprintf(out, "{\"address\":\"%#lx\"", insn->address);
+    if (label) {
+        memcpy(out + n, ",\"symbol\":\"", 11u);
+        n += 11u;
+        n += json_escape(out + n, label);
+        out[n++] = '"';
+    }
+    memcpy(out + n, ",\"bytes\":\"", 10u);
+    n += 10u;
+    for (uint8_t i = 0; insn->bytes && i < insn->size; i++) {
+        out[n++] = g_hex[insn->bytes[i] >> 4];
+        out[n++] = g_hex[insn->bytes[i] & 0xf];
+    }
+    memcpy(out + n, "\",\"mnemonic\":\"", 14u);
+    n += 14u;
+    n += json_escape(out + n, insn->mnemonic);
+    memcpy(out + n, "\",\"operands\":\"", 14u);
+    n += 14u;
+    n += json_escape(out + n, insn->op_str);
+    memcpy(out + n, "\"}\n", 3u);
+    return n + 3u;
+}
+
+/**
+ * @brief format every instruction of a decoded chunk into the slot of its code range.
+ *
+ * @param batch the batch run.
+ * @param chunk the chunk.
+ * @param slot the slot.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+format_chunk(const btch_t* batch, const insn_chunk_t* chunk, btch_slot_t* slot) {
+    size_t capacity = chunk->count * 96u + 4096u, used = 0u;
+    slot->text = malloc(capacity);
+    slot->lines = calloc(chunk->count + 1u, sizeof *slot->lines);
+    slot->offsets = chunk->offsets;
+    if (!slot->text || !slot->lines) {
+        fprintf(stderr, "lzd, format_chunk; calloc failed; could not allocate memory for text.\n");
+        return -1;
+    }
+    for (size_t i = 0; i < chunk->count; i++) {
+        ux_insn_t insn;
+        insn_chunk_get(chunk, i, &insn);
+        uint64_t into = 1u;
+        const elf_symbol_t* symbol = batch->symbols ? syms_at(batch->symbols, insn.address, &into) : 0x0;
+        const char* label = symbol && into == 0u && symbol->type == ELF_STT_FUNC ? symbol->name : 0x0;
+
+        /* make room for the longest the instruction could be formatted as (escaped). */
+        size_t bound = 640u + 6u * (strlen(insn.mnemonic) + strlen(insn.op_str) + \
+            (label ? strlen(label) : 0u));
+        if (used + bound > capacity) {
+            while (used + bound > capacity) capacity *= 2u;
+            char* grown = realloc(slot->text, capacity);
+            if (!grown) {
+                fprintf(stderr, "lzd, format_chunk; realloc failed; could not grow text.\n");
+                return -1;
+            }
+            slot->text = grown;
+        }
+        slot->lines[i] = (uint32_t) used;
+        used += format_insn(batch, &insn, label, slot->text + used);
+    }
+    slot->lines[chunk->count] = (uint32_t) used;
+    return 0;
+}
+
+/**
+ * @brief free the text of a slot.
+ *
+ * @param slot the slot.
+ */
+internal void
+slot_free(btch_slot_t* slot) {
+    free(slot->text);
+    free(slot->lines);
+    slot->text = 0x0;
+    slot->lines = 0x0;
+}
+
+/**
+ * @brief find the code range a chunk was decoded for.
+ *
+ * @param ctx the emit context.
+ * @param base the base address of the chunk.
+ * @return the index of the code range, the number of code ranges if there is none.
+ */
+internal size_t
+range_index(const emit_ctx_t* ctx, uint64_t base) {
+    size_t lo = 0u, hi = ctx->code_ranges->length;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2u;
+        if (_get(ctx->code_ranges, code_range_t*, mid)->vaddr < base) lo = mid + 1u;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief take a decoded page on a worker thread; the chunk is formatted right there, so the
+ *  writer only has to stitch and copy text.
+ *
+ * @param message the page (ownership is taken).
+ * @param arg the batch run.
+ */
+internal void
+batch_sink(ux_page_msg_t* message, void* arg) {
+    btch_t* batch = arg;
+    size_t index = message->chunk ? range_index(batch->ctx, message->chunk->base) : 0u;
+    if (message->chunk && index < batch->ctx->code_ranges->length && \
+        format_chunk(batch, message->chunk, &batch->slots[index]) != 0)
+        slot_free(&batch->slots[index]);
+
+    /* the push publishes the slot to the writer. */
+    message->node.kind = 0u;
+    msgq_push(&batch->inbox, &message->node);
+    uint64_t one = 1u;
+    ssize_t written = write(batch->wakeup, &one, sizeof one);
+    (void) written; /* a full counter is already a pending wakeup. */
+}
+
+/**
+ * @brief check if the chunk of a code range is final, it is decoded and so is the chunk after
+ *  it if the two are stitched.
+ *
+ * @param store the instruction store (one chunk per code range).
+ * @param ctx the emit context.
+ * @param index the index of the code range.
+ * @return true if the chunk won't change anymore, false o.w.
+ */
+internal bool
+chunk_final(const insn_store_t* store, const emit_ctx_t* ctx, size_t index) {
+    if (store->chunks[index]->state != INSN_CHUNK_DECODED) return false;
+    if (index + 1u >= store->count) return true;
+    const code_range_t* range = _get(ctx->code_ranges, code_range_t*, index);
+    const code_range_t* next = _get(ctx->code_ranges, code_range_t*, index + 1u);
+    return !next->seam || next->vaddr != range->vaddr + range->length || \
+        store->chunks[index + 1u]->state == INSN_CHUNK_DECODED;
+}
+
+/**
+ * @brief write the instructions a chunk kept after stitching, o.w. its lookahead.
+ *
+ * @param batch the batch run.
+ * @param chunk the chunk.
+ * @param slot the slot of its code range.
+ */
+internal void
+write_chunk(btch_t* batch, const insn_chunk_t* chunk, btch_slot_t* slot) {
+    if (!slot->text) {
+        fprintf(stderr, "lzd, write_chunk; could not format the chunk at 0x%lx.\n", chunk->base);
+        batch->failed = true;
+        return;
+    }
+    size_t front = (size_t) (chunk->offsets - slot->offsets);
+    size_t back = front + chunk->count - chunk->overlap;
+    batch_write(batch, slot->text + slot->lines[front], slot->lines[back] - slot->lines[front]);
+    slot_free(slot);
+}
+
+/**
+ * @brief install every page the writer was handed into the store.
+ *
+ * @param batch the batch run.
+ * @param store the instruction store.
+ * @return the number of pages installed.
+ */
+internal size_t
+batch_drain(btch_t* batch, insn_store_t* store) {
+    size_t count = 0u;
+    for (msgq_node_t* node = msgq_pop(&batch->inbox); node; node = msgq_pop(&batch->inbox)) {
+        ux_page_msg_t* message = (ux_page_msg_t*) node;
+        stat_record(STAT_HIST_POST, stat_now() - message->posted);
+        if (!message->chunk || insn_store_insert(store, message->chunk) != 0) {
+            fprintf(stderr, "lzd, batch_drain; could not install the chunk at 0x%lx.\n", message->base);
+            insn_chunk_free(message->chunk);
+            batch->failed = true;
+        }
+        free(message);
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief post the decoding of a few code ranges.
+ *
+ * @param batch the batch run.
+ * @param pool the worker pool.
+ * @param first the index of the first code range.
+ * @param count the number of code ranges.
+ */
+internal void
+batch_post(btch_t* batch, wrk_pool_t* pool, size_t first, size_t count) {
+    const code_range_t* a = _get(batch->ctx->code_ranges, code_range_t*, first);
+    const code_range_t* b = _get(batch->ctx->code_ranges, code_range_t*, first + count - 1u);
+    if (emit_range(batch->ctx, pool, a->vaddr, b->vaddr + b->length, WRK_PRIO_HIGH, 0u) != 0)
+        batch->failed = true;
+}
+
+/**
+ * @brief decode and write every code range, a window ahead of the writer.
+ *
+ * @param batch the batch run.
+ * @param pool the worker pool.
+ * @param store the instruction store, holding a placeholder for every code range.
+ */
+internal void
+batch_loop(btch_t* batch, wrk_pool_t* pool, insn_store_t* store) {
+    size_t count = batch->ctx->code_ranges->length, window = pool->count * BTCH_WINDOW;
+    size_t posted = count < window ? count : window, next = 0u;
+    batch_post(batch, pool, 0u, posted);
+    while (next < count && !batch->failed) {
+        size_t installed = batch_drain(batch, store);
+
+        /* write out every chunk at the front that won't change anymore, each one lets another
+         *  code range into the window. */
+        while (next < count && !batch->failed && chunk_final(store, batch->ctx, next)) {
+            write_chunk(batch, store->chunks[next], &batch->slots[next]);
+            if (posted < count) batch_post(batch, pool, posted++, 1u);
+            next++;
+        }
+        if (next == count || batch->failed || installed > 0u) continue;
+
+        /* wait for the next page; once the pool is idle and nothing arrived, a job failed
+         *  without posting one. */
+        struct pollfd wait = { .fd = batch->wakeup, .events = POLLIN, .revents = 0 };
+        if (poll(&wait, 1u, 100) > 0) {
+            uint64_t value;
+            ssize_t got = read(batch->wakeup, &value, sizeof value);
+            (void) got;
+        } else if (atomic_load(&pool->pending) == 0u && batch_drain(batch, store) == 0u && \
+            !chunk_final(store, batch->ctx, next)) {
+            fprintf(stderr, "lzd, batch_loop; could not decode the code range at 0x%lx.\n", \
+                store->chunks[next]->base);
+            batch->failed = true;
+        }
+    }
+}
+
+/**
+ * @brief find the code ranges of a binary by following control flow, instead of sweeping every
+ *  executable region; if nothing is reachable it falls back to the sweep.
+ *
+ * @param ctx the emit context.
+ * @param pool the worker pool.
+ * @param symbols the (indexed) symbols of the binary (or 0x0).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+batch_descent(emit_ctx_t* ctx, wrk_pool_t* pool, const syms_t* symbols) {
+    flow_t* flow = flow_create(ctx);
+    if (!flow) return -1;
+    ssize_t pushed = flow_explore(flow, pool, symbols) == 0 ? flow_code_ranges(flow, ctx) : -1;
+    flow_free(flow);
+    if (pushed < 0) return -1;
+    if (pushed == 0) {
+        fprintf(stderr, "lzd, batch_descent; nothing reachable from the entry point, sweeping " \
+            "every region instead.\n");
+        return emit_scan_text(ctx);
+    }
+    return 0;
+}
+
+/**
+ * @brief disassemble every code range of an elf binary without the tui, and write it out in
+ *  address order; the ranges are decoded (and formatted) on the worker pool, a window ahead of
+ *  the writer, and a chunk is written as soon as it and the chunk it is stitched to arrived.
+ *
+ * @param path the path to the elf binary.
+ * @param fd the file descriptor to write to.
+ * @param format the output format.
+ * @param descent true to only disassemble code reachable from the entry point and the function
+ *  symbols (recursive descent), false to sweep every code range.
+ * @param stats the file the stats of the run are written to as json once it is done (or 0x0).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+btch_run(const char* path, int fd, btch_format_t format, bool descent, FILE* stats) {
+    if (!path || fd < 0) return -1;
+
+    /* the same worker pool as the tui, sized by LZD_THREADS and pinned by LZD_PIN. */
+    const char* threads = getenv("LZD_THREADS");
+    const char* pin = getenv("LZD_PIN");
+    size_t count = threads ? (size_t) strtoul(threads, 0x0, 10) : 0u;
+    wrk_pool_t* pool = wrk_pool_create(count > 0u ? count : wrk_cpu_count());
+    if (!pool) return -1;
+    if (pin && pin[0] && strcmp(pin, "0") != 0) wrk_pool_pin(pool);
+    emit_ctx_t* ctx = emit_load(path, (tup_arch_t) { 0, 0 });
+    if (!ctx) {
+        wrk_pool_destroy(pool);
+        return -1;
+    }
+
+    /* function starts label the output and are where big ranges get split. */
+    syms_t* symbols = emit_extract_symbols(ctx, pool);
+    if (symbols && syms_index(symbols, pool) != 0) {
+        syms_free(symbols);
+        symbols = 0x0;
+    }
+    btch_t batch = { .ctx = ctx, .symbols = symbols, .format = format, .fd = fd, .wakeup = -1 };
+    insn_store_t* store = insn_store_create();
+    bool ready = store && (descent ? batch_descent(ctx, pool, symbols) : emit_scan_text(ctx)) == 0 && \
+        emit_split_ranges(ctx, symbols, EMIT_SPLIT_TARGET) == 0;
+    size_t ranges = ready ? ctx->code_ranges->length : 0u;
+    batch.slots = calloc(ranges ? ranges : 1u, sizeof *batch.slots);
+    batch.buffer = malloc(BTCH_BUFFER);
+    batch.wakeup = eventfd(0u, EFD_NONBLOCK | EFD_CLOEXEC);
+    ready = ready && batch.slots && batch.buffer && batch.wakeup >= 0;
+    for (size_t i = 0; ready && i < ranges; i++) {
+        const code_range_t* range = _get(ctx->code_ranges, code_range_t*, i);
+        ready = insn_store_reserve(store, range->vaddr, range->length, 0u) == 0;
+    }
+    if (!ready) fprintf(stderr, "lzd, btch_run; could not prepare %s for disassembly.\n", path);
+
+    /* decode and write, then drop whatever was still in flight after a failure. */
+    msgq_init(&batch.inbox);
+    if (ready && ranges > 0u) {
+        ux_set_sink(batch_sink, &batch);
+        batch_loop(&batch, pool, store);
+        wrk_pool_drain(pool);
+        ux_set_sink(0x0, 0x0);
+        batch_drain(&batch, store);
+        batch_flush(&batch);
+    }
+    bool ok = ready && !batch.failed;
+    if (stats) {
+        stat_snapshot_t snapshot;
+        stat_snapshot(&snapshot, pool);
+        if (stat_write_json(&snapshot, stats) != 0) ok = false;
+    }
+    for (size_t i = 0; batch.slots && i < ranges; i++) slot_free(&batch.slots[i]);
+    if (batch.wakeup >= 0) close(batch.wakeup);
+    free(batch.buffer);
+    free(batch.slots);
+    insn_store_free(store);
+    syms_free(symbols);
+    emit_free(ctx);
+    wrk_pool_destroy(pool);
+    return ok ? 0 : -1;
+}
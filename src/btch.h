@@ -0,0 +1,44 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-10
+ */
+#ifndef LZD_BTCH_H
+#define LZD_BTCH_H
+
+/*! @uses size_t, ssize_t. */
+#include <sys/types.h>
+
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses FILE. */
+#include <stdio.h>
+
+/* output format of a batch run. */
+typedef enum {
+    BTCH_FORMAT_TEXT = 0u, /* the lines of the disassembly view, with a label at every function. */
+    BTCH_FORMAT_JSON, /* one json object per instruction (json lines). */
+} btch_format_t;
+
+/* code ranges decoding ahead of the writer, per worker thread. */
+#define BTCH_WINDOW 4u
+
+/* size of the output buffer, anything written is gathered into writes this large. */
+#define BTCH_BUFFER (1u << 20)
+
+/**
+ * @brief disassemble every code range of an elf binary without the tui, and write it out in
+ *  address order; the ranges are decoded (and formatted) on the worker pool, a window ahead of
+ *  the writer, and a chunk is written as soon as it and the chunk it is stitched to arrived.
+ *
+ * @param path the path to the elf binary.
+ * @param fd the file descriptor to write to.
+ * @param format the output format.
+ * @param descent true to only disassemble code reachable from the entry point and the function
+ *  symbols (recursive descent), false to sweep every code range.
+ * @param stats the file the stats of the run are written to as json once it is done (or 0x0).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+btch_run(const char* path, int fd, btch_format_t format, bool descent, FILE* stats);
+#endif /* LZD_BTCH_H */
@@ -0,0 +1,564 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-03
+ */
+#include "cach.h"
+
+/*! @uses fprintf, stderr, snprintf, fopen, fwrite, fseek, fclose, rename, remove. */
+#include <stdio.h>
+
+/*! @uses calloc, free, getenv. */
+#include <stdlib.h>
+
+/*! @uses memcpy, memcmp, memset. */
+#include <string.h>
+
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses mkdir. */
+#include <sys/stat.h>
+
+/*! @uses access, R_OK, getpid. */
+#include <unistd.h>
+
+/*! @uses PATH_MAX. */
+#include <limits.h>
+
+/*! @uses elf_symbol_t. */
+#include "elfx.h"
+
+/*! @uses aren_alloc. */
+#include "aren.h"
+
+/* magic at the start of every cache file. */
+static const char g_magic[8] = { 'l', 'z', 'd', 'c', 'a', 'c', 'h', 'e' };
+
+/**
+ * @brief finalize a 64-bit hash lane (murmur3 fmix64).
+ *
+ * @param h the lane.
+ * @return the mixed lane.
+ */
+internal uint64_t
+hash_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * @brief hash a buffer 32 bytes at a time over four independent lanes; this is not a
+ *  cryptographic hash, it only has to tell different builds apart quickly since it runs over
+ *  the whole binary on every open.
+ *
+ * @param data the buffer.
+ * @param size the size of the buffer.
+ * @return the 64-bit hash.
+ */
+uint64_t
+cach_hash(const uint8_t* data, size_t size) {
+    uint64_t lanes[4] = { 0x9e3779b97f4a7c15ull, 0xbf58476d1ce4e5b9ull, \
+        0x94d049bb133111ebull, 0x2545f4914f6cdd1dull };
+    size_t i = 0;
+    for (; i + 32u <= size; i += 32u) {
+        for (size_t j = 0; j < 4u; j++) {
+            uint64_t word;
+            memcpy(&word, data + i + j * 8u, sizeof word);
+            lanes[j] = (lanes[j] ^ word) * 0x9e3779b97f4a7c15ull;
+            lanes[j] = (lanes[j] << 31) | (lanes[j] >> 33);
+        }
+    }
+
+    /* fold the tail into the first lane a byte at a time. */
+    for (; i < size; i++)
+        lanes[0] = (lanes[0] ^ data[i]) * 0x100000001b3ull;
+    uint64_t h = (uint64_t) size;
+    for (size_t j = 0; j < 4u; j++)
+        h = hash_mix(h ^ hash_mix(lanes[j]));
+    return h;
+}
+
+/**
+ * @brief build the path of the cache file of a key, under $XDG_CACHE_HOME/lzd (or
+ *  $HOME/.cache/lzd).
+ *
+ * @param key the cache key.
+ * @param path the buffer to write the path into.
+ * @param size the size of the buffer.
+ * @param create true if the cache directory should be created.
+ * @return -1 if there is no cache directory, 0 o.w.
+ */
+internal ssize_t
+cache_path(const cach_key_t* key, char* path, size_t size, bool create) {
+    char dir[PATH_MAX];
+    const char* xdg = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    int n;
+    if (xdg && xdg[0]) {
+        if (create) mkdir(xdg, 0700);
+        n = snprintf(dir, sizeof dir, "%s/lzd", xdg);
+    } else if (home && home[0]) {
+        n = snprintf(dir, sizeof dir, "%s/.cache", home);
+        if (create && n > 0 && (size_t) n < sizeof dir) mkdir(dir, 0700);
+        n = snprintf(dir, sizeof dir, "%s/.cache/lzd", home);
+    } else return -1;
+    if (n < 0 || (size_t) n >= sizeof dir) return -1;
+    if (create) mkdir(dir, 0700);
+
+    /* one file per binary and architecture, the capstone version is checked in the header. */
+    n = snprintf(path, size, "%s/%016lx-%x-%x.lzc", dir, key->hash, (unsigned) key->tuple.arch, \
+        (unsigned) key->tuple.mode);
+    return n < 0 || (size_t) n >= size ? -1 : 0;
+}
+
+/**
+ * @brief check that a table of a cache file lies inside of the mapping.
+ *
+ * @param cache the cache.
+ * @param offset the file offset of the table.
+ * @param count the number of elements.
+ * @param size the size of a single element.
+ * @return true if the table is in bounds, false o.w.
+ */
+internal bool
+table_ok(const cach_t* cache, uint64_t offset, uint64_t count, uint64_t size) {
+    if (count != 0u && size > UINT64_MAX / count) return false;
+    return mapf_slice(cache->image, offset, count * size) != 0x0;
+}
+
+/**
+ * @brief check that a region of nul-terminated strings lies inside of the mapping and ends
+ *  with a terminator, so no string read out of it can run past the region.
+ *
+ * @param cache the cache.
+ * @param offset the file offset of the region.
+ * @param size the size of the region in bytes.
+ * @return true if the region is valid, false o.w.
+ */
+internal bool
+region_ok(const cach_t* cache, uint64_t offset, uint64_t size) {
+    const uint8_t* data = mapf_slice(cache->image, offset, size);
+    return data && (size == 0u || data[size - 1u] == '\0');
+}
+
+/**
+ * @brief check every index inside of the columns of a chunk; the header hash is of the binary,
+ *  not of the cache file, so a damaged file can still hold indices past the columns they index.
+ *
+ * @param cache the cache.
+ * @param r the chunk record, its tables already in bounds.
+ * @return true if every index is in bounds, false o.w.
+ */
+internal bool
+columns_ok(const cach_t* cache, const cach_chunk_t* r) {
+    const uint8_t* data = cache->image->data;
+    const uint32_t* offsets = (const uint32_t*) (data + r->offsets);
+    const uint8_t* sizes = data + r->sizes;
+    const uint16_t* mnemonics = (const uint16_t*) (data + r->mnemonics);
+    const uint32_t* operands = (const uint32_t*) (data + r->operands);
+    const uint32_t* mnem_offs = (const uint32_t*) (data + r->mnem_offs);
+    for (size_t i = 0; i < r->mnem_count; i++)
+        if (mnem_offs[i] >= r->mnem_size) return false;
+    for (size_t i = 0; i < r->count; i++)
+        if (mnemonics[i] >= r->mnem_count || operands[i] >= r->op_size || \
+            (uint64_t) offsets[i] + sizes[i] > r->length) return false;
+    return true;
+}
+
+/**
+ * @brief build the cache key of a loaded binary; this hashes the whole mapped image.
+ *
+ * @param ctx the emit context of the binary.
+ * @param key the key to be filled.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+cach_key(const emit_ctx_t* ctx, cach_key_t* key) {
+    if (!ctx || !key || !ctx->elf || !ctx->elf->image) return -1;
+    memset(key, 0, sizeof *key);
+    key->hash = cach_hash(ctx->elf->image->data, ctx->elf->image->size);
+    key->size = ctx->elf->image->size;
+    key->tuple = ctx->tuple;
+    cs_version(&key->cs_major, &key->cs_minor);
+    return 0;
+}
+
+/**
+ * @brief open the cache file of a key, if there is one and it matches the key.
+ *
+ * @param key the cache key.
+ * @return an opened cache if there is a valid one, 0x0 o.w.
+ */
+cach_t*
+cach_open(const cach_key_t* key) {
+    /* a missing cache is the common case, don't report it. */
+    char path[PATH_MAX];
+    if (!key || cache_path(key, path, sizeof path, false) != 0) return 0x0;
+    if (access(path, R_OK) != 0) return 0x0;
+
+    cach_t* cache = calloc(1u, sizeof *cache);
+    if (!cache) {
+        fprintf(stderr, "lzd, cach_open; calloc failed; could not allocate memory for cache.\n");
+        return 0x0;
+    }
+    cache->image = mapf_open(path);
+    cache->header = (const cach_header_t*) mapf_slice(cache->image, 0u, sizeof(cach_header_t));
+    const cach_header_t* h = cache->header;
+
+    /* the header check, anything stale or damaged is a miss (and gets rewritten). */
+    if (!h || memcmp(h->magic, g_magic, sizeof g_magic) != 0 || h->version != CACH_VERSION || \
+        h->hash != key->hash || h->size != key->size || h->arch != (uint32_t) key->tuple.arch || \
+        h->mode != (uint32_t) key->tuple.mode || h->cs_major != key->cs_major || \
+        h->cs_minor != key->cs_minor || h->file_size != cache->image->size || \
+        !table_ok(cache, h->range_offset, h->range_count, sizeof(cach_range_t)) || \
+        !table_ok(cache, h->chunk_offset, h->chunk_count, sizeof(cach_chunk_t)) || \
+        !table_ok(cache, h->symbol_offset, h->symbol_count, sizeof(cach_symbol_t)) || \
+        !table_ok(cache, h->string_offset, h->string_count, sizeof(cach_string_t))) {
+        cach_close(cache);
+        return 0x0;
+    }
+    return cache;
+}
+
+/**
+ * @brief close a cache; chunks borrowed from it must be freed before.
+ *
+ * @param cache the cache to be closed.
+ */
+void
+cach_close(cach_t* cache) {
+    if (!cache) return;
+    mapf_close(cache->image);
+    free(cache);
+}
+
+/**
+ * @brief restore the code ranges of a cache.
+ *
+ * @param cache the cache.
+ * @param ctx the emit context, its code ranges are pushed (from its arena).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+cach_ranges(const cach_t* cache, emit_ctx_t* ctx) {
+    if (!cache || !ctx) return -1;
+    const cach_range_t* table = (const cach_range_t*) (cache->image->data + cache->header->range_offset);
+
+    /* every range has to lie inside of a region, at the file offset the region maps it to; all
+     *  of them are checked first, so a bad table leaves the code ranges untouched. */
+    for (size_t i = 0; i < cache->header->range_count; i++) {
+        const emit_region_t* region = emit_region_at(ctx, table[i].vaddr);
+        if (!region || table[i].length > region->size - (table[i].vaddr - region->vaddr) || \
+            table[i].offset != region->offset + (table[i].vaddr - region->vaddr))
+            return -1;
+    }
+    for (size_t i = 0; i < cache->header->range_count; i++) {
+        code_range_t* range = aren_alloc(ctx->arena, sizeof *range);
+        if (!range) {
+            fprintf(stderr, "lzd, cach_ranges; aren_alloc failed; could not allocate memory for range.\n");
+            return -1;
+        }
+        range->vaddr = table[i].vaddr;
+        range->offset = (size_t) table[i].offset;
+        range->length = (size_t) table[i].length;
+        range->seam = table[i].seam != 0u;
+        dyna_push(ctx->code_ranges, range);
+    }
+    return 0;
+}
+
+/**
+ * @brief view a decoded chunk of a cache without allocating it; its columns are borrowed from the
+ *  cache mapping.
+ *
+ * @param cache the cache.
+ * @param index the index of the chunk in the cache.
+ * @param ctx the emit context the raw bytes are borrowed from.
+ * @param out the chunk to fill (it owns nothing, and is never freed on its own).
+ * @return -1 if the chunk is malformed or out of bounds, 0 o.w.
+ */
+ssize_t
+cach_view(const cach_t* cache, size_t index, const emit_ctx_t* ctx, insn_chunk_t* out) {
+    if (!cache || !ctx || !out || index >= cache->header->chunk_count) return -1;
+    const cach_chunk_t* r = (const cach_chunk_t*) (cache->image->data + \
+        cache->header->chunk_offset) + index;
+
+    /* every column has to be in bounds, the chunk has to lie inside of a region and every index
+     *  inside of the columns has to be in bounds too; anything off is a miss. */
+    const emit_region_t* region = emit_region_at(ctx, r->base);
+    if (!region || r->length > region->size - (r->base - region->vaddr) || r->count > UINT32_MAX || \
+        !table_ok(cache, r->offsets, r->count, sizeof(uint32_t)) || \
+        !table_ok(cache, r->sizes, r->count, sizeof(uint8_t)) || \
+        !table_ok(cache, r->mnemonics, r->count, sizeof(uint16_t)) || \
+        !table_ok(cache, r->operands, r->count, sizeof(uint32_t)) || \
+        !table_ok(cache, r->mnem_offs, r->mnem_count, sizeof(uint32_t)) || \
+        !table_ok(cache, r->xrefs, r->xref_count, sizeof(insn_xref_t)) || \
+        !region_ok(cache, r->op_arena, r->op_size) || !region_ok(cache, r->mnem_pool, r->mnem_size) || \
+        r->overlap > r->count || !columns_ok(cache, r))
+        return -1;
+    memset(out, 0, sizeof *out);
+    out->base = r->base;
+    out->length = (size_t) r->length;
+    out->bytes = region->data + (r->base - region->vaddr);
+
+    /* the mapping is read-only, the columns are never written through these pointers. */
+    uint8_t* data = cache->image->data;
+    out->count = out->capacity = (size_t) r->count;
+    out->offsets = (uint32_t*) (data + r->offsets);
+    out->sizes = data + r->sizes;
+    out->mnemonics = (uint16_t*) (data + r->mnemonics);
+    out->operands = (uint32_t*) (data + r->operands);
+    out->xrefs = (insn_xref_t*) (data + r->xrefs);
+    out->xref_count = (size_t) r->xref_count;
+    out->op_arena = (char*) (data + r->op_arena);
+    out->op_size = out->op_capacity = (size_t) r->op_size;
+    out->mnem_pool = (char*) (data + r->mnem_pool);
+    out->mnem_size = out->mnem_capacity = (size_t) r->mnem_size;
+    out->mnem_offs = (uint32_t*) (data + r->mnem_offs);
+    out->mnem_count = (size_t) r->mnem_count;
+    out->backing = cache->image;
+    out->overlap = (size_t) r->overlap;
+    out->seam = r->seam != 0u;
+    out->state = INSN_CHUNK_DECODED;
+    return 0;
+}
+
+/**
+ * @brief restore a decoded chunk of a cache; its columns are borrowed from the cache mapping.
+ *
+ * @param cache the cache.
+ * @param index the index of the chunk in the cache.
+ * @param ctx the emit context the raw bytes are borrowed from (and the chunk is allocated in).
+ * @return a chunk in the arena of the context if successful, 0x0 o.w.
+ */
+insn_chunk_t*
+cach_chunk(const cach_t* cache, size_t index, const emit_ctx_t* ctx) {
+    insn_chunk_t view;
+    if (cach_view(cache, index, ctx, &view) != 0) return 0x0;
+
+    /* only the chunk itself is allocated (in the arena), its columns stay in the cache. */
+    insn_chunk_t* chunk = aren_alloc(ctx->chunks, sizeof *chunk);
+    if (!chunk) {
+        fprintf(stderr, "lzd, cach_chunk; aren_alloc failed; could not allocate memory for chunk.\n");
+        return 0x0;
+    }
+    *chunk = view;
+    chunk->arena = ctx->chunks;
+    return chunk;
+}
+
+/**
+ * @brief restore the strings of a cache.
+ *
+ * @param cache the cache.
+ * @param image the mapped image of the binary the strings point into.
+ * @return the strings if successful, 0x0 o.w.
+ */
+strs_t*
+cach_strings(const cach_t* cache, const mapf_t* image) {
+    if (!cache || !image) return 0x0;
+    strs_t* strings = strs_create(image);
+    if (!strings) return 0x0;
+
+    /* every string has to lie inside of the image, it is read straight out of it. */
+    const cach_string_t* table = (const cach_string_t*) (cache->image->data + \
+        cache->header->string_offset);
+    for (size_t i = 0; i < cache->header->string_count; i++) {
+        if (!mapf_slice(image, table[i].offset, table[i].length) || table[i].encoding > STRS_UTF16LE)
+            continue;
+        strs_entry_t entry = { table[i].offset, table[i].vaddr, table[i].length, table[i].section, \
+            table[i].encoding };
+        if (strs_push(strings, &entry) != 0) break;
+    }
+    return strings;
+}
+
+/**
+ * @brief restore the symbols of a cache.
+ *
+ * @param cache the cache.
+ * @param image the mapped image of the binary the names point into.
+ * @return the symbols if successful, 0x0 o.w.
+ */
+syms_t*
+cach_symbols(const cach_t* cache, const mapf_t* image) {
+    if (!cache || !image) return 0x0;
+    syms_t* symbols = syms_create(image, (size_t) cache->header->symbol_count);
+    if (!symbols) return 0x0;
+
+    /* every name is read straight out of the image, so it has to end inside of it. */
+    size_t bound = syms_names_bound(image->data, image->size);
+    const cach_symbol_t* table = (const cach_symbol_t*) (cache->image->data + \
+        cache->header->symbol_offset);
+    for (size_t i = 0; i < cache->header->symbol_count; i++) {
+        if (table[i].name >= bound) continue;
+        elf_symbol_t sym = {
+            .name = (const char*) (image->data + table[i].name),
+            .value = table[i].value,
+            .size = table[i].size,
+            .info = table[i].info,
+            .other = table[i].other,
+            .shndx = table[i].shndx,
+            .bind = table[i].bind,
+            .type = table[i].type,
+        };
+        if (syms_push(symbols, &sym) != 0) break;
+    }
+    return symbols;
+}
+
+/* a sequential writer that keeps track of the file offset, and of whether any write failed. */
+typedef struct {
+    FILE* file;
+    uint64_t offset;
+    bool failed;
+} cache_writer_t;
+
+/**
+ * @brief write a table to a cache file, aligned to 8 bytes.
+ *
+ * @param writer the writer.
+ * @param data the data to be written.
+ * @param size the size of the data in bytes.
+ * @return the file offset the data was written at.
+ */
+internal uint64_t
+writer_put(cache_writer_t* writer, const void* data, size_t size) {
+    static const uint8_t zeros[8] = { 0 };
+    size_t pad = (size_t) ((8u - (writer->offset & 7u)) & 7u);
+    if (pad > 0u && fwrite(zeros, 1u, pad, writer->file) != pad) writer->failed = true;
+    writer->offset += pad;
+
+    uint64_t at = writer->offset;
+    if (size > 0u && fwrite(data, 1u, size, writer->file) != size) writer->failed = true;
+    writer->offset += size;
+    return at;
+}
+
+/**
+ * @brief append bytes to a cache file right after the previous write (no alignment).
+ *
+ * @param writer the writer.
+ * @param data the data to be written.
+ * @param size the size of the data in bytes.
+ */
+internal void
+writer_append(cache_writer_t* writer, const void* data, size_t size) {
+    if (size > 0u && fwrite(data, 1u, size, writer->file) != size) writer->failed = true;
+    writer->offset += size;
+}
+
+/**
+ * @brief write the cache file of a key; the file is written aside and renamed into place, so
+ *  an older cache that is still mapped stays valid.
+ *
+ * @param key the cache key.
+ * @param ctx the emit context (for the code ranges).
+ * @param store the instruction store, only decoded chunks are written.
+ * @param strings the strings of the binary (or 0x0).
+ * @param symbols the symbols of the binary (or 0x0).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+cach_save(const cach_key_t* key, const emit_ctx_t* ctx, const insn_store_t* store, \
+    const strs_t* strings, const syms_t* symbols) {
+    if (!key || !ctx || !store) return -1;
+    char path[PATH_MAX], temp[PATH_MAX + 32];
+    if (cache_path(key, path, sizeof path, true) != 0) return -1;
+    snprintf(temp, sizeof temp, "%s.%d.tmp", path, (int) getpid());
+
+    cache_writer_t writer = { fopen(temp, "wb"), 0u, false };
+    if (!writer.file) {
+        fprintf(stderr, "lzd, cach_save; could not create cache file %s.\n", temp);
+        return -1;
+    }
+    cach_header_t header = { 0 };
+    memcpy(header.magic, g_magic, sizeof g_magic);
+    header.version = CACH_VERSION;
+    header.arch = (uint32_t) key->tuple.arch;
+    header.mode = (uint32_t) key->tuple.mode;
+    header.cs_major = key->cs_major;
+    header.cs_minor = key->cs_minor;
+    header.hash = key->hash;
+    header.size = key->size;
+    writer_put(&writer, &header, sizeof header);
+
+    /* code ranges. */
+    header.range_offset = writer.offset;
+    _foreach(ctx->code_ranges, code_range_t*, range)
+        cach_range_t r = { range->vaddr, range->offset, range->length, range->seam };
+        writer_put(&writer, &r, sizeof r);
+        header.range_count++;
+    _endforeach;
+
+    /* the columns of every decoded chunk, then the chunk table that points at them. */
+    cach_chunk_t* records = calloc(store->count ? store->count : 1u, sizeof *records);
+    if (!records) {
+        fprintf(stderr, "lzd, cach_save; calloc failed; could not allocate memory for chunk table.\n");
+        fclose(writer.file);
+        remove(temp);
+        return -1;
+    }
+    for (size_t i = 0; i < store->count; i++) {
+        const insn_chunk_t* chunk = store->chunks[i];
+        if (chunk->state != INSN_CHUNK_DECODED) continue;
+        cach_chunk_t* r = &records[header.chunk_count++];
+        r->base = chunk->base;
+        r->length = chunk->length;
+        r->count = chunk->count;
+        r->op_size = chunk->op_size;
+        r->mnem_size = chunk->mnem_size;
+        r->mnem_count = chunk->mnem_count;
+        r->overlap = chunk->overlap;
+        r->seam = chunk->seam;
+        r->offsets = writer_put(&writer, chunk->offsets, chunk->count * sizeof(uint32_t));
+        r->sizes = writer_put(&writer, chunk->sizes, chunk->count * sizeof(uint8_t));
+        r->mnemonics = writer_put(&writer, chunk->mnemonics, chunk->count * sizeof(uint16_t));
+        r->operands = writer_put(&writer, chunk->operands, chunk->count * sizeof(uint32_t));
+        r->op_arena = writer_put(&writer, chunk->op_arena, chunk->op_size);
+        r->mnem_pool = writer_put(&writer, chunk->mnem_pool, chunk->mnem_size);
+        r->mnem_offs = writer_put(&writer, chunk->mnem_offs, chunk->mnem_count * sizeof(uint32_t));
+        r->xref_count = chunk->xref_count;
+        r->xrefs = writer_put(&writer, chunk->xrefs, chunk->xref_count * sizeof(insn_xref_t));
+    }
+    header.chunk_offset = writer_put(&writer, records, header.chunk_count * sizeof *records);
+    free(records);
+
+    /* strings, only where they are in the binary. */
+    header.string_offset = writer_put(&writer, 0x0, 0u);
+    for (size_t i = 0; strings && i < strings->count; i++) {
+        const strs_entry_t* entry = &strings->entries[i];
+        cach_string_t r = { entry->offset, entry->vaddr, entry->length, entry->section, \
+            entry->encoding, 0u };
+        writer_append(&writer, &r, sizeof r);
+        header.string_count++;
+    }
+
+    /* symbols, their names stay where they are in the binary. */
+    header.symbol_offset = writer_put(&writer, 0x0, 0u);
+    const char* base = symbols ? (const char*) symbols->image->data : 0x0;
+    for (size_t i = 0; symbols && i < symbols->count; i++) {
+        const elf_symbol_t* sym = &symbols->symbols[i];
+        if (!sym->name) continue;
+        cach_symbol_t r = { (uint64_t) (sym->name - base), sym->value, sym->size, sym->info, \
+            sym->other, sym->bind, sym->type, sym->shndx, 0u };
+        writer_append(&writer, &r, sizeof r);
+        header.symbol_count++;
+    }
+
+    /* patch the header now that every offset is known, and swap the file into place. */
+    header.file_size = writer.offset;
+    if (fseek(writer.file, 0L, SEEK_SET) != 0) writer.failed = true;
+    else if (fwrite(&header, 1u, sizeof header, writer.file) != sizeof header) writer.failed = true;
+    if (fclose(writer.file) != 0) writer.failed = true;
+    if (writer.failed || rename(temp, path) != 0) {
+        fprintf(stderr, "lzd, cach_save; could not write cache file %s.\n", path);
+        remove(temp);
+        return -1;
+    }
+    return 0;
+}
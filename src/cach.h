@@ -0,0 +1,212 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-03
+ */
+#ifndef LZD_CACH_H
+#define LZD_CACH_H
+
+/*! @uses uint64_t, uint32_t. */
+#include <stdint.h>
+
+/*! @uses size_t, ssize_t. */
+#include <sys/types.h>
+
+/*! @uses tup_arch_t. */
+#include "arch.h"
+
+/*! @uses dyna_t. */
+#include "dyna.h"
+
+/*! @uses mapf_t. */
+#include "mapf.h"
+
+/*! @uses insn_chunk_t, insn_store_t. */
+#include "insn.h"
+
+/*! @uses emit_ctx_t. */
+#include "emit.h"
+
+/*! @uses strs_t. */
+#include "strs.h"
+
+/*! @uses syms_t. */
+#include "syms.h"
+
+/* bump whenever the on-disk layout changes, older files are treated as a miss. */
+#define CACH_VERSION 6u
+
+/* identifies a cache file; a cache is only valid for the exact same bytes, decoded for the
+ *  same architecture by the same capstone. */
+typedef struct {
+    uint64_t hash; /* content hash of the whole binary. */
+    uint64_t size; /* size of the binary in bytes. */
+    tup_arch_t tuple; /* architecture the instructions were decoded for. */
+    int cs_major, cs_minor; /* capstone version the instructions were decoded with. */
+} cach_key_t;
+
+/**
+ * on-disk header of a cache file; every table after it is 8-byte aligned and referenced by a
+ *  file offset, so a cache can be used straight out of a read-only mapping.
+ */
+typedef struct {
+    char magic[8]; /* "lzdcache". */
+    uint32_t version; /* CACH_VERSION. */
+    uint32_t arch, mode; /* cach_key_t.tuple. */
+    int32_t cs_major, cs_minor; /* cach_key_t.cs_*. */
+    uint32_t reserved;
+    uint64_t hash, size; /* cach_key_t.hash, cach_key_t.size. */
+    uint64_t file_size; /* size of the cache file itself (catches truncation). */
+    uint64_t range_count, range_offset; /* code ranges, as cach_range_t. */
+    uint64_t chunk_count, chunk_offset; /* decoded chunks, as cach_chunk_t. */
+    uint64_t string_count, string_offset; /* strings, as cach_string_t. */
+    uint64_t symbol_count, symbol_offset; /* symbols, as cach_symbol_t. */
+} cach_header_t;
+
+/* on-disk code range. */
+typedef struct {
+    uint64_t vaddr, offset, length;
+    uint64_t seam; /* code_range_t.seam. */
+} cach_range_t;
+
+/* on-disk decoded chunk, each column is stored exactly as insn_chunk_t holds it. */
+typedef struct {
+    uint64_t base, length; /* code range of the chunk. */
+    uint64_t count; /* number of instructions. */
+    uint64_t op_size, mnem_size, mnem_count; /* sizes of the operand arena and mnemonic pool. */
+    uint64_t offsets, sizes, mnemonics, operands; /* file offsets of the instruction columns. */
+    uint64_t op_arena, mnem_pool, mnem_offs; /* file offsets of the string columns. */
+    uint64_t overlap, seam; /* insn_chunk_t.overlap, insn_chunk_t.seam (a seam not stitched yet). */
+    uint64_t xref_count, xrefs; /* references out of the chunk, as insn_xref_t. */
+} cach_chunk_t;
+
+/* on-disk string, it points into the binary just like strs_entry_t. */
+typedef struct {
+    uint64_t offset, vaddr;
+    uint32_t length;
+    uint16_t section;
+    uint8_t encoding;
+    uint8_t reserved;
+} cach_string_t;
+
+/* on-disk symbol, its name points into the binary just like elf_symbol_t. */
+typedef struct {
+    uint64_t name; /* file offset of the name in the binary. */
+    uint64_t value, size;
+    uint8_t info, other, bind, type;
+    uint16_t shndx;
+    uint16_t reserved;
+} cach_symbol_t;
+
+/* an opened (and validated) cache file. */
+typedef struct {
+    mapf_t* image; /* read-only mapping of the cache file (owned). */
+    const cach_header_t* header; /* header at the start of the mapping. */
+} cach_t;
+
+/**
+ * @brief hash a buffer 32 bytes at a time over four independent lanes; this is not a
+ *  cryptographic hash, it only has to tell different builds (or sections) apart quickly.
+ *
+ * @param data the buffer.
+ * @param size the size of the buffer.
+ * @return the 64-bit hash.
+ */
+uint64_t
+cach_hash(const uint8_t* data, size_t size);
+
+/**
+ * @brief build the cache key of a loaded binary; this hashes the whole mapped image.
+ *
+ * @param ctx the emit context of the binary.
+ * @param key the key to be filled.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+cach_key(const emit_ctx_t* ctx, cach_key_t* key);
+
+/**
+ * @brief open the cache file of a key, if there is one and it matches the key.
+ *
+ * @param key the cache key.
+ * @return an opened cache if there is a valid one, 0x0 o.w.
+ */
+cach_t*
+cach_open(const cach_key_t* key);
+
+/**
+ * @brief close a cache; chunks borrowed from it must be freed before.
+ *
+ * @param cache the cache to be closed.
+ */
+void
+cach_close(cach_t* cache);
+
+/**
+ * @brief restore the code ranges of a cache.
+ *
+ * @param cache the cache.
+ * @param ctx the emit context, its code ranges are pushed (from its arena).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+cach_ranges(const cach_t* cache, emit_ctx_t* ctx);
+
+/**
+ * @brief view a decoded chunk of a cache without allocating it; its columns are borrowed from the
+ *  cache mapping.
+ *
+ * @param cache the cache.
+ * @param index the index of the chunk in the cache.
+ * @param ctx the emit context the raw bytes are borrowed from.
+ * @param out the chunk to fill (it owns nothing, and is never freed on its own).
+ * @return -1 if the chunk is malformed or out of bounds, 0 o.w.
+ */
+ssize_t
+cach_view(const cach_t* cache, size_t index, const emit_ctx_t* ctx, insn_chunk_t* out);
+
+/**
+ * @brief restore a decoded chunk of a cache; its columns are borrowed from the cache mapping.
+ *
+ * @param cache the cache.
+ * @param index the index of the chunk in the cache.
+ * @param ctx the emit context the raw bytes are borrowed from (and the chunk is allocated in).
+ * @return a chunk in the arena of the context if successful, 0x0 o.w.
+ */
+insn_chunk_t*
+cach_chunk(const cach_t* cache, size_t index, const emit_ctx_t* ctx);
+
+/**
+ * @brief restore the strings of a cache.
+ *
+ * @param cache the cache.
+ * @param image the mapped image of the binary the strings point into.
+ * @return the strings if successful, 0x0 o.w.
+ */
+strs_t*
+cach_strings(const cach_t* cache, const mapf_t* image);
+
+/**
+ * @brief restore the symbols of a cache.
+ *
+ * @param cache the cache.
+ * @param image the mapped image of the binary the names point into.
+ * @return the symbols if successful, 0x0 o.w.
+ */
+syms_t*
+cach_symbols(const cach_t* cache, const mapf_t* image);
+
+/**
+ * @brief write the cache file of a key; the file is written aside and renamed into place, so
+ *  an older cache that is still mapped stays valid.
+ *
+ * @param key the cache key.
+ * @param ctx the emit context (for the code ranges).
+ * @param store the instruction store, only decoded chunks are written.
+ * @param strings the strings of the binary (or 0x0).
+ * @param symbols the symbols of the binary (or 0x0).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+cach_save(const cach_key_t* key, const emit_ctx_t* ctx, const insn_store_t* store, \
+    const strs_t* strings, const syms_t* symbols);
+#endif /* LZD_CACH_H */
@@ -0,0 +1,558 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-15
+ */
+#include "diff.h"
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses calloc, free, qsort, strtoull. */
+#include <stdlib.h>
+
+/*! @uses strcmp, strncmp, strlen, memcpy, memset. */
+#include <string.h>
+
+/*! @uses atomic_size_t, atomic_fetch_add, atomic_load. */
+#include <stdatomic.h>
+
+/*! @uses cs_disasm_iter, cs_insn. */
+#include <capstone/capstone.h>
+
+/*! @uses internal. */
+#include "dyna.h"
+
+/*! @uses disj_thread_handle, disj_reference. */
+#include "disj.h"
+
+/*! @uses stat_now. */
+#include "stat.h"
+
+/* an empty slot of a match table. */
+#define DIFF_EMPTY UINT32_MAX
+
+/* one of the two binaries of a diff. */
+typedef struct {
+    const emit_ctx_t* ctx; /* its emit context (borrowed). */
+    const syms_t* symbols; /* its (indexed) symbols (borrowed). */
+    insn_chunk_t* chunks; /* views of the chunks of its decode cache, by base address. */
+    size_t chunk_count; /* number of chunk views. */
+    uint64_t lo, hi; /* bounds of its loadable segments, an immediate inside of them is an address. */
+    diff_func_t* funcs; /* its functions, by address. */
+    size_t count; /* number of functions. */
+    atomic_size_t cached; /* functions hashed out of the decode cache. */
+} diff_side_t;
+
+/* a run of functions of one side to be hashed on the pool. */
+typedef struct {
+    diff_side_t* side;
+    size_t first, last; /* functions [first, last) of the side. */
+} diff_job_t;
+
+/**
+ * @brief hash bytes into a running hash (fnv-1a).
+ *
+ * @param hash the running hash.
+ * @param data the bytes.
+ * @param size the number of bytes.
+ * @return the hash.
+ */
+internal uint64_t
+fnv(uint64_t hash, const void* data, size_t size) {
+    for (const uint8_t* p = data; size > 0u; size--, p++) hash = (hash ^ *p) * 0x100000001b3ull;
+    return hash;
+}
+
+/**
+ * @brief hash a string into a running hash (fnv-1a).
+ *
+ * @param hash the running hash.
+ * @param text the string.
+ * @return the hash.
+ */
+internal uint64_t
+fnv_str(uint64_t hash, const char* text) {
+    for (const uint8_t* p = (const uint8_t*) text; *p; p++) hash = (hash ^ *p) * 0x100000001b3ull;
+    return hash;
+}
+
+/**
+ * @brief scramble a hash, so that sums of them don't cancel out (splitmix64).
+ *
+ * @param x the hash.
+ * @return the scrambled hash.
+ */
+internal uint64_t
+mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief hash the text of an instruction into a running hash; an immediate that points into the
+ *  image (and a rip-relative displacement) hashes as '@', where it points to is hashed with the
+ *  references of the function.
+ *
+ * @param side the side the instruction is of.
+ * @param hash the running hash.
+ * @param mnemonic the mnemonic.
+ * @param op_str the operands.
+ * @return the hash.
+ */
+internal uint64_t
+hash_text(const diff_side_t* side, uint64_t hash, const char* mnemonic, const char* op_str) {
+    hash = fnv_str(hash, mnemonic);
+    hash = fnv(hash, " ", 1u);
+    for (const char* p = op_str; p && *p;) {
+        if (p[0] != '0' || p[1] != 'x') {
+            hash = fnv(hash, p++, 1u);
+            continue;
+        }
+        char* end = 0x0;
+        uint64_t value = strtoull(p, &end, 16);
+        bool rip = p - op_str >= 6 && (!strncmp(p - 6, "rip + ", 6u) || !strncmp(p - 6, "rip - ", 6u));
+        bool address = value >= DIFF_LOW_ADDRESS && value >= side->lo && value < side->hi;
+        hash = rip || address ? fnv(hash, "@", 1u) : fnv(hash, p, (size_t) (end - p));
+        p = end;
+    }
+    return fnv(hash, "\n", 1u);
+}
+
+/**
+ * @brief hash a reference out of a function by where it points to: an offset into the function
+ *  itself, a symbol (and an offset into it), or somewhere else.
+ *
+ * @param side the side the function is of.
+ * @param func the function.
+ * @param from the offset of the referring instruction into the function.
+ * @param kind the insn_xref_kind_t of the reference.
+ * @param target the address referred to.
+ * @return the hash of the reference, references are summed so their order doesn't matter.
+ */
+internal uint64_t
+hash_ref(const diff_side_t* side, const diff_func_t* func, uint64_t from, uint8_t kind, uint64_t target) {
+    uint64_t into = 0u, to = 0u;
+    if (target >= func->address && target < func->address + func->size)
+        to = mix(target - func->address) ^ 0x1u;
+    else {
+        const elf_symbol_t* symbol = syms_at(side->symbols, target, &into);
+        to = 0x3u;
+        if (symbol && symbol->name) to = fnv(fnv_str(0xcbf29ce484222325ull, symbol->name), &into, sizeof into);
+    }
+    return mix(to ^ mix(from << 8 | kind));
+}
+
+/**
+ * @brief hash a function out of the decode cache, if a chunk of it holds all of the function;
+ *  it hashes the same as hash_decoded would.
+ *
+ * @param side the side the function is of.
+ * @param func the function.
+ * @param out output for the hash.
+ * @return true if it was hashed, false o.w.
+ */
+internal bool
+hash_cached(const diff_side_t* side, const diff_func_t* func, uint64_t* out) {
+    /* the last chunk at or before the function, it has to hold it whole. */
+    size_t lo = 0u, hi = side->chunk_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2u;
+        if (side->chunks[mid].base <= func->address) lo = mid + 1u;
+        else hi = mid;
+    }
+    if (lo == 0u) return false;
+    const insn_chunk_t* chunk = &side->chunks[lo - 1u];
+    uint64_t start = func->address - chunk->base, end = start + func->size;
+    if (end > chunk->length) return false;
+
+    /* an instruction has to start right at the function. */
+    size_t first = 0u, last = chunk->count;
+    while (first < last) {
+        size_t mid = first + (last - first) / 2u;
+        if (chunk->offsets[mid] < start) first = mid + 1u;
+        else last = mid;
+    }
+    if (first == chunk->count || chunk->offsets[first] != start) return false;
+
+    uint64_t text = 0xcbf29ce484222325ull, refs = 0u;
+    for (size_t i = first; i < chunk->count && chunk->offsets[i] + chunk->sizes[i] <= end; i++) {
+        ux_insn_t insn;
+        insn_chunk_get(chunk, i, &insn);
+        text = hash_text(side, text, insn.mnemonic, insn.op_str);
+    }
+    for (size_t i = 0; i < chunk->xref_count; i++) {
+        const insn_xref_t* ref = &chunk->xrefs[i];
+        if (ref->from >= start && ref->from < end)
+            refs += hash_ref(side, func, ref->from - start, ref->kind, ref->target);
+    }
+    *out = mix(text ^ mix(refs));
+    return true;
+}
+
+/**
+ * @brief hash a function by decoding it.
+ *
+ * @param side the side the function is of.
+ * @param func the function.
+ * @param handle the capstone handle of the calling thread (in detail mode).
+ * @param insn the instruction to decode into.
+ * @return the hash.
+ */
+internal uint64_t
+hash_decoded(const diff_side_t* side, const diff_func_t* func, csh handle, cs_insn* insn) {
+    const emit_region_t* region = emit_region_at(side->ctx, func->address);
+    const uint8_t* code = region->data + (func->address - region->vaddr);
+    size_t size = (size_t) func->size;
+    uint64_t address = func->address, text = 0xcbf29ce484222325ull, refs = 0u;
+    while (cs_disasm_iter(handle, &code, &size, &address, insn)) {
+        text = hash_text(side, text, insn->mnemonic, insn->op_str);
+        insn_xref_t ref;
+        if (disj_reference(handle, side->ctx->tuple.arch, insn, &ref))
+            refs += hash_ref(side, func, insn->address - func->address, ref.kind, ref.target);
+    }
+    return mix(text ^ mix(refs));
+}
+
+/**
+ * @brief hash a run of functions (a worker job), out of the decode cache where it can.
+ *
+ * @param arg the diff_job_t.
+ */
+internal void
+hash_job(void* arg) {
+    diff_job_t* job = arg;
+    diff_side_t* side = job->side;
+    csh handle = 0;
+    cs_insn* insn = 0x0;
+    size_t cached = 0u;
+    for (size_t i = job->first; i < job->last; i++) {
+        diff_func_t* func = &side->funcs[i];
+        if (hash_cached(side, func, &func->hash)) {
+            cached++;
+            continue;
+        }
+
+        /* without a handle it can only tell the size apart. */
+        if (!insn && disj_thread_handle(side->ctx->tuple, &handle, &insn) != 0) {
+            func->hash = mix(func->size);
+            continue;
+        }
+        func->hash = hash_decoded(side, func, handle, insn);
+    }
+    atomic_fetch_add(&side->cached, cached);
+}
+
+/**
+ * @brief compare two functions by address (then global first, then by name) for qsort.
+ *
+ * @param a the first function.
+ * @param b the second function.
+ * @return the ordering of a and b.
+ */
+internal int
+func_compare(const void* a, const void* b) {
+    const diff_func_t* x = a;
+    const diff_func_t* y = b;
+    if (x->address != y->address) return x->address < y->address ? -1 : 1;
+    if (x->matched != y->matched) return x->matched > y->matched ? -1 : 1;
+    return strcmp(x->name, y->name);
+}
+
+/**
+ * @brief compare two chunk views by base address for qsort.
+ *
+ * @param a the first chunk.
+ * @param b the second chunk.
+ * @return the ordering of a and b.
+ */
+internal int
+chunk_compare(const void* a, const void* b) {
+    const insn_chunk_t* x = a;
+    const insn_chunk_t* y = b;
+    return x->base < y->base ? -1 : x->base > y->base ? 1 : 0;
+}
+
+/**
+ * @brief gather the functions of a binary (one per address, with its code inside of a region),
+ *  the bounds of its image and the chunks of its decode cache.
+ *
+ * @param side the side to fill.
+ * @param ctx the emit context.
+ * @param symbols the (indexed) symbols.
+ * @param cache the decode cache (or 0x0).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+side_init(diff_side_t* side, const emit_ctx_t* ctx, const syms_t* symbols, const cach_t* cache) {
+    side->ctx = ctx;
+    side->symbols = symbols;
+    side->lo = UINT64_MAX;
+    atomic_init(&side->cached, 0u);
+    for (size_t i = 0; i < ctx->elf->phnum; i++) {
+        const elf_phdr_t* phdr = &ctx->elf->phdrs[i];
+        if (phdr->type != ELF_PT_LOAD || phdr->memsz == 0u) continue;
+        if (phdr->vaddr < side->lo) side->lo = phdr->vaddr;
+        if (phdr->vaddr + phdr->memsz > side->hi) side->hi = phdr->vaddr + phdr->memsz;
+    }
+
+    /* matched holds whether the symbol is global while sorting, so aliases keep that name. */
+    size_t count = symbols ? symbols->count : 0u;
+    side->funcs = calloc(count ? count : 1u, sizeof *side->funcs);
+    size_t chunks = cache ? (size_t) cache->header->chunk_count : 0u;
+    side->chunks = calloc(chunks ? chunks : 1u, sizeof *side->chunks);
+    if (!side->funcs || !side->chunks) {
+        fprintf(stderr, "lzd, side_init; calloc failed; could not allocate memory for functions.\n");
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const elf_symbol_t* symbol = &symbols->symbols[i];
+        if (symbol->type != ELF_STT_FUNC || symbol->size == 0u || symbol->shndx == ELF_SHN_UNDEF || \
+            !symbol->name || !symbol->name[0]) continue;
+        const emit_region_t* region = emit_region_at(ctx, symbol->value);
+        if (!region || symbol->size > region->size - (symbol->value - region->vaddr)) continue;
+        side->funcs[side->count++] = (diff_func_t){ symbol->name, symbol->value, symbol->size, 0u, \
+            symbol->bind == ELF_STB_GLOBAL };
+    }
+    qsort(side->funcs, side->count, sizeof *side->funcs, func_compare);
+    size_t kept = 0u;
+    for (size_t i = 0; i < side->count; i++) {
+        if (kept > 0u && side->funcs[kept - 1u].address == side->funcs[i].address) continue;
+        side->funcs[kept] = side->funcs[i];
+        side->funcs[kept++].matched = 0u;
+    }
+    side->count = kept;
+
+    /* a chunk that is malformed is decoded instead. */
+    for (size_t i = 0; i < chunks; i++)
+        if (cach_view(cache, i, ctx, &side->chunks[side->chunk_count]) == 0) side->chunk_count++;
+    qsort(side->chunks, side->chunk_count, sizeof *side->chunks, chunk_compare);
+    return 0;
+}
+
+/**
+ * @brief build an open-addressed table of the functions of a side that aren't matched yet.
+ *
+ * @param side the side.
+ * @param key the hash of the name of a function, or of its code.
+ * @param mask output for the number of slots - 1.
+ * @return the slots (DIFF_EMPTY if empty) if successful, 0x0 o.w.
+ */
+internal uint32_t*
+table_build(const diff_side_t* side, uint64_t (*key)(const diff_func_t*), size_t* mask) {
+    size_t slots = 16u;
+    while (slots < side->count * 2u) slots <<= 1u;
+    uint32_t* table = calloc(slots, sizeof *table);
+    if (!table) {
+        fprintf(stderr, "lzd, table_build; calloc failed; could not allocate memory for table.\n");
+        return 0x0;
+    }
+    memset(table, 0xff, slots * sizeof *table);
+    *mask = slots - 1u;
+    for (size_t i = 0; i < side->count; i++) {
+        if (side->funcs[i].matched) continue;
+        size_t slot = (size_t) key(&side->funcs[i]) & *mask;
+        while (table[slot] != DIFF_EMPTY) slot = (slot + 1u) & *mask;
+        table[slot] = (uint32_t) i;
+    }
+    return table;
+}
+
+/**
+ * @brief get the key of a function by name.
+ *
+ * @param func the function.
+ * @return the hash of its name.
+ */
+internal uint64_t
+name_key(const diff_func_t* func) { return fnv_str(0xcbf29ce484222325ull, func->name); }
+
+/**
+ * @brief get the key of a function by code.
+ *
+ * @param func the function.
+ * @return the hash of its code.
+ */
+internal uint64_t
+code_key(const diff_func_t* func) { return func->hash; }
+
+/**
+ * @brief match the functions of the new side with the old one, by name first and by code after;
+ *  every entry of a changed, added or removed function is appended with its name.
+ *
+ * @param diff the diff, its entries have room for every function of both sides.
+ * @param old the old side.
+ * @param new the new side.
+ * @param names output for the name of every entry.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+match(diff_t* diff, diff_side_t* old, diff_side_t* new, const char** names) {
+    size_t mask = 0u;
+    uint32_t* table = table_build(old, name_key, &mask);
+    if (!table) return -1;
+
+    /* by name; a name that is there more than once (e.g. a static function) pairs up in order. */
+    for (size_t i = 0; i < new->count; i++) {
+        diff_func_t* func = &new->funcs[i];
+        size_t slot = (size_t) name_key(func) & mask;
+        for (; table[slot] != DIFF_EMPTY; slot = (slot + 1u) & mask) {
+            diff_func_t* other = &old->funcs[table[slot]];
+            if (other->matched || strcmp(other->name, func->name)) continue;
+            other->matched = func->matched = 1u;
+            if (other->hash == func->hash) diff->same++;
+            else {
+                names[diff->count] = func->name;
+                diff->entries[diff->count++] = (diff_entry_t){ DIFF_CHANGED, 0u, other->address, \
+                    other->size, func->address, func->size };
+            }
+            break;
+        }
+    }
+    free(table);
+
+    /* by code, for the ones whose name is only in one of them (renamed, or inlined as another). */
+    table = table_build(old, code_key, &mask);
+    if (!table) return -1;
+    for (size_t i = 0; i < new->count; i++) {
+        diff_func_t* func = &new->funcs[i];
+        if (func->matched) continue;
+        for (size_t slot = (size_t) func->hash & mask; table[slot] != DIFF_EMPTY; slot = (slot + 1u) & mask) {
+            diff_func_t* other = &old->funcs[table[slot]];
+            if (other->matched || other->hash != func->hash) continue;
+            other->matched = func->matched = 1u;
+            diff->renamed++;
+            break;
+        }
+        if (func->matched) continue;
+        names[diff->count] = func->name;
+        diff->entries[diff->count++] = (diff_entry_t){ DIFF_ADDED, 0u, 0u, 0u, func->address, func->size };
+    }
+    free(table);
+    for (size_t i = 0; i < old->count; i++) {
+        diff_func_t* func = &old->funcs[i];
+        if (func->matched) continue;
+        names[diff->count] = func->name;
+        diff->entries[diff->count++] = (diff_entry_t){ DIFF_REMOVED, 0u, func->address, func->size, 0u, 0u };
+    }
+    return 0;
+}
+
+/**
+ * @brief copy the name of every entry into the names of the diff.
+ *
+ * @param diff the diff.
+ * @param names the name of every entry (borrowed from the symbols).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+copy_names(diff_t* diff, const char** names) {
+    size_t size = 1u;
+    for (size_t i = 0; i < diff->count; i++) size += strlen(names[i]) + 1u;
+    if (size > UINT32_MAX || !(diff->names = calloc(size, 1u))) {
+        fprintf(stderr, "lzd, copy_names; calloc failed; could not allocate memory for names.\n");
+        return -1;
+    }
+    size_t offset = 0u;
+    for (size_t i = 0; i < diff->count; i++) {
+        size_t length = strlen(names[i]) + 1u;
+        memcpy(diff->names + offset, names[i], length);
+        diff->entries[i].name = (uint32_t) offset;
+        offset += length;
+    }
+    return 0;
+}
+
+/**
+ * @brief free what a side gathered.
+ *
+ * @param side the side.
+ */
+internal void
+side_free(diff_side_t* side) {
+    free(side->funcs);
+    free(side->chunks);
+}
+
+/**
+ * @brief diff the functions of two binaries; this waits for its own jobs to finish, so it is run off
+ *  of the ui thread.
+ *
+ * @param old the emit context of the old binary (borrowed, until it returns).
+ * @param old_symbols the (indexed) symbols of the old binary.
+ * @param old_cache the decode cache of the old binary (or 0x0).
+ * @param new the emit context of the new binary (borrowed, until it returns).
+ * @param new_symbols the (indexed) symbols of the new binary.
+ * @param new_cache the decode cache of the new binary (or 0x0).
+ * @param pool the worker pool to hash on (or 0x0 to hash on the calling thread).
+ * @return an allocated diff if successful, 0x0 o.w.
+ */
+diff_t*
+diff_binaries(const emit_ctx_t* old, const syms_t* old_symbols, const cach_t* old_cache, \
+    const emit_ctx_t* new, const syms_t* new_symbols, const cach_t* new_cache, wrk_pool_t* pool) {
+    if (!old || !new) return 0x0;
+    uint64_t started = stat_now();
+    diff_side_t sides[2] = { 0 };
+    diff_t* diff = calloc(1u, sizeof *diff);
+    if (!diff || side_init(&sides[0], old, old_symbols, old_cache) != 0 || \
+        side_init(&sides[1], new, new_symbols, new_cache) != 0) {
+        if (!diff) fprintf(stderr, "lzd, diff_binaries; calloc failed; could not allocate memory for diff.\n");
+        side_free(&sides[0]);
+        side_free(&sides[1]);
+        free(diff);
+        return 0x0;
+    }
+
+    /* runs of DIFF_BATCH functions of either side, hashed in parallel. */
+    size_t made = 0u, runs = (sides[0].count + DIFF_BATCH - 1u) / DIFF_BATCH + \
+        (sides[1].count + DIFF_BATCH - 1u) / DIFF_BATCH;
+    diff_job_t* batches = calloc(runs ? runs : 1u, sizeof *batches);
+    job_t* jobs = calloc(runs ? runs : 1u, sizeof *jobs);
+    size_t total = sides[0].count + sides[1].count;
+    diff->entries = calloc(total ? total : 1u, sizeof *diff->entries);
+    const char** names = calloc(total ? total : 1u, sizeof *names);
+    ssize_t result = batches && jobs && diff->entries && names ? 0 : -1;
+    if (result != 0) fprintf(stderr, "lzd, diff_binaries; calloc failed; could not allocate memory for jobs.\n");
+    for (size_t s = 0; result == 0 && s < 2u; s++) {
+        for (size_t i = 0; i < sides[s].count; i += DIFF_BATCH) {
+            batches[made] = (diff_job_t){ &sides[s], i, i + DIFF_BATCH < sides[s].count ? i + DIFF_BATCH : \
+                sides[s].count };
+            jobs[made] = (job_t){ hash_job, &batches[made] };
+            made++;
+        }
+    }
+    if (result == 0) {
+        if (!pool || made < 2u || wrk_pool_run_batch(pool, jobs, made, WRK_PRIO_LOW) != 0) {
+            for (size_t i = 0; i < made; i++) hash_job(&batches[i]);
+        }
+        result = match(diff, &sides[0], &sides[1], names);
+    }
+    if (result == 0) result = copy_names(diff, names);
+    diff->functions[0] = sides[0].count;
+    diff->functions[1] = sides[1].count;
+    diff->cached = atomic_load(&sides[0].cached) + atomic_load(&sides[1].cached);
+    diff->ns = stat_now() - started;
+    free(names);
+    free(jobs);
+    free(batches);
+    side_free(&sides[0]);
+    side_free(&sides[1]);
+    if (result != 0) {
+        diff_free(diff);
+        return 0x0;
+    }
+    return diff;
+}
+
+/**
+ * @brief free a diff.
+ *
+ * @param diff the diff to be freed.
+ */
+void
+diff_free(diff_t* diff) {
+    if (!diff) return;
+    free(diff->entries);
+    free(diff->names);
+    free(diff);
+}
@@ -0,0 +1,98 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-15
+ */
+#ifndef LZD_DIFF_H
+#define LZD_DIFF_H
+
+/*! @uses uint64_t, uint32_t, uint8_t. */
+#include <stdint.h>
+
+/*! @uses size_t, ssize_t. */
+#include <sys/types.h>
+
+/*! @uses wrk_pool_t. */
+#include "wrk.h"
+
+/*! @uses emit_ctx_t. */
+#include "emit.h"
+
+/*! @uses cach_t. */
+#include "cach.h"
+
+/*! @uses syms_t. */
+#include "syms.h"
+
+/* functions hashed by a single job. */
+#define DIFF_BATCH 256u
+
+/* an immediate below this is never taken for an address, even inside of the image. */
+#define DIFF_LOW_ADDRESS 0x1000u
+
+/* how a function changed from the old binary to the new one. */
+typedef enum {
+    DIFF_CHANGED = 0u, /* in both, under the same name, with other code. */
+    DIFF_ADDED, /* only in the new binary. */
+    DIFF_REMOVED, /* only in the old binary. */
+} diff_kind_t;
+
+/* a function of a binary, with the hash of its code. */
+typedef struct {
+    const char* name; /* borrowed from the symbols of its binary. */
+    uint64_t address; /* address of its first instruction. */
+    uint64_t size; /* size in bytes. */
+    uint64_t hash; /* position-independent hash of its instructions. */
+    uint8_t matched; /* matched with a function of the other binary. */
+} diff_func_t;
+
+/* a function that changed, is new, or is gone. */
+typedef struct {
+    uint8_t kind; /* diff_kind_t. */
+    uint32_t name; /* offset of its name in the names of the diff. */
+    uint64_t old_address, old_size; /* where it is in the old binary (0 if added). */
+    uint64_t new_address, new_size; /* where it is in the new binary (0 if removed). */
+} diff_entry_t;
+
+/**
+ * the functions that differ between two binaries; every function symbol of both is hashed over
+ *  its normalized instructions (addresses that move between builds hash as where they point
+ *  to: a symbol, an offset into the function itself, or "somewhere else"), on the worker pool,
+ *  and out of the decode cache for the code it holds. functions are matched by name first and by
+ *  hash after, so a renamed function that is otherwise the same isn't reported.
+ */
+typedef struct {
+    diff_entry_t* entries; /* the changed ones first, then the added and the removed ones. */
+    size_t count; /* number of entries. */
+    char* names; /* nul-terminated names of the entries (owned, the binaries may be closed). */
+    size_t functions[2]; /* functions of the old and the new binary. */
+    size_t same; /* matched by name, and identical. */
+    size_t renamed; /* matched only by hash, under another name. */
+    size_t cached; /* functions hashed out of a decode cache, without decoding. */
+    uint64_t ns; /* time it took. */
+} diff_t;
+
+/**
+ * @brief diff the functions of two binaries; this waits for its own jobs to finish, so it is run off
+ *  of the ui thread.
+ *
+ * @param old the emit context of the old binary (borrowed, until it returns).
+ * @param old_symbols the (indexed) symbols of the old binary.
+ * @param old_cache the decode cache of the old binary (or 0x0).
+ * @param new the emit context of the new binary (borrowed, until it returns).
+ * @param new_symbols the (indexed) symbols of the new binary.
+ * @param new_cache the decode cache of the new binary (or 0x0).
+ * @param pool the worker pool to hash on (or 0x0 to hash on the calling thread).
+ * @return an allocated diff if successful, 0x0 o.w.
+ */
+diff_t*
+diff_binaries(const emit_ctx_t* old, const syms_t* old_symbols, const cach_t* old_cache, \
+    const emit_ctx_t* new, const syms_t* new_symbols, const cach_t* new_cache, wrk_pool_t* pool);
+
+/**
+ * @brief free a diff.
+ *
+ * @param diff the diff to be freed.
+ */
+void
+diff_free(diff_t* diff);
+#endif /* LZD_DIFF_H */
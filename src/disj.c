@@ -4,27 +4,27 @@
  */
 #include "disj.h"
 
-/*! @uses ux_insn_t, ux_page_msg_t. */
+/*! @uses insn_chunk_t, ux_page_msg_t. */
 #include "ux.h"
 
 /*! @uses capstone. */
 #include <capstone/capstone.h>
 
-/*! @uses calloc, free, malloc. */
+/*! @uses calloc, realloc, free, qsort. */
 #include <stdlib.h>
 
 /*! @uses fprintf, stderr. */
 #include <stdio.h>
 
-/*! @uses memcpy, strncpy. */
-#include <string.h>
-
 /*! @uses pthread_key_t, pthread_once_t. */
 #include <pthread.h>
 
 /*! @uses internal. */
 #include "dyna.h"
 
+/*! @uses stat_now, stat_add, stat_record. */
+#include "stat.h"
+
 /* copied macro for minimum values. */
 #define min(a, b) ((a) < (b) ? (a) : (b))
 
@@ -34,6 +34,10 @@ typedef struct {
     tup_arch_t tuple;
     csh handle;
     int ok;
+    insn_xref_t* xrefs; /* references of the chunk being decoded, reused across jobs. */
+    size_t xref_capacity; /* allocated capacity of xrefs. */
+    insn_chunk_t* scratch; /* chunk every job decodes into before it is packed, reused too. */
+    cs_insn* insn; /* instruction decoded one at a time (cs_disasm_iter), reused too. */
 } cs_tls_t;
 
 /* thread specific key for capstone. */
@@ -49,7 +53,10 @@ internal void
 cs_tls_free(void* p) {
     cs_tls_t* t = p;
     if (!t) return; /* tls already freed. */
+    if (t->insn) cs_free(t->insn, 1u);
     if (t->ok) cs_close(&t->handle);
+    free(t->xrefs);
+    insn_chunk_free(t->scratch);
     free(t);
 };
 
@@ -90,6 +97,8 @@ cs_get(tup_arch_t tuple) {
         }
         pthread_setspecific(g_cs_key, tls);
     } else if (tls->ok) {
+        if (tls->insn) cs_free(tls->insn, 1u);
+        tls->insn = 0x0;
         cs_close(&tls->handle);
         tls->ok = 0;
     }
@@ -99,91 +108,393 @@ cs_get(tup_arch_t tuple) {
     if (cs_open(tuple.arch, tuple.mode, &tls->handle) != CS_ERR_OK)
         return NULL;
 
+    /* detail mode gives the operands, which is where references come from. */
+    cs_option(tls->handle, CS_OPT_DETAIL, CS_OPT_ON);
+
     tls->ok = 1;
     return tls;
 };
 #pragma endregion
 
 /**
- * @brief main worker thread for disassembling a byte buffer.
+ * @brief get the thread local capstone handle for an architecture, with its instruction to
+ *  decode into one at a time (cs_disasm_iter), allocated on first use.
  *
- * @param arg the job to be executed.
+ * @param tuple the architecture tuple.
+ * @return the thread local capstone handle and instruction, 0x0 if a failure occurs.
  */
-internal void
-disj_run_bytes(void* arg) {
-    disas_job_t *job = arg;
+internal cs_tls_t*
+cs_get_insn(tup_arch_t tuple) {
+    cs_tls_t* tls = cs_get(tuple);
+    if (!tls) return 0x0;
+    if (!tls->insn) tls->insn = cs_malloc(tls->handle);
+    if (!tls->insn) {
+        fprintf(stderr, "lzd, cs_get_insn; cs_malloc failed; could not allocate an instruction.\n");
+        return 0x0;
+    }
+    return tls;
+}
 
-    /* decode with capstone, get the tls handle and get ready to start iterating. */
-    cs_tls_t* tls = cs_get(job->tuple);
-    if (!tls) { free(job->data); free(job); return; }
-    cs_insn *insn = NULL;
-    size_t count = cs_disasm(tls->handle, job->data, job->length, job->vaddr, 0, &insn);
-
-    /* iterate through each instruction. */
-    dyna_t* disassembled = dyna_create();
-    for (size_t i = 0; i < count; i++) {
-        /* allocate a decompiled insn. and push the data. */
-        ux_insn_t* out = calloc(1u, sizeof *out);
-        out->address = insn[i].address;
-        out->size = (uint8_t) min(insn[i].size, 16);
-        memcpy(out->bytes, insn[i].bytes, out->size);
-        strncpy(out->mnemonic, insn[i].mnemonic, sizeof(out->mnemonic) - 1);
-        strncpy(out->op_str, insn[i].op_str, sizeof(out->op_str) - 1);
-        dyna_push(disassembled, out);
+/**
+ * @brief get the capstone handle of the calling thread for an architecture (in detail mode),
+ *  and an instruction to decode into one at a time; both stay owned by the thread.
+ *
+ * @param tuple the architecture tuple.
+ * @param handle output for the handle.
+ * @param insn output for the instruction (allocated with cs_malloc on first use).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+disj_thread_handle(tup_arch_t tuple, csh* handle, cs_insn** insn) {
+    cs_tls_t* tls = cs_get_insn(tuple);
+    if (!tls || !handle || !insn) return -1;
+    *handle = tls->handle;
+    *insn = tls->insn;
+    return 0;
+}
+
+/**
+ * @brief get the address an instruction refers to, a branch or call target or (on x86) the
+ *  target of a rip-relative memory operand.
+ *
+ * @param handle the capstone handle the instruction was decoded with (in detail mode).
+ * @param arch the architecture.
+ * @param insn the instruction.
+ * @param out the reference to be filled (its from is left to the caller).
+ * @return true if the instruction refers to an address, false o.w.
+ */
+bool
+disj_reference(csh handle, cs_arch arch, const cs_insn* insn, insn_xref_t* out) {
+    const cs_detail* detail = insn->detail;
+    if (!detail) return false;
+    bool call = cs_insn_group(handle, insn, CS_GRP_CALL);
+    bool branch = call || cs_insn_group(handle, insn, CS_GRP_JUMP);
+    out->kind = call ? INSN_XREF_CALL : INSN_XREF_JUMP;
+    switch (arch) {
+        case CS_ARCH_X86: {
+            for (uint8_t i = 0; i < detail->x86.op_count; i++) {
+                const cs_x86_op* op = &detail->x86.operands[i];
+                if (branch && op->type == X86_OP_IMM) {
+                    out->target = (uint64_t) op->imm;
+                    return true;
+                }
+                if (op->type == X86_OP_MEM && op->mem.base == X86_REG_RIP && \
+                    op->mem.index == X86_REG_INVALID) {
+                    out->target = insn->address + insn->size + (uint64_t) op->mem.disp;
+                    out->kind = INSN_XREF_DATA;
+                    return true;
+                }
+            }
+            return false;
+        }
+        case CS_ARCH_AARCH64: {
+            for (uint8_t i = 0; branch && i < detail->aarch64.op_count; i++) {
+                if (detail->aarch64.operands[i].type != AARCH64_OP_IMM) continue;
+                out->target = (uint64_t) detail->aarch64.operands[i].imm;
+                return true;
+            }
+            return false;
+        }
+        case CS_ARCH_ARM: {
+            for (uint8_t i = 0; branch && i < detail->arm.op_count; i++) {
+                if (detail->arm.operands[i].type != ARM_OP_IMM) continue;
+                out->target = (uint64_t) (uint32_t) detail->arm.operands[i].imm;
+                return true;
+            }
+            return false;
+        }
+        default: return false;
+    }
+}
+
+/**
+ * @brief compare two references by target (then by source) for qsort.
+ *
+ * @param a the first reference.
+ * @param b the second reference.
+ * @return the ordering of a and b.
+ */
+internal int
+xref_compare(const void* a, const void* b) {
+    const insn_xref_t* x = a;
+    const insn_xref_t* y = b;
+    if (x->target != y->target) return x->target < y->target ? -1 : 1;
+    return x->from < y->from ? -1 : x->from > y->from ? 1 : 0;
+}
+
+/**
+ * @brief append a reference to the thread-local buffer, growing it when needed.
+ *
+ * @param tls the thread specific tls.
+ * @param count the number of references in the buffer.
+ * @param xref the reference to be appended.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+tls_push_xref(cs_tls_t* tls, size_t count, const insn_xref_t* xref) {
+    if (count == tls->xref_capacity) {
+        size_t capacity = tls->xref_capacity ? tls->xref_capacity * 2u : 1024u;
+        insn_xref_t* grown = realloc(tls->xrefs, capacity * sizeof *grown);
+        if (!grown) {
+            fprintf(stderr, "lzd, tls_push_xref; realloc failed; could not grow xrefs.\n");
+            return -1;
+        }
+        tls->xrefs = grown;
+        tls->xref_capacity = capacity;
+    }
+    tls->xrefs[count] = *xref;
+    return 0;
+}
+
+/**
+ * @brief check if a job is stale, its binary was closed or its generation has passed.
+ *
+ * @param job the job.
+ * @return true if the job is stale, false o.w.
+ */
+internal bool
+job_stale(const disas_job_t* job) {
+    if (!job->token) return false;
+    if (atomic_load(&job->token->closed)) return true;
+    return job->generation && atomic_load_explicit(&job->token->generation, memory_order_relaxed) \
+        != job->generation;
+}
+
+/**
+ * @brief post the page of a job to the ux module; a stale (or failed) job posts an empty page, so
+ *  the placeholder is requested again when it is still wanted, unless the binary was closed.
+ *
+ * @param job the job (freed).
+ * @param chunk the decoded chunk (ownership is taken), or 0x0 if the job was stale or failed.
+ */
+internal void
+job_post(disas_job_t* job, insn_chunk_t* chunk) {
+    if (!chunk && job->token && atomic_load(&job->token->closed)) {
+        free(job);
+        return;
     }
-    cs_free(insn, count);
 
     /* allocate and pack a message, then post. */
     ux_page_msg_t* message = calloc(1, sizeof *message);
+    if (!message) {
+        fprintf(stderr, "lzd, job_post; calloc failed; could not allocate memory for message.\n");
+        insn_chunk_free(chunk);
+        free(job);
+        return;
+    }
     message->pid = 0; /* no pid for byte-based disassembly. */
     message->base = job->vaddr;
     message->length = job->length;
     message->read = job->length;
-    message->insns = disassembled;
-    ux_post(message); /* handler now owns msg + msg->insns. */
-
-    free(job->data);
+    message->generation = job->generation;
+    message->owner = job->token;
+    message->chunk = chunk;
+    ux_post(message); /* handler now owns msg + msg->chunk. */
     free(job);
+}
+
+/**
+ * @brief main worker thread for disassembling a byte buffer.
+ *
+ * @param arg the job to be executed.
+ */
+internal void
+disj_run_bytes(void* arg) {
+    disas_job_t *job = arg;
+
+    /* a stale job is dropped while it is still cheap to. */
+    if (job_stale(job)) {
+        job_post(job, 0x0);
+        return;
+    }
+
+    /* decode with capstone, one instruction at a time into the one owned by this thread, so
+     *  a job doesn't allocate (or copy out of) an array of every instruction in its range. */
+    cs_tls_t* tls = cs_get_insn(job->tuple);
+    if (!tls) {
+        job_post(job, 0x0);
+        return;
+    }
+    csh handle = tls->handle;
+    cs_insn* insn = tls->insn;
+
+    /* decode into the scratch chunk of this thread, over the (borrowed) bytes; its columns only
+     *  grow until they fit the largest code range, so steady decoding doesn't allocate. whatever
+     *  starts past the end is lookahead, kept until the chunk is stitched to the next one. */
+    if (tls->scratch) insn_chunk_reset(tls->scratch, job->vaddr, job->length, job->data);
+    else tls->scratch = insn_chunk_create(job->vaddr, job->length, job->data);
+    insn_chunk_t* scratch = tls->scratch;
+    if (!scratch) {
+        job_post(job, 0x0);
+        return;
+    }
+    scratch->seam = job->seam;
+    uint64_t started = stat_now();
+    size_t xrefs = 0u, size = job->length + job->overlap;
+    const uint8_t* code = job->data;
+    uint64_t address = job->vaddr;
+    while (cs_disasm_iter(handle, &code, &size, &address, insn)) {
+        if (insn_chunk_push(scratch, insn->address, (uint8_t) min(insn->size, 16), \
+            insn->mnemonic, insn->op_str) != 0) {
+            fprintf(stderr, "lzd, disj_run_bytes; insn_chunk_push failed at 0x%lx.\n", insn->address);
+            break;
+        }
+        if (insn->address >= job->vaddr + job->length) scratch->overlap++;
+
+        /* references are gathered in the thread-local buffer, the chunk gets an exact copy. */
+        insn_xref_t xref = { 0u, (uint32_t) (insn->address - job->vaddr), 0u, { 0u } };
+        if (disj_reference(handle, job->tuple.arch, insn, &xref) && \
+            tls_push_xref(tls, xrefs, &xref) == 0) xrefs++;
+    }
+    stat_add(STAT_BYTES_DECODED, job->length);
+    stat_add(STAT_INSNS_DECODED, scratch->count);
+    if (job->length > 0u) stat_record(STAT_HIST_DECODE, (stat_now() - started) * 1024u / job->length);
+
+    /* it may have gone stale while decoding, there is no point in keeping it then. */
+    if (job_stale(job)) {
+        job_post(job, 0x0);
+        return;
+    }
+
+    /* sorted by target, so the xref index can merge them as a run; then the chunk is packed
+     *  into the arena of the binary with exactly what it holds (an empty page if it can't be). */
+    if (xrefs > 0u) qsort(tls->xrefs, xrefs, sizeof *tls->xrefs, xref_compare);
+    insn_chunk_t* chunk = insn_chunk_pack(scratch, tls->xrefs, xrefs, job->arena);
+    job_post(job, chunk);
 };
 
 /**
- * @brief post a byte buffer to be disassembled by worker threads.
+ * @brief initialize a generation token, at generation 1 and open, with nothing in flight.
  *
- * @param pool the worker pool to post the job to.
+ * @param token the token.
+ */
+void
+disj_token_init(disj_token_t* token) {
+    if (!token) return;
+    atomic_init(&token->generation, 1u);
+    atomic_init(&token->closed, false);
+    wrk_latch_init(&token->inflight);
+}
+
+/**
+ * @brief move a token to its next generation, every job posted in an earlier one is stale.
+ *
+ * @param token the token.
+ * @return the new generation.
+ */
+uint64_t
+disj_token_bump(disj_token_t* token) {
+    if (!token) return 0u;
+    return atomic_fetch_add(&token->generation, 1u) + 1u;
+}
+
+/**
+ * @brief close a token, every job posted with it is stale (they still have to be waited for,
+ *  on its inflight latch).
+ *
+ * @param token the token.
+ */
+void
+disj_token_close(disj_token_t* token) {
+    if (token) atomic_store(&token->closed, true);
+}
+
+/**
+ * @brief open a closed token again, at generation 1; every job posted with it has to be done.
+ *
+ * @param token the token.
+ */
+void
+disj_token_open(disj_token_t* token) {
+    if (!token) return;
+    atomic_store(&token->generation, 1u);
+    atomic_store(&token->closed, false);
+}
+
+/**
+ * @brief destroy a generation token; every job posted with it has to be done.
+ *
+ * @param token the token.
+ */
+void
+disj_token_destroy(disj_token_t* token) {
+    if (token) wrk_latch_destroy(&token->inflight);
+}
+
+/**
+ * @brief prepare a job that disassembles a byte buffer, to be posted with wrk_pool_post_batch.
+ *
+ * @param out the job to be filled (its argument is freed by the job once it has run).
  * @param tuple the architecture tuple.
- * @param data the byte buffer (will be copied).
+ * @param data the byte buffer (borrowed, must outlive the job; see wrk_latch_wait).
  * @param length the length of the buffer.
  * @param vaddr the virtual address of the first byte.
+ * @param overlap readable bytes past length to decode as lookahead, if the next buffer starts at
+ *  a seam (0 o.w.).
+ * @param seam true if the buffer itself starts at a seam.
+ * @param arena the arena of the binary, the decoded chunk is packed into it.
+ * @param token the token of the binary (or 0x0).
+ * @param generation the generation the job is posted in (0 if only closing drops it).
  * @return -1 if a failure occurs, 0 o.w.
  */
 ssize_t
-disj_post_bytes(wrk_pool_t* pool, tup_arch_t tuple, uint8_t* data, \
-    size_t length, uint64_t vaddr) {
-    if (!pool || !data || length == 0) return -1;
-    /* allocate and copy the data. */
-    uint8_t* data_copy = malloc(length);
-    if (!data_copy) {
-        fprintf(stderr, "lzd, disj_post_bytes; malloc failed; could not allocate memory for data.\n");
-        return -1;
-    }
-    memcpy(data_copy, data, length);
+disj_job_bytes(job_t* out, tup_arch_t tuple, const uint8_t* data, size_t length, uint64_t vaddr, \
+    size_t overlap, bool seam, aren_t* arena, const disj_token_t* token, uint64_t generation) {
+    if (!out || !data || length == 0 || !arena) return -1;
 
-    /* allocate the job. */
+    /* allocate the job, the bytes are borrowed from the mapped image (zero-copy). */
     disas_job_t* job = calloc(1u, sizeof *job);
     if (!job) {
-        fprintf(stderr, "lzd, disj_post_bytes; calloc failed; could not allocate memory for job.\n");
-        free(data_copy);
+        fprintf(stderr, "lzd, disj_job_bytes; calloc failed; could not allocate memory for job.\n");
         return -1;
     }
     job->tuple = tuple;
-    job->data = data_copy;
+    job->data = data;
     job->length = length;
     job->vaddr = vaddr;
+    job->overlap = overlap;
+    job->seam = seam;
+    job->arena = arena;
+    job->token = token;
+    job->generation = generation;
+    out->fn = disj_run_bytes;
+    out->arg = job;
+    return 0;
+}
+
+/**
+ * @brief release a prepared job that was never posted.
+ *
+ * @param job the job to be released.
+ */
+void
+disj_job_drop(job_t* job) {
+    if (!job) return;
+    free(job->arg);
+    job->arg = 0x0;
+}
+
+/**
+ * @brief post a byte buffer to be disassembled by worker threads.
+ *
+ * @param pool the worker pool to post the job to.
+ * @param tuple the architecture tuple.
+ * @param data the byte buffer (borrowed, must outlive the job; see wrk_pool_drain).
+ * @param length the length of the buffer.
+ * @param vaddr the virtual address of the first byte.
+ * @param arena the arena the decoded chunk is packed into.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+disj_post_bytes(wrk_pool_t* pool, tup_arch_t tuple, const uint8_t* data, \
+    size_t length, uint64_t vaddr, aren_t* arena) {
+    if (!pool) return -1;
+    job_t job;
+    if (disj_job_bytes(&job, tuple, data, length, vaddr, 0u, false, arena, 0x0, 0u) != 0) return -1;
 
     /* post the job. */
-    if (wrk_pool_post(pool, disj_run_bytes, job) != 0) {
-        free(data_copy);
-        free(job);
+    if (wrk_pool_post(pool, job.fn, job.arg) != 0) {
+        disj_job_drop(&job);
         fprintf(stderr, "lzd, disj_post_bytes; wrk_pool_post failed; could not post job.\n");
         return -1;
     }
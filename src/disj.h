@@ -11,30 +11,155 @@
 /*! @uses pid_t. */
 #include <sys/types.h>
 
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses _Atomic, atomic_bool. */
+#include <stdatomic.h>
+
 /*! @uses tup_arch_t. */
 #include "arch.h"
 
-/*! @uses wrk_pool_t, wrk_pool_post. */
+/*! @uses wrk_pool_t, wrk_latch_t, job_t, wrk_pool_post. */
 #include "wrk.h"
 
+/*! @uses aren_t. */
+#include "aren.h"
+
+/*! @uses insn_xref_t. */
+#include "insn.h"
+
+/**
+ * a generation token shared by every job decoding one binary; a job is stale once the binary
+ *  is closed, or once the token moved past the generation the job was posted in (unless it was
+ *  posted in generation 0). a stale job is dropped before it decodes, or after, instead of
+ *  being posted.
+ */
+typedef struct {
+    _Atomic(uint64_t) generation; /* current generation, starts at 1. */
+    atomic_bool closed; /* the binary is being closed, every job is stale. */
+    wrk_latch_t inflight; /* every job of the binary that has not finished yet. */
+} disj_token_t;
+
 typedef struct {
     tup_arch_t tuple; /* architecture tuple for capstone. */
-    uint8_t* data; /* byte buffer to disassemble. */
+    const uint8_t* data; /* byte buffer to disassemble (borrowed, not owned). */
     size_t length; /* length of the buffer. */
     uint64_t vaddr; /* virtual address of the first byte. */
+    size_t overlap; /* bytes past length that may be decoded as lookahead into the next seam. */
+    bool seam; /* the buffer starts at a seam (see insn_chunk_t). */
+    aren_t* arena; /* arena of the binary, the decoded chunk is packed into it. */
+    const disj_token_t* token; /* token of the binary (or 0x0 if the job is never stale). */
+    uint64_t generation; /* generation the job was posted in, 0 if only closing drops it. */
 } disas_job_t;
 
+/**
+ * @brief get the capstone handle of the calling thread for an architecture (in detail mode),
+ *  and an instruction to decode into one at a time; both stay owned by the thread.
+ *
+ * @param tuple the architecture tuple.
+ * @param handle output for the handle.
+ * @param insn output for the instruction (allocated with cs_malloc on first use).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+disj_thread_handle(tup_arch_t tuple, csh* handle, cs_insn** insn);
+
+/**
+ * @brief get the address an instruction refers to, a branch or call target or (on x86) the
+ *  target of a rip-relative memory operand.
+ *
+ * @param handle the capstone handle the instruction was decoded with (in detail mode).
+ * @param arch the architecture.
+ * @param insn the instruction.
+ * @param out the reference to be filled (its from is left to the caller).
+ * @return true if the instruction refers to an address, false o.w.
+ */
+bool
+disj_reference(csh handle, cs_arch arch, const cs_insn* insn, insn_xref_t* out);
+
+/**
+ * @brief initialize a generation token, at generation 1 and open, with nothing in flight.
+ *
+ * @param token the token.
+ */
+void
+disj_token_init(disj_token_t* token);
+
+/**
+ * @brief move a token to its next generation, every job posted in an earlier one is stale.
+ *
+ * @param token the token.
+ * @return the new generation.
+ */
+uint64_t
+disj_token_bump(disj_token_t* token);
+
+/**
+ * @brief close a token, every job posted with it is stale (they still have to be waited for,
+ *  on its inflight latch).
+ *
+ * @param token the token.
+ */
+void
+disj_token_close(disj_token_t* token);
+
+/**
+ * @brief open a closed token again, at generation 1; every job posted with it has to be done.
+ *
+ * @param token the token.
+ */
+void
+disj_token_open(disj_token_t* token);
+
+/**
+ * @brief destroy a generation token; every job posted with it has to be done.
+ *
+ * @param token the token.
+ */
+void
+disj_token_destroy(disj_token_t* token);
+
+/**
+ * @brief prepare a job that disassembles a byte buffer, to be posted with wrk_pool_post_batch.
+ *
+ * @param out the job to be filled (its argument is freed by the job once it has run).
+ * @param tuple the architecture tuple.
+ * @param data the byte buffer (borrowed, must outlive the job; see wrk_latch_wait).
+ * @param length the length of the buffer.
+ * @param vaddr the virtual address of the first byte.
+ * @param overlap readable bytes past length to decode as lookahead, if the next buffer starts at
+ *  a seam (0 o.w.).
+ * @param seam true if the buffer itself starts at a seam.
+ * @param arena the arena of the binary, the decoded chunk is packed into it.
+ * @param token the token of the binary (or 0x0).
+ * @param generation the generation the job is posted in (0 if only closing drops it).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+disj_job_bytes(job_t* out, tup_arch_t tuple, const uint8_t* data, size_t length, uint64_t vaddr, \
+    size_t overlap, bool seam, aren_t* arena, const disj_token_t* token, uint64_t generation);
+
+/**
+ * @brief release a prepared job that was never posted.
+ *
+ * @param job the job to be released.
+ */
+void
+disj_job_drop(job_t* job);
+
 /**
  * @brief post a byte buffer to be disassembled by worker threads.
  *
  * @param pool the worker pool to post the job to.
  * @param tuple the architecture tuple.
- * @param data the byte buffer (will be copied).
+ * @param data the byte buffer (borrowed, must outlive the job; see wrk_pool_drain).
  * @param length the length of the buffer.
  * @param vaddr the virtual address of the first byte.
+ * @param arena the arena the decoded chunk is packed into.
  * @return -1 if a failure occurs, 0 o.w.
  */
 ssize_t
-disj_post_bytes(wrk_pool_t* pool, tup_arch_t tuple, uint8_t* data, \
-    size_t length, uint64_t vaddr);
+disj_post_bytes(wrk_pool_t* pool, tup_arch_t tuple, const uint8_t* data, \
+    size_t length, uint64_t vaddr, aren_t* arena);
 #endif /* LZD_DISJ_H */
@@ -4,15 +4,18 @@
  */
 #include "elfx.h"
 
-/*! @uses fprintf, stderr, fopen, fclose, fread, fseek, ftell. */
+/*! @uses fprintf, stderr. */
 #include <stdio.h>
 
-/*! @uses calloc, malloc, free. */
+/*! @uses calloc, free. */
 #include <stdlib.h>
 
-/*! @uses memcpy. */
+/*! @uses memcpy, memchr, strcmp, strdup. */
 #include <string.h>
 
+/*! @uses offsetof. */
+#include <stddef.h>
+
 /*! @uses internal. */
 #include "dyna.h"
 
@@ -117,6 +120,12 @@ typedef struct {
     uint64_t sh_entsize;
 } __attribute__((packed)) elf64_shdr_t;
 
+/* the elf64 header tables are viewed in place, as the structures they are parsed into. */
+_Static_assert(sizeof(elf_phdr_t) == sizeof(elf64_phdr_t) && offsetof(elf_phdr_t, offset) == 8u && \
+    offsetof(elf_phdr_t, align) == 48u, "elf_phdr_t must have the layout of an elf64 program header");
+_Static_assert(sizeof(elf_shdr_t) == sizeof(elf64_shdr_t) && offsetof(elf_shdr_t, link) == 40u && \
+    offsetof(elf_shdr_t, entsize) == 56u, "elf_shdr_t must have the layout of an elf64 section header");
+
 /**
  * @brief check if an elf identifier is valid.
  *
@@ -124,11 +133,135 @@ typedef struct {
  * @return if the identifier is valid.
  */
 internal bool
-elf_valid_ident(uint8_t* ident) {
+elf_valid_ident(const uint8_t* ident) {
     return ident[EI_MAG0] == 0x7fu && ident[EI_MAG1] == 'E' &&
            ident[EI_MAG2] == 'L' && ident[EI_MAG3] == 'F';
 }
 
+/**
+ * @brief check if a header table lies within the buffer.
+ *
+ * @param offset the file offset of the table.
+ * @param count the number of entries.
+ * @param entsize the size of an entry in the file.
+ * @param min the size of the entry structure, entsize can't be smaller.
+ * @param size the size of the buffer.
+ * @return if the table fits.
+ */
+internal bool
+table_fits(uint64_t offset, size_t count, size_t entsize, size_t min, size_t size) {
+    if (count == 0u) return true;
+    if (entsize < min || offset > size) return false;
+    return (size - offset) / entsize >= count;
+}
+
+/**
+ * @brief convert an elf32 program header.
+ *
+ * @param raw the program header in the file.
+ * @return the program header.
+ */
+internal elf_phdr_t
+phdr_from32(const elf32_phdr_t* raw) {
+    return (elf_phdr_t) { raw->p_type, raw->p_flags, raw->p_offset, raw->p_vaddr, raw->p_paddr, \
+        raw->p_filesz, raw->p_memsz, raw->p_align };
+}
+
+/**
+ * @brief convert an elf32 section header.
+ *
+ * @param raw the section header in the file.
+ * @return the section header.
+ */
+internal elf_shdr_t
+shdr_from32(const elf32_shdr_t* raw) {
+    return (elf_shdr_t) { raw->sh_name, raw->sh_type, raw->sh_flags, raw->sh_addr, raw->sh_offset, \
+        raw->sh_size, raw->sh_link, raw->sh_info, raw->sh_addralign, raw->sh_entsize };
+}
+
+/**
+ * @brief find the header tables and the section header string table of an elf in the buffer;
+ *  they are viewed in place when the layout in the file is the one of elf_phdr_t and elf_shdr_t
+ *  (elf64), and converted into a single allocation o.w. (elf32). extended numbering, for more
+ *  than 0xff00 sections, is resolved out of the first section header.
+ *
+ * @param elf the elf structure, with the fields of its header set.
+ * @param buffer the buffer containing the elf file.
+ * @param size the size of the buffer.
+ * @param phentsize the size of a program header in the file.
+ * @param shentsize the size of a section header in the file.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+elf_tables(elf_t* elf, const uint8_t* buffer, size_t size, size_t phentsize, size_t shentsize) {
+    bool wide = elf->class == ELF_CLASS_64;
+    size_t phmin = wide ? sizeof(elf64_phdr_t) : sizeof(elf32_phdr_t);
+    size_t shmin = wide ? sizeof(elf64_shdr_t) : sizeof(elf32_shdr_t);
+
+    /* the real counts are in the first section header when they don't fit into the elf header. */
+    if (elf->shoff && table_fits(elf->shoff, 1u, shentsize, shmin, size)) {
+        const uint8_t* first = buffer + elf->shoff;
+        elf_shdr_t zero;
+        if (wide) memcpy(&zero, first, sizeof zero);
+        else zero = shdr_from32((const elf32_shdr_t*) first);
+        if (elf->shnum == 0u && zero.size < UINT32_MAX) elf->shnum = (uint32_t) zero.size;
+        if (elf->shstrndx == ELF_SHN_XINDEX) elf->shstrndx = zero.link;
+        if (elf->phnum == ELF_PN_XNUM) elf->phnum = zero.info;
+    }
+
+    /* a table that isn't (whole) in the file is left out. */
+    if (!table_fits(elf->phoff, elf->phnum, phentsize, phmin, size)) elf->phnum = 0u;
+    if (!table_fits(elf->shoff, elf->shnum, shentsize, shmin, size)) elf->shnum = 0u;
+    const uint8_t* phtab = buffer + (elf->phnum ? elf->phoff : 0u);
+    const uint8_t* shtab = buffer + (elf->shnum ? elf->shoff : 0u);
+    bool phview = wide && elf->phnum && phentsize == sizeof(elf_phdr_t) && \
+        (uintptr_t) phtab % _Alignof(elf_phdr_t) == 0u;
+    bool shview = wide && elf->shnum && shentsize == sizeof(elf_shdr_t) && \
+        (uintptr_t) shtab % _Alignof(elf_shdr_t) == 0u;
+    if (phview) elf->phdrs = (const elf_phdr_t*) phtab;
+    if (shview) elf->shdrs = (const elf_shdr_t*) shtab;
+
+    /* the rest is converted, once; program headers first, then section headers. */
+    size_t phcopy = phview ? 0u : elf->phnum, shcopy = shview ? 0u : elf->shnum;
+    if (phcopy + shcopy > 0u) {
+        elf->headers = calloc(1u, phcopy * sizeof(elf_phdr_t) + shcopy * sizeof(elf_shdr_t));
+        if (!elf->headers) {
+            fprintf(stderr, "lzd, elf_tables; calloc failed; could not allocate memory for headers.\n");
+            return -1;
+        }
+        elf_phdr_t* phdrs = elf->headers;
+        elf_shdr_t* shdrs = (elf_shdr_t*) (phdrs + phcopy);
+        for (size_t i = 0; i < phcopy; i++) {
+            const uint8_t* raw = phtab + i * phentsize;
+            if (wide) memcpy(&phdrs[i], raw, sizeof *phdrs);
+            else phdrs[i] = phdr_from32((const elf32_phdr_t*) raw);
+        }
+        for (size_t i = 0; i < shcopy; i++) {
+            const uint8_t* raw = shtab + i * shentsize;
+            if (wide) memcpy(&shdrs[i], raw, sizeof *shdrs);
+            else shdrs[i] = shdr_from32((const elf32_shdr_t*) raw);
+        }
+        if (phcopy) elf->phdrs = phdrs;
+        if (shcopy) elf->shdrs = shdrs;
+    }
+
+    /* the section header string table is borrowed from the buffer. */
+    if (elf->shstrndx < elf->shnum) {
+        const elf_shdr_t* shstrtab = &elf->shdrs[elf->shstrndx];
+        if (shstrtab->offset <= size && shstrtab->size <= size - shstrtab->offset) {
+            elf->shstrtab = (const char*) buffer + shstrtab->offset;
+            elf->shstrtab_size = (size_t) shstrtab->size;
+        }
+    }
+
+    /* the name hash is sized now, and built on the first lookup. */
+    size_t slots = 16u;
+    while (slots < (size_t) elf->shnum * 2u) slots <<= 1u;
+    elf->names_mask = slots - 1u;
+    atomic_init(&elf->names, 0x0);
+    return 0;
+}
+
 /**
  * @brief parse an elf32 file from a buffer.
  *
@@ -137,8 +270,8 @@ elf_valid_ident(uint8_t* ident) {
  * @return a pointer to an allocated elf_t if successful, 0x0 o.w.
  */
 internal elf_t*
-elf_parse32(uint8_t* buffer, size_t size) {
-    elf32_ehdr_t* ehdr = (elf32_ehdr_t*)buffer;
+elf_parse32(const uint8_t* buffer, size_t size) {
+    const elf32_ehdr_t* ehdr = (const elf32_ehdr_t*)buffer;
     if (size < sizeof *ehdr) {
         fprintf(stderr, "lzd, elf_parse32; buffer too small for elf32 header.\n");
         return 0x0;
@@ -146,6 +279,10 @@ elf_parse32(uint8_t* buffer, size_t size) {
 
     /* allocate our elf structure. */
     elf_t* elf = calloc(1u, sizeof *elf);
+    if (!elf) {
+        fprintf(stderr, "lzd, elf_parse32; calloc failed; could not allocate memory for elf.\n");
+        return 0x0;
+    }
     elf->class = ELF_CLASS_32;
     elf->data = ehdr->e_ident[EI_DATA];
     elf->type = ehdr->e_type;
@@ -156,53 +293,11 @@ elf_parse32(uint8_t* buffer, size_t size) {
     elf->phnum = ehdr->e_phnum;
     elf->shnum = ehdr->e_shnum;
     elf->shstrndx = ehdr->e_shstrndx;
-    elf->phdrs = dyna_create();
-    elf->shdrs = dyna_create();
-
-    /* parse program headers. */
-    if (elf->phnum > 0 && elf->phoff + elf->phnum * sizeof(elf32_phdr_t) <= size) {
-        for (uint16_t i = 0; i < elf->phnum; i++) {
-            elf32_phdr_t* phdr32 = (elf32_phdr_t*)(buffer + elf->phoff + i * sizeof(elf32_phdr_t));
-            elf_phdr_t* phdr = calloc(1u, sizeof *phdr);
-            phdr->type = phdr32->p_type;
-            phdr->flags = phdr32->p_flags;
-            phdr->offset = phdr32->p_offset;
-            phdr->vaddr = phdr32->p_vaddr;
-            phdr->paddr = phdr32->p_paddr;
-            phdr->filesz = phdr32->p_filesz;
-            phdr->memsz = phdr32->p_memsz;
-            phdr->align = phdr32->p_align;
-            dyna_push(elf->phdrs, phdr);
-        }
-    }
 
-    /* parse section headers. */
-    if (elf->shnum > 0 && elf->shoff + elf->shnum * sizeof(elf32_shdr_t) <= size) {
-        for (uint16_t i = 0; i < elf->shnum; i++) {
-            elf32_shdr_t* shdr32 = (elf32_shdr_t*)(buffer + elf->shoff + i * sizeof(elf32_shdr_t));
-            elf_shdr_t* shdr = calloc(1u, sizeof *shdr);
-            shdr->name = shdr32->sh_name;
-            shdr->type = shdr32->sh_type;
-            shdr->flags = shdr32->sh_flags;
-            shdr->addr = shdr32->sh_addr;
-            shdr->offset = shdr32->sh_offset;
-            shdr->size = shdr32->sh_size;
-            shdr->link = shdr32->sh_link;
-            shdr->info = shdr32->sh_info;
-            shdr->addralign = shdr32->sh_addralign;
-            shdr->entsize = shdr32->sh_entsize;
-            dyna_push(elf->shdrs, shdr);
-        }
-
-        /* parse section header string table. */
-        if (elf->shstrndx < elf->shnum) {
-            elf_shdr_t* shstrtab = _get(elf->shdrs, elf_shdr_t*, elf->shstrndx);
-            if (shstrtab && shstrtab->offset + shstrtab->size <= size) {
-                elf->shstrtab_size = shstrtab->size;
-                elf->shstrtab = malloc(elf->shstrtab_size);
-                memcpy(elf->shstrtab, buffer + shstrtab->offset, elf->shstrtab_size);
-            }
-        }
+    /* find the header tables, and the section header string table. */
+    if (elf_tables(elf, buffer, size, ehdr->e_phentsize, ehdr->e_shentsize) != 0) {
+        free(elf);
+        return 0x0;
     }
     return elf;
 }
@@ -215,8 +310,8 @@ elf_parse32(uint8_t* buffer, size_t size) {
  * @return a pointer to an allocated elf_t if successful, 0x0 o.w.
  */
 internal elf_t*
-elf_parse64(uint8_t* buffer, size_t size) {
-    elf64_ehdr_t* ehdr = (elf64_ehdr_t*)buffer;
+elf_parse64(const uint8_t* buffer, size_t size) {
+    const elf64_ehdr_t* ehdr = (const elf64_ehdr_t*)buffer;
     if (size < sizeof *ehdr) {
         fprintf(stderr, "lzd, elf_parse64; buffer too small for elf64 header.\n");
         return 0x0;
@@ -224,6 +319,10 @@ elf_parse64(uint8_t* buffer, size_t size) {
 
     /* allocate our elf structure. */
     elf_t* elf = calloc(1u, sizeof *elf);
+    if (!elf) {
+        fprintf(stderr, "lzd, elf_parse64; calloc failed; could not allocate memory for elf.\n");
+        return 0x0;
+    }
     elf->class = ELF_CLASS_64;
     elf->data = ehdr->e_ident[EI_DATA];
     elf->type = ehdr->e_type;
@@ -234,53 +333,11 @@ elf_parse64(uint8_t* buffer, size_t size) {
     elf->phnum = ehdr->e_phnum;
     elf->shnum = ehdr->e_shnum;
     elf->shstrndx = ehdr->e_shstrndx;
-    elf->phdrs = dyna_create();
-    elf->shdrs = dyna_create();
-
-    /* parse program headers. */
-    if (elf->phnum > 0 && elf->phoff + elf->phnum * sizeof(elf64_phdr_t) <= size) {
-        for (uint16_t i = 0; i < elf->phnum; i++) {
-            elf64_phdr_t* phdr64 = (elf64_phdr_t*)(buffer + elf->phoff + i * sizeof(elf64_phdr_t));
-            elf_phdr_t* phdr = calloc(1u, sizeof *phdr);
-            phdr->type = phdr64->p_type;
-            phdr->flags = phdr64->p_flags;
-            phdr->offset = phdr64->p_offset;
-            phdr->vaddr = phdr64->p_vaddr;
-            phdr->paddr = phdr64->p_paddr;
-            phdr->filesz = phdr64->p_filesz;
-            phdr->memsz = phdr64->p_memsz;
-            phdr->align = phdr64->p_align;
-            dyna_push(elf->phdrs, phdr);
-        }
-    }
 
-    /* parse section headers. */
-    if (elf->shnum > 0 && elf->shoff + elf->shnum * sizeof(elf64_shdr_t) <= size) {
-        for (uint16_t i = 0; i < elf->shnum; i++) {
-            elf64_shdr_t* shdr64 = (elf64_shdr_t*)(buffer + elf->shoff + i * sizeof(elf64_shdr_t));
-            elf_shdr_t* shdr = calloc(1u, sizeof *shdr);
-            shdr->name = shdr64->sh_name;
-            shdr->type = shdr64->sh_type;
-            shdr->flags = shdr64->sh_flags;
-            shdr->addr = shdr64->sh_addr;
-            shdr->offset = shdr64->sh_offset;
-            shdr->size = shdr64->sh_size;
-            shdr->link = shdr64->sh_link;
-            shdr->info = shdr64->sh_info;
-            shdr->addralign = shdr64->sh_addralign;
-            shdr->entsize = shdr64->sh_entsize;
-            dyna_push(elf->shdrs, shdr);
-        }
-
-        /* parse section header string table. */
-        if (elf->shstrndx < elf->shnum) {
-            elf_shdr_t* shstrtab = _get(elf->shdrs, elf_shdr_t*, elf->shstrndx);
-            if (shstrtab && shstrtab->offset + shstrtab->size <= size) {
-                elf->shstrtab_size = shstrtab->size;
-                elf->shstrtab = malloc(elf->shstrtab_size);
-                memcpy(elf->shstrtab, buffer + shstrtab->offset, elf->shstrtab_size);
-            }
-        }
+    /* find the header tables (viewed in place), and the section header string table. */
+    if (elf_tables(elf, buffer, size, ehdr->e_phentsize, ehdr->e_shentsize) != 0) {
+        free(elf);
+        return 0x0;
     }
     return elf;
 }
@@ -293,37 +350,19 @@ elf_parse64(uint8_t* buffer, size_t size) {
  */
 elf_t*
 elf_parse(const char* path) {
-    /* open the file. */
-    FILE* file = fopen(path, "rb");
-    if (!file) {
-        fprintf(stderr, "lzd, elf_parse; could not open file %s.\n", path);
-        return 0x0;
-    }
-
-    /* get the file size. */
-    fseek(file, 0, SEEK_END);
-    size_t size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    /* read the file into a buffer. */
-    uint8_t* buffer = malloc(size);
-    if (!buffer) {
-        fprintf(stderr, "lzd, elf_parse; malloc failed; could not allocate memory for buffer.\n");
-        fclose(file);
+    /* map the file, the mapping is kept alive (and owned) by the elf structure. */
+    mapf_t* image = mapf_open(path);
+    if (!image) {
+        fprintf(stderr, "lzd, elf_parse; could not map file %s.\n", path);
         return 0x0;
     }
-    if (fread(buffer, 1u, size, file) != size) {
-        fprintf(stderr, "lzd, elf_parse; fread failed; could not read file %s.\n", path);
-        free(buffer);
-        fclose(file);
-        return 0x0;
-    }
-    fclose(file);
+    const uint8_t* buffer = image->data;
+    size_t size = image->size;
 
     /* check if the elf is valid. */
     if (size < EI_NIDENT || !elf_valid_ident(buffer)) {
         fprintf(stderr, "lzd, elf_parse; invalid elf file %s.\n", path);
-        free(buffer);
+        mapf_close(image);
         return 0x0;
     }
 
@@ -336,12 +375,13 @@ elf_parse(const char* path) {
     else
         fprintf(stderr, "lzd, elf_parse; unsupported elf class %d.\n", buffer[EI_CLASS]);
 
-    /* store path in elf structure. */
-    if (elf) {
-        elf->path = strdup(path);
+    /* store path and image in elf structure. */
+    if (!elf) {
+        mapf_close(image);
+        return 0x0;
     }
-
-    free(buffer);
+    elf->path = strdup(path);
+    elf->image = image;
     return elf;
 }
 
@@ -354,27 +394,13 @@ void
 elf_free(elf_t* elf) {
     if (!elf) return;
 
-    /* free program headers. */
-    if (elf->phdrs) {
-        _foreach(elf->phdrs, elf_phdr_t*, phdr)
-            free(phdr);
-        _endforeach;
-        dyna_free(elf->phdrs);
-    }
-
-    /* free section headers. */
-    if (elf->shdrs) {
-        _foreach(elf->shdrs, elf_shdr_t*, shdr)
-            free(shdr);
-        _endforeach;
-        dyna_free(elf->shdrs);
-    }
-
-    /* free string table. */
-    free(elf->shstrtab);
+    /* free the converted header tables and the name hash, the rest is a view of the image. */
+    free(elf->headers);
+    free(atomic_load(&elf->names));
 
-    /* free path. */
+    /* free path and unmap the image. */
     free(elf->path);
+    mapf_close(elf->image);
     free(elf);
 }
 
@@ -386,7 +412,7 @@ elf_free(elf_t* elf) {
  * @return a pointer to the name if successful, 0x0 o.w.
  */
 const char*
-elf_shdr_name(elf_t* elf, elf_shdr_t* shdr) {
+elf_shdr_name(const elf_t* elf, const elf_shdr_t* shdr) {
     if (!elf || !shdr || !elf->shstrtab) return 0x0;
     if (shdr->name >= elf->shstrtab_size) return 0x0;
 
@@ -396,6 +422,64 @@ elf_shdr_name(elf_t* elf, elf_shdr_t* shdr) {
     return s;
 }
 
+/**
+ * @brief hash a section name (fnv-1a).
+ *
+ * @param name the name.
+ * @return the hash.
+ */
+internal uint64_t
+name_hash(const char* name) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (; *name; name++) hash = (hash ^ (uint8_t) *name) * 0x100000001b3ull;
+    return hash;
+}
+
+/**
+ * @brief find a section by its name; the first lookup hashes the name of every section once (it
+ *  is safe to race), every later one is O(1).
+ *
+ * @param elf the elf structure.
+ * @param name the name of the section (e.g. ".text").
+ * @return the first section header of that name if there is one, 0x0 o.w.
+ */
+const elf_shdr_t*
+elf_section(elf_t* elf, const char* name) {
+    if (!elf || !name || !elf->shstrtab) return 0x0;
+    uint32_t* table = atomic_load_explicit(&elf->names, memory_order_acquire);
+    if (!table) {
+        /* open addressing by index + 1 (0 is empty), the first section of a name is kept. */
+        uint32_t* built = calloc(elf->names_mask + 1u, sizeof *built);
+        if (!built) {
+            fprintf(stderr, "lzd, elf_section; calloc failed; could not allocate memory for names.\n");
+            return 0x0;
+        }
+        for (uint32_t i = 1u; i < elf->shnum; i++) {
+            const char* at = elf_shdr_name(elf, &elf->shdrs[i]);
+            if (!at || !*at) continue;
+            size_t slot = (size_t) name_hash(at) & elf->names_mask;
+            while (built[slot] && strcmp(elf_shdr_name(elf, &elf->shdrs[built[slot] - 1u]), at))
+                slot = (slot + 1u) & elf->names_mask;
+            if (!built[slot]) built[slot] = i + 1u;
+        }
+
+        /* another thread may have built it meanwhile, the one that was published first stays. */
+        uint32_t* expected = 0x0;
+        if (atomic_compare_exchange_strong_explicit(&elf->names, &expected, built, \
+            memory_order_acq_rel, memory_order_acquire)) table = built;
+        else {
+            free(built);
+            table = expected;
+        }
+    }
+    for (size_t slot = (size_t) name_hash(name) & elf->names_mask; table[slot]; \
+        slot = (slot + 1u) & elf->names_mask) {
+        const elf_shdr_t* shdr = &elf->shdrs[table[slot] - 1u];
+        if (!strcmp(elf_shdr_name(elf, shdr), name)) return shdr;
+    }
+    return 0x0;
+}
+
 /**
  * @brief get the capstone architecture tuple for an elf file.
  *
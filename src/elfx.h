@@ -14,8 +14,11 @@
 /*! @uses bool. */
 #include <stdbool.h>
 
-/*! @uses dyna_t. */
-#include "dyna.h"
+/*! @uses _Atomic. */
+#include <stdatomic.h>
+
+/*! @uses mapf_t. */
+#include "mapf.h"
 
 /* elf class. */
 typedef enum {
@@ -87,6 +90,25 @@ typedef enum {
 #define ELF_SHF_ALLOC 0x2 /* occupies memory. */
 #define ELF_SHF_EXECINSTR 0x4 /* executable. */
 
+/* symbol types. */
+#define ELF_STT_NOTYPE 0x0 /* unspecified (e.g. an assembly label). */
+#define ELF_STT_OBJECT 0x1 /* data object. */
+#define ELF_STT_FUNC 0x2 /* function. */
+#define ELF_STT_GNU_IFUNC 0xa /* indirect function. */
+
+/* symbol bindings. */
+#define ELF_STB_LOCAL 0x0 /* local. */
+#define ELF_STB_GLOBAL 0x1 /* global. */
+#define ELF_STB_WEAK 0x2 /* weak. */
+
+/* special section indices. */
+#define ELF_SHN_UNDEF 0x0 /* undefined (imported). */
+#define ELF_SHN_LORESERVE 0xff00 /* first reserved index (absolute, common, ...). */
+#define ELF_SHN_XINDEX 0xffff /* e_shstrndx is in the sh_link of the first section header. */
+
+/* e_phnum is in the sh_info of the first section header (extended numbering). */
+#define ELF_PN_XNUM 0xffff
+
 /* ... */
 typedef struct {
     uint32_t type; /* segment type. */
@@ -122,19 +144,23 @@ typedef struct {
     uint64_t entry; /* entry point address. */
     uint64_t phoff; /* program header table offset. */
     uint64_t shoff; /* section header table offset. */
-    uint16_t phnum; /* number of program headers. */
-    uint16_t shnum; /* number of section headers. */
-    uint16_t shstrndx; /* section header string table index. */
-    dyna_t* phdrs; /* dynamic array of elf_phdr_t*. */
-    dyna_t* shdrs; /* dynamic array of elf_shdr_t*. */
-    char* shstrtab; /* section header string table. */
+    uint32_t phnum; /* number of program headers (0 if the table isn't in the file). */
+    uint32_t shnum; /* number of section headers (0 if the table isn't in the file). */
+    uint32_t shstrndx; /* section header string table index. */
+    const elf_phdr_t* phdrs; /* program header table, a view into the image for elf64. */
+    const elf_shdr_t* shdrs; /* section header table, a view into the image for elf64. */
+    void* headers; /* the tables that had to be converted (elf32), owned; 0x0 if none. */
+    const char* shstrtab; /* section header string table (borrowed from the image). */
     size_t shstrtab_size; /* size of shstrtab. */
+    _Atomic(uint32_t*) names; /* hash of section names to their index + 1, built on the first lookup. */
+    size_t names_mask; /* slots of the hash - 1, a power of two at least twice shnum. */
     char* path; /* path to elf file. */
+    mapf_t* image; /* read-only mapping of the whole file (owned). */
 } elf_t;
 
 /* ... */
 typedef struct {
-    char* name; /* symbol name (owned). */
+    const char* name; /* symbol name (borrowed from a mapped string table). */
     uint64_t value; /* virtual address / value. */
     uint64_t size; /* size of symbol (if known). */
     uint8_t info; /* st_info. */
@@ -169,7 +195,18 @@ elf_free(elf_t* elf);
  * @return a pointer to the name if successful, 0x0 o.w.
  */
 const char*
-elf_shdr_name(elf_t* elf, elf_shdr_t* shdr);
+elf_shdr_name(const elf_t* elf, const elf_shdr_t* shdr);
+
+/**
+ * @brief find a section by its name; the first lookup hashes the name of every section once (it
+ *  is safe to race), every later one is O(1).
+ *
+ * @param elf the elf structure.
+ * @param name the name of the section (e.g. ".text").
+ * @return the first section header of that name if there is one, 0x0 o.w.
+ */
+const elf_shdr_t*
+elf_section(elf_t* elf, const char* name);
 
 /**
  * @brief get the capstone architecture tuple for an elf file.
@@ -4,16 +4,28 @@
  */
 #include "emit.h"
 
-/*! @uses disj_post_bytes. */
+/*! @uses disj_job_bytes, disj_job_drop, disj_token_init, disj_token_destroy. */
 #include "disj.h"
 
-/*! @uses fprintf, stderr, fopen, fclose, fread, fseek. */
+/*! @uses aren_create, aren_destroy, aren_alloc, aren_mapped. */
+#include "aren.h"
+
+/*! @uses simd_set_t, simd_skip, simd_find_run. */
+#include "simd.h"
+
+/*! @uses xlen_count, XLEN_MAX. */
+#include "xlen.h"
+
+/*! @uses stat_now, stat_add, stat_record. */
+#include "stat.h"
+
+/*! @uses fprintf, stderr. */
 #include <stdio.h>
 
-/*! @uses calloc, malloc, free. */
+/*! @uses calloc, free, qsort. */
 #include <stdlib.h>
 
-/*! @uses memcmp, memset. */
+/*! @uses memmove, strcmp. */
 #include <string.h>
 
 /*! @uses bool, true, false. */
@@ -23,33 +35,82 @@
 #include "dyna.h"
 
 /**
- * @brief check if a byte is a common padding byte.
+ * @brief the bytes an architecture pads between functions with.
  *
- * @param byte the byte to check.
- * @return if the byte is padding.
+ * @param tuple the architecture tuple.
+ * @return the padding set (x86 pads with nops and int3, arm/aarch64 only with zeros).
  */
-internal bool
-is_padding(uint8_t byte) {
-    return byte == 0x00 || byte == 0x90 || byte == 0xcc;
+internal simd_set_t
+padding_set(tup_arch_t tuple) {
+    if (tuple.arch == CS_ARCH_X86) return (simd_set_t){ .bytes = { 0x00, 0x90, 0xcc }, .count = 3u };
+    return (simd_set_t){ .bytes = { 0x00 }, .count = 1u };
 }
 
 /**
- * @brief check if a sequence of bytes looks like padding.
+ * @brief compare two regions by virtual address for qsort.
  *
- * @param data the data to check.
- * @param length the length of the data.
- * @param min_run minimum run of padding bytes to consider it padding.
- * @return if the sequence is padding.
+ * @param a the first region.
+ * @param b the second region.
+ * @return the ordering of a and b.
  */
-internal bool
-is_padding_run(uint8_t* data, size_t length, size_t min_run) {
-    size_t count = 0;
-    for (size_t i = 0; i < length; i++) {
-        if (is_padding(data[i])) count++;
-        else count = 0;
-        if (count >= min_run) return true;
-    }
-    return false;
+internal int
+region_compare(const void* a, const void* b) {
+    const emit_region_t* x = a;
+    const emit_region_t* y = b;
+    return x->vaddr < y->vaddr ? -1 : x->vaddr > y->vaddr ? 1 : 0;
+}
+
+/**
+ * @brief collect the executable regions of an elf; every allocated SHF_EXECINSTR section with
+ *  bytes in the file, or every PF_X load segment if there are none (a stripped or sectionless
+ *  binary). they are sorted by address, and a region overlapping the one before it (e.g. the
+ *  sections of an object file, all at address 0) is dropped.
+ *
+ * @param elf the elf structure.
+ * @param count output for the number of regions.
+ * @return the regions (allocated, freed by the caller), or 0x0 if there are none.
+ */
+internal emit_region_t*
+find_regions(elf_t* elf, size_t* count) {
+    *count = 0u;
+    size_t capacity = (size_t) elf->shnum + elf->phnum;
+    emit_region_t* regions = calloc(capacity ? capacity : 1u, sizeof *regions);
+    if (!regions) {
+        fprintf(stderr, "lzd, find_regions; calloc failed; could not allocate memory for regions.\n");
+        return 0x0;
+    }
+    for (size_t i = 0; i < elf->shnum; i++) {
+        const elf_shdr_t* shdr = &elf->shdrs[i];
+        if (!(shdr->flags & ELF_SHF_EXECINSTR) || !(shdr->flags & ELF_SHF_ALLOC) || \
+            shdr->type == ELF_SHT_NOBITS || shdr->size == 0u)
+            continue;
+        const uint8_t* data = mapf_slice(elf->image, shdr->offset, shdr->size);
+        if (!data) continue;
+        regions[(*count)++] = (emit_region_t) { shdr->addr, shdr->offset, data, (size_t) shdr->size, \
+            elf_shdr_name(elf, shdr) };
+    }
+    if (*count == 0u) {
+        for (size_t i = 0; i < elf->phnum; i++) {
+            const elf_phdr_t* phdr = &elf->phdrs[i];
+            if (phdr->type != ELF_PT_LOAD || !(phdr->flags & ELF_PF_X) || phdr->filesz == 0u)
+                continue;
+            const uint8_t* data = mapf_slice(elf->image, phdr->offset, phdr->filesz);
+            if (!data) continue;
+            regions[(*count)++] = (emit_region_t) { phdr->vaddr, phdr->offset, data, \
+                (size_t) phdr->filesz, 0x0 };
+        }
+    }
+    qsort(regions, *count, sizeof *regions, region_compare);
+    size_t kept = 0u;
+    for (size_t i = 0; i < *count; i++) {
+        if (kept > 0u && regions[i].vaddr < regions[kept - 1u].vaddr + regions[kept - 1u].size)
+            continue;
+        regions[kept++] = regions[i];
+    }
+    *count = kept;
+    if (kept > 0u) return regions;
+    free(regions);
+    return 0x0;
 }
 
 /**
@@ -62,71 +123,49 @@ is_padding_run(uint8_t* data, size_t length, size_t min_run) {
 emit_ctx_t*
 emit_load(const char* path, tup_arch_t tuple) {
     /* parse the elf. */
+    uint64_t started = stat_now();
     elf_t* elf = elf_parse(path);
     if (!elf) {
         fprintf(stderr, "lzd, emit_load; could not parse elf file %s.\n", path);
         return 0x0;
     }
+    stat_add(STAT_BYTES_MAPPED, elf->image->size);
 
     /* if tuple is zero, auto-detect from elf. */
     if (tuple.arch == 0 && tuple.mode == 0) {
         tuple = elf_get_arch(elf);
     }
 
-    /* find the .text section. */
-    elf_shdr_t* text_shdr = 0x0;
-    _foreach(elf->shdrs, elf_shdr_t*, shdr)
-        const char* name = elf_shdr_name(elf, shdr);
-        if (name && strcmp(name, ".text") == 0) {
-            text_shdr = shdr;
-            break;
-        }
-    _endforeach;
-    if (!text_shdr) {
-        fprintf(stderr, "lzd, emit_load; could not find .text section.\n");
-        elf_free(elf);
-        return 0x0;
-    }
-
-    /* open the file and read .text section. */
-    FILE* file = fopen(path, "rb");
-    if (!file) {
-        fprintf(stderr, "lzd, emit_load; could not open file %s.\n", path);
-        elf_free(elf);
-        return 0x0;
-    }
-    if (fseek(file, text_shdr->offset, SEEK_SET) != 0) {
-        fprintf(stderr, "lzd, emit_load; fseek failed.\n");
-        fclose(file);
+    /* every executable region is borrowed straight out of the mapped image. */
+    size_t region_count = 0u;
+    emit_region_t* regions = find_regions(elf, &region_count);
+    if (!regions) {
+        fprintf(stderr, "lzd, emit_load; could not find an executable section or segment.\n");
         elf_free(elf);
         return 0x0;
     }
 
-    /* read .text section. */
-    uint8_t* text_data = malloc(text_shdr->size);
-    if (!text_data) {
-        fprintf(stderr, "lzd, emit_load; malloc failed; could not allocate memory for .text.\n");
-        fclose(file);
-        elf_free(elf);
-        return 0x0;
-    }
-    if (fread(text_data, 1, text_shdr->size, file) != text_shdr->size) {
-        fprintf(stderr, "lzd, emit_load; fread failed; could not read .text section.\n");
-        free(text_data);
-        fclose(file);
+    /* allocate and initialize context, with the arena everything decoded from it lives in. */
+    emit_ctx_t* ctx = calloc(1u, sizeof *ctx);
+    aren_t* arena = aren_create(), *chunks = aren_create();
+    if (!ctx || !arena || !chunks) {
+        fprintf(stderr, "lzd, emit_load; calloc failed; could not allocate memory for context.\n");
+        aren_destroy(arena);
+        aren_destroy(chunks);
+        free(ctx);
+        free(regions);
         elf_free(elf);
         return 0x0;
     }
-    fclose(file);
-
-    /* allocate and initialize context. */
-    emit_ctx_t* ctx = calloc(1u, sizeof *ctx);
+    ctx->arena = arena;
+    ctx->chunks = chunks;
     ctx->elf = elf;
     ctx->tuple = tuple;
-    ctx->text_data = text_data;
-    ctx->text_vaddr = text_shdr->addr;
-    ctx->text_size = text_shdr->size;
+    ctx->regions = regions;
+    ctx->region_count = region_count;
     ctx->code_ranges = dyna_create();
+    disj_token_init(&ctx->token);
+    stat_record(STAT_HIST_LOAD, stat_now() - started);
     return ctx;
 }
 
@@ -139,99 +178,323 @@ void
 emit_free(emit_ctx_t* ctx) {
     if (!ctx) return;
     elf_free(ctx->elf);
-    free(ctx->text_data);
-    if (ctx->code_ranges) {
-        _foreach(ctx->code_ranges, code_range_t*, range)
-            free(range);
-        _endforeach;
-        dyna_free(ctx->code_ranges);
-    }
+    free(ctx->regions);
+    if (ctx->code_ranges) dyna_free(ctx->code_ranges);
+    disj_token_destroy(&ctx->token);
+
+    /* the code ranges and every decoded chunk go with the arenas, in a few unmaps. */
+    aren_destroy(ctx->chunks);
+    aren_destroy(ctx->arena);
     free(ctx);
 }
 
 /**
- * @brief scan .text section and identify code ranges (skip nops/padding).
+ * @brief unmap every decoded chunk of a context at once and start a fresh arena for them; no
+ *  job may still be decoding into it, and no chunk out of it may still be installed anywhere.
+ *
+ * @param ctx the emit context.
+ * @return the bytes that were unmapped if successful, -1 o.w. (the chunks are kept).
+ */
+ssize_t
+emit_drop_chunks(emit_ctx_t* ctx) {
+    if (!ctx) return -1;
+    aren_t* fresh = aren_create();
+    if (!fresh) {
+        fprintf(stderr, "lzd, emit_drop_chunks; calloc failed; could not allocate memory for arena.\n");
+        return -1;
+    }
+    size_t mapped = aren_mapped(ctx->chunks);
+    aren_destroy(ctx->chunks);
+    ctx->chunks = fresh;
+    return (ssize_t) mapped;
+}
+
+/**
+ * @brief find the executable region an address falls in, in O(log n).
+ *
+ * @param ctx the emit context.
+ * @param vaddr the virtual address.
+ * @return the region if there is one, 0x0 o.w.
+ */
+const emit_region_t*
+emit_region_at(const emit_ctx_t* ctx, uint64_t vaddr) {
+    if (!ctx) return 0x0;
+
+    /* the last region starting at or before the address. */
+    size_t lo = 0u, hi = ctx->region_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2u;
+        if (ctx->regions[mid].vaddr <= vaddr) lo = mid + 1u;
+        else hi = mid;
+    }
+    if (lo == 0u) return 0x0;
+    const emit_region_t* region = &ctx->regions[lo - 1u];
+    return vaddr - region->vaddr < region->size ? region : 0x0;
+}
+
+/**
+ * @brief scan every executable region and identify code ranges (skip nops/padding).
  *
  * @param ctx the emit context.
  * @return -1 if a failure occurs, 0 o.w.
  */
 ssize_t
 emit_scan_text(emit_ctx_t* ctx) {
-    if (!ctx || !ctx->text_data) return -1;
-
-    /* scan through .text and find contiguous code ranges. */
-    size_t i = 0;
-    while (i < ctx->text_size) {
-        /* skip padding. */
-        if (is_padding(ctx->text_data[i])) {
-            i++;
-            continue;
-        }
-
-        /* found start of code, find the end. */
-        size_t start = i;
-        while (i < ctx->text_size) {
-            /* look ahead for padding runs (at least 16 bytes). */
-            if (i + 16 <= ctx->text_size && is_padding_run(&ctx->text_data[i], 16, 16)) {
-                break;
+    if (!ctx || !ctx->regions) return -1;
+    uint64_t started = stat_now();
+    size_t first = ctx->code_ranges->length;
+
+    /* scan through every region and find contiguous code ranges, a vector of bytes at a time. */
+    simd_set_t padding = padding_set(ctx->tuple);
+    for (size_t r = 0; r < ctx->region_count; r++) {
+        const emit_region_t* region = &ctx->regions[r];
+        size_t i = 0;
+        while (i < region->size) {
+            /* skip padding. */
+            i = simd_skip(region->data, region->size, i, &padding);
+            if (i >= region->size) break;
+
+            /* found start of code, it ends at the next padding run (at least 16 bytes). */
+            size_t start = i;
+            i = simd_find_run(region->data, region->size, i, &padding, 16u);
+
+            /* create a code range. */
+            size_t length = i - start;
+            if (length > 0) {
+                code_range_t* range = aren_alloc(ctx->arena, sizeof *range);
+                if (!range) {
+                    fprintf(stderr, "lzd, emit_scan_text; aren_alloc failed; could not allocate " \
+                        "code range.\n");
+                    return -1;
+                }
+                range->vaddr = region->vaddr + start;
+                range->offset = (size_t) region->offset + start;
+                range->length = length;
+                dyna_push(ctx->code_ranges, range);
             }
-            i++;
         }
+    }
+    stat_add(STAT_RANGES_SCANNED, ctx->code_ranges->length - first);
+    stat_record(STAT_HIST_SCAN, stat_now() - started);
+    return 0;
+}
 
-        /* create a code range. */
-        size_t length = i - start;
-        if (length > 0) {
-            code_range_t* range = calloc(1u, sizeof *range);
-            range->vaddr = ctx->text_vaddr + start;
-            range->offset = start;
-            range->length = length;
-            dyna_push(ctx->code_ranges, range);
-        }
+/**
+ * @brief compare two addresses, for qsort.
+ *
+ * @param a pointer to the first address.
+ * @param b pointer to the second address.
+ * @return < 0, 0 or > 0.
+ */
+internal int
+addr_compare(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief find the function start closest to an address within a window.
+ *
+ * @param starts sorted function starts.
+ * @param count the number of function starts.
+ * @param want the address we would like to split at.
+ * @param lo the lowest acceptable address.
+ * @param hi the highest acceptable address (exclusive).
+ * @return the closest function start in [lo, hi), or 0 if there is none.
+ */
+internal uint64_t
+nearest_start(const uint64_t* starts, size_t count, uint64_t want, uint64_t lo, uint64_t hi) {
+    size_t l = 0u, h = count;
+    while (l < h) {
+        size_t mid = l + (h - l) / 2u;
+        if (starts[mid] < want) l = mid + 1u;
+        else h = mid;
+    }
+
+    /* the first start at or after want, and the last one before it. */
+    uint64_t best = 0u, distance = UINT64_MAX;
+    if (l < count && starts[l] < hi) {
+        best = starts[l];
+        distance = starts[l] - want;
+    }
+    if (l > 0u && starts[l - 1u] >= lo && want - starts[l - 1u] < distance)
+        best = starts[l - 1u];
+    return best;
+}
+
+/**
+ * @brief split code ranges larger than a target size into pieces of about that size, so one
+ *  huge range doesn't serialize the decode; pieces start at function symbols when one is close
+ *  to the target, and at a seam (stitched after decoding) o.w.
+ *
+ * @param ctx the emit context (after emit_scan_text).
+ * @param symbols the symbols of the binary (or 0x0).
+ * @param target the target size of a piece in bytes.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+emit_split_ranges(emit_ctx_t* ctx, const syms_t* symbols, size_t target) {
+    if (!ctx || !ctx->code_ranges || target < 64u) return -1;
+
+    /* sorted function starts inside of a region, these are known instruction boundaries. */
+    size_t count = 0u;
+    uint64_t* starts = calloc(symbols && symbols->count ? symbols->count : 1u, sizeof *starts);
+    if (!starts) {
+        fprintf(stderr, "lzd, emit_split_ranges; calloc failed; could not allocate memory for starts.\n");
+        return -1;
+    }
+    for (size_t i = 0; symbols && i < symbols->count; i++) {
+        const elf_symbol_t* sym = &symbols->symbols[i];
+        if (sym->type != ELF_STT_FUNC || !emit_region_at(ctx, sym->value)) continue;
+        starts[count++] = sym->value;
     }
+    qsort(starts, count, sizeof *starts, addr_compare);
+
+    /* rebuild the list of code ranges, splitting anything over 1.5x the target. */
+    dyna_t* ranges = dyna_create();
+    if (!ranges) {
+        free(starts);
+        return -1;
+    }
+    _foreach(ctx->code_ranges, code_range_t*, range)
+        uint64_t pos = range->vaddr, end = range->vaddr + range->length;
+        bool seam = range->seam;
+        while (end - pos > target + target / 2u) {
+            /* prefer a function start within a quarter of the target, o.w. cut at a seam
+             *  aligned to 4 bytes (every fixed-width isa we decode is at least that aligned). */
+            uint64_t want = (pos + target) & ~(uint64_t) 3u;
+            uint64_t split = nearest_start(starts, count, want, want - target / 4u, \
+                want + target / 4u);
+            bool cut = split == 0u;
+            if (cut) split = want;
+
+            code_range_t* piece = aren_alloc(ctx->arena, sizeof *piece);
+            if (!piece) break;
+            piece->vaddr = pos;
+            piece->offset = range->offset + (size_t) (pos - range->vaddr);
+            piece->length = (size_t) (split - pos);
+            piece->seam = seam;
+            dyna_push(ranges, piece);
+            pos = split;
+            seam = cut;
+        }
+
+        /* the rest of the range (or all of it) keeps the original allocation. */
+        range->offset += (size_t) (pos - range->vaddr);
+        range->length = (size_t) (end - pos);
+        range->vaddr = pos;
+        range->seam = seam;
+        dyna_push(ranges, range);
+    _endforeach;
+    dyna_free(ctx->code_ranges);
+    ctx->code_ranges = ranges;
+    free(starts);
     return 0;
 }
 
 /**
- * @brief emit disassembly jobs for a specific virtual address range.
+ * @brief post disassembly jobs for every code range from an index on that intersects a virtual
+ *  address range, as a single batch.
  *
  * @param ctx the emit context.
  * @param pool the worker pool to post jobs to.
+ * @param first the index of the first code range to consider.
  * @param vaddr_start the starting virtual address.
  * @param vaddr_end the ending virtual address.
- * @return -1 if a failure occurs, 0 o.w.
+ * @param prio the priority of the jobs.
+ * @param generation the generation of ctx->token the jobs are posted in.
+ * @return -1 if a failure occurs (or nothing intersects), 0 o.w.
  */
-ssize_t
-emit_range(emit_ctx_t* ctx, wrk_pool_t* pool, uint64_t vaddr_start, uint64_t vaddr_end) {
-    if (!ctx || !pool) return -1;
+internal ssize_t
+post_ranges(emit_ctx_t* ctx, wrk_pool_t* pool, size_t first, uint64_t vaddr_start, \
+    uint64_t vaddr_end, wrk_prio_t prio, uint64_t generation) {
+    /* code ranges are sorted, so everything intersecting is contiguous from first on. */
+    size_t last = first;
+    while (last < ctx->code_ranges->length && \
+        _get(ctx->code_ranges, code_range_t*, last)->vaddr < vaddr_end)
+        last++;
+    if (last == first) return -1;
+    job_t* jobs = calloc(last - first, sizeof *jobs);
+    if (!jobs) {
+        fprintf(stderr, "lzd, post_ranges; calloc failed; could not allocate memory for jobs.\n");
+        return -1;
+    }
 
     /* find code ranges that intersect with the requested range. */
-    size_t posted = 0;
-    _foreach(ctx->code_ranges, code_range_t*, range)
+    size_t count = 0u;
+    bool failed = false;
+    for (size_t i = first; i < last && !failed; i++) {
+        code_range_t* range = _get(ctx->code_ranges, code_range_t*, i);
         uint64_t range_end = range->vaddr + range->length;
-
-        /* check for intersection. */
-        if (range->vaddr >= vaddr_end || range_end <= vaddr_start)
-            continue;
+        if (range_end <= vaddr_start) continue;
 
         /* calculate the intersection. */
         uint64_t job_vaddr = range->vaddr > vaddr_start ? range->vaddr : vaddr_start;
         uint64_t job_end = range_end < vaddr_end ? range_end : vaddr_end;
-        size_t job_offset = (job_vaddr - ctx->text_vaddr);
+        size_t job_offset = range->offset + (size_t) (job_vaddr - range->vaddr);
         size_t job_length = job_end - job_vaddr;
 
-        /* post the disassembly job. */
-        if (disj_post_bytes(pool, ctx->tuple, ctx->text_data + job_offset, \
-            job_length, job_vaddr) != 0) {
-            fprintf(stderr, "lzd, emit_range; disj_post_bytes failed.\n");
-            return -1;
+        /* decode a little past the end when the next range continues at a seam, so the two can
+         *  be stitched where their instruction streams agree. */
+        size_t overlap = 0u;
+        code_range_t* next = i + 1u < ctx->code_ranges->length ? \
+            _get(ctx->code_ranges, code_range_t*, i + 1u) : 0x0;
+        if (job_end == range_end && next && next->seam && next->vaddr == range_end) {
+            const emit_region_t* region = emit_region_at(ctx, range->vaddr);
+            size_t left = region->size - (size_t) (range_end - region->vaddr);
+            overlap = left < EMIT_SEAM_OVERLAP ? left : EMIT_SEAM_OVERLAP;
         }
-        posted++;
-    _endforeach;
-    return posted > 0 ? 0 : -1;
+        bool seam = range->seam && job_vaddr == range->vaddr;
+        if (disj_job_bytes(&jobs[count], ctx->tuple, ctx->elf->image->data + job_offset, \
+            job_length, job_vaddr, overlap, seam, ctx->chunks, &ctx->token, generation) != 0)
+            failed = true;
+        else count++;
+    }
+
+    /* post the disassembly jobs in one go. */
+    if (failed || count == 0u || wrk_pool_post_latched(pool, jobs, count, prio, &ctx->token.inflight) != 0) {
+        fprintf(stderr, "lzd, post_ranges; could not post disassembly jobs.\n");
+        for (size_t i = 0; i < count; i++)
+            disj_job_drop(&jobs[i]);
+        free(jobs);
+        return -1;
+    }
+    free(jobs);
+    return 0;
+}
+
+/**
+ * @brief emit disassembly jobs for a specific virtual address range.
+ *
+ * @param ctx the emit context.
+ * @param pool the worker pool to post jobs to.
+ * @param vaddr_start the starting virtual address.
+ * @param vaddr_end the ending virtual address.
+ * @param prio the priority of the jobs.
+ * @param generation the generation of ctx->token the jobs are posted in, they are dropped once
+ *  it has passed (0 if only closing the binary drops them).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+emit_range(emit_ctx_t* ctx, wrk_pool_t* pool, uint64_t vaddr_start, uint64_t vaddr_end, \
+    wrk_prio_t prio, uint64_t generation) {
+    if (!ctx || !pool) return -1;
+
+    /* code ranges are sorted and disjoint, so binary search for the first one ending after the
+     *  start of the requested range. */
+    size_t lo = 0u, hi = ctx->code_ranges->length;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2u;
+        code_range_t* range = _get(ctx->code_ranges, code_range_t*, mid);
+        if (range->vaddr + range->length <= vaddr_start) lo = mid + 1u;
+        else hi = mid;
+    }
+    return post_ranges(ctx, pool, lo, vaddr_start, vaddr_end, prio, generation);
 }
 
 /**
- * @brief emit all disassembly jobs for the entire binary.
+ * @brief emit all disassembly jobs for the entire binary, at low priority and only dropped
+ *  when the binary is closed.
  *
  * @param ctx the emit context.
  * @param pool the worker pool to post jobs to.
@@ -240,126 +503,196 @@ emit_range(emit_ctx_t* ctx, wrk_pool_t* pool, uint64_t vaddr_start, uint64_t vad
 ssize_t
 emit_all(emit_ctx_t* ctx, wrk_pool_t* pool) {
     if (!ctx || !pool) return -1;
+    if (ctx->code_ranges->length == 0u) return 0;
 
     /* post all code ranges. */
-    _foreach(ctx->code_ranges, code_range_t*, range)
-        if (disj_post_bytes(pool, ctx->tuple, ctx->text_data + range->offset, \
-            range->length, range->vaddr) != 0) {
-            fprintf(stderr, "lzd, emit_all; disj_post_bytes failed.\n");
-            return -1;
-        }
-    _endforeach;
-    return 0;
+    return post_ranges(ctx, pool, 0u, 0u, UINT64_MAX, WRK_PRIO_LOW, 0u);
 }
 
+/* a run of code ranges whose instructions are counted on the pool. */
+typedef struct {
+    const emit_ctx_t* ctx; /* the emit context. */
+    size_t first, last; /* the run of code ranges, [first, last). */
+} rows_job_t;
+
 /**
- * @brief check if a byte is printable ascii.
+ * @brief count the instructions of a run of code ranges with the length decoder (a worker job).
  *
- * @param c the byte to check.
- * @return if the byte is printable.
+ * @param arg the rows_job_t.
  */
-internal bool
-is_printable(uint8_t c) {
-    return c >= 0x20 && c <= 0x7e;
+internal void
+rows_job(void* arg) {
+    rows_job_t* job = arg;
+    for (size_t i = job->first; i < job->last; i++) {
+        code_range_t* range = _get(job->ctx->code_ranges, code_range_t*, i);
+        const emit_region_t* region = emit_region_at(job->ctx, range->vaddr);
+        if (!region) continue;
+
+        /* the last instruction may run past the end, into the rest of the region. */
+        size_t at = (size_t) (range->vaddr - region->vaddr), available = region->size - at;
+        if (available > range->length + XLEN_MAX) available = range->length + XLEN_MAX;
+        range->rows = xlen_count(region->data + at, range->length, available);
+    }
 }
 
 /**
- * @brief check if string is valid (has enough alphanumeric chars).
+ * @brief count the instructions of every code range with the x86_64 length decoder, without
+ *  decoding their operands, so placeholders hold (about) the row count they decode into; runs
+ *  of ranges are counted in parallel, this waits for its own jobs to finish. other architectures
+ *  are left to the rows-per-byte estimate.
  *
- * @param str the string to check.
- * @param len the length of the string.
- * @return if the string appears valid.
+ * @param ctx the emit context (after the code ranges are split).
+ * @param pool the worker pool to count on (or 0x0 to count on the calling thread).
+ * @return -1 if a failure occurs, 0 o.w.
  */
-internal bool
-is_valid_string(const char* str, size_t len) {
-    if (len == 0) return false;
-
-    size_t alnum_count = 0;
-    size_t space_count = 0;
+ssize_t
+emit_count_rows(emit_ctx_t* ctx, wrk_pool_t* pool) {
+    if (!ctx) return -1;
+    if (ctx->tuple.arch != CS_ARCH_X86 || ctx->tuple.mode != CS_MODE_64) return 0;
+    size_t count = ctx->code_ranges->length;
+    if (count == 0u) return 0;
+
+    /* runs of about EMIT_ROWS_PIECE bytes each, a huge binary has many small ranges. */
+    rows_job_t* runs = calloc(count, sizeof *runs);
+    job_t* jobs = calloc(count, sizeof *jobs);
+    if (!runs || !jobs) {
+        fprintf(stderr, "lzd, emit_count_rows; calloc failed; could not allocate memory for jobs.\n");
+        free(runs);
+        free(jobs);
+        return -1;
+    }
+    size_t made = 0u, bytes = 0u;
+    for (size_t i = 0; i < count; i++) {
+        if (bytes == 0u) runs[made] = (rows_job_t){ ctx, i, i };
+        runs[made].last = i + 1u;
+        bytes += _get(ctx->code_ranges, code_range_t*, i)->length;
+        if (bytes >= EMIT_ROWS_PIECE || i + 1u == count) {
+            jobs[made] = (job_t){ rows_job, &runs[made] };
+            made++;
+            bytes = 0u;
+        }
+    }
 
-    for (size_t i = 0; i < len; i++) {
-        uint8_t c = str[i];
-        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'))
-            alnum_count++;
-        else if (c == ' ')
-            space_count++;
+    /* count the runs in parallel, or right here if they can't be posted. */
+    if (!pool || made < 2u || wrk_pool_run_batch(pool, jobs, made, WRK_PRIO_HIGH) != 0) {
+        for (size_t i = 0; i < made; i++)
+            rows_job(&runs[i]);
     }
+    free(runs);
+    free(jobs);
+    return 0;
+}
+
+/* a piece of a section to be scanned for strings on the pool. */
+typedef struct {
+    strs_section_t section; /* the section. */
+    size_t start, end; /* the piece, strings starting in it are kept. */
+    size_t min_len; /* minimum string length, in characters. */
+    strs_t* found; /* strings found in the piece. */
+    bool failed; /* if the scan failed. */
+} strings_job_t;
 
-    /* require at least 50% alphanumeric, and not all spaces. */
-    return (alnum_count * 2 >= len) && (space_count < len);
+/**
+ * @brief scan a piece of a section for strings (a worker job).
+ *
+ * @param arg the strings_job_t.
+ */
+internal void
+strings_job(void* arg) {
+    strings_job_t* job = arg;
+    job->failed = strs_scan(job->found, &job->section, job->start, job->end, job->min_len) != 0;
 }
 
 /**
- * @brief extract printable strings from elf using strings command.
+ * @brief check if a section should be scanned for strings.
+ *
+ * @param elf the elf structure.
+ * @param index the index of the section header.
+ * @param header the section header.
+ * @return if the section holds data that isn't code.
+ */
+internal bool
+has_strings(const elf_t* elf, size_t index, const elf_shdr_t* header) {
+    if (!header || header->size == 0u || index == elf->shstrndx) return false;
+    if (header->type != ELF_SHT_PROGBITS && header->type != ELF_SHT_STRTAB) return false;
+    return !(header->flags & ELF_SHF_EXECINSTR);
+}
+
+/**
+ * @brief extract ascii, utf-8 and utf-16le strings from every non-executable section with
+ *  data; the sections are scanned in pieces in parallel, this waits for its own jobs to finish.
  *
  * @param ctx the emit context.
- * @param min_len minimum string length to extract (default 4).
- * @return dyna_t* of char* strings, or 0x0 on failure.
+ * @param pool the worker pool to scan on (or 0x0 to scan on the calling thread).
+ * @param min_len minimum string length to extract, in characters (default 4).
+ * @return the strings ordered by section and offset, they point into ctx->elf->image; or 0x0
+ *  on failure.
  */
-dyna_t*
-emit_extract_strings(emit_ctx_t* ctx, size_t min_len) {
-    dyna_t* strings = dyna_create();
+strs_t*
+emit_extract_strings(emit_ctx_t* ctx, wrk_pool_t* pool, size_t min_len) {
+    if (!ctx || !ctx->elf) return 0x0;
+    strs_t* strings = strs_create(ctx->elf->image);
     if (!strings) return 0x0;
 
-    /* scan .rodata and .data sections. */
-    const char* section_names[] = { ".rodata", ".data", ".dynstr", ".strtab" };
-    _foreach(ctx->elf->shdrs, elf_shdr_t*, header)
-        /* find the section. */
-        bool found = false;
-        const char* name = elf_shdr_name(ctx->elf, header);
-        if (!name) continue;
-        for (size_t j = 0; j < 4; j++) {
-            if (!strcmp(name, section_names[j])) {
-                found = true;
-                break;
-            }
-        }
-        if (!header || header->size == 0 || !found) continue;
-
-        /* read section data from file. */
-        FILE* f = fopen(ctx->elf->path, "rb");
-        if (!f) continue;
-        uint8_t* data = malloc(header->size);
-        if (!data) {
-            fclose(f);
-            continue;
-        }
-        fseek(f, header->offset, SEEK_SET);
-        size_t read = fread(data, 1, header->size, f);
-        fclose(f);
-        if (read != header->size) {
-            free(data);
-            continue;
-        }
+    /* count the pieces of every section that is scanned. */
+    const elf_shdr_t* shdrs = ctx->elf->shdrs;
+    size_t count = 0u;
+    for (size_t i = 0; i < ctx->elf->shnum; i++) {
+        const elf_shdr_t* header = &shdrs[i];
+        if (has_strings(ctx->elf, i, header))
+            count += (size_t) ((header->size + EMIT_STRING_PIECE - 1u) / EMIT_STRING_PIECE);
+    }
+    if (count == 0u) return strings;
+
+    strings_job_t* pieces = calloc(count, sizeof *pieces);
+    job_t* jobs = calloc(count, sizeof *jobs);
+    if (!pieces || !jobs) {
+        fprintf(stderr, "lzd, emit_extract_strings; calloc failed; could not allocate memory for jobs.\n");
+        free(pieces);
+        free(jobs);
+        strs_free(strings);
+        return 0x0;
+    }
 
-        /* extract strings. */
-        size_t str_start = 0;
-        bool in_string = false;
-        for (size_t j = 0; j < header->size; j++) {
-            if (is_printable(data[j]) && data[j] != 0) {
-                if (!in_string) {
-                    str_start = j;
-                    in_string = true;
-                }
-            } else {
-                if (in_string) {
-                    size_t len = j - str_start;
-                    if (len >= min_len) {
-                        /* validate the string before adding. */
-                        if (is_valid_string((char*)(data + str_start), len)) {
-                            char* str = calloc(1, len + 1);
-                            if (str) {
-                                memcpy(str, data + str_start, len);
-                                dyna_push(strings, str);
-                            }
-                        }
-                    }
-                    in_string = false;
-                }
-            }
+    /* borrow the section data from the mapped image, and split it into pieces. */
+    size_t made = 0u;
+    for (size_t i = 0; i < ctx->elf->shnum; i++) {
+        const elf_shdr_t* header = &shdrs[i];
+        if (!has_strings(ctx->elf, i, header)) continue;
+        const uint8_t* data = mapf_slice(ctx->elf->image, header->offset, header->size);
+        if (!data) continue;
+
+        strs_section_t section = {
+            .data = data, .size = (size_t) header->size, .offset = header->offset,
+            .vaddr = (header->flags & ELF_SHF_ALLOC) ? header->addr : 0u, .index = (uint16_t) i,
+        };
+        for (size_t start = 0; start < section.size; start += EMIT_STRING_PIECE) {
+            strings_job_t* piece = &pieces[made];
+            piece->section = section;
+            piece->start = start;
+            piece->end = section.size - start < EMIT_STRING_PIECE ? section.size : start + EMIT_STRING_PIECE;
+            piece->min_len = min_len;
+            piece->found = strs_create(ctx->elf->image);
+            if (!piece->found) break;
+            jobs[made++] = (job_t){ strings_job, piece };
         }
-        free(data);
-    _endforeach;
+    }
+
+    /* scan the pieces in parallel, or right here if they can't be posted. */
+    if (!pool || made < 2u || wrk_pool_run_batch(pool, jobs, made, WRK_PRIO_HIGH) != 0) {
+        for (size_t i = 0; i < made; i++)
+            strings_job(&pieces[i]);
+    }
+
+    /* pieces are in section and offset order, so are the strings found in them. */
+    bool failed = false;
+    for (size_t i = 0; i < made; i++) {
+        if (pieces[i].failed || strs_append(strings, pieces[i].found) != 0) failed = true;
+        strs_free(pieces[i].found);
+    }
+    free(pieces);
+    free(jobs);
+    if (failed) fprintf(stderr, "lzd, emit_extract_strings; could not extract every string.\n");
     return strings;
 }
 
@@ -387,166 +720,144 @@ typedef struct {
 #define ELF_ST_BIND(i) ((uint8_t)((i) >> 4))
 #define ELF_ST_TYPE(i) ((uint8_t)((i) & 0x0f))
 
+/* a run of entries of one symbol table to be parsed on the pool. */
+typedef struct {
+    const uint8_t* entries; /* symbol table bytes (borrowed from the image). */
+    size_t entsize; /* size of an entry. */
+    size_t first, last; /* the run of entries, [first, last). */
+    const char* names; /* string table of the symbol table (borrowed from the image). */
+    size_t names_bound; /* names starting before this are terminated inside of the table. */
+    bool wide; /* ELF64 entries, ELF32 o.w. */
+    elf_symbol_t* out; /* room for last - first symbols, in the shared table. */
+    size_t kept; /* number of symbols written to out. */
+} symbols_job_t;
+
 /**
- * @brief check if a string offset is valid and nul-terminated.
+ * @brief parse a run of entries of a symbol table (a worker job); only the offset of a name is
+ *  checked, every name in the table's bound is terminated, so nothing is copied or scanned.
  *
- * @param strtab the string table bytes.
- * @param strtab_size size of string table.
- * @param off offset into string table.
- * @return if the string is valid.
+ * @param arg the symbols_job_t.
  */
-internal bool
-is_valid_strtab_off(uint8_t* strtab, size_t strtab_size, uint32_t off) {
-    if (!strtab || strtab_size == 0) return false;
-    if (off >= strtab_size) return false;
-    /* must be nul-terminated within the table. */
-    return memchr(strtab + off, 0, strtab_size - off) != 0x0;
+internal void
+symbols_job(void* arg) {
+    symbols_job_t* job = arg;
+    elf_symbol_t* out = job->out;
+    for (size_t i = job->first; i < job->last; i++) {
+        const uint8_t* entry = job->entries + i * job->entsize;
+        elf_symbol_t sym;
+        uint32_t name;
+        if (job->wide) {
+            const elf64_sym_t* s = (const elf64_sym_t*) entry;
+            name = s->name;
+            sym = (elf_symbol_t){ 0x0, s->value, s->size, s->info, s->other, s->shndx, \
+                ELF_ST_BIND(s->info), ELF_ST_TYPE(s->info) };
+        } else {
+            const elf32_sym_t* s = (const elf32_sym_t*) entry;
+            name = s->name;
+            sym = (elf_symbol_t){ 0x0, (uint64_t) s->value, (uint64_t) s->size, s->info, s->other, \
+                s->shndx, ELF_ST_BIND(s->info), ELF_ST_TYPE(s->info) };
+        }
+        if (name == 0u || name >= job->names_bound || job->names[name] == '\0') continue;
+        sym.name = job->names + name;
+        *out++ = sym;
+    }
+    job->kept = (size_t) (out - job->out);
+}
+
+/**
+ * @brief get the entry size of a symbol table.
+ *
+ * @param elf the elf structure.
+ * @param header the section header.
+ * @return the entry size, 0 if the section isn't a symbol table that can be parsed.
+ */
+internal size_t
+symbols_entsize(const elf_t* elf, const elf_shdr_t* header) {
+    if (!header || (header->type != ELF_SHT_SYMTAB && header->type != ELF_SHT_DYNSYM)) return 0u;
+    size_t min = elf->class == ELF_CLASS_64 ? sizeof(elf64_sym_t) : sizeof(elf32_sym_t);
+    size_t entsize = header->entsize ? (size_t) header->entsize : min;
+    return entsize < min ? 0u : entsize;
 }
 
 /**
- * @brief extract symbols from elf symbol tables.
+ * @brief extract symbols from elf symbol tables; the tables are parsed in pieces in parallel,
+ *  this waits for its own jobs to finish.
  *
  * @param ctx the emit context.
- * @return dyna_t* of elf_symbol_t* symbols, or 0x0 on failure.
+ * @param pool the worker pool to parse on (or 0x0 to parse on the calling thread).
+ * @return a flat table of symbols (in symbol table order) whose names point into
+ *  ctx->elf->image, or 0x0 on failure.
  */
-dyna_t*
-emit_extract_symbols(emit_ctx_t* ctx) {
+syms_t*
+emit_extract_symbols(emit_ctx_t* ctx, wrk_pool_t* pool) {
     if (!ctx || !ctx->elf) return 0x0;
+    if (ctx->elf->class != ELF_CLASS_32 && ctx->elf->class != ELF_CLASS_64)
+        return syms_create(ctx->elf->image, 0u);
+
+    /* count the entries of .symtab and .dynsym, an upper bound of the symbols kept. */
+    const elf_shdr_t* shdrs = ctx->elf->shdrs;
+    size_t total = 0u, pieces = 0u;
+    for (size_t i = 0; i < ctx->elf->shnum; i++) {
+        const elf_shdr_t* symhdr = &shdrs[i];
+        size_t entsize = symbols_entsize(ctx->elf, symhdr);
+        if (entsize == 0u) continue;
+        size_t count = (size_t) (symhdr->size / entsize);
+        total += count;
+        pieces += (count + EMIT_SYMBOL_PIECE - 1u) / EMIT_SYMBOL_PIECE;
+    }
+    syms_t* symbols = syms_create(ctx->elf->image, total);
+    if (!symbols || pieces == 0u) return symbols;
+
+    symbols_job_t* parts = calloc(pieces, sizeof *parts);
+    job_t* jobs = calloc(pieces, sizeof *jobs);
+    if (!parts || !jobs) {
+        fprintf(stderr, "lzd, emit_extract_symbols; calloc failed; could not allocate memory for jobs.\n");
+        free(parts);
+        free(jobs);
+        syms_free(symbols);
+        return 0x0;
+    }
 
-    dyna_t* symbols = dyna_create();
-    if (!symbols) return 0x0;
-
-    /* scan .symtab and .dynsym sections. */
-    const char* section_names[] = { ".symtab", ".dynsym" };
-    _foreach(ctx->elf->shdrs, elf_shdr_t*, symhdr)
-        /* find the section. */
-        bool found = false;
-        const char* name = elf_shdr_name(ctx->elf, symhdr);
-        if (!name) continue;
-        for (size_t j = 0; j < 2; j++) {
-            if (!strcmp(name, section_names[j])) {
-                found = true;
-                break;
-            }
-        }
-        if (!symhdr || symhdr->size == 0 || !found) continue;
-
-        /* resolve associated string table using sh_link. */
-        if (symhdr->link >= ctx->elf->shdrs->length) continue;
-        elf_shdr_t* strhdr = _get(ctx->elf->shdrs, elf_shdr_t*, symhdr->link);
-        if (!strhdr || strhdr->size == 0) continue;
-        if (strhdr->type != ELF_SHT_STRTAB) continue;
-
-        /* read symtab and strtab data from file. */
-        FILE* f = fopen(ctx->elf->path, "rb");
-        if (!f) continue;
-
-        uint8_t* sym_data = malloc(symhdr->size);
-        if (!sym_data) {
-            fclose(f);
-            continue;
-        }
-        uint8_t* str_data = malloc(strhdr->size);
-        if (!str_data) {
-            free(sym_data);
-            fclose(f);
-            continue;
-        }
-
-        /* read sym section. */
-        fseek(f, symhdr->offset, SEEK_SET);
-        size_t sym_read = fread(sym_data, 1, symhdr->size, f);
-        if (sym_read != symhdr->size) {
-            free(sym_data);
-            free(str_data);
-            fclose(f);
-            continue;
+    /* every piece writes into its own run of the table, they are packed afterwards. */
+    size_t made = 0u, base = 0u;
+    for (size_t i = 0; i < ctx->elf->shnum; i++) {
+        const elf_shdr_t* symhdr = &shdrs[i];
+        size_t entsize = symbols_entsize(ctx->elf, symhdr);
+        if (entsize == 0u) continue;
+        size_t count = (size_t) (symhdr->size / entsize);
+
+        /* resolve associated string table using sh_link, and borrow both from the image. */
+        if (symhdr->link >= ctx->elf->shnum) continue;
+        const elf_shdr_t* strhdr = &shdrs[symhdr->link];
+        if (strhdr->size == 0 || strhdr->type != ELF_SHT_STRTAB) continue;
+        const uint8_t* sym_data = mapf_slice(ctx->elf->image, symhdr->offset, symhdr->size);
+        const uint8_t* str_data = mapf_slice(ctx->elf->image, strhdr->offset, strhdr->size);
+        if (!sym_data || !str_data) continue;
+        size_t bound = syms_names_bound(str_data, (size_t) strhdr->size);
+
+        for (size_t first = 0; first < count; first += EMIT_SYMBOL_PIECE) {
+            size_t last = count - first < EMIT_SYMBOL_PIECE ? count : first + EMIT_SYMBOL_PIECE;
+            parts[made] = (symbols_job_t){ sym_data, entsize, first, last, (const char*) str_data, \
+                bound, ctx->elf->class == ELF_CLASS_64, symbols->symbols + base, 0u };
+            jobs[made] = (job_t){ symbols_job, &parts[made] };
+            base += last - first;
+            made++;
         }
+    }
 
-        /* read str section. */
-        fseek(f, strhdr->offset, SEEK_SET);
-        size_t str_read = fread(str_data, 1, strhdr->size, f);
-        fclose(f);
-        if (str_read != strhdr->size) {
-            free(sym_data);
-            free(str_data);
-            continue;
-        }
+    /* parse the pieces in parallel, or right here if they can't be posted. */
+    if (!pool || made < 2u || wrk_pool_run_batch(pool, jobs, made, WRK_PRIO_HIGH) != 0) {
+        for (size_t i = 0; i < made; i++)
+            symbols_job(&parts[i]);
+    }
 
-        /* parse symbols. */
-        if (ctx->elf->class == ELF_CLASS_32) {
-            size_t entsize = symhdr->entsize ? symhdr->entsize : sizeof(elf32_sym_t);
-            if (entsize == 0) {
-                free(sym_data);
-                free(str_data);
-                continue;
-            }
-            size_t count = symhdr->size / entsize;
-            for (size_t i = 0; i < count; i++) {
-                elf32_sym_t* s = (elf32_sym_t*)(sym_data + i * entsize);
-                if (s->name == 0) continue;
-                if (!is_valid_strtab_off(str_data, strhdr->size, s->name)) continue;
-                const char* sym_name = (const char*)(str_data + s->name);
-                if (!sym_name || !*sym_name) continue;
-
-                /* copy name. */
-                size_t len = strnlen(sym_name, strhdr->size - s->name);
-                char* owned = calloc(1, len + 1);
-                if (!owned) continue;
-                memcpy(owned, sym_name, len);
-                elf_symbol_t* out = calloc(1u, sizeof *out);
-                if (!out) {
-                    free(owned);
-                    continue;
-                }
-                out->name = owned;
-                out->value = (uint64_t)s->value;
-                out->size = (uint64_t)s->size;
-                out->info = s->info;
-                out->other = s->other;
-                out->shndx = s->shndx;
-                out->bind = ELF_ST_BIND(s->info);
-                out->type = ELF_ST_TYPE(s->info);
-                dyna_push(symbols, out);
-            }
-        } else if (ctx->elf->class == ELF_CLASS_64) {
-            size_t entsize = symhdr->entsize ? symhdr->entsize : sizeof(elf64_sym_t);
-            if (entsize == 0) {
-                free(sym_data);
-                free(str_data);
-                continue;
-            }
-            size_t count = symhdr->size / entsize;
-            for (size_t i = 0; i < count; i++) {
-                elf64_sym_t* s = (elf64_sym_t*)(sym_data + i * entsize);
-                if (s->name == 0) continue;
-                if (!is_valid_strtab_off(str_data, strhdr->size, s->name)) continue;
-                const char* sym_name = (const char*)(str_data + s->name);
-                if (!sym_name || !*sym_name) continue;
-
-                /* copy name. */
-                size_t len = strnlen(sym_name, strhdr->size - s->name);
-                char* owned = calloc(1, len + 1);
-                if (!owned) continue;
-                memcpy(owned, sym_name, len);
-                elf_symbol_t* out = calloc(1u, sizeof *out);
-                if (!out) {
-                    free(owned);
-                    continue;
-                }
-                out->name = owned;
-                out->value = s->value;
-                out->size = s->size;
-                out->info = s->info;
-                out->other = s->other;
-                out->shndx = s->shndx;
-                out->bind = ELF_ST_BIND(s->info);
-                out->type = ELF_ST_TYPE(s->info);
-                dyna_push(symbols, out);
-            }
-        }
-        free(sym_data);
-        free(str_data);
-    _endforeach;
+    /* pack the pieces, in order, over the entries that were skipped. */
+    for (size_t i = 0; i < made; i++) {
+        elf_symbol_t* at = symbols->symbols + symbols->count;
+        if (parts[i].out != at) memmove(at, parts[i].out, parts[i].kept * sizeof *at);
+        symbols->count += parts[i].kept;
+    }
+    free(parts);
+    free(jobs);
     return symbols;
-}
\ No newline at end of file
+}
@@ -14,32 +14,72 @@
 /*! @uses tup_arch_t. */
 #include "arch.h"
 
-/*! @uses wrk_pool_t. */
+/*! @uses wrk_pool_t, wrk_prio_t. */
 #include "wrk.h"
 
+/*! @uses disj_token_t. */
+#include "disj.h"
+
+/*! @uses aren_t. */
+#include "aren.h"
+
 /*! @uses dyna_t. */
 #include "dyna.h"
 
 /*! @uses elf_t, elf_shdr_t. */
 #include "elfx.h"
 
+/*! @uses strs_t. */
+#include "strs.h"
+
+/*! @uses syms_t. */
+#include "syms.h"
+
+/* an executable region of the binary, mapping its virtual addresses to file offsets. */
+typedef struct {
+    uint64_t vaddr; /* virtual address of the region. */
+    uint64_t offset; /* file offset of the region. */
+    const uint8_t* data; /* bytes of the region (borrowed from elf->image). */
+    size_t size; /* size of the region in the file. */
+    const char* name; /* name of the section, 0x0 for a segment. */
+} emit_region_t;
+
 /* ... */
 typedef struct {
     elf_t* elf; /* parsed elf structure. */
     tup_arch_t tuple; /* architecture for disassembly. */
-    uint8_t* text_data; /* .text section bytes. */
-    uint64_t text_vaddr; /* virtual address of .text. */
-    size_t text_size; /* size of .text section. */
-    dyna_t* code_ranges; /* dynamic array of code_range_t*. */
+    emit_region_t* regions; /* every SHF_EXECINSTR section (or PF_X segment if there are none),
+                             *  sorted by virtual address and disjoint. */
+    size_t region_count; /* number of regions. */
+    dyna_t* code_ranges; /* dynamic array of code_range_t* (in the arena), sorted over every
+                          *  region. */
+    aren_t* arena; /* code ranges, unmapped with the context. */
+    aren_t* chunks; /* decoded chunks, unmapped with the context (or on their own by
+                     *  emit_drop_chunks). */
+    disj_token_t token; /* generation token of every disassembly job posted for this binary. */
 } emit_ctx_t;
 
 /* ... */
 typedef struct {
     uint64_t vaddr; /* virtual address. */
-    size_t offset; /* offset into text_data. */
+    size_t offset; /* file offset, the range never crosses the end of its region. */
     size_t length; /* length of code range. */
+    bool seam; /* starts at a split that may fall inside of an instruction (stitched on decode). */
+    size_t rows; /* instructions found by the length decoder (emit_count_rows), 0 if not counted. */
 } code_range_t;
 
+/* size a code range is split into for decoding, and the lookahead decoded past a seam. */
+#define EMIT_SPLIT_TARGET (64u * 1024u)
+#define EMIT_SEAM_OVERLAP 256u
+
+/* size of the pieces a section is split into when scanning it for strings, and the number
+ *  of entries of a symbol table parsed by a single job. */
+#define EMIT_STRING_PIECE (1u << 20)
+#define EMIT_SYMBOL_PIECE (1u << 16)
+
+/* bytes of code ranges whose instructions are counted by a single job. */
+#define EMIT_ROWS_PIECE (1u << 20)
+
 /**
  * @brief load an elf binary and prepare it for disassembly.
  *
@@ -59,7 +99,27 @@ void
 emit_free(emit_ctx_t* ctx);
 
 /**
- * @brief scan .text section and identify code ranges (skip nops/padding).
+ * @brief unmap every decoded chunk of a context at once and start a fresh arena for them; no
+ *  job may still be decoding into it, and no chunk out of it may still be installed anywhere.
+ *
+ * @param ctx the emit context.
+ * @return the bytes that were unmapped if successful, -1 o.w. (the chunks are kept).
+ */
+ssize_t
+emit_drop_chunks(emit_ctx_t* ctx);
+
+/**
+ * @brief find the executable region an address falls in, in O(log n).
+ *
+ * @param ctx the emit context.
+ * @param vaddr the virtual address.
+ * @return the region if there is one, 0x0 o.w.
+ */
+const emit_region_t*
+emit_region_at(const emit_ctx_t* ctx, uint64_t vaddr);
+
+/**
+ * @brief scan every executable region and identify code ranges (skip nops/padding).
  *
  * @param ctx the emit context.
  * @return -1 if a failure occurs, 0 o.w.
@@ -67,6 +127,19 @@ emit_free(emit_ctx_t* ctx);
 ssize_t
 emit_scan_text(emit_ctx_t* ctx);
 
+/**
+ * @brief split code ranges larger than a target size into pieces of about that size, so one
+ *  huge range doesn't serialize the decode; pieces start at function symbols when one is close
+ *  to the target, and at a seam (stitched after decoding) o.w.
+ *
+ * @param ctx the emit context (after emit_scan_text).
+ * @param symbols the symbols of the binary (or 0x0).
+ * @param target the target size of a piece in bytes.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+emit_split_ranges(emit_ctx_t* ctx, const syms_t* symbols, size_t target);
+
 /**
  * @brief emit disassembly jobs for a specific virtual address range.
  *
@@ -74,13 +147,18 @@ emit_scan_text(emit_ctx_t* ctx);
  * @param pool the worker pool to post jobs to.
  * @param vaddr_start the starting virtual address.
  * @param vaddr_end the ending virtual address.
+ * @param prio the priority of the jobs.
+ * @param generation the generation of ctx->token the jobs are posted in, they are dropped once
+ *  it has passed (0 if only closing the binary drops them).
  * @return -1 if a failure occurs, 0 o.w.
  */
 ssize_t
-emit_range(emit_ctx_t* ctx, wrk_pool_t* pool, uint64_t vaddr_start, uint64_t vaddr_end);
+emit_range(emit_ctx_t* ctx, wrk_pool_t* pool, uint64_t vaddr_start, uint64_t vaddr_end, \
+    wrk_prio_t prio, uint64_t generation);
 
 /**
- * @brief emit all disassembly jobs for the entire binary.
+ * @brief emit all disassembly jobs for the entire binary, at low priority and only dropped
+ *  when the binary is closed.
  *
  * @param ctx the emit context.
  * @param pool the worker pool to post jobs to.
@@ -90,21 +168,40 @@ ssize_t
 emit_all(emit_ctx_t* ctx, wrk_pool_t* pool);
 
 /**
- * @brief extract printable strings from elf sections.
+ * @brief count the instructions of every code range with the x86_64 length decoder, without
+ *  decoding their operands, so placeholders hold (about) the row count they decode into; runs
+ *  of ranges are counted in parallel, this waits for its own jobs to finish. other architectures
+ *  are left to the rows-per-byte estimate.
+ *
+ * @param ctx the emit context (after the code ranges are split).
+ * @param pool the worker pool to count on (or 0x0 to count on the calling thread).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+emit_count_rows(emit_ctx_t* ctx, wrk_pool_t* pool);
+
+/**
+ * @brief extract ascii, utf-8 and utf-16le strings from every non-executable section with
+ *  data; the sections are scanned in pieces in parallel, this waits for its own jobs to finish.
  *
  * @param ctx the emit context.
- * @param min_len minimum string length to extract (default 4).
- * @return dyna_t* of char* strings, or 0x0 on failure.
+ * @param pool the worker pool to scan on (or 0x0 to scan on the calling thread).
+ * @param min_len minimum string length to extract, in characters (default 4).
+ * @return the strings ordered by section and offset, they point into ctx->elf->image; or 0x0
+ *  on failure.
  */
-dyna_t*
-emit_extract_strings(emit_ctx_t* ctx, size_t min_len);
+strs_t*
+emit_extract_strings(emit_ctx_t* ctx, wrk_pool_t* pool, size_t min_len);
 
 /**
- * @brief extract symbols from elf symbol tables.
+ * @brief extract symbols from elf symbol tables; the tables are parsed in pieces in parallel,
+ *  this waits for its own jobs to finish.
  *
  * @param ctx the emit context.
- * @return dyna_t* of elf_symbol_t* symbols, or 0x0 on failure.
+ * @param pool the worker pool to parse on (or 0x0 to parse on the calling thread).
+ * @return a flat table of symbols (in symbol table order) whose names point into
+ *  ctx->elf->image, or 0x0 on failure.
  */
-dyna_t*
-emit_extract_symbols(emit_ctx_t* ctx);
+syms_t*
+emit_extract_symbols(emit_ctx_t* ctx, wrk_pool_t* pool);
 #endif /* LZD_EMIT_H */
\ No newline at end of file
@@ -0,0 +1,466 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-11
+ */
+#include "flow.h"
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses calloc, malloc, realloc, free. */
+#include <stdlib.h>
+
+/*! @uses memcpy, memmove, strcmp. */
+#include <string.h>
+
+/*! @uses cs_disasm_iter, cs_insn_group, CS_GRP_*. */
+#include <capstone/capstone.h>
+
+/*! @uses internal, dyna_push. */
+#include "dyna.h"
+
+/*! @uses disj_thread_handle, disj_reference. */
+#include "disj.h"
+
+/*! @uses aren_alloc. */
+#include "aren.h"
+
+/*! @uses stat_now, stat_add, stat_record. */
+#include "stat.h"
+
+/* how an instruction moves control flow. */
+typedef enum {
+    FLOW_NEXT = 0u, /* falls through to the next instruction. */
+    FLOW_CALL, /* calls a target, and falls through once it returns. */
+    FLOW_BRANCH, /* branches to a target, or falls through (a new block). */
+    FLOW_JUMP, /* always jumps to a target. */
+    FLOW_STOP, /* returns or traps, nothing after it is reached. */
+} flow_kind_t;
+
+/* a job, a batch of targets to explore on the worker pool. */
+typedef struct {
+    flow_t* flow; /* the pass. */
+    wrk_pool_t* pool; /* the pool to hand targets to. */
+    size_t count; /* number of targets. */
+    uint64_t targets[FLOW_BATCH]; /* the targets. */
+} flow_job_t;
+
+/* the frontier of a job, block starts still to be explored (a stack). */
+typedef struct {
+    uint64_t* targets;
+    size_t count, capacity;
+} flow_frontier_t;
+
+/**
+ * @brief claim a bit of a bitmap.
+ *
+ * @param map the bitmap.
+ * @param bit the index of the bit.
+ * @return true if it was already set, false o.w.
+ */
+internal bool
+bit_claim(_Atomic(uint64_t)* map, size_t bit) {
+    uint64_t mask = 1ull << (bit & 63u);
+    return (atomic_fetch_or_explicit(&map[bit >> 6u], mask, memory_order_relaxed) & mask) != 0u;
+}
+
+/**
+ * @brief test a bit of a bitmap.
+ *
+ * @param map the bitmap.
+ * @param bit the index of the bit.
+ * @return true if it is set, false o.w.
+ */
+internal bool
+bit_test(_Atomic(uint64_t)* map, size_t bit) {
+    return (atomic_load_explicit(&map[bit >> 6u], memory_order_relaxed) >> (bit & 63u)) & 1u;
+}
+
+/**
+ * @brief set a run of bits of a bitmap, a word at a time.
+ *
+ * @param map the bitmap.
+ * @param first the index of the first bit.
+ * @param count the number of bits.
+ */
+internal void
+bits_set(_Atomic(uint64_t)* map, size_t first, size_t count) {
+    while (count > 0u) {
+        size_t at = first & 63u, n = count < 64u - at ? count : 64u - at;
+        uint64_t mask = (n == 64u ? ~0ull : ((1ull << n) - 1u)) << at;
+        atomic_fetch_or_explicit(&map[first >> 6u], mask, memory_order_relaxed);
+        first += n;
+        count -= n;
+    }
+}
+
+/**
+ * @brief find the next set (or clear) bit of a bitmap, a word at a time.
+ *
+ * @param map the bitmap.
+ * @param bits the number of bits in the bitmap.
+ * @param from the index to start from.
+ * @param set true to find a set bit, false to find a clear one.
+ * @return the index of the bit, or bits if there is none.
+ */
+internal size_t
+bit_next(_Atomic(uint64_t)* map, size_t bits, size_t from, bool set) {
+    if (from >= bits) return bits;
+    size_t word = from >> 6u;
+    uint64_t value = atomic_load_explicit(&map[word], memory_order_relaxed);
+    value = (set ? value : ~value) & (~0ull << (from & 63u));
+    while (value == 0u) {
+        if (++word << 6u >= bits) return bits;
+        value = atomic_load_explicit(&map[word], memory_order_relaxed);
+        if (!set) value = ~value;
+    }
+    size_t at = (word << 6u) + (size_t) __builtin_ctzll(value);
+    return at < bits ? at : bits;
+}
+
+/**
+ * @brief find the region an address is in.
+ *
+ * @param flow the pass.
+ * @param address the address.
+ * @param offset output for the offset of the address in the region.
+ * @return -1 if it is outside of every region, the index of the region o.w.
+ */
+internal ssize_t
+region_index(const flow_t* flow, uint64_t address, size_t* offset) {
+    const emit_region_t* region = emit_region_at(flow->ctx, address);
+    if (!region) return -1;
+    *offset = (size_t) (address - region->vaddr);
+    return region - flow->ctx->regions;
+}
+
+/**
+ * @brief push a target onto a frontier.
+ *
+ * @param frontier the frontier.
+ * @param target the target address.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+frontier_push(flow_frontier_t* frontier, uint64_t target) {
+    if (frontier->count == frontier->capacity) {
+        size_t capacity = frontier->capacity ? frontier->capacity * 2u : FLOW_BATCH;
+        uint64_t* targets = realloc(frontier->targets, capacity * sizeof *targets);
+        if (!targets) {
+            fprintf(stderr, "lzd, frontier_push; realloc failed; could not grow frontier.\n");
+            return -1;
+        }
+        frontier->targets = targets;
+        frontier->capacity = capacity;
+    }
+    frontier->targets[frontier->count++] = target;
+    return 0;
+}
+
+/**
+ * @brief mark a basic block start, and push it onto a frontier if nothing decoded it yet.
+ *
+ * @param flow the pass.
+ * @param frontier the frontier.
+ * @param target the target address.
+ */
+internal void
+flow_target(flow_t* flow, flow_frontier_t* frontier, uint64_t target) {
+    size_t offset;
+    ssize_t r = region_index(flow, target, &offset);
+    if (r < 0) return;
+    if (!bit_claim(flow->maps[r].blocks, offset)) atomic_fetch_add(&flow->blocks, 1u);
+    if (bit_test(flow->maps[r].starts, offset)) return;
+    if (frontier_push(frontier, target) != 0) atomic_store(&flow->failed, true);
+}
+
+/**
+ * @brief classify how an instruction moves control flow.
+ *
+ * @param handle the capstone handle it was decoded with (in detail mode).
+ * @param insn the instruction.
+ * @return the kind of the instruction.
+ */
+internal flow_kind_t
+insn_kind(csh handle, const cs_insn* insn) {
+    if (cs_insn_group(handle, insn, CS_GRP_RET) || cs_insn_group(handle, insn, CS_GRP_IRET))
+        return FLOW_STOP;
+
+    /* halts and traps end a block too, nothing falls through them. */
+    static const char* stops[] = { "hlt", "ud2", "int3", "udf", "brk" };
+    for (size_t i = 0; i < sizeof stops / sizeof *stops; i++)
+        if (!strcmp(insn->mnemonic, stops[i])) return FLOW_STOP;
+    if (cs_insn_group(handle, insn, CS_GRP_CALL)) return FLOW_CALL;
+    if (!cs_insn_group(handle, insn, CS_GRP_JUMP)) return FLOW_NEXT;
+
+    /* the unconditional jumps, every isa spells them with a mnemonic of their own. */
+    static const char* jumps[] = { "jmp", "ljmp", "b", "b.w", "br", "bx" };
+    for (size_t i = 0; i < sizeof jumps / sizeof *jumps; i++)
+        if (!strcmp(insn->mnemonic, jumps[i])) return FLOW_JUMP;
+    return FLOW_BRANCH;
+}
+
+/**
+ * @brief decode a basic block (and whatever falls through from it), until it jumps away,
+ *  stops, or runs into an instruction another path decoded already.
+ *
+ * @param flow the pass.
+ * @param frontier the frontier to push the branch targets onto.
+ * @param handle the capstone handle of the thread.
+ * @param insn the instruction of the thread to decode into.
+ * @param start the address of the block.
+ */
+internal void
+flow_block(flow_t* flow, flow_frontier_t* frontier, csh handle, cs_insn* insn, uint64_t start) {
+    size_t offset;
+    ssize_t r = region_index(flow, start, &offset);
+    if (r < 0) return;
+    const emit_region_t* region = &flow->ctx->regions[r];
+    flow_map_t* map = &flow->maps[r];
+
+    /* claim the start, whoever sets its bit first decodes it. */
+    if (bit_claim(map->starts, offset)) return;
+    const uint8_t* code = region->data + offset;
+    size_t size = region->size - offset, decoded = 0u;
+    uint64_t address = start;
+    while (cs_disasm_iter(handle, &code, &size, &address, insn)) {
+        bits_set(map->covered, offset, insn->size);
+        offset += insn->size;
+        decoded++;
+
+        /* follow direct targets; a rip-relative operand (e.g. an indirect jump through the got)
+         *  is data, and indirect branches aren't followed. */
+        flow_kind_t kind = insn_kind(handle, insn);
+        insn_xref_t ref;
+        if (kind != FLOW_NEXT && kind != FLOW_STOP && \
+            disj_reference(handle, flow->ctx->tuple.arch, insn, &ref) && ref.kind != INSN_XREF_DATA)
+            flow_target(flow, frontier, ref.target);
+        if (kind == FLOW_JUMP || kind == FLOW_STOP || size == 0u) break;
+
+        /* a conditional branch falls through into a new block. */
+        if (kind == FLOW_BRANCH && !bit_claim(map->blocks, offset)) atomic_fetch_add(&flow->blocks, 1u);
+        if (bit_claim(map->starts, offset)) break;
+    }
+    atomic_fetch_add(&flow->instructions, decoded);
+}
+
+/* forward declaration, jobs post jobs. */
+internal void
+flow_job(void* arg);
+
+/**
+ * @brief post a batch of targets as a job.
+ *
+ * @param flow the pass.
+ * @param pool the worker pool.
+ * @param targets the targets.
+ * @param count the number of targets (at most FLOW_BATCH).
+ * @param latch the latch of the pass, or 0x0 from one of its jobs (which posts against its own).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+flow_post(flow_t* flow, wrk_pool_t* pool, const uint64_t* targets, size_t count, wrk_latch_t* latch) {
+    flow_job_t* job = malloc(sizeof *job);
+    if (!job) {
+        fprintf(stderr, "lzd, flow_post; malloc failed; could not allocate job.\n");
+        return -1;
+    }
+    job->flow = flow;
+    job->pool = pool;
+    job->count = count;
+    memcpy(job->targets, targets, count * sizeof *targets);
+    job_t posted = { flow_job, job };
+    if ((latch ? wrk_pool_post_latched(pool, &posted, 1u, WRK_PRIO_HIGH, latch) : \
+        wrk_pool_post(pool, flow_job, job)) != 0) {
+        free(job);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief explore a batch of targets and everything reachable from them; while other workers
+ *  sleep and the frontier is large, the oldest part of it is handed to the pool.
+ *
+ * @param arg the job (freed here).
+ */
+internal void
+flow_job(void* arg) {
+    flow_job_t* job = arg;
+    flow_t* flow = job->flow;
+    csh handle;
+    cs_insn* insn;
+    flow_frontier_t frontier = { 0 };
+    if (disj_thread_handle(flow->ctx->tuple, &handle, &insn) != 0) {
+        atomic_store(&flow->failed, true);
+        free(job);
+        return;
+    }
+    for (size_t i = 0; i < job->count; i++)
+        if (frontier_push(&frontier, job->targets[i]) != 0) atomic_store(&flow->failed, true);
+    while (frontier.count > 0u) {
+        flow_block(flow, &frontier, handle, insn, frontier.targets[--frontier.count]);
+        if (frontier.count >= 2u * FLOW_BATCH && atomic_load(&job->pool->sleeping) > 0u && \
+            flow_post(flow, job->pool, frontier.targets, FLOW_BATCH, 0x0) == 0) {
+            frontier.count -= FLOW_BATCH;
+            memmove(frontier.targets, frontier.targets + FLOW_BATCH, frontier.count * sizeof(uint64_t));
+        }
+    }
+    free(frontier.targets);
+    free(job);
+}
+
+/**
+ * @brief create an empty recursive-descent pass over the regions of an emit context.
+ *
+ * @param ctx the emit context (borrowed, it has to outlive the pass).
+ * @return an allocated pass if successful, 0x0 o.w.
+ */
+flow_t*
+flow_create(const emit_ctx_t* ctx) {
+    if (!ctx || !ctx->regions) return 0x0;
+    flow_t* flow = calloc(1u, sizeof *flow);
+    if (!flow) {
+        fprintf(stderr, "lzd, flow_create; calloc failed; could not allocate pass.\n");
+        return 0x0;
+    }
+    flow->ctx = ctx;
+    flow->maps = calloc(ctx->region_count, sizeof *flow->maps);
+    bool ok = flow->maps != 0x0;
+    for (size_t r = 0; ok && r < ctx->region_count; r++) {
+        size_t words = (ctx->regions[r].size + 63u) / 64u;
+        flow->maps[r].starts = calloc(words, sizeof(uint64_t));
+        flow->maps[r].covered = calloc(words, sizeof(uint64_t));
+        flow->maps[r].blocks = calloc(words, sizeof(uint64_t));
+        ok = flow->maps[r].starts && flow->maps[r].covered && flow->maps[r].blocks;
+    }
+    if (!ok) {
+        fprintf(stderr, "lzd, flow_create; calloc failed; could not allocate bitmaps.\n");
+        flow_free(flow);
+        return 0x0;
+    }
+    return flow;
+}
+
+/**
+ * @brief free a recursive-descent pass.
+ *
+ * @param flow the pass to be freed.
+ */
+void
+flow_free(flow_t* flow) {
+    if (!flow) return;
+    for (size_t r = 0; flow->maps && r < flow->ctx->region_count; r++) {
+        free(flow->maps[r].starts);
+        free(flow->maps[r].covered);
+        free(flow->maps[r].blocks);
+    }
+    free(flow->maps);
+    free(flow);
+}
+
+/**
+ * @brief follow control flow from the entry point and every function symbol inside of a
+ *  region; this waits for its own jobs to finish.
+ *
+ * @param flow the pass.
+ * @param pool the worker pool to explore on.
+ * @param symbols the (indexed) symbols of the binary (or 0x0).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+flow_explore(flow_t* flow, wrk_pool_t* pool, const syms_t* symbols) {
+    if (!flow || !pool) return -1;
+    uint64_t started = stat_now();
+
+    /* the seeds are block starts, a thumb address has its low bit set. */
+    flow_frontier_t seeds = { 0 };
+    uint64_t mask = flow->ctx->tuple.arch == CS_ARCH_ARM ? ~1ull : ~0ull;
+    flow_target(flow, &seeds, flow->ctx->elf->entry & mask);
+    for (size_t i = 0; symbols && i < symbols->count; i++) {
+        const elf_symbol_t* symbol = &symbols->symbols[i];
+        if (symbol->type == ELF_STT_FUNC) flow_target(flow, &seeds, symbol->value & mask);
+    }
+
+    /* hand the seeds to the pool a batch at a time, each job explores from there. */
+    wrk_latch_t latch;
+    wrk_latch_init(&latch);
+    for (size_t i = 0; i < seeds.count; i += FLOW_BATCH) {
+        size_t count = seeds.count - i < FLOW_BATCH ? seeds.count - i : FLOW_BATCH;
+        if (flow_post(flow, pool, seeds.targets + i, count, &latch) != 0) atomic_store(&flow->failed, true);
+    }
+    free(seeds.targets);
+    wrk_latch_wait(pool, &latch);
+    wrk_latch_destroy(&latch);
+    stat_record(STAT_HIST_SCAN, stat_now() - started);
+    return atomic_load(&flow->failed) ? -1 : 0;
+}
+
+/**
+ * @brief push a code range for every run of reachable bytes onto the code ranges of the emit
+ *  context (instead of emit_scan_text), every run starts at an instruction; nothing is pushed
+ *  if a failure occurs.
+ *
+ * @param flow the explored pass.
+ * @param ctx the emit context of the pass.
+ * @return -1 if a failure occurs, the number of code ranges pushed o.w.
+ */
+ssize_t
+flow_code_ranges(const flow_t* flow, emit_ctx_t* ctx) {
+    if (!flow || !ctx || flow->ctx != ctx) return -1;
+    size_t first = ctx->code_ranges->length;
+    ssize_t pushed = 0;
+    for (size_t r = 0; r < ctx->region_count; r++) {
+        const emit_region_t* region = &ctx->regions[r];
+        _Atomic(uint64_t)* covered = flow->maps[r].covered;
+        size_t i = 0;
+        while ((i = bit_next(covered, region->size, i, true)) < region->size) {
+            /* a run starts at an instruction, o.w. the bytes before it would be covered. */
+            size_t start = i;
+            i = bit_next(covered, region->size, i, false);
+            code_range_t* range = aren_alloc(ctx->arena, sizeof *range);
+            if (!range) {
+                fprintf(stderr, "lzd, flow_code_ranges; aren_alloc failed; could not allocate " \
+                    "code range.\n");
+                ctx->code_ranges->length = first;
+                return -1;
+            }
+            range->vaddr = region->vaddr + start;
+            range->offset = (size_t) region->offset + start;
+            range->length = i - start;
+            range->seam = false;
+            dyna_push(ctx->code_ranges, range);
+            pushed++;
+        }
+    }
+    stat_add(STAT_RANGES_SCANNED, (uint64_t) pushed);
+    return pushed;
+}
+
+/**
+ * @brief check if an instruction starts at an address.
+ *
+ * @param flow the explored pass.
+ * @param address the address.
+ * @return true if a reachable instruction starts there, false o.w.
+ */
+bool
+flow_is_insn(const flow_t* flow, uint64_t address) {
+    size_t offset;
+    ssize_t r = flow ? region_index(flow, address, &offset) : -1;
+    return r >= 0 && bit_test(flow->maps[r].starts, offset);
+}
+
+/**
+ * @brief check if a basic block starts at an address.
+ *
+ * @param flow the explored pass.
+ * @param address the address.
+ * @return true if a basic block starts there, false o.w.
+ */
+bool
+flow_is_block(const flow_t* flow, uint64_t address) {
+    size_t offset;
+    ssize_t r = flow ? region_index(flow, address, &offset) : -1;
+    return r >= 0 && bit_test(flow->maps[r].blocks, offset);
+}
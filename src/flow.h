@@ -0,0 +1,115 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-11
+ */
+#ifndef LZD_FLOW_H
+#define LZD_FLOW_H
+
+/*! @uses uint64_t. */
+#include <stdint.h>
+
+/*! @uses size_t, ssize_t. */
+#include <sys/types.h>
+
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses _Atomic, atomic_size_t. */
+#include <stdatomic.h>
+
+/*! @uses wrk_pool_t. */
+#include "wrk.h"
+
+/*! @uses emit_ctx_t, emit_region_t. */
+#include "emit.h"
+
+/*! @uses syms_t. */
+#include "syms.h"
+
+/* targets handed to another worker at once, when a frontier grows past twice as many. */
+#define FLOW_BATCH 256u
+
+/* the bitmaps of a region, one bit per byte of it. */
+typedef struct {
+    _Atomic(uint64_t)* starts; /* every instruction start that was claimed (and decoded). */
+    _Atomic(uint64_t)* covered; /* every byte of a decoded instruction. */
+    _Atomic(uint64_t)* blocks; /* every basic block start (a branch target or a fall-through). */
+} flow_map_t;
+
+/**
+ * a recursive-descent pass over the executable regions of a binary; it starts at the entry
+ *  point and every function symbol and follows control flow, so only reachable code is
+ *  decoded and inline data is never mistaken for instructions. the pass runs on the worker
+ *  pool: every job works through a frontier of its own and hands part of it to the pool when
+ *  it grows, and an instruction start is claimed with an atomic or, so every one is decoded
+ *  exactly once. indirect branches are not followed.
+ */
+typedef struct {
+    const emit_ctx_t* ctx; /* the emit context whose regions are explored. */
+    flow_map_t* maps; /* one per region of the context. */
+    atomic_size_t instructions; /* number of instructions decoded. */
+    atomic_size_t blocks; /* number of basic block starts found. */
+    atomic_bool failed; /* a job ran out of memory, some of the reachable code was missed. */
+} flow_t;
+
+/**
+ * @brief create an empty recursive-descent pass over the regions of an emit context.
+ *
+ * @param ctx the emit context (borrowed, it has to outlive the pass).
+ * @return an allocated pass if successful, 0x0 o.w.
+ */
+flow_t*
+flow_create(const emit_ctx_t* ctx);
+
+/**
+ * @brief free a recursive-descent pass.
+ *
+ * @param flow the pass to be freed.
+ */
+void
+flow_free(flow_t* flow);
+
+/**
+ * @brief follow control flow from the entry point and every function symbol inside of a
+ *  region; this waits for its own jobs to finish.
+ *
+ * @param flow the pass.
+ * @param pool the worker pool to explore on.
+ * @param symbols the (indexed) symbols of the binary (or 0x0).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+flow_explore(flow_t* flow, wrk_pool_t* pool, const syms_t* symbols);
+
+/**
+ * @brief push a code range for every run of reachable bytes onto the code ranges of the emit
+ *  context (instead of emit_scan_text), every run starts at an instruction; nothing is pushed
+ *  if a failure occurs.
+ *
+ * @param flow the explored pass.
+ * @param ctx the emit context of the pass.
+ * @return -1 if a failure occurs, the number of code ranges pushed o.w.
+ */
+ssize_t
+flow_code_ranges(const flow_t* flow, emit_ctx_t* ctx);
+
+/**
+ * @brief check if an instruction starts at an address.
+ *
+ * @param flow the explored pass.
+ * @param address the address.
+ * @return true if a reachable instruction starts there, false o.w.
+ */
+bool
+flow_is_insn(const flow_t* flow, uint64_t address);
+
+/**
+ * @brief check if a basic block starts at an address.
+ *
+ * @param flow the explored pass.
+ * @param address the address.
+ * @return true if a basic block starts there, false o.w.
+ */
+bool
+flow_is_block(const flow_t* flow, uint64_t address);
+#endif /* LZD_FLOW_H */
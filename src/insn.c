@@ -0,0 +1,784 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-02
+ */
+#include "insn.h"
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses calloc, realloc, free. */
+#include <stdlib.h>
+
+/*! @uses memmove, memcpy, memset, strlen, strcmp. */
+#include <string.h>
+
+/*! @uses internal. */
+#include "dyna.h"
+
+/* number of slots in the per-chunk mnemonic intern table (must be a power of two). */
+#define MNEM_HASH_SIZE 2048u
+
+/**
+ * @brief grow a column to a new capacity.
+ *
+ * @param column pointer to the column.
+ * @param size the size of a single element.
+ * @param capacity the new capacity (in elements).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+column_grow(void** column, size_t size, size_t capacity) {
+    void* _column = realloc(*column, size * (capacity ? capacity : 1u));
+    if (!_column) return -1;
+    *column = _column;
+    return 0;
+}
+
+/**
+ * @brief append a nul-terminated string to a pool, growing it when needed.
+ *
+ * @param pool pointer to the pool.
+ * @param used pointer to the bytes used in the pool.
+ * @param capacity pointer to the allocated bytes of the pool.
+ * @param str the string to be appended.
+ * @param offset output offset of the appended string.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+pool_append(char** pool, size_t* used, size_t* capacity, const char* str, uint32_t* offset) {
+    size_t n = strlen(str) + 1u;
+    if (*used + n > *capacity) {
+        size_t _capacity = *capacity == 0u ? 256u : *capacity;
+        while (*used + n > _capacity) _capacity *= 2u;
+        char* _pool = realloc(*pool, _capacity);
+        if (!_pool) return -1;
+        *pool = _pool;
+        *capacity = _capacity;
+    }
+    memcpy(*pool + *used, str, n);
+    *offset = (uint32_t) *used;
+    *used += n;
+    return 0;
+}
+
+/**
+ * @brief fnv-1a hash of a nul-terminated string.
+ *
+ * @param str the string to be hashed.
+ * @return the 32-bit hash.
+ */
+internal uint32_t
+str_hash(const char* str) {
+    uint32_t h = 0x811c9dc5u;
+    for (; *str; str++) h = (h ^ (uint8_t) *str) * 0x01000193u;
+    return h;
+}
+
+/**
+ * @brief intern a mnemonic into a chunk.
+ *
+ * @param chunk the chunk.
+ * @param mnemonic the mnemonic to be interned.
+ * @return -1 if a failure occurs, the index of the mnemonic o.w.
+ */
+internal ssize_t
+chunk_intern(insn_chunk_t* chunk, const char* mnemonic) {
+    /* the offsets are sized for as many mnemonics as the table takes, so they never grow. */
+    if (!chunk->mnem_hash) {
+        chunk->mnem_hash = calloc(MNEM_HASH_SIZE, sizeof(uint16_t));
+        if (!chunk->mnem_hash) return -1;
+        if (column_grow((void**) &chunk->mnem_offs, sizeof(uint32_t), MNEM_HASH_SIZE / 2u) != 0)
+            return -1;
+    }
+
+    /* probe the table, slots hold index + 1 so that 0 marks an empty slot. */
+    size_t slot = str_hash(mnemonic) & (MNEM_HASH_SIZE - 1u);
+    while (chunk->mnem_hash[slot] != 0u) {
+        size_t index = chunk->mnem_hash[slot] - 1u;
+        if (!strcmp(chunk->mnem_pool + chunk->mnem_offs[index], mnemonic))
+            return (ssize_t) index;
+        slot = (slot + 1u) & (MNEM_HASH_SIZE - 1u);
+    }
+
+    /* keep the table at most half full, no real isa gets close to this in one chunk. */
+    if (chunk->mnem_count >= MNEM_HASH_SIZE / 2u) return -1;
+    if (pool_append(&chunk->mnem_pool, &chunk->mnem_size, &chunk->mnem_capacity, mnemonic, \
+        &chunk->mnem_offs[chunk->mnem_count]) != 0)
+        return -1;
+    chunk->mnem_hash[slot] = (uint16_t) (chunk->mnem_count + 1u);
+    return (ssize_t) chunk->mnem_count++;
+}
+
+/**
+ * @brief create a new empty chunk for a code range.
+ *
+ * @param base the base address of the code range.
+ * @param length the length of the code range.
+ * @param bytes the bytes of the code range (borrowed).
+ * @return an allocated chunk if successful, 0x0 o.w.
+ */
+insn_chunk_t*
+insn_chunk_create(uint64_t base, size_t length, const uint8_t* bytes) {
+    insn_chunk_t* chunk = calloc(1u, sizeof *chunk);
+    if (!chunk) {
+        fprintf(stderr, "lzd, insn_chunk_create; calloc failed; could not allocate memory for chunk.\n");
+        return 0x0;
+    }
+    chunk->base = base;
+    chunk->length = length;
+    chunk->bytes = bytes;
+    return chunk;
+}
+
+/**
+ * @brief free a chunk and all of its columns (unless they are borrowed).
+ *
+ * @param chunk the chunk to be freed.
+ */
+void
+insn_chunk_free(insn_chunk_t* chunk) {
+    if (!chunk || chunk->arena) return;
+    if (chunk->backing) {
+        free(chunk);
+        return;
+    }
+    free(chunk->offsets);
+    free(chunk->sizes);
+    free(chunk->mnemonics);
+    free(chunk->operands);
+    free(chunk->op_arena);
+    free(chunk->mnem_pool);
+    free(chunk->mnem_offs);
+    free(chunk->mnem_hash);
+    free(chunk->xrefs);
+    free(chunk);
+}
+
+/**
+ * @brief empty a chunk for another code range, keeping its columns (and their capacity); a
+ *  chunk that is decoded into over and over (e.g. per thread) only grows until it is as large
+ *  as the largest code range.
+ *
+ * @param chunk the chunk, it must own its columns.
+ * @param base the base address of the code range.
+ * @param length the length of the code range.
+ * @param bytes the bytes of the code range (borrowed).
+ */
+void
+insn_chunk_reset(insn_chunk_t* chunk, uint64_t base, size_t length, const uint8_t* bytes) {
+    if (!chunk || chunk->backing) return;
+    chunk->base = base;
+    chunk->length = length;
+    chunk->bytes = bytes;
+    chunk->state = INSN_CHUNK_DECODED;
+    chunk->count = 0u;
+    chunk->op_size = 0u;
+    chunk->mnem_size = 0u;
+    chunk->mnem_count = 0u;
+    if (chunk->mnem_hash) memset(chunk->mnem_hash, 0, MNEM_HASH_SIZE * sizeof(uint16_t));
+    free(chunk->xrefs);
+    chunk->xrefs = 0x0;
+    chunk->xref_count = 0u;
+    chunk->overlap = 0u;
+    chunk->seam = false;
+}
+
+/**
+ * @brief append a decoded instruction to a chunk.
+ *
+ * @param chunk the chunk to append to.
+ * @param address the address of the instruction (must be >= base, and ascending).
+ * @param size the size of the instruction.
+ * @param mnemonic the mnemonic of the instruction (interned).
+ * @param op_str the operand string of the instruction (copied into the arena).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+insn_chunk_push(insn_chunk_t* chunk, uint64_t address, uint8_t size, const char* mnemonic, \
+    const char* op_str) {
+    if (!chunk || address < chunk->base) return -1;
+
+    /* grow every column together. */
+    if (chunk->count == chunk->capacity) {
+        size_t _capacity = chunk->capacity == 0u ? 64u : chunk->capacity * 2u;
+        if (column_grow((void**) &chunk->offsets, sizeof(uint32_t), _capacity) != 0 ||
+            column_grow((void**) &chunk->sizes, sizeof(uint8_t), _capacity) != 0 ||
+            column_grow((void**) &chunk->mnemonics, sizeof(uint16_t), _capacity) != 0 ||
+            column_grow((void**) &chunk->operands, sizeof(uint32_t), _capacity) != 0) {
+            fprintf(stderr, "lzd, insn_chunk_push; realloc failed; could not grow columns.\n");
+            return -1;
+        }
+        chunk->capacity = _capacity;
+    }
+
+    /* intern the mnemonic and copy the operands into the arena. */
+    ssize_t mnem = chunk_intern(chunk, mnemonic ? mnemonic : "");
+    if (mnem < 0) return -1;
+    if (pool_append(&chunk->op_arena, &chunk->op_size, &chunk->op_capacity, op_str ? op_str : "", \
+        &chunk->operands[chunk->count]) != 0)
+        return -1;
+    chunk->offsets[chunk->count] = (uint32_t) (address - chunk->base);
+    chunk->sizes[chunk->count] = size;
+    chunk->mnemonics[chunk->count] = (uint16_t) mnem;
+    chunk->count++;
+    return 0;
+}
+
+/**
+ * @brief finish decoding a chunk; drops the intern table and trims each column to fit.
+ *
+ * @param chunk the chunk to seal.
+ */
+void
+insn_chunk_seal(insn_chunk_t* chunk) {
+    if (!chunk) return;
+    free(chunk->mnem_hash);
+    chunk->mnem_hash = 0x0;
+
+    /* shrinking can't really fail, and if it does the old column is still valid. */
+    if (chunk->count > 0u && chunk->count < chunk->capacity) {
+        column_grow((void**) &chunk->offsets, sizeof(uint32_t), chunk->count);
+        column_grow((void**) &chunk->sizes, sizeof(uint8_t), chunk->count);
+        column_grow((void**) &chunk->mnemonics, sizeof(uint16_t), chunk->count);
+        column_grow((void**) &chunk->operands, sizeof(uint32_t), chunk->count);
+        chunk->capacity = chunk->count;
+    }
+    if (chunk->op_size > 0u && chunk->op_size < chunk->op_capacity) {
+        column_grow((void**) &chunk->op_arena, sizeof(char), chunk->op_size);
+        chunk->op_capacity = chunk->op_size;
+    }
+}
+
+/**
+ * @brief carve a column out of a packed allocation.
+ *
+ * @param cursor pointer to the next free byte of the allocation (advanced).
+ * @param source the column to copy (or 0x0 if it is empty).
+ * @param bytes the size of the column in bytes.
+ * @return the copy of the column.
+ */
+internal void*
+pack_column(uint8_t** cursor, const void* source, size_t bytes) {
+    void* column = *cursor;
+    if (bytes) memcpy(column, source, bytes);
+    *cursor += bytes;
+    return column;
+}
+
+/**
+ * @brief pack a copy of a decoded chunk into an arena; the copy and its columns (trimmed to
+ *  fit) take a single allocation, and it stays alive as long as the arena does.
+ *
+ * @param chunk the chunk to be copied.
+ * @param xrefs the references out of the chunk, sorted by target (copied).
+ * @param xref_count the number of references.
+ * @param arena the arena.
+ * @return the sealed copy if successful, 0x0 o.w.
+ */
+insn_chunk_t*
+insn_chunk_pack(const insn_chunk_t* chunk, const insn_xref_t* xrefs, size_t xref_count, \
+    aren_t* arena) {
+    if (!chunk || !arena || (!xrefs && xref_count > 0u)) return 0x0;
+
+    /* the columns follow the chunk from the widest element down, so each one stays aligned. */
+    size_t n = chunk->count;
+    size_t bytes = sizeof *chunk + xref_count * sizeof(insn_xref_t) + n * 2u * sizeof(uint32_t) + \
+        chunk->mnem_count * sizeof(uint32_t) + n * sizeof(uint16_t) + n * sizeof(uint8_t) + \
+        chunk->op_size + chunk->mnem_size;
+    insn_chunk_t* packed = aren_alloc(arena, bytes);
+    if (!packed) {
+        fprintf(stderr, "lzd, insn_chunk_pack; aren_alloc failed; could not pack chunk.\n");
+        return 0x0;
+    }
+    *packed = *chunk;
+    uint8_t* cursor = (uint8_t*) (packed + 1);
+    packed->xrefs = pack_column(&cursor, xrefs, xref_count * sizeof(insn_xref_t));
+    packed->xref_count = xref_count;
+    packed->offsets = pack_column(&cursor, chunk->offsets, n * sizeof(uint32_t));
+    packed->operands = pack_column(&cursor, chunk->operands, n * sizeof(uint32_t));
+    packed->mnem_offs = pack_column(&cursor, chunk->mnem_offs, chunk->mnem_count * sizeof(uint32_t));
+    packed->mnemonics = pack_column(&cursor, chunk->mnemonics, n * sizeof(uint16_t));
+    packed->sizes = pack_column(&cursor, chunk->sizes, n * sizeof(uint8_t));
+    packed->op_arena = pack_column(&cursor, chunk->op_arena, chunk->op_size);
+    packed->mnem_pool = pack_column(&cursor, chunk->mnem_pool, chunk->mnem_size);
+    packed->capacity = n;
+    packed->op_capacity = chunk->op_size;
+    packed->mnem_capacity = chunk->mnem_size;
+    packed->mnem_hash = 0x0;
+    packed->backing = arena;
+    packed->arena = arena;
+    return packed;
+}
+
+/**
+ * @brief set the references out of a chunk, replacing older ones.
+ *
+ * @param chunk the chunk.
+ * @param xrefs the references, sorted by target (copied).
+ * @param count the number of references.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+insn_chunk_set_xrefs(insn_chunk_t* chunk, const insn_xref_t* xrefs, size_t count) {
+    if (!chunk || chunk->backing || (!xrefs && count > 0u)) return -1;
+    insn_xref_t* copy = 0x0;
+    if (count > 0u) {
+        copy = calloc(count, sizeof *copy);
+        if (!copy) {
+            fprintf(stderr, "lzd, insn_chunk_set_xrefs; calloc failed; could not allocate memory " \
+                "for xrefs.\n");
+            return -1;
+        }
+        memcpy(copy, xrefs, count * sizeof *copy);
+    }
+    free(chunk->xrefs);
+    chunk->xrefs = copy;
+    chunk->xref_count = count;
+    return 0;
+}
+
+/**
+ * @brief get a view of the instruction at an index inside of a chunk.
+ *
+ * @param chunk the chunk.
+ * @param index the index of the instruction in the chunk.
+ * @param out the view to be filled.
+ */
+void
+insn_chunk_get(const insn_chunk_t* chunk, size_t index, ux_insn_t* out) {
+    out->address = chunk->base + chunk->offsets[index];
+    out->size = chunk->sizes[index];
+    out->bytes = chunk->bytes ? chunk->bytes + chunk->offsets[index] : 0x0;
+    out->mnemonic = chunk->mnem_pool + chunk->mnem_offs[chunk->mnemonics[index]];
+    out->op_str = chunk->op_arena + chunk->operands[index];
+}
+
+/**
+ * @brief get the number of rows of a chunk, estimated for placeholders from the bytes-per-row
+ *  ratio of every chunk decoded so far (or ~4 bytes per instruction before any).
+ *
+ * @param store the instruction store.
+ * @param chunk the chunk.
+ * @return the number of rows.
+ */
+internal size_t
+chunk_rows(const insn_store_t* store, const insn_chunk_t* chunk) {
+    if (chunk->state == INSN_CHUNK_DECODED) return chunk->count;
+    if (chunk->length == 0u) return 0u;
+    if (chunk->rows > 0u) return chunk->rows;
+    double per_byte = store->decoded_bytes > 0u ? \
+        (double) store->decoded_rows / (double) store->decoded_bytes : 0.25;
+    size_t rows = (size_t) ((double) chunk->length * per_byte + 0.5);
+    return rows > 0u ? rows : 1u;
+}
+
+/**
+ * @brief get the number of rows of the chunk at an index from the running row counts.
+ *
+ * @param store the instruction store.
+ * @param index the chunk index.
+ * @return the number of rows.
+ */
+internal size_t
+store_rows_of(const insn_store_t* store, size_t index) {
+    size_t end = index + 1u < store->count ? store->prefix[index + 1u] : store->rows;
+    return end - store->prefix[index];
+}
+
+/**
+ * @brief recompute the running row counts from a chunk index onwards.
+ *
+ * @param store the instruction store.
+ * @param from the first chunk index whose prefix is stale.
+ */
+internal void
+store_reprefix(insn_store_t* store, size_t from) {
+    size_t rows = from == 0u ? 0u : store->prefix[from - 1u] + chunk_rows(store, store->chunks[from - 1u]);
+    for (size_t i = from; i < store->count; i++) {
+        store->prefix[i] = rows;
+        rows += chunk_rows(store, store->chunks[i]);
+    }
+    store->rows = rows;
+}
+
+/**
+ * @brief account a chunk entering or leaving the store in the running totals.
+ *
+ * @param store the instruction store.
+ * @param chunk the chunk.
+ * @param sign +1 when the chunk enters, -1 when it leaves.
+ */
+internal void
+store_account(insn_store_t* store, const insn_chunk_t* chunk, int sign) {
+    if (chunk->state != INSN_CHUNK_DECODED) {
+        store->pending += (size_t) sign;
+        return;
+    }
+    store->decoded_bytes += (uint64_t) (sign * (int64_t) chunk->length);
+    store->decoded_rows += (uint64_t) (sign * (int64_t) chunk->count);
+}
+
+/**
+ * @brief fill a view for a row inside of a placeholder with an estimated address.
+ *
+ * @param chunk the placeholder chunk.
+ * @param index the row inside of the chunk.
+ * @param rows the estimated number of rows of the chunk.
+ * @param out the view to be filled.
+ */
+internal void
+pending_get(const insn_chunk_t* chunk, size_t index, size_t rows, ux_insn_t* out) {
+    out->address = chunk->base + (uint64_t) ((double) index * (double) chunk->length / (double) rows);
+    out->size = 0u;
+    out->bytes = 0x0;
+    out->mnemonic = 0x0;
+    out->op_str = 0x0;
+}
+
+/**
+ * @brief find the index of the first chunk with a base >= an address.
+ *
+ * @param store the instruction store.
+ * @param base the base address.
+ * @return the lower bound index in [0, count].
+ */
+internal size_t
+store_lower_bound(insn_store_t* store, uint64_t base) {
+    size_t lo = 0u, hi = store->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2u;
+        if (store->chunks[mid]->base < base) lo = mid + 1u;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief drop the first instructions of a chunk.
+ *
+ * @param chunk the chunk.
+ * @param n the number of instructions to drop.
+ */
+internal void
+chunk_drop_front(insn_chunk_t* chunk, size_t n) {
+    if (n > chunk->count) n = chunk->count;
+    if (n == 0u) return;
+    size_t keep = chunk->count - n;
+    if (chunk->backing) {
+        /* borrowed columns are read-only, move the views instead. */
+        chunk->offsets += n;
+        chunk->sizes += n;
+        chunk->mnemonics += n;
+        chunk->operands += n;
+    } else {
+        memmove(chunk->offsets, chunk->offsets + n, keep * sizeof(uint32_t));
+        memmove(chunk->sizes, chunk->sizes + n, keep * sizeof(uint8_t));
+        memmove(chunk->mnemonics, chunk->mnemonics + n, keep * sizeof(uint16_t));
+        memmove(chunk->operands, chunk->operands + n, keep * sizeof(uint32_t));
+    }
+    chunk->count = keep;
+}
+
+/**
+ * @brief stitch a decoded chunk to the decoded chunk right after it, if that one starts at a
+ *  seam; both decodes are walked for the first address they agree on, the left chunk keeps
+ *  everything before it and the right chunk everything from it on.
+ *
+ * @param store the instruction store.
+ * @param left the index of the left chunk.
+ */
+internal void
+store_stitch(insn_store_t* store, size_t left) {
+    if (left + 1u >= store->count) return;
+    insn_chunk_t* l = store->chunks[left], *r = store->chunks[left + 1u];
+    if (l->state != INSN_CHUNK_DECODED || r->state != INSN_CHUNK_DECODED || !r->seam || \
+        l->base + l->length != r->base)
+        return;
+
+    /* both streams are address-ordered, so merge them until they meet. */
+    size_t first = l->count - l->overlap, a = first, b = 0u;
+    bool synced = false;
+    while (a < l->count && b < r->count) {
+        uint64_t la = l->base + l->offsets[a], rb = r->base + r->offsets[b];
+        if (la == rb) {
+            synced = true;
+            break;
+        }
+        if (la < rb) a++;
+        else b++;
+    }
+
+    /* no agreement inside of the lookahead, keep the left stream up to the seam and start the
+     *  right one after the instruction that crosses it. */
+    if (!synced) {
+        a = first;
+        uint64_t end = a > 0u ? l->base + l->offsets[a - 1u] + l->sizes[a - 1u] : r->base;
+        for (b = 0u; b < r->count && r->base + r->offsets[b] < end; b++);
+    }
+    store_account(store, l, -1);
+    store_account(store, r, -1);
+    l->count = a;
+    l->overlap = 0u;
+    chunk_drop_front(r, b);
+    r->seam = false;
+    store_account(store, l, +1);
+    store_account(store, r, +1);
+}
+
+/**
+ * @brief create a new empty instruction store.
+ *
+ * @return an allocated instruction store if successful, 0x0 o.w.
+ */
+insn_store_t*
+insn_store_create() {
+    insn_store_t* store = calloc(1u, sizeof *store);
+    if (!store) {
+        fprintf(stderr, "lzd, insn_store_create; calloc failed; could not allocate memory for store.\n");
+        return 0x0;
+    }
+    return store;
+}
+
+/**
+ * @brief free an instruction store, all of its chunks and instructions.
+ *
+ * @param store the store to be freed.
+ */
+void
+insn_store_free(insn_store_t* store) {
+    if (!store) return;
+    insn_store_clear(store);
+    free(store->chunks);
+    free(store->prefix);
+    free(store);
+}
+
+/**
+ * @brief remove (and free) every chunk in an instruction store.
+ *
+ * @param store the store to be cleared.
+ */
+void
+insn_store_clear(insn_store_t* store) {
+    if (!store) return;
+    for (size_t i = 0; i < store->count; i++)
+        insn_chunk_free(store->chunks[i]);
+    store->count = 0u;
+    store->rows = 0u;
+    store->hint = 0u;
+    store->pending = 0u;
+    store->decoded_bytes = 0u;
+    store->decoded_rows = 0u;
+}
+
+/**
+ * @brief place a chunk into the table, shifting the chunks after it.
+ *
+ * @param store the instruction store.
+ * @param at the index to insert at.
+ * @param chunk the chunk to be inserted.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+store_place(insn_store_t* store, size_t at, insn_chunk_t* chunk) {
+    /* grow both arrays together. */
+    if (store->count == store->capacity) {
+        size_t _capacity = store->capacity == 0u ? 16u : store->capacity * 2u;
+        if (column_grow((void**) &store->chunks, sizeof(insn_chunk_t*), _capacity) != 0 ||
+            column_grow((void**) &store->prefix, sizeof(size_t), _capacity) != 0) {
+            fprintf(stderr, "lzd, store_place; realloc failed; could not grow chunk table.\n");
+            return -1;
+        }
+        store->capacity = _capacity;
+    }
+
+    /* shift the chunk table (not the instructions). */
+    memmove(&store->chunks[at + 1u], &store->chunks[at], sizeof(insn_chunk_t*) * (store->count - at));
+    store->chunks[at] = chunk;
+    store->count++;
+    return 0;
+}
+
+/**
+ * @brief insert a decoded chunk into the store at its address-ordered position; if a chunk with
+ *  the same base already exists it is replaced.
+ *
+ * @param store the instruction store.
+ * @param chunk the sealed chunk to be inserted (ownership is taken).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+insn_store_insert(insn_store_t* store, insn_chunk_t* chunk) {
+    if (!store || !chunk) return -1;
+
+    /* replace a chunk (or placeholder) that was decoded again. */
+    size_t at = store_lower_bound(store, chunk->base);
+    if (at < store->count && store->chunks[at]->base == chunk->base) {
+        store_account(store, store->chunks[at], -1);
+        insn_chunk_free(store->chunks[at]);
+        store->chunks[at] = chunk;
+    } else if (store_place(store, at, chunk) != 0) {
+        return -1;
+    }
+
+    /* stitch the seams on either side, then recount; the rows-per-byte estimate changed, so
+     *  every placeholder has to be recounted too. */
+    store_account(store, chunk, +1);
+    if (at > 0u) store_stitch(store, at - 1u);
+    store_stitch(store, at);
+    store_reprefix(store, store->pending > 0u || at == 0u ? 0u : at - 1u);
+    return 0;
+}
+
+/**
+ * @brief reserve a placeholder chunk for a code range that will be decoded later; does nothing
+ *  if a chunk with the same base already exists.
+ *
+ * @param store the instruction store.
+ * @param base the base address of the code range.
+ * @param length the length of the code range.
+ * @param rows the number of rows it decodes into, 0 to estimate it.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+insn_store_reserve(insn_store_t* store, uint64_t base, size_t length, size_t rows) {
+    if (!store) return -1;
+    size_t at = store_lower_bound(store, base);
+    if (at < store->count && store->chunks[at]->base == base) return 0;
+
+    /* a placeholder is just an empty chunk without bytes. */
+    insn_chunk_t* chunk = insn_chunk_create(base, length, 0x0);
+    if (!chunk) return -1;
+    chunk->state = INSN_CHUNK_PENDING;
+    chunk->rows = rows;
+    if (store_place(store, at, chunk) != 0) {
+        insn_chunk_free(chunk);
+        return -1;
+    }
+    store_account(store, chunk, +1);
+    store_reprefix(store, at);
+    return 0;
+}
+
+/**
+ * @brief get the index of the chunk a row belongs to.
+ *
+ * @param store the instruction store.
+ * @param row the row.
+ * @return -1 if the row is out of bounds, the chunk index o.w.
+ */
+ssize_t
+insn_store_chunk(insn_store_t* store, size_t row) {
+    if (!store || row >= store->rows) return -1;
+
+    /* rows are almost always fetched in order, so check the last chunk (and its neighbour). */
+    size_t hint = store->hint < store->count ? store->hint : 0u;
+    for (size_t i = hint; i < store->count && i <= hint + 1u; i++) {
+        if (row >= store->prefix[i] && row - store->prefix[i] < store_rows_of(store, i)) {
+            store->hint = i;
+            return (ssize_t) i;
+        }
+    }
+
+    /* o.w. binary search for the last chunk whose prefix is <= row. */
+    size_t lo = 0u, hi = store->count;
+    while (hi - lo > 1u) {
+        size_t mid = lo + (hi - lo) / 2u;
+        if (store->prefix[mid] <= row) lo = mid;
+        else hi = mid;
+    }
+
+    /* skip over empty chunks sharing the same prefix. */
+    while (lo < store->count && row - store->prefix[lo] >= store_rows_of(store, lo)) lo++;
+    if (lo == store->count) return -1;
+    store->hint = lo;
+    return (ssize_t) lo;
+}
+
+/**
+ * @brief get the instruction at a row.
+ *
+ * @param store the instruction store.
+ * @param row the row (global instruction index).
+ * @param out the view to be filled.
+ * @return -1 if the row is out of bounds, 1 if the row belongs to a placeholder (only
+ *  out->address is filled, with an estimate), 0 o.w.
+ */
+ssize_t
+insn_store_at(insn_store_t* store, size_t row, ux_insn_t* out) {
+    if (!out) return -1;
+    ssize_t at = insn_store_chunk(store, row);
+    if (at < 0) return -1;
+    insn_chunk_t* chunk = store->chunks[at];
+    if (chunk->state != INSN_CHUNK_DECODED) {
+        pending_get(chunk, row - store->prefix[at], store_rows_of(store, (size_t) at), out);
+        return 1;
+    }
+    insn_chunk_get(chunk, row - store->prefix[at], out);
+    return 0;
+}
+
+/**
+ * @brief get the index of the chunk (or placeholder) for the code range at a base address.
+ *
+ * @param store the instruction store.
+ * @param base the base address of the code range.
+ * @return -1 if there is none, the chunk index o.w.
+ */
+ssize_t
+insn_store_index(insn_store_t* store, uint64_t base) {
+    if (!store) return -1;
+    size_t at = store_lower_bound(store, base);
+    return at < store->count && store->chunks[at]->base == base ? (ssize_t) at : -1;
+}
+
+/**
+ * @brief find the row of the first instruction at or after an address.
+ *
+ * @param store the instruction store.
+ * @param address the address to look for.
+ * @return -1 if no instruction lies at or after the address, the row o.w.
+ */
+ssize_t
+insn_store_find(insn_store_t* store, uint64_t address) {
+    if (!store || store->count == 0u) return -1;
+
+    /* find the chunk containing the address (the last one with base <= address). */
+    size_t at = store_lower_bound(store, address);
+    if (at == store->count || store->chunks[at]->base > address) {
+        if (at == 0u) return store->rows > 0u ? 0 : -1;
+        at--;
+    }
+
+    /* after a stitch the previous chunk may keep a few instructions past its end. */
+    if (at > 0u) {
+        insn_chunk_t* prev = store->chunks[at - 1u];
+        if (prev->state == INSN_CHUNK_DECODED && prev->count > 0u && \
+            prev->base + prev->offsets[prev->count - 1u] >= address)
+            at--;
+    }
+
+    /* binary search over the offsets of the chunk, falling through to the next non-empty one. */
+    for (; at < store->count; at++) {
+        insn_chunk_t* chunk = store->chunks[at];
+        uint64_t target = address > chunk->base ? address - chunk->base : 0u;
+        if (chunk->state != INSN_CHUNK_DECODED) {
+            /* estimate the row inside of a placeholder. */
+            size_t rows = store_rows_of(store, at);
+            if (rows == 0u || target >= chunk->length) continue;
+            size_t est = (size_t) ((double) target * (double) rows / (double) chunk->length);
+            return (ssize_t) (store->prefix[at] + (est < rows ? est : rows - 1u));
+        }
+        size_t lo = 0u, hi = chunk->count;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2u;
+            if (chunk->offsets[mid] < target) lo = mid + 1u;
+            else hi = mid;
+        }
+        if (lo < chunk->count)
+            return (ssize_t) (store->prefix[at] + lo);
+    }
+    return -1;
+}
@@ -0,0 +1,290 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-02
+ */
+#ifndef LZD_INSN_H
+#define LZD_INSN_H
+
+/*! @uses uint64_t, uint8_t. */
+#include <stdint.h>
+
+/*! @uses size_t, ssize_t. */
+#include <sys/types.h>
+
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses aren_t. */
+#include "aren.h"
+
+/* a view of a single decoded instruction, it points into its chunk and is only valid while the
+ *  chunk is alive. */
+typedef struct {
+    uint64_t address;
+    uint8_t size;
+    const uint8_t* bytes; /* raw bytes (borrowed from the mapped image). */
+
+    /* used in the tui. */
+    const char* mnemonic;
+    const char* op_str;
+} ux_insn_t;
+
+/* kind of a reference out of an instruction. */
+typedef enum {
+    INSN_XREF_JUMP = 0u, /* branch target. */
+    INSN_XREF_CALL, /* call target. */
+    INSN_XREF_DATA, /* rip-relative memory operand. */
+} insn_xref_kind_t;
+
+/* a reference out of a decoded instruction to another address. */
+typedef struct {
+    uint64_t target; /* address referred to. */
+    uint32_t from; /* byte offset of the referring instruction from the chunk base. */
+    uint8_t kind; /* insn_xref_kind_t. */
+    uint8_t reserved[3]; /* zero, the record is written to the cache as it is. */
+} insn_xref_t;
+
+/* decode state of a chunk in the store. */
+typedef enum {
+    INSN_CHUNK_DECODED = 0u, /* decoded, the columns hold every instruction. */
+    INSN_CHUNK_PENDING, /* placeholder for a code range nobody has asked for yet. */
+    INSN_CHUNK_REQUESTED, /* placeholder for a code range that is being decoded. */
+} insn_chunk_state_t;
+
+/**
+ * a decoded chunk of instructions, one per disassembled code range, packed column-wise; the
+ *  instructions inside of a chunk are already sorted by address since they come out of a
+ *  linear decode. the address of an instruction is base + offsets[i] and its raw bytes are
+ *  bytes + offsets[i], mnemonics are interned once per chunk and every operand string lives
+ *  nul-terminated in a single arena.
+ */
+typedef struct {
+    uint64_t base; /* base address of the code range. */
+    size_t length; /* length of the code range in bytes. */
+    const uint8_t* bytes; /* bytes of the code range (borrowed from the mapped image). */
+    insn_chunk_state_t state; /* decoded, or a placeholder with an estimated row count. */
+    size_t rows; /* row count of a placeholder from the length decoder, 0 if it is estimated. */
+    size_t count, capacity; /* number of instructions, and allocated capacity of each column. */
+    uint32_t* offsets; /* byte offset of each instruction from base. */
+    uint8_t* sizes; /* size of each instruction. */
+    uint16_t* mnemonics; /* index into mnem_offs of each instruction. */
+    uint32_t* operands; /* offset into op_arena of each instruction. */
+    char* op_arena; /* nul-terminated operand strings. */
+    size_t op_size, op_capacity; /* used and allocated bytes of the operand arena. */
+    char* mnem_pool; /* nul-terminated interned mnemonics. */
+    size_t mnem_size, mnem_capacity; /* used and allocated bytes of the mnemonic pool. */
+    uint32_t* mnem_offs; /* offset into mnem_pool of each interned mnemonic. */
+    size_t mnem_count; /* number of interned mnemonics. */
+    uint16_t* mnem_hash; /* open-addressed intern table (1-based), only alive while decoding. */
+    insn_xref_t* xrefs; /* references out of the instructions, sorted by target. */
+    size_t xref_count; /* number of references. */
+    const void* backing; /* mapping the columns are borrowed from (a cache file or an arena), 0x0
+                          *  if owned. */
+    const aren_t* arena; /* arena the chunk itself lives in (freed with it), 0x0 if on the heap. */
+    size_t overlap; /* trailing instructions decoded past the end into a seam, until stitched. */
+    bool seam; /* starts at a split that may not be an instruction boundary, until stitched. */
+    uint64_t requested; /* generation a placeholder was requested in (see disj_token_t). */
+    bool urgent; /* a placeholder was requested at high priority (ahead of the prefetch). */
+} insn_chunk_t;
+
+/**
+ * @brief create a new empty chunk for a code range.
+ *
+ * @param base the base address of the code range.
+ * @param length the length of the code range.
+ * @param bytes the bytes of the code range (borrowed).
+ * @return an allocated chunk if successful, 0x0 o.w.
+ */
+insn_chunk_t*
+insn_chunk_create(uint64_t base, size_t length, const uint8_t* bytes);
+
+/**
+ * @brief free a chunk and all of its columns (unless they are borrowed); a chunk that lives in
+ *  an arena is left to it.
+ *
+ * @param chunk the chunk to be freed.
+ */
+void
+insn_chunk_free(insn_chunk_t* chunk);
+
+/**
+ * @brief empty a chunk for another code range, keeping its columns (and their capacity); a
+ *  chunk that is decoded into over and over (e.g. per thread) only grows until it is as large
+ *  as the largest code range.
+ *
+ * @param chunk the chunk, it must own its columns.
+ * @param base the base address of the code range.
+ * @param length the length of the code range.
+ * @param bytes the bytes of the code range (borrowed).
+ */
+void
+insn_chunk_reset(insn_chunk_t* chunk, uint64_t base, size_t length, const uint8_t* bytes);
+
+/**
+ * @brief append a decoded instruction to a chunk.
+ *
+ * @param chunk the chunk to append to.
+ * @param address the address of the instruction (must be >= base, and ascending).
+ * @param size the size of the instruction.
+ * @param mnemonic the mnemonic of the instruction (interned).
+ * @param op_str the operand string of the instruction (copied into the arena).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+insn_chunk_push(insn_chunk_t* chunk, uint64_t address, uint8_t size, const char* mnemonic, \
+    const char* op_str);
+
+/**
+ * @brief finish decoding a chunk; drops the intern table and trims each column to fit.
+ *
+ * @param chunk the chunk to seal.
+ */
+void
+insn_chunk_seal(insn_chunk_t* chunk);
+
+/**
+ * @brief pack a copy of a decoded chunk into an arena; the copy and its columns (trimmed to
+ *  fit) take a single allocation, and it stays alive as long as the arena does.
+ *
+ * @param chunk the chunk to be copied.
+ * @param xrefs the references out of the chunk, sorted by target (copied).
+ * @param xref_count the number of references.
+ * @param arena the arena.
+ * @return the sealed copy if successful, 0x0 o.w.
+ */
+insn_chunk_t*
+insn_chunk_pack(const insn_chunk_t* chunk, const insn_xref_t* xrefs, size_t xref_count, \
+    aren_t* arena);
+
+/**
+ * @brief set the references out of a chunk, replacing older ones.
+ *
+ * @param chunk the chunk.
+ * @param xrefs the references, sorted by target (copied).
+ * @param count the number of references.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+insn_chunk_set_xrefs(insn_chunk_t* chunk, const insn_xref_t* xrefs, size_t count);
+
+/**
+ * @brief get a view of the instruction at an index inside of a chunk.
+ *
+ * @param chunk the chunk.
+ * @param index the index of the instruction in the chunk.
+ * @param out the view to be filled.
+ */
+void
+insn_chunk_get(const insn_chunk_t* chunk, size_t index, ux_insn_t* out);
+
+/**
+ * an address-ordered store of decoded chunks; chunks can arrive in any order, they are kept
+ *  sorted by base address along with a running row count so a row can be mapped back to its
+ *  chunk without ever re-sorting the instructions themselves. code ranges that have not been
+ *  decoded yet can be reserved as placeholders whose row count is counted by a length decoder
+ *  or, without one, estimated from the average instruction size seen so far, which keeps row
+ *  counts (and the scrollbar) plausible. when two
+ *  decoded chunks meet at a seam they are stitched at the first address both decodes agree on,
+ *  the left chunk drops its lookahead past that point and the right one everything before it.
+ */
+typedef struct {
+    insn_chunk_t** chunks; /* array of chunks sorted by base. */
+    size_t* prefix; /* prefix[i] = number of rows before chunks[i]. */
+    size_t count, capacity; /* number of chunks, and allocated capacity. */
+    size_t rows; /* total number of rows in the store, estimated rows of placeholders included. */
+    size_t hint; /* index of the last chunk a row lookup landed in. */
+    size_t pending; /* number of placeholder chunks. */
+    uint64_t decoded_bytes, decoded_rows; /* linear-sweep totals used for the rows-per-byte estimate. */
+} insn_store_t;
+
+/**
+ * @brief create a new empty instruction store.
+ *
+ * @return an allocated instruction store if successful, 0x0 o.w.
+ */
+insn_store_t*
+insn_store_create();
+
+/**
+ * @brief free an instruction store, all of its chunks and instructions.
+ *
+ * @param store the store to be freed.
+ */
+void
+insn_store_free(insn_store_t* store);
+
+/**
+ * @brief remove (and free) every chunk in an instruction store.
+ *
+ * @param store the store to be cleared.
+ */
+void
+insn_store_clear(insn_store_t* store);
+
+/**
+ * @brief insert a decoded chunk into the store at its address-ordered position; if a chunk with
+ *  the same base already exists it is replaced.
+ *
+ * @param store the instruction store.
+ * @param chunk the sealed chunk to be inserted (ownership is taken).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+insn_store_insert(insn_store_t* store, insn_chunk_t* chunk);
+
+/**
+ * @brief reserve a placeholder chunk for a code range that will be decoded later; does nothing
+ *  if a chunk with the same base already exists.
+ *
+ * @param store the instruction store.
+ * @param base the base address of the code range.
+ * @param length the length of the code range.
+ * @param rows the number of rows it decodes into, 0 to estimate it.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+insn_store_reserve(insn_store_t* store, uint64_t base, size_t length, size_t rows);
+
+/**
+ * @brief get the instruction at a row.
+ *
+ * @param store the instruction store.
+ * @param row the row (global instruction index).
+ * @param out the view to be filled.
+ * @return -1 if the row is out of bounds, 1 if the row belongs to a placeholder (only
+ *  out->address is filled, with an estimate), 0 o.w.
+ */
+ssize_t
+insn_store_at(insn_store_t* store, size_t row, ux_insn_t* out);
+
+/**
+ * @brief get the index of the chunk a row belongs to.
+ *
+ * @param store the instruction store.
+ * @param row the row.
+ * @return -1 if the row is out of bounds, the chunk index o.w.
+ */
+ssize_t
+insn_store_chunk(insn_store_t* store, size_t row);
+
+/**
+ * @brief get the index of the chunk (or placeholder) for the code range at a base address.
+ *
+ * @param store the instruction store.
+ * @param base the base address of the code range.
+ * @return -1 if there is none, the chunk index o.w.
+ */
+ssize_t
+insn_store_index(insn_store_t* store, uint64_t base);
+
+/**
+ * @brief find the row of the first instruction at or after an address; inside of a placeholder
+ *  the row is an estimate.
+ *
+ * @param store the instruction store.
+ * @param address the address to look for.
+ * @return -1 if no instruction lies at or after the address, the row o.w.
+ */
+ssize_t
+insn_store_find(insn_store_t* store, uint64_t address);
+#endif /* LZD_INSN_H */
@@ -0,0 +1,186 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-03
+ */
+#include "line.h"
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses calloc, free. */
+#include <stdlib.h>
+
+/*! @uses internal. */
+#include "dyna.h"
+
+/**
+ * @brief hash a (tag, key) pair into a bucket index.
+ *
+ * @param cache the line cache.
+ * @param tag the view tag.
+ * @param key the key.
+ * @return the bucket index.
+ */
+internal size_t
+line_bucket(line_cache_t* cache, uint32_t tag, uint64_t key) {
+    uint64_t h = (key ^ ((uint64_t) tag << 56)) * 0x9e3779b97f4a7c15ull;
+    return (size_t) (h >> 32) & (cache->nbuckets - 1u);
+}
+
+/**
+ * @brief unlink a slot from the lru list.
+ *
+ * @param cache the line cache.
+ * @param index the slot index.
+ */
+internal void
+lru_unlink(line_cache_t* cache, int32_t index) {
+    line_slot_t* slot = &cache->slots[index];
+    if (slot->prev >= 0) cache->slots[slot->prev].next = slot->next;
+    else cache->head = slot->next;
+    if (slot->next >= 0) cache->slots[slot->next].prev = slot->prev;
+    else cache->tail = slot->prev;
+    slot->prev = slot->next = -1;
+}
+
+/**
+ * @brief push a slot to the front (most recently used) of the lru list.
+ *
+ * @param cache the line cache.
+ * @param index the slot index.
+ */
+internal void
+lru_push_front(line_cache_t* cache, int32_t index) {
+    line_slot_t* slot = &cache->slots[index];
+    slot->prev = -1;
+    slot->next = cache->head;
+    if (cache->head >= 0) cache->slots[cache->head].prev = index;
+    cache->head = index;
+    if (cache->tail < 0) cache->tail = index;
+}
+
+/**
+ * @brief remove a slot from its hash chain.
+ *
+ * @param cache the line cache.
+ * @param index the slot index.
+ */
+internal void
+chain_unlink(line_cache_t* cache, int32_t index) {
+    line_slot_t* slot = &cache->slots[index];
+    int32_t* link = &cache->buckets[line_bucket(cache, slot->tag, slot->key)];
+    while (*link >= 0 && *link != index) link = &cache->slots[*link].chain;
+    if (*link == index) *link = slot->chain;
+    slot->chain = -1;
+}
+
+/**
+ * @brief create a new line cache.
+ *
+ * @param capacity the maximum number of lines kept.
+ * @return an allocated line cache if successful, 0x0 o.w.
+ */
+line_cache_t*
+line_cache_create(size_t capacity) {
+    if (capacity == 0u) capacity = 1u;
+    line_cache_t* cache = calloc(1u, sizeof *cache);
+    if (!cache) {
+        fprintf(stderr, "lzd, line_cache_create; calloc failed; could not allocate memory for cache.\n");
+        return 0x0;
+    }
+
+    /* two buckets per slot keeps the chains short. */
+    cache->nbuckets = 1u;
+    while (cache->nbuckets < capacity * 2u) cache->nbuckets <<= 1u;
+    cache->slots = calloc(capacity, sizeof(line_slot_t));
+    cache->buckets = calloc(cache->nbuckets, sizeof(int32_t));
+    if (!cache->slots || !cache->buckets) {
+        fprintf(stderr, "lzd, line_cache_create; calloc failed; could not allocate memory for slots.\n");
+        line_cache_free(cache);
+        return 0x0;
+    }
+    cache->capacity = capacity;
+    line_cache_clear(cache);
+    return cache;
+}
+
+/**
+ * @brief free a line cache.
+ *
+ * @param cache the cache to be freed.
+ */
+void
+line_cache_free(line_cache_t* cache) {
+    if (!cache) return;
+    free(cache->slots);
+    free(cache->buckets);
+    free(cache);
+}
+
+/**
+ * @brief drop every line in the cache (e.g. when the backing data changes).
+ *
+ * @param cache the cache to be cleared.
+ */
+void
+line_cache_clear(line_cache_t* cache) {
+    if (!cache) return;
+    for (size_t i = 0; i < cache->nbuckets; i++) cache->buckets[i] = -1;
+    cache->used = 0u;
+    cache->head = cache->tail = -1;
+}
+
+/**
+ * @brief look up a formatted line, marking it as most recently used.
+ *
+ * @param cache the line cache.
+ * @param tag the view the line belongs to.
+ * @param key the address (or row) of the line.
+ * @return 0x0 if the line is not cached, the line o.w.
+ */
+const char*
+line_cache_get(line_cache_t* cache, uint32_t tag, uint64_t key) {
+    if (!cache) return 0x0;
+    for (int32_t i = cache->buckets[line_bucket(cache, tag, key)]; i >= 0; i = cache->slots[i].chain) {
+        if (cache->slots[i].key == key && cache->slots[i].tag == tag) {
+            if (cache->head != i) {
+                lru_unlink(cache, i);
+                lru_push_front(cache, i);
+            }
+            return cache->slots[i].text;
+        }
+    }
+    return 0x0;
+}
+
+/**
+ * @brief claim a slot for a line, evicting the least recently used one if the cache is full.
+ *
+ * @param cache the line cache.
+ * @param tag the view the line belongs to.
+ * @param key the address (or row) of the line.
+ * @return a buffer of LINE_WIDTH bytes to format the line into.
+ */
+char*
+line_cache_put(line_cache_t* cache, uint32_t tag, uint64_t key) {
+    int32_t index;
+    if (cache->used < cache->capacity) {
+        index = (int32_t) cache->used++;
+    } else {
+        /* evict the least recently used line. */
+        index = cache->tail;
+        lru_unlink(cache, index);
+        chain_unlink(cache, index);
+    }
+
+    /* link the slot into its bucket and at the front of the lru list. */
+    line_slot_t* slot = &cache->slots[index];
+    slot->key = key;
+    slot->tag = tag;
+    size_t bucket = line_bucket(cache, tag, key);
+    slot->chain = cache->buckets[bucket];
+    cache->buckets[bucket] = index;
+    lru_push_front(cache, index);
+    slot->text[0] = '\0';
+    return slot->text;
+}
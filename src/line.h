@@ -0,0 +1,84 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-03
+ */
+#ifndef LZD_LINE_H
+#define LZD_LINE_H
+
+/*! @uses uint64_t, uint32_t, int32_t. */
+#include <stdint.h>
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/* maximum length of a single formatted line (including the terminator). */
+#define LINE_WIDTH 256u
+
+/* ... */
+typedef struct {
+    uint64_t key; /* address (or row) the line was formatted for. */
+    uint32_t tag; /* which view the line belongs to. */
+    int32_t prev, next; /* neighbours in the lru list (-1 if none). */
+    int32_t chain; /* next slot in the same hash bucket (-1 if none). */
+    char text[LINE_WIDTH]; /* the formatted line. */
+} line_slot_t;
+
+/**
+ * a small, bounded lru cache of formatted display lines; it only ever holds what has recently
+ *  been on screen so scrolling back and forth doesn't format the same rows again.
+ */
+typedef struct {
+    line_slot_t* slots; /* fixed array of slots. */
+    size_t capacity, used; /* number of slots, and how many are in use. */
+    int32_t* buckets; /* hash buckets, head slot of each chain (-1 if empty). */
+    size_t nbuckets; /* number of buckets (power of two). */
+    int32_t head, tail; /* most and least recently used slots. */
+} line_cache_t;
+
+/**
+ * @brief create a new line cache.
+ *
+ * @param capacity the maximum number of lines kept.
+ * @return an allocated line cache if successful, 0x0 o.w.
+ */
+line_cache_t*
+line_cache_create(size_t capacity);
+
+/**
+ * @brief free a line cache.
+ *
+ * @param cache the cache to be freed.
+ */
+void
+line_cache_free(line_cache_t* cache);
+
+/**
+ * @brief drop every line in the cache (e.g. when the backing data changes).
+ *
+ * @param cache the cache to be cleared.
+ */
+void
+line_cache_clear(line_cache_t* cache);
+
+/**
+ * @brief look up a formatted line, marking it as most recently used.
+ *
+ * @param cache the line cache.
+ * @param tag the view the line belongs to.
+ * @param key the address (or row) of the line.
+ * @return 0x0 if the line is not cached, the line o.w.
+ */
+const char*
+line_cache_get(line_cache_t* cache, uint32_t tag, uint64_t key);
+
+/**
+ * @brief claim a slot for a line, evicting the least recently used one if the cache is full.
+ *
+ * @param cache the line cache.
+ * @param tag the view the line belongs to.
+ * @param key the address (or row) of the line.
+ * @return a buffer of LINE_WIDTH bytes to format the line into.
+ */
+char*
+line_cache_put(line_cache_t* cache, uint32_t tag, uint64_t key);
+#endif /* LZD_LINE_H */
@@ -4,18 +4,63 @@
  */
 #include <stdio.h>
 
+/*! @uses getopt, optarg, optind, close. */
+#include <unistd.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses open, O_WRONLY, O_CREAT, O_TRUNC, O_CLOEXEC. */
+#include <fcntl.h>
+
 /*! @uses ui_model_t, ui_model_create, ui_run, ui_model_free. */
 #include "ui.h"
 
-/*! @uses ux_init. */
+/*! @uses ux_init, ux_shutdown. */
 #include "ux.h"
 
+/*! @uses btch_format_t, btch_run. */
+#include "btch.h"
+
 /* reference to the ui model. */
 ui_model_t* g_ui_model = NULL;
 
-int main() {
+int main(int argc, char** argv) {
+    /* lzd [-d <path> [-j] [-r] [-s] [-o <file>]], -d disassembles without the tui and -s dumps
+     *  its stats to stderr. */
+    const char* path = NULL, *output = NULL;
+    btch_format_t format = BTCH_FORMAT_TEXT;
+    bool descent = false, stats = false;
+    int option;
+    while ((option = getopt(argc, argv, "d:jrso:")) != -1) {
+        if (option == 'd') path = optarg;
+        else if (option == 'j') format = BTCH_FORMAT_JSON;
+        else if (option == 'r') descent = true;
+        else if (option == 's') stats = true;
+        else if (option == 'o') output = optarg;
+        else {
+            fprintf(stderr, "usage: %s [-d <path> [-j] [-r] [-s] [-o <file>]]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind < argc || (!path && (output || descent || stats || format != BTCH_FORMAT_TEXT))) {
+        fprintf(stderr, "usage: %s [-d <path> [-j] [-r] [-s] [-o <file>]]\n", argv[0]);
+        return 2;
+    }
+    if (path) {
+        int fd = output ? open(output, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) : 1;
+        if (fd < 0) {
+            fprintf(stderr, "lzd, main; could not open %s for writing.\n", output);
+            return 1;
+        }
+        int status = btch_run(path, fd, format, descent, stats ? stderr : NULL) == 0 ? 0 : 1;
+        if (output && close(fd) != 0) status = 1;
+        return status;
+    }
+
     ux_init();
     g_ui_model = ui_model_create("lzd - lazy disassembler", "? | ?");
     ui_run(g_ui_model);
+    ux_shutdown();
     ui_model_free(g_ui_model);
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-02
+ */
+#include "mapf.h"
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses calloc, free. */
+#include <stdlib.h>
+
+/*! @uses open, O_RDONLY. */
+#include <fcntl.h>
+
+/*! @uses fstat, struct stat. */
+#include <sys/stat.h>
+
+/*! @uses mmap, munmap, PROT_READ, MAP_PRIVATE. */
+#include <sys/mman.h>
+
+/*! @uses close. */
+#include <unistd.h>
+
+/**
+ * @brief map an entire file into memory (read-only).
+ *
+ * @param path the path to the file to be mapped.
+ * @return a pointer to an allocated mapping if successful, 0x0 o.w.
+ */
+mapf_t*
+mapf_open(const char* path) {
+    /* open the file and get the size of it. */
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "lzd, mapf_open; could not open file %s.\n", path);
+        return 0x0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        fprintf(stderr, "lzd, mapf_open; could not stat file %s (or it is empty).\n", path);
+        close(fd);
+        return 0x0;
+    }
+
+    /* map the whole file, the descriptor is not needed after this. */
+    void* data = mmap(0x0, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "lzd, mapf_open; mmap failed; could not map file %s.\n", path);
+        return 0x0;
+    }
+
+    /* allocate the mapping structure. */
+    mapf_t* map = calloc(1u, sizeof *map);
+    if (!map) {
+        fprintf(stderr, "lzd, mapf_open; calloc failed; could not allocate memory for map.\n");
+        munmap(data, (size_t) st.st_size);
+        return 0x0;
+    }
+    map->data = data;
+    map->size = (size_t) st.st_size;
+    return map;
+}
+
+/**
+ * @brief unmap and free a file mapping.
+ *
+ * @param map the mapping to be closed.
+ */
+void
+mapf_close(mapf_t* map) {
+    if (!map) return;
+    if (map->data) munmap(map->data, map->size);
+    free(map);
+}
+
+/**
+ * @brief borrow a bounds-checked slice of a mapping.
+ *
+ * @param map the mapping to borrow from.
+ * @param offset the offset into the file.
+ * @param length the length of the slice.
+ * @return a pointer into the mapping if [offset, offset + length) is in bounds, 0x0 o.w.
+ */
+const uint8_t*
+mapf_slice(const mapf_t* map, uint64_t offset, uint64_t length) {
+    if (!map || !map->data) return 0x0;
+    if (offset > map->size || length > map->size - offset) return 0x0;
+    return map->data + offset;
+}
@@ -0,0 +1,50 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-02
+ */
+#ifndef LZD_MAPF_H
+#define LZD_MAPF_H
+
+/*! @uses uint8_t, uint64_t. */
+#include <stdint.h>
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/**
+ * a read-only memory mapping of an entire file on disk, every consumer borrows slices of this
+ *  mapping instead of reading (and copying) the file again.
+ */
+typedef struct {
+    uint8_t* data; /* base of the mapping (read-only). */
+    size_t size; /* size of the mapping in bytes. */
+} mapf_t;
+
+/**
+ * @brief map an entire file into memory (read-only).
+ *
+ * @param path the path to the file to be mapped.
+ * @return a pointer to an allocated mapping if successful, 0x0 o.w.
+ */
+mapf_t*
+mapf_open(const char* path);
+
+/**
+ * @brief unmap and free a file mapping.
+ *
+ * @param map the mapping to be closed.
+ */
+void
+mapf_close(mapf_t* map);
+
+/**
+ * @brief borrow a bounds-checked slice of a mapping.
+ *
+ * @param map the mapping to borrow from.
+ * @param offset the offset into the file.
+ * @param length the length of the slice.
+ * @return a pointer into the mapping if [offset, offset + length) is in bounds, 0x0 o.w.
+ */
+const uint8_t*
+mapf_slice(const mapf_t* map, uint64_t offset, uint64_t length);
+#endif /* LZD_MAPF_H */
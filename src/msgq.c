@@ -0,0 +1,65 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-08
+ */
+#include "msgq.h"
+
+/**
+ * @brief initialize an empty message queue.
+ *
+ * @param queue the queue.
+ */
+void
+msgq_init(msgq_t* queue) {
+    atomic_init(&queue->stub.next, 0x0);
+    queue->stub.kind = 0u;
+    atomic_init(&queue->head, &queue->stub);
+    queue->tail = &queue->stub;
+}
+
+/**
+ * @brief push a message onto a queue, from any thread.
+ *
+ * @param queue the queue.
+ * @param node the link of the message (ownership is handed to the consumer).
+ */
+void
+msgq_push(msgq_t* queue, msgq_node_t* node) {
+    atomic_store_explicit(&node->next, 0x0, memory_order_relaxed);
+
+    /* the release on the link publishes the message to the consumer. */
+    msgq_node_t* prev = atomic_exchange_explicit(&queue->head, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+/**
+ * @brief pop the oldest message off of a queue, from the consumer thread only.
+ *
+ * @param queue the queue.
+ * @return the link of the message if there is one, 0x0 o.w.
+ */
+msgq_node_t*
+msgq_pop(msgq_t* queue) {
+    msgq_node_t* tail = queue->tail;
+    msgq_node_t* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    /* step over the stub, it is never handed out. */
+    if (tail == &queue->stub) {
+        if (!next) return 0x0;
+        queue->tail = tail = next;
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    }
+    if (next) {
+        queue->tail = next;
+        return tail;
+    }
+
+    /* tail is the last node linked in; unless a push is halfway, put the stub back behind it
+     *  so tail can be handed out without leaving the queue empty of nodes. */
+    if (tail != atomic_load_explicit(&queue->head, memory_order_acquire)) return 0x0;
+    msgq_push(queue, &queue->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (!next) return 0x0;
+    queue->tail = next;
+    return tail;
+}
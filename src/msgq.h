@@ -0,0 +1,57 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-08
+ */
+#ifndef LZD_MSGQ_H
+#define LZD_MSGQ_H
+
+/*! @uses uint32_t. */
+#include <stdint.h>
+
+/*! @uses _Atomic. */
+#include <stdatomic.h>
+
+/* a link in a message queue, the first member of every message that goes through one. */
+typedef struct msgq_node {
+    _Atomic(struct msgq_node*) next; /* the message pushed after this one. */
+    uint32_t kind; /* what the message is, up to the owner of the queue. */
+} msgq_node_t;
+
+/**
+ * an intrusive multi-producer single-consumer queue (vyukov's); a push is one exchange on the
+ *  head and a store to the link of the node before it, so producers never wait on each other
+ *  or on the consumer. a pop is wait-free too, but sees nothing past a push that has exchanged
+ *  the head and not linked the node in yet; the consumer tries again on its next round.
+ */
+typedef struct {
+    _Alignas(64) _Atomic(msgq_node_t*) head; /* the last node pushed, contended by producers. */
+    _Alignas(64) msgq_node_t* tail; /* the next node to pop, only touched by the consumer. */
+    msgq_node_t stub; /* keeps the queue from ever being empty of nodes. */
+} msgq_t;
+
+/**
+ * @brief initialize an empty message queue.
+ *
+ * @param queue the queue.
+ */
+void
+msgq_init(msgq_t* queue);
+
+/**
+ * @brief push a message onto a queue, from any thread.
+ *
+ * @param queue the queue.
+ * @param node the link of the message (ownership is handed to the consumer).
+ */
+void
+msgq_push(msgq_t* queue, msgq_node_t* node);
+
+/**
+ * @brief pop the oldest message off of a queue, from the consumer thread only.
+ *
+ * @param queue the queue.
+ * @return the link of the message if there is one, 0x0 o.w.
+ */
+msgq_node_t*
+msgq_pop(msgq_t* queue);
+#endif /* LZD_MSGQ_H */
@@ -0,0 +1,432 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-04
+ */
+#include "simd.h"
+
+/*! @uses memcpy, memcmp. */
+#include <string.h>
+
+/*! @uses internal. */
+#include "dyna.h"
+
+#if defined(__x86_64__)
+/*! @uses __m128i, __m256i, _mm_*, _mm256_*. */
+#include <immintrin.h>
+#elif defined(__aarch64__)
+/*! @uses uint8x16_t, vld1q_u8, vceqq_u8, vaddv_u8. */
+#include <arm_neon.h>
+#endif
+
+/* classify exactly 64 readable bytes against a set, or into character classes. */
+typedef uint64_t (*mask_fn_t)(const uint8_t* data, const simd_set_t* set);
+typedef void (*class_fn_t)(const uint8_t* data, simd_class_t* out);
+
+#if defined(__x86_64__)
+/**
+ * @brief classify 16 bytes against a set with SSE2.
+ *
+ * @param data the 16 bytes to classify.
+ * @param set the set of byte values.
+ * @return a mask with bit i set iff data[i] is in the set.
+ */
+internal uint64_t
+mask_sse2_16(const uint8_t* data, const simd_set_t* set) {
+    __m128i v = _mm_loadu_si128((const __m128i*) data);
+    __m128i hit = _mm_setzero_si128();
+    for (size_t j = 0; j < set->count; j++)
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8((char) set->bytes[j])));
+    return (uint64_t) (uint32_t) _mm_movemask_epi8(hit);
+}
+
+/**
+ * @brief classify 64 bytes against a set with SSE2 (always there on x86_64).
+ *
+ * @param data the 64 bytes to classify.
+ * @param set the set of byte values.
+ * @return a mask with bit i set iff data[i] is in the set.
+ */
+internal uint64_t
+mask_sse2(const uint8_t* data, const simd_set_t* set) {
+    return mask_sse2_16(data, set) | mask_sse2_16(data + 16, set) << 16 \
+        | mask_sse2_16(data + 32, set) << 32 | mask_sse2_16(data + 48, set) << 48;
+}
+
+/**
+ * @brief sort 64 bytes into character classes with SSE2.
+ *
+ * @param data the 64 bytes to classify.
+ * @param out the classes to be filled.
+ */
+internal void
+class_sse2(const uint8_t* data, simd_class_t* out) {
+    *out = (simd_class_t){ 0 };
+    for (size_t i = 0; i < 64u; i += 16u) {
+        /* unsigned range checks, x is in [lo, lo + n] iff min(x - lo, n) == x - lo. */
+        __m128i v = _mm_loadu_si128((const __m128i*) (data + i));
+        __m128i p = _mm_sub_epi8(v, _mm_set1_epi8(0x20));
+        __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+        __m128i l = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        __m128i print = _mm_cmpeq_epi8(_mm_min_epu8(p, _mm_set1_epi8(0x5e)), p);
+        __m128i alnum = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d), \
+            _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(25)), l));
+        out->print |= (uint64_t) (uint32_t) _mm_movemask_epi8(print) << i;
+        out->alnum |= (uint64_t) (uint32_t) _mm_movemask_epi8(alnum) << i;
+        out->space |= (uint64_t) (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(0x20))) << i;
+        out->high |= (uint64_t) (uint32_t) _mm_movemask_epi8(v) << i;
+        out->zero |= (uint64_t) (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) << i;
+    }
+}
+
+/**
+ * @brief classify 32 bytes against a set with AVX2.
+ *
+ * @param data the 32 bytes to classify.
+ * @param set the set of byte values.
+ * @return a mask with bit i set iff data[i] is in the set.
+ */
+__attribute__((target("avx2"))) internal uint64_t
+mask_avx2_32(const uint8_t* data, const simd_set_t* set) {
+    __m256i v = _mm256_loadu_si256((const __m256i*) data);
+    __m256i hit = _mm256_setzero_si256();
+    for (size_t j = 0; j < set->count; j++)
+        hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, _mm256_set1_epi8((char) set->bytes[j])));
+    return (uint64_t) (uint32_t) _mm256_movemask_epi8(hit);
+}
+
+/**
+ * @brief classify 64 bytes against a set with AVX2.
+ *
+ * @param data the 64 bytes to classify.
+ * @param set the set of byte values.
+ * @return a mask with bit i set iff data[i] is in the set.
+ */
+__attribute__((target("avx2"))) internal uint64_t
+mask_avx2(const uint8_t* data, const simd_set_t* set) {
+    return mask_avx2_32(data, set) | mask_avx2_32(data + 32, set) << 32;
+}
+
+/**
+ * @brief sort 64 bytes into character classes with AVX2.
+ *
+ * @param data the 64 bytes to classify.
+ * @param out the classes to be filled.
+ */
+__attribute__((target("avx2"))) internal void
+class_avx2(const uint8_t* data, simd_class_t* out) {
+    *out = (simd_class_t){ 0 };
+    for (size_t i = 0; i < 64u; i += 32u) {
+        __m256i v = _mm256_loadu_si256((const __m256i*) (data + i));
+        __m256i p = _mm256_sub_epi8(v, _mm256_set1_epi8(0x20));
+        __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+        __m256i l = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i print = _mm256_cmpeq_epi8(_mm256_min_epu8(p, _mm256_set1_epi8(0x5e)), p);
+        __m256i alnum = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d), \
+            _mm256_cmpeq_epi8(_mm256_min_epu8(l, _mm256_set1_epi8(25)), l));
+        out->print |= (uint64_t) (uint32_t) _mm256_movemask_epi8(print) << i;
+        out->alnum |= (uint64_t) (uint32_t) _mm256_movemask_epi8(alnum) << i;
+        out->space |= (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, \
+            _mm256_set1_epi8(0x20))) << i;
+        out->high |= (uint64_t) (uint32_t) _mm256_movemask_epi8(v) << i;
+        out->zero |= (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, \
+            _mm256_setzero_si256())) << i;
+    }
+}
+#elif defined(__aarch64__)
+/**
+ * @brief gather the top bit of every lane into a mask (neon has no movemask).
+ *
+ * @param v the lanes, each either 0x00 or 0xff.
+ * @return a mask with bit i set iff lane i is set.
+ */
+internal uint64_t
+movemask_neon(uint8x16_t v) {
+    /* weight each lane by its bit and sum the halves. */
+    static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t bits = vandq_u8(v, vld1q_u8(weights));
+    return (uint64_t) vaddv_u8(vget_low_u8(bits)) | (uint64_t) vaddv_u8(vget_high_u8(bits)) << 8;
+}
+
+/**
+ * @brief classify 16 bytes against a set with NEON.
+ *
+ * @param data the 16 bytes to classify.
+ * @param set the set of byte values.
+ * @return a mask with bit i set iff data[i] is in the set.
+ */
+internal uint64_t
+mask_neon_16(const uint8_t* data, const simd_set_t* set) {
+    uint8x16_t v = vld1q_u8(data);
+    uint8x16_t hit = vdupq_n_u8(0);
+    for (size_t j = 0; j < set->count; j++)
+        hit = vorrq_u8(hit, vceqq_u8(v, vdupq_n_u8(set->bytes[j])));
+    return movemask_neon(hit);
+}
+
+/**
+ * @brief classify 64 bytes against a set with NEON.
+ *
+ * @param data the 64 bytes to classify.
+ * @param set the set of byte values.
+ * @return a mask with bit i set iff data[i] is in the set.
+ */
+internal uint64_t
+mask_neon(const uint8_t* data, const simd_set_t* set) {
+    return mask_neon_16(data, set) | mask_neon_16(data + 16, set) << 16 \
+        | mask_neon_16(data + 32, set) << 32 | mask_neon_16(data + 48, set) << 48;
+}
+
+/**
+ * @brief sort 64 bytes into character classes with NEON.
+ *
+ * @param data the 64 bytes to classify.
+ * @param out the classes to be filled.
+ */
+internal void
+class_neon(const uint8_t* data, simd_class_t* out) {
+    *out = (simd_class_t){ 0 };
+    for (size_t i = 0; i < 64u; i += 16u) {
+        uint8x16_t v = vld1q_u8(data + i);
+        uint8x16_t print = vcleq_u8(vsubq_u8(v, vdupq_n_u8(0x20)), vdupq_n_u8(0x5e));
+        uint8x16_t alnum = vorrq_u8(vcleq_u8(vsubq_u8(v, vdupq_n_u8('0')), vdupq_n_u8(9)), \
+            vcleq_u8(vsubq_u8(vorrq_u8(v, vdupq_n_u8(0x20)), vdupq_n_u8('a')), vdupq_n_u8(25)));
+        out->print |= movemask_neon(print) << i;
+        out->alnum |= movemask_neon(alnum) << i;
+        out->space |= movemask_neon(vceqq_u8(v, vdupq_n_u8(0x20))) << i;
+        out->high |= movemask_neon(vcgeq_u8(v, vdupq_n_u8(0x80))) << i;
+        out->zero |= movemask_neon(vceqq_u8(v, vdupq_n_u8(0))) << i;
+    }
+}
+#else
+/**
+ * @brief classify 64 bytes against a set, one byte at a time.
+ *
+ * @param data the 64 bytes to classify.
+ * @param set the set of byte values.
+ * @return a mask with bit i set iff data[i] is in the set.
+ */
+internal uint64_t
+mask_scalar(const uint8_t* data, const simd_set_t* set) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < 64u; i++) {
+        for (size_t j = 0; j < set->count; j++) {
+            if (data[i] == set->bytes[j]) {
+                mask |= 1ull << i;
+                break;
+            }
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief sort 64 bytes into character classes, one byte at a time.
+ *
+ * @param data the 64 bytes to classify.
+ * @param out the classes to be filled.
+ */
+internal void
+class_scalar(const uint8_t* data, simd_class_t* out) {
+    *out = (simd_class_t){ 0 };
+    for (size_t i = 0; i < 64u; i++) {
+        uint8_t c = data[i], l = c | 0x20;
+        uint64_t bit = 1ull << i;
+        if (c >= 0x20 && c <= 0x7e) out->print |= bit;
+        if ((c >= '0' && c <= '9') || (l >= 'a' && l <= 'z')) out->alnum |= bit;
+        if (c == 0x20) out->space |= bit;
+        if (c >= 0x80) out->high |= bit;
+        if (c == 0x00) out->zero |= bit;
+    }
+}
+#endif
+
+/**
+ * @brief pick the widest classifier this cpu supports.
+ *
+ * @return the classifier.
+ */
+internal mask_fn_t
+mask_pick(void) {
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2")) return mask_avx2;
+    return mask_sse2;
+#elif defined(__aarch64__)
+    return mask_neon;
+#else
+    return mask_scalar;
+#endif
+}
+
+/**
+ * @brief pick the widest character classifier this cpu supports.
+ *
+ * @return the classifier.
+ */
+internal class_fn_t
+class_pick(void) {
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2")) return class_avx2;
+    return class_sse2;
+#elif defined(__aarch64__)
+    return class_neon;
+#else
+    return class_scalar;
+#endif
+}
+
+/**
+ * @brief classify up to 64 bytes against a set, never reading past length.
+ *
+ * @param fn the classifier.
+ * @param data the bytes to classify.
+ * @param length the number of bytes.
+ * @param set the set of byte values.
+ * @return a mask with bit i set iff data[i] is in the set, bits at or past length are clear.
+ */
+internal uint64_t
+mask_any(mask_fn_t fn, const uint8_t* data, size_t length, const simd_set_t* set) {
+    if (length >= 64u) return fn(data, set);
+    if (length == 0) return 0;
+
+    /* copy the tail into a full block, the filler is cleared after classifying. */
+    uint8_t block[64] = { 0 };
+    memcpy(block, data, length);
+    return fn(block, set) & ((1ull << length) - 1u);
+}
+
+/**
+ * @brief classify up to 64 bytes against a set.
+ *
+ * @param data the bytes to classify.
+ * @param length the number of bytes (anything past 64 is ignored).
+ * @param set the set of byte values.
+ * @return a mask with bit i set iff data[i] is in the set, bits at or past length are clear.
+ */
+uint64_t
+simd_mask64(const uint8_t* data, size_t length, const simd_set_t* set) {
+    if (!data || !set) return 0;
+    return mask_any(mask_pick(), data, length, set);
+}
+
+/**
+ * @brief find the first byte at or after an index that is not in a set.
+ *
+ * @param data the bytes to scan.
+ * @param size the number of bytes.
+ * @param from the index to start at.
+ * @param set the set of byte values.
+ * @return the index of the first byte not in the set, size if there is none.
+ */
+size_t
+simd_skip(const uint8_t* data, size_t size, size_t from, const simd_set_t* set) {
+    if (!data || !set) return size;
+    mask_fn_t fn = mask_pick();
+    for (size_t i = from; i < size; i += 64u) {
+        size_t length = size - i < 64u ? size - i : 64u;
+        uint64_t other = ~mask_any(fn, data + i, length, set);
+        if (length < 64u) other &= (1ull << length) - 1u;
+        if (other) return i + (size_t) __builtin_ctzll(other);
+    }
+    return size;
+}
+
+/**
+ * @brief find the first run of bytes in a set, of at least a given length, starting at or after
+ *  an index; the run has to fit entirely before size.
+ *
+ * @param data the bytes to scan.
+ * @param size the number of bytes.
+ * @param from the index to start at.
+ * @param set the set of byte values.
+ * @param run the minimum length of a run (1 to 64).
+ * @return the index the first such run starts at, size if there is none.
+ */
+size_t
+simd_find_run(const uint8_t* data, size_t size, size_t from, const simd_set_t* set, size_t run) {
+    if (!data || !set || run == 0 || run > 64u || from >= size) return size;
+    mask_fn_t fn = mask_pick();
+
+    /**
+     * slide a 128-bit window (lo, hi) over the masks 64 bytes at a time; after and-ing the
+     *  window with itself shifted by doubling amounts, bit p is set iff bits p..p+run-1 were,
+     *  so any bit left in lo starts a run. bits past size are clear, so runs can't overhang.
+     */
+    uint64_t lo = mask_any(fn, data + from, size - from, set);
+    for (size_t i = from; i < size; i += 64u) {
+        uint64_t hi = i + 64u < size ? mask_any(fn, data + i + 64u, size - i - 64u, set) : 0;
+        uint64_t rlo = lo, rhi = hi;
+        for (size_t k = 1; k < run;) {
+            size_t s = k < run - k ? k : run - k;
+            rlo &= rlo >> s | rhi << (64u - s);
+            rhi &= rhi >> s;
+            k += s;
+        }
+        if (rlo) return i + (size_t) __builtin_ctzll(rlo);
+        lo = hi;
+    }
+    return size;
+}
+
+/**
+ * @brief find the first occurrence of a byte pattern starting at or after an index; candidates
+ *  are the positions where both the first and the last byte of the pattern match, 64 at a time,
+ *  and only those are compared in full.
+ *
+ * @param data the bytes to search.
+ * @param size the number of bytes.
+ * @param from the index to start at.
+ * @param needle the pattern.
+ * @param length the length of the pattern.
+ * @return the index the first occurrence starts at, size if there is none.
+ */
+size_t
+simd_memmem(const uint8_t* data, size_t size, size_t from, const uint8_t* needle, size_t length) {
+    if (!data || !needle || length == 0u || from >= size || size - from < length) return size;
+    mask_fn_t fn = mask_pick();
+    simd_set_t first = { { needle[0] }, 1u }, last = { { needle[length - 1u] }, 1u };
+
+    /* a pattern can only start where it still fits. */
+    size_t end = size - length + 1u;
+    for (size_t i = from; i < end; i += 64u) {
+        size_t n = end - i < 64u ? end - i : 64u;
+        uint64_t candidates = mask_any(fn, data + i, n, &first) & \
+            mask_any(fn, data + i + length - 1u, n, &last);
+        while (candidates) {
+            size_t at = i + (size_t) __builtin_ctzll(candidates);
+            if (length <= 2u || !memcmp(data + at + 1u, needle + 1u, length - 2u)) return at;
+            candidates &= candidates - 1u;
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief sort up to 64 bytes into character classes, all of them in a single pass.
+ *
+ * @param data the bytes to classify.
+ * @param length the number of bytes (anything past 64 is ignored).
+ * @param out the classes to be filled, bits at or past length are clear.
+ */
+void
+simd_classify(const uint8_t* data, size_t length, simd_class_t* out) {
+    if (!out) return;
+    if (!data || length == 0) {
+        *out = (simd_class_t){ 0 };
+        return;
+    }
+    if (length >= 64u) {
+        class_pick()(data, out);
+        return;
+    }
+
+    /* same as mask_any, classify a copy of the tail and clear the filler. */
+    uint8_t block[64] = { 0 };
+    memcpy(block, data, length);
+    class_pick()(block, out);
+    uint64_t valid = (1ull << length) - 1u;
+    out->print &= valid;
+    out->alnum &= valid;
+    out->space &= valid;
+    out->high &= valid;
+    out->zero &= valid;
+}
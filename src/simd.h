@@ -0,0 +1,93 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-04
+ */
+#ifndef LZD_SIMD_H
+#define LZD_SIMD_H
+
+/*! @uses uint8_t, uint64_t. */
+#include <stdint.h>
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/**
+ * a small set of byte values (at most 4) to classify bytes against, a whole vector at a time;
+ *  AVX2 or SSE2 on x86_64 (picked at runtime), NEON on aarch64, a lookup table o.w.
+ */
+typedef struct {
+    uint8_t bytes[4]; /* the values in the set. */
+    size_t count; /* number of values in the set (1 to 4). */
+} simd_set_t;
+
+/* character classes of up to 64 bytes, bit i of each mask is about byte i. */
+typedef struct {
+    uint64_t print; /* printable ascii (0x20 to 0x7e). */
+    uint64_t alnum; /* ascii letters and digits. */
+    uint64_t space; /* ascii space (0x20). */
+    uint64_t high; /* bytes with the high bit set (0x80 to 0xff). */
+    uint64_t zero; /* nul bytes. */
+} simd_class_t;
+
+/**
+ * @brief classify up to 64 bytes against a set.
+ *
+ * @param data the bytes to classify.
+ * @param length the number of bytes (anything past 64 is ignored).
+ * @param set the set of byte values.
+ * @return a mask with bit i set iff data[i] is in the set, bits at or past length are clear.
+ */
+uint64_t
+simd_mask64(const uint8_t* data, size_t length, const simd_set_t* set);
+
+/**
+ * @brief find the first byte at or after an index that is not in a set.
+ *
+ * @param data the bytes to scan.
+ * @param size the number of bytes.
+ * @param from the index to start at.
+ * @param set the set of byte values.
+ * @return the index of the first byte not in the set, size if there is none.
+ */
+size_t
+simd_skip(const uint8_t* data, size_t size, size_t from, const simd_set_t* set);
+
+/**
+ * @brief find the first run of bytes in a set, of at least a given length, starting at or after
+ *  an index; the run has to fit entirely before size.
+ *
+ * @param data the bytes to scan.
+ * @param size the number of bytes.
+ * @param from the index to start at.
+ * @param set the set of byte values.
+ * @param run the minimum length of a run (1 to 64).
+ * @return the index the first such run starts at, size if there is none.
+ */
+size_t
+simd_find_run(const uint8_t* data, size_t size, size_t from, const simd_set_t* set, size_t run);
+
+/**
+ * @brief find the first occurrence of a byte pattern starting at or after an index; candidates
+ *  are the positions where both the first and the last byte of the pattern match, 64 at a time,
+ *  and only those are compared in full.
+ *
+ * @param data the bytes to search.
+ * @param size the number of bytes.
+ * @param from the index to start at.
+ * @param needle the pattern.
+ * @param length the length of the pattern.
+ * @return the index the first occurrence starts at, size if there is none.
+ */
+size_t
+simd_memmem(const uint8_t* data, size_t size, size_t from, const uint8_t* needle, size_t length);
+
+/**
+ * @brief sort up to 64 bytes into character classes, all of them in a single pass.
+ *
+ * @param data the bytes to classify.
+ * @param length the number of bytes (anything past 64 is ignored).
+ * @param out the classes to be filled, bits at or past length are clear.
+ */
+void
+simd_classify(const uint8_t* data, size_t length, simd_class_t* out);
+#endif /* LZD_SIMD_H */
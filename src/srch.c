@@ -0,0 +1,746 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-07
+ */
+#include "srch.h"
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses calloc, realloc, free, qsort. */
+#include <stdlib.h>
+
+/*! @uses strcmp, strlen, memcpy, memset. */
+#include <string.h>
+
+/*! @uses internal. */
+#include "dyna.h"
+
+/*! @uses simd_memmem. */
+#include "simd.h"
+
+/* initial number of mnemonic slots, x86 has about 1500 mnemonics in total. */
+#define SRCH_INITIAL_SLOTS 256u
+
+/* number of trigram buckets. */
+#define SRCH_BUCKETS (1u << SRCH_GRAM_BITS)
+
+/* longest text a pattern is matched against, longer strings are cut when formatted. */
+#define SRCH_TEXT_SIZE 512u
+
+/* get the text of an entry (a symbol name or a formatted string), and its address. */
+typedef const char* (*text_fn_t)(const void* source, size_t index, char* buffer, size_t size, \
+    uint64_t* address);
+
+/**
+ * @brief fold an ascii letter to lowercase, any other byte stays the same.
+ *
+ * @param c the byte.
+ * @return the folded byte.
+ */
+internal uint8_t
+fold(uint8_t c) {
+    return c >= 'A' && c <= 'Z' ? (uint8_t) (c + ('a' - 'A')) : c;
+}
+
+/**
+ * @brief hash a mnemonic (fnv-1a).
+ *
+ * @param mnemonic the mnemonic.
+ * @return the hash.
+ */
+internal uint64_t
+mnemonic_hash(const char* mnemonic) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const uint8_t* p = (const uint8_t*) mnemonic; *p; p++)
+        hash = (hash ^ *p) * 0x100000001b3ull;
+    return hash;
+}
+
+/**
+ * @brief get the trigram bucket of three (folded) bytes.
+ *
+ * @param a the first byte.
+ * @param b the second byte.
+ * @param c the third byte.
+ * @return the bucket.
+ */
+internal uint32_t
+gram_bucket(uint8_t a, uint8_t b, uint8_t c) {
+    uint32_t key = ((uint32_t) a << 16) | ((uint32_t) b << 8) | c;
+    return (key * 0x9e3779b1u) >> (32u - SRCH_GRAM_BITS);
+}
+
+/**
+ * @brief the text of a symbol, its name.
+ *
+ * @param source the symbols.
+ * @param index the index of the symbol.
+ * @param buffer unused.
+ * @param size unused.
+ * @param address output for the value of the symbol.
+ * @return the name of the symbol.
+ */
+internal const char*
+symbol_text(const void* source, size_t index, char* buffer, size_t size, uint64_t* address) {
+    (void) buffer;
+    (void) size;
+    const elf_symbol_t* symbol = &((const syms_t*) source)->symbols[index];
+    *address = symbol->value;
+    return symbol->name ? symbol->name : "";
+}
+
+/**
+ * @brief the text of a string, formatted the way the strings view shows it.
+ *
+ * @param source the strings.
+ * @param index the index of the string.
+ * @param buffer the buffer to format into.
+ * @param size the size of the buffer.
+ * @param address output for the address of the string (its file offset if it isn't loaded).
+ * @return the formatted string.
+ */
+internal const char*
+string_text(const void* source, size_t index, char* buffer, size_t size, uint64_t* address) {
+    const strs_t* strings = source;
+    const strs_entry_t* entry = &strings->entries[index];
+    *address = entry->vaddr ? entry->vaddr : entry->offset;
+    strs_format(strings, index, buffer, size);
+    return buffer;
+}
+
+/**
+ * @brief match a text against a folded pattern.
+ *
+ * @param text the text.
+ * @param n the length of the text.
+ * @param pattern the pattern, folded.
+ * @param m the length of the pattern.
+ * @return how well it matched, 0 if it did not.
+ */
+internal int
+match_text(const char* text, size_t n, const char* pattern, size_t m) {
+    for (size_t at = 0; at + m <= n; at++) {
+        size_t k = 0u;
+        while (k < m && fold((uint8_t) text[at + k]) == (uint8_t) pattern[k]) k++;
+        if (k == m) return at ? SRCH_MATCH_SUBSTRING : n == m ? SRCH_MATCH_EXACT : SRCH_MATCH_PREFIX;
+    }
+    return 0;
+}
+
+/**
+ * @brief free the rows of a trigram index.
+ *
+ * @param grams the trigram index.
+ */
+internal void
+grams_drop(srch_grams_t* grams) {
+    pthread_mutex_lock(&grams->lock);
+    free(grams->starts);
+    free(grams->postings);
+    grams->starts = grams->postings = 0x0;
+    grams->count = 0u;
+    grams->built = false;
+    pthread_mutex_unlock(&grams->lock);
+}
+
+/**
+ * @brief walk the trigrams of every text once, a stamp per bucket keeps a text from being
+ *  counted twice in one.
+ *
+ * @param source the set of texts.
+ * @param count the number of texts.
+ * @param text the text getter.
+ * @param stamps last text + 1 seen in every bucket (zeroed by the caller).
+ * @param tallies the number of texts in every bucket to add to, or the next posting of every
+ *  bucket if postings are filled.
+ * @param postings the postings to fill (or 0x0 to only count).
+ */
+internal void
+grams_pass(const void* source, size_t count, text_fn_t text, uint32_t* stamps, uint32_t* tallies, \
+    uint32_t* postings) {
+    char buffer[SRCH_TEXT_SIZE];
+    for (size_t i = 0; i < count; i++) {
+        uint64_t address = 0u;
+        const uint8_t* t = (const uint8_t*) text(source, i, buffer, sizeof buffer, &address);
+        size_t n = strlen((const char*) t);
+        for (size_t j = 0; j + 2u < n; j++) {
+            uint32_t b = gram_bucket(fold(t[j]), fold(t[j + 1u]), fold(t[j + 2u]));
+            if (stamps[b] == (uint32_t) i + 1u) continue;
+            stamps[b] = (uint32_t) i + 1u;
+            if (postings) postings[tallies[b]++] = (uint32_t) i;
+            else tallies[b]++;
+        }
+    }
+}
+
+/**
+ * @brief build a trigram index over a set of texts, in two passes; the first counts the texts
+ *  of every bucket and the second fills them in. the index is locked by the caller.
+ *
+ * @param grams the trigram index.
+ * @param source the set of texts.
+ * @param count the number of texts.
+ * @param text the text getter.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+grams_build(srch_grams_t* grams, const void* source, size_t count, text_fn_t text) {
+    if (count >= UINT32_MAX) return -1;
+    uint32_t* starts = calloc(SRCH_BUCKETS + 1u, sizeof *starts);
+    uint32_t* cursors = calloc(SRCH_BUCKETS, sizeof *cursors);
+    uint32_t* stamps = calloc(SRCH_BUCKETS, sizeof *stamps);
+    uint32_t* postings = 0x0;
+    if (starts && cursors && stamps) {
+        /* count, turn the counts into the first posting of every bucket, then fill. */
+        grams_pass(source, count, text, stamps, starts + 1, 0x0);
+        for (size_t b = 0; b < SRCH_BUCKETS; b++) starts[b + 1u] += starts[b];
+        memcpy(cursors, starts, SRCH_BUCKETS * sizeof *cursors);
+        memset(stamps, 0, SRCH_BUCKETS * sizeof *stamps);
+        postings = calloc(starts[SRCH_BUCKETS] ? starts[SRCH_BUCKETS] : 1u, sizeof *postings);
+        if (postings) grams_pass(source, count, text, stamps, cursors, postings);
+    }
+    free(cursors);
+    free(stamps);
+    if (!postings) {
+        fprintf(stderr, "lzd, grams_build; calloc failed; could not allocate memory for trigram index.\n");
+        free(starts);
+        return -1;
+    }
+    grams->starts = starts;
+    grams->postings = postings;
+    grams->count = count;
+    grams->built = true;
+    return 0;
+}
+
+/**
+ * @brief check a text against a pattern and add it as a hit if it matches.
+ *
+ * @param source the set of texts.
+ * @param index the index of the text.
+ * @param text the text getter.
+ * @param pattern the pattern, folded.
+ * @param m the length of the pattern.
+ * @param kind the kind of the hits.
+ * @param out the hits to append to.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+grams_check(const void* source, size_t index, text_fn_t text, const char* pattern, size_t m, \
+    srch_kind_t kind, srch_hits_t* out) {
+    char buffer[SRCH_TEXT_SIZE];
+    uint64_t address = 0u;
+    const char* t = text(source, index, buffer, sizeof buffer, &address);
+    size_t n = strlen(t);
+    int match = match_text(t, n, pattern, m);
+    if (!match) return 0;
+    return srch_hits_push(out, kind, (srch_match_t) match, address, (uint32_t) index, n);
+}
+
+/**
+ * @brief find every text that contains a pattern, through the trigram index (built first if it
+ *  isn't yet); a pattern shorter than a trigram is checked against every text.
+ *
+ * @param grams the trigram index.
+ * @param source the set of texts.
+ * @param count the number of texts.
+ * @param text the text getter.
+ * @param pattern the pattern.
+ * @param kind the kind of the hits.
+ * @param out the hits to append to.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+grams_find(srch_grams_t* grams, const void* source, size_t count, text_fn_t text, \
+    const char* pattern, srch_kind_t kind, srch_hits_t* out) {
+    char folded[256];
+    size_t m = 0u;
+    for (; pattern[m] && m < sizeof folded - 1u; m++) folded[m] = (char) fold((uint8_t) pattern[m]);
+    folded[m] = '\0';
+    if (m == 0u || count == 0u) return 0;
+    if (m < 3u) {
+        for (size_t i = 0; i < count; i++)
+            if (grams_check(source, i, text, folded, m, kind, out) != 0) return -1;
+        return 0;
+    }
+
+    /* the index stays locked while it is read, so it can't be dropped underneath. */
+    pthread_mutex_lock(&grams->lock);
+    if (!grams->built && grams_build(grams, source, count, text) != 0) {
+        pthread_mutex_unlock(&grams->lock);
+        return -1;
+    }
+
+    /* every candidate has to be in the two rarest buckets of the pattern's trigrams. */
+    uint32_t rare[2] = { UINT32_MAX, UINT32_MAX };
+    for (size_t j = 0; j + 2u < m; j++) {
+        const uint8_t* p = (const uint8_t*) folded + j;
+        uint32_t bucket = gram_bucket(p[0], p[1], p[2]);
+        uint32_t size = grams->starts[bucket + 1u] - grams->starts[bucket];
+        if (bucket == rare[0] || bucket == rare[1]) continue;
+        if (rare[0] == UINT32_MAX || size < grams->starts[rare[0] + 1u] - grams->starts[rare[0]]) {
+            rare[1] = rare[0];
+            rare[0] = bucket;
+        } else if (rare[1] == UINT32_MAX || size < grams->starts[rare[1] + 1u] - grams->starts[rare[1]])
+            rare[1] = bucket;
+    }
+    const uint32_t* a = grams->postings + grams->starts[rare[0]];
+    const uint32_t* a_end = grams->postings + grams->starts[rare[0] + 1u];
+    const uint32_t* b = rare[1] == UINT32_MAX ? 0x0 : grams->postings + grams->starts[rare[1]];
+    const uint32_t* b_end = rare[1] == UINT32_MAX ? 0x0 : grams->postings + grams->starts[rare[1] + 1u];
+    ssize_t result = 0;
+    for (; a < a_end && result == 0; a++) {
+        if (b) {
+            while (b < b_end && *b < *a) b++;
+            if (b == b_end) break;
+            if (*b != *a) continue;
+        }
+        result = grams_check(source, *a, text, folded, m, kind, out);
+    }
+    pthread_mutex_unlock(&grams->lock);
+    return result;
+}
+
+/**
+ * @brief create empty search indices.
+ *
+ * @return allocated search indices if successful, 0x0 o.w.
+ */
+srch_t*
+srch_create() {
+    srch_t* search = calloc(1u, sizeof *search);
+    srch_posting_t* postings = calloc(SRCH_INITIAL_SLOTS, sizeof *postings);
+    if (!search || !postings) {
+        fprintf(stderr, "lzd, srch_create; calloc failed; could not allocate memory for search indices.\n");
+        free(search);
+        free(postings);
+        return 0x0;
+    }
+    search->postings = postings;
+    search->mask = SRCH_INITIAL_SLOTS - 1u;
+    pthread_mutex_init(&search->lock, 0x0);
+    pthread_mutex_init(&search->symbols.lock, 0x0);
+    pthread_mutex_init(&search->strings.lock, 0x0);
+    return search;
+}
+
+/**
+ * @brief free search indices.
+ *
+ * @param search the search indices to be freed.
+ */
+void
+srch_free(srch_t* search) {
+    if (!search) return;
+    srch_clear(search);
+    srch_drop_texts(search);
+    free(search->postings);
+    pthread_mutex_destroy(&search->lock);
+    pthread_mutex_destroy(&search->symbols.lock);
+    pthread_mutex_destroy(&search->strings.lock);
+    free(search);
+}
+
+/**
+ * @brief drop every mnemonic posting (the instructions are gone).
+ *
+ * @param search the search indices.
+ */
+void
+srch_clear(srch_t* search) {
+    if (!search) return;
+    pthread_mutex_lock(&search->lock);
+    for (size_t i = 0; i <= search->mask; i++) {
+        free(search->postings[i].mnemonic);
+        free(search->postings[i].addresses);
+    }
+    memset(search->postings, 0, (search->mask + 1u) * sizeof *search->postings);
+    search->used = 0u;
+    pthread_mutex_unlock(&search->lock);
+}
+
+/**
+ * @brief drop the trigram indices, they are rebuilt by the next search (the strings or the
+ *  symbols changed).
+ *
+ * @param search the search indices.
+ */
+void
+srch_drop_texts(srch_t* search) {
+    if (!search) return;
+    grams_drop(&search->symbols);
+    grams_drop(&search->strings);
+}
+
+/**
+ * @brief find the slot of a mnemonic, the search indices are locked by the caller.
+ *
+ * @param search the search indices.
+ * @param mnemonic the mnemonic.
+ * @return the slot of the mnemonic if there is one, otherwise the empty slot it would go in.
+ */
+internal srch_posting_t*
+posting_slot(srch_t* search, const char* mnemonic) {
+    for (size_t i = mnemonic_hash(mnemonic) & search->mask;; i = (i + 1u) & search->mask) {
+        srch_posting_t* slot = &search->postings[i];
+        if (!slot->mnemonic || !strcmp(slot->mnemonic, mnemonic)) return slot;
+    }
+}
+
+/**
+ * @brief double the number of mnemonic slots, the search indices are locked by the caller.
+ *
+ * @param search the search indices.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+postings_grow(srch_t* search) {
+    size_t slots = (search->mask + 1u) * 2u;
+    srch_posting_t* old = search->postings;
+    size_t old_slots = search->mask + 1u;
+    srch_posting_t* postings = calloc(slots, sizeof *postings);
+    if (!postings) {
+        fprintf(stderr, "lzd, postings_grow; calloc failed; could not allocate memory for postings.\n");
+        return -1;
+    }
+    search->postings = postings;
+    search->mask = slots - 1u;
+    for (size_t i = 0; i < old_slots; i++)
+        if (old[i].mnemonic) *posting_slot(search, old[i].mnemonic) = old[i];
+    free(old);
+    return 0;
+}
+
+/**
+ * @brief add the instructions of a decoded chunk to the mnemonic postings.
+ *
+ * @param search the search indices.
+ * @param chunk the chunk.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+srch_add_insns(srch_t* search, const insn_chunk_t* chunk) {
+    if (!search || !chunk) return -1;
+    if (chunk->state != INSN_CHUNK_DECODED || chunk->count == 0u || chunk->mnem_count == 0u) return 0;
+
+    /* group the addresses by mnemonic before the lock, a counting sort keeps every group in
+     *  address order. */
+    size_t* firsts = calloc(chunk->mnem_count + 1u, sizeof *firsts);
+    size_t* cursors = calloc(chunk->mnem_count, sizeof *cursors);
+    uint64_t* grouped = calloc(chunk->count, sizeof *grouped);
+    if (!firsts || !cursors || !grouped) {
+        fprintf(stderr, "lzd, srch_add_insns; calloc failed; could not allocate memory for postings.\n");
+        free(firsts);
+        free(cursors);
+        free(grouped);
+        return -1;
+    }
+    for (size_t i = 0; i < chunk->count; i++) firsts[chunk->mnemonics[i] + 1u]++;
+    for (size_t k = 0; k < chunk->mnem_count; k++) {
+        firsts[k + 1u] += firsts[k];
+        cursors[k] = firsts[k];
+    }
+    for (size_t i = 0; i < chunk->count; i++)
+        grouped[cursors[chunk->mnemonics[i]]++] = chunk->base + chunk->offsets[i];
+
+    /* append every group to the posting of its mnemonic. */
+    ssize_t result = 0;
+    pthread_mutex_lock(&search->lock);
+    for (size_t k = 0; k < chunk->mnem_count && result == 0; k++) {
+        size_t n = firsts[k + 1u] - firsts[k];
+        if (n == 0u) continue;
+        const char* mnemonic = chunk->mnem_pool + chunk->mnem_offs[k];
+        if ((search->used + 1u) * 2u > search->mask + 1u && postings_grow(search) != 0) {
+            result = -1;
+            break;
+        }
+        srch_posting_t* posting = posting_slot(search, mnemonic);
+        if (!posting->mnemonic) {
+            size_t length = strlen(mnemonic);
+            posting->mnemonic = calloc(length + 1u, 1u);
+            if (!posting->mnemonic) {
+                result = -1;
+                break;
+            }
+            memcpy(posting->mnemonic, mnemonic, length);
+            search->used++;
+        }
+        if (posting->count + n > posting->capacity) {
+            size_t capacity = posting->capacity ? posting->capacity : 64u;
+            while (capacity < posting->count + n) capacity *= 2u;
+            uint64_t* addresses = realloc(posting->addresses, capacity * sizeof *addresses);
+            if (!addresses) {
+                result = -1;
+                break;
+            }
+            posting->addresses = addresses;
+            posting->capacity = capacity;
+        }
+        memcpy(posting->addresses + posting->count, grouped + firsts[k], n * sizeof *grouped);
+        posting->count += n;
+    }
+    pthread_mutex_unlock(&search->lock);
+    if (result != 0)
+        fprintf(stderr, "lzd, srch_add_insns; allocation failed; could not grow postings.\n");
+    free(firsts);
+    free(cursors);
+    free(grouped);
+    return result;
+}
+
+/**
+ * @brief compare two addresses for qsort.
+ *
+ * @param a the first address.
+ * @param b the second address.
+ * @return the ordering of a and b.
+ */
+internal int
+address_compare(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/**
+ * @brief get the address of every decoded instruction with a mnemonic.
+ *
+ * @param search the search indices.
+ * @param mnemonic the mnemonic (lowercase, as capstone prints it).
+ * @param out output for the addresses (allocated, freed by the caller), ascending and without
+ *  repeats.
+ * @return -1 if a failure occurs, the number of addresses o.w.
+ */
+ssize_t
+srch_find_mnemonic(srch_t* search, const char* mnemonic, uint64_t** out) {
+    if (out) *out = 0x0;
+    if (!search || !mnemonic || !out) return -1;
+    pthread_mutex_lock(&search->lock);
+    const srch_posting_t* posting = posting_slot(search, mnemonic);
+    size_t count = posting->mnemonic ? posting->count : 0u;
+    uint64_t* addresses = calloc(count ? count : 1u, sizeof *addresses);
+    if (!addresses) {
+        pthread_mutex_unlock(&search->lock);
+        fprintf(stderr, "lzd, srch_find_mnemonic; calloc failed; could not allocate memory for addresses.\n");
+        return -1;
+    }
+    if (count) memcpy(addresses, posting->addresses, count * sizeof *addresses);
+    pthread_mutex_unlock(&search->lock);
+
+    /* chunks arrive in any order, and one that was decoded twice adds its addresses twice. */
+    qsort(addresses, count, sizeof *addresses, address_compare);
+    size_t unique = 0u;
+    for (size_t i = 0; i < count; i++)
+        if (!unique || addresses[unique - 1u] != addresses[i]) addresses[unique++] = addresses[i];
+    *out = addresses;
+    return (ssize_t) unique;
+}
+
+/**
+ * @brief compare two hits by address (then by index) for qsort.
+ *
+ * @param a the first hit.
+ * @param b the second hit.
+ * @return the ordering of a and b.
+ */
+internal int
+hit_address_compare(const void* a, const void* b) {
+    const srch_hit_t* x = a;
+    const srch_hit_t* y = b;
+    if (x->address != y->address) return x->address < y->address ? -1 : 1;
+    return x->index < y->index ? -1 : x->index > y->index ? 1 : 0;
+}
+
+/**
+ * @brief compare two hits by rank for qsort.
+ *
+ * @param a the first hit.
+ * @param b the second hit.
+ * @return the ordering of a and b.
+ */
+internal int
+hit_rank_compare(const void* a, const void* b) {
+    const srch_hit_t* x = a;
+    const srch_hit_t* y = b;
+    if (x->score != y->score) return x->score > y->score ? -1 : 1;
+    if (x->length != y->length) return x->length < y->length ? -1 : 1;
+    return hit_address_compare(a, b);
+}
+
+/**
+ * @brief move a hit down a heap of hits (the worst ranked one first) until it is in place.
+ *
+ * @param hits the heap.
+ * @param count the number of hits in the heap.
+ * @param at the index of the hit.
+ */
+internal void
+hits_sift_down(srch_hit_t* hits, size_t count, size_t at) {
+    for (;;) {
+        size_t worst = at, left = 2u * at + 1u, right = left + 1u;
+        if (left < count && hit_rank_compare(&hits[left], &hits[worst]) > 0) worst = left;
+        if (right < count && hit_rank_compare(&hits[right], &hits[worst]) > 0) worst = right;
+        if (worst == at) return;
+        srch_hit_t swap = hits[at];
+        hits[at] = hits[worst];
+        hits[worst] = swap;
+        at = worst;
+    }
+}
+
+/**
+ * @brief move a hit up a heap of hits (the worst ranked one first) until it is in place.
+ *
+ * @param hits the heap.
+ * @param at the index of the hit.
+ */
+internal void
+hits_sift_up(srch_hit_t* hits, size_t at) {
+    while (at > 0u && hit_rank_compare(&hits[at], &hits[(at - 1u) / 2u]) > 0) {
+        srch_hit_t swap = hits[at];
+        hits[at] = hits[(at - 1u) / 2u];
+        hits[(at - 1u) / 2u] = swap;
+        at = (at - 1u) / 2u;
+    }
+}
+
+/**
+ * @brief order a list of hits as a heap, the worst ranked one first.
+ *
+ * @param hits the list of hits.
+ */
+internal void
+hits_heapify(srch_hits_t* hits) {
+    for (size_t i = hits->count / 2u; i > 0u; i--) hits_sift_down(hits->hits, hits->count, i - 1u);
+}
+
+/**
+ * @brief find every symbol whose name contains a pattern (ignoring case).
+ *
+ * @param search the search indices.
+ * @param symbols the symbols.
+ * @param pattern the pattern.
+ * @param out the hits to append to.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+srch_find_symbols(srch_t* search, const syms_t* symbols, const char* pattern, srch_hits_t* out) {
+    if (!search || !pattern || !out) return -1;
+    if (!symbols) return 0;
+    size_t first = out->count;
+    if (grams_find(&search->symbols, symbols, symbols->count, symbol_text, pattern, \
+        SRCH_HIT_SYMBOL, out) != 0) return -1;
+
+    /* .symtab and .dynsym name most symbols twice, keep one of each name and address (a heap
+     *  of a truncated list is ordered again afterwards). */
+    srch_hit_t* hits = out->hits + first;
+    size_t count = out->count - first, unique = 0u;
+    if (count > 0u) qsort(hits, count, sizeof *hits, hit_address_compare);
+    for (size_t i = 0; i < count; i++) {
+        bool repeat = false;
+        for (size_t j = unique; j > 0u && hits[j - 1u].address == hits[i].address && !repeat; j--)
+            repeat = !strcmp(symbols->symbols[hits[j - 1u].index].name, symbols->symbols[hits[i].index].name);
+        if (!repeat) hits[unique++] = hits[i];
+    }
+    out->count = first + unique;
+    if (out->truncated) hits_heapify(out);
+    return 0;
+}
+
+/**
+ * @brief find every string that contains a pattern (ignoring case).
+ *
+ * @param search the search indices.
+ * @param strings the strings.
+ * @param pattern the pattern.
+ * @param out the hits to append to.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+srch_find_strings(srch_t* search, const strs_t* strings, const char* pattern, srch_hits_t* out) {
+    if (!search || !pattern || !out) return -1;
+    if (!strings) return 0;
+    return grams_find(&search->strings, strings, strings->count, string_text, pattern, \
+        SRCH_HIT_STRING, out);
+}
+
+/**
+ * @brief find every occurrence of a byte pattern.
+ *
+ * @param data the bytes to search.
+ * @param size the number of bytes.
+ * @param base the address of the first byte.
+ * @param needle the byte pattern.
+ * @param length the length of the byte pattern.
+ * @param out the hits to append to.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+srch_find_bytes(const uint8_t* data, size_t size, uint64_t base, const uint8_t* needle, \
+    size_t length, srch_hits_t* out) {
+    if (!needle || length == 0u || !out) return -1;
+    if (!data) return 0;
+
+    /* every hit ranks the same but for its address, so none past a truncation would be kept. */
+    for (size_t at = simd_memmem(data, size, 0u, needle, length); at < size && !out->truncated; \
+        at = simd_memmem(data, size, at + 1u, needle, length))
+        if (srch_hits_push(out, SRCH_HIT_BYTES, SRCH_MATCH_EXACT, base + at, 0u, length) != 0) return -1;
+    return 0;
+}
+
+/**
+ * @brief append a hit to a list; past SRCH_MAX_HITS the list is truncated to the best ranked
+ *  ones, it is then kept as a heap with the worst one first (until it is ranked), and a hit
+ *  only goes in in place of that one.
+ *
+ * @param hits the list of hits.
+ * @param kind the kind of the hit.
+ * @param match how well it matched.
+ * @param address the address of the hit.
+ * @param index the index of the symbol or string.
+ * @param length the length of the text matched against.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+srch_hits_push(srch_hits_t* hits, srch_kind_t kind, srch_match_t match, uint64_t address, \
+    uint32_t index, size_t length) {
+    if (!hits) return -1;
+    srch_hit_t hit = { address, index, (uint16_t) (length > UINT16_MAX ? UINT16_MAX : length), \
+        (uint8_t) kind, (uint8_t) (match * 4u + (SRCH_HIT_STRING - kind)) };
+
+    /* full, keep the best ranked ones; the worst one is first, and only a better hit replaces it. */
+    if (hits->count == SRCH_MAX_HITS) {
+        if (!hits->truncated) hits_heapify(hits);
+        hits->truncated = true;
+        if (hit_rank_compare(&hit, &hits->hits[0]) < 0) {
+            hits->hits[0] = hit;
+            hits_sift_down(hits->hits, hits->count, 0u);
+        }
+        return 0;
+    }
+    if (hits->count == hits->capacity) {
+        size_t capacity = hits->capacity ? hits->capacity * 2u : 64u;
+        srch_hit_t* grown = realloc(hits->hits, capacity * sizeof *grown);
+        if (!grown) {
+            fprintf(stderr, "lzd, srch_hits_push; realloc failed; could not allocate memory for hits.\n");
+            return -1;
+        }
+        hits->hits = grown;
+        hits->capacity = capacity;
+    }
+    hits->hits[hits->count++] = hit;
+    if (hits->truncated) hits_sift_up(hits->hits, hits->count - 1u);
+    return 0;
+}
+
+/**
+ * @brief order hits from the best to the worst; by score, then the shorter text, then the
+ *  lower address.
+ *
+ * @param hits the list of hits.
+ */
+void
+srch_rank(srch_hits_t* hits) {
+    if (!hits || hits->count == 0u) return;
+    qsort(hits->hits, hits->count, sizeof *hits->hits, hit_rank_compare);
+}
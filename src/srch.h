@@ -0,0 +1,218 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-07
+ */
+#ifndef LZD_SRCH_H
+#define LZD_SRCH_H
+
+/*! @uses uint64_t, uint32_t, uint16_t, uint8_t. */
+#include <stdint.h>
+
+/*! @uses size_t, ssize_t. */
+#include <sys/types.h>
+
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses pthread_mutex_t. */
+#include <pthread.h>
+
+/*! @uses insn_chunk_t. */
+#include "insn.h"
+
+/*! @uses strs_t. */
+#include "strs.h"
+
+/*! @uses syms_t. */
+#include "syms.h"
+
+/* number of trigram buckets (log2), a bucket holds every trigram that hashes into it. */
+#define SRCH_GRAM_BITS 16u
+
+/* most hits a single search keeps, per kind and over all of them. */
+#define SRCH_MAX_HITS 65536u
+
+/* kind of a hit, in the order they are ranked at the same match quality. */
+typedef enum {
+    SRCH_HIT_SYMBOL = 0u, /* a symbol name. */
+    SRCH_HIT_INSN, /* a decoded instruction by mnemonic (and operands). */
+    SRCH_HIT_BYTES, /* a byte pattern inside of an executable region. */
+    SRCH_HIT_STRING, /* an extracted string. */
+} srch_kind_t;
+
+/* how well a text matched a pattern. */
+typedef enum {
+    SRCH_MATCH_SUBSTRING = 1u, /* the pattern is inside of the text. */
+    SRCH_MATCH_PREFIX, /* the text starts with the pattern. */
+    SRCH_MATCH_EXACT, /* the text is the pattern (every instruction and byte hit). */
+} srch_match_t;
+
+/* a single hit of a search. */
+typedef struct {
+    uint64_t address; /* address of the hit (the file offset of a string that isn't loaded). */
+    uint32_t index; /* index of the symbol or string, unused o.w. */
+    uint16_t length; /* length of the text matched against, a shorter one ranks higher. */
+    uint8_t kind; /* srch_kind_t. */
+    uint8_t score; /* match quality and kind, a higher one ranks higher. */
+} srch_hit_t;
+
+/* a growable list of hits. */
+typedef struct {
+    srch_hit_t* hits; /* the hits. */
+    size_t count, capacity; /* count and capacity of hits. */
+    bool truncated; /* more than SRCH_MAX_HITS matched, the hits are a heap (see srch_hits_push). */
+} srch_hits_t;
+
+/**
+ * a trigram index over a set of texts (symbol names or strings), in compressed rows; every
+ *  lowercased trigram of a text hashes into a bucket, and a bucket lists the texts that have
+ *  one of its trigrams in ascending order. a pattern is looked up in the rarest two buckets of
+ *  its trigrams and every candidate is checked, so a collision only costs a comparison.
+ */
+typedef struct {
+    uint32_t* starts; /* first posting of every bucket, (1 << SRCH_GRAM_BITS) + 1 of them. */
+    uint32_t* postings; /* text of every posting. */
+    size_t count; /* number of texts indexed. */
+    bool built; /* built on the first search, and dropped when the texts change. */
+    pthread_mutex_t lock; /* the first search of every kind builds it. */
+} srch_grams_t;
+
+/* the addresses of every decoded instruction with one mnemonic. */
+typedef struct {
+    char* mnemonic; /* the mnemonic (owned), 0x0 if the slot is empty. */
+    uint64_t* addresses; /* addresses, ascending inside of every chunk. */
+    size_t count, capacity; /* count and capacity of addresses. */
+} srch_posting_t;
+
+/**
+ * the search indices of an opened binary; mnemonic postings are added as chunks are decoded,
+ *  the trigram indices are built by the first search that needs them. like the xref index an
+ *  address is never removed, so instruction hits are checked against the store by the caller.
+ */
+typedef struct {
+    srch_posting_t* postings; /* open-addressed by mnemonic. */
+    size_t mask, used; /* number of slots - 1 (a power of two), and slots in use. */
+    pthread_mutex_t lock; /* chunks arrive on the worker threads. */
+    srch_grams_t symbols, strings; /* trigram indices of the symbol names and the strings. */
+} srch_t;
+
+/**
+ * @brief create empty search indices.
+ *
+ * @return allocated search indices if successful, 0x0 o.w.
+ */
+srch_t*
+srch_create();
+
+/**
+ * @brief free search indices.
+ *
+ * @param search the search indices to be freed.
+ */
+void
+srch_free(srch_t* search);
+
+/**
+ * @brief drop every mnemonic posting (the instructions are gone).
+ *
+ * @param search the search indices.
+ */
+void
+srch_clear(srch_t* search);
+
+/**
+ * @brief drop the trigram indices, they are rebuilt by the next search (the strings or the
+ *  symbols changed).
+ *
+ * @param search the search indices.
+ */
+void
+srch_drop_texts(srch_t* search);
+
+/**
+ * @brief add the instructions of a decoded chunk to the mnemonic postings.
+ *
+ * @param search the search indices.
+ * @param chunk the chunk.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+srch_add_insns(srch_t* search, const insn_chunk_t* chunk);
+
+/**
+ * @brief get the address of every decoded instruction with a mnemonic.
+ *
+ * @param search the search indices.
+ * @param mnemonic the mnemonic (lowercase, as capstone prints it).
+ * @param out output for the addresses (allocated, freed by the caller), ascending and without
+ *  repeats.
+ * @return -1 if a failure occurs, the number of addresses o.w.
+ */
+ssize_t
+srch_find_mnemonic(srch_t* search, const char* mnemonic, uint64_t** out);
+
+/**
+ * @brief find every symbol whose name contains a pattern (ignoring case).
+ *
+ * @param search the search indices.
+ * @param symbols the symbols.
+ * @param pattern the pattern.
+ * @param out the hits to append to.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+srch_find_symbols(srch_t* search, const syms_t* symbols, const char* pattern, srch_hits_t* out);
+
+/**
+ * @brief find every string that contains a pattern (ignoring case).
+ *
+ * @param search the search indices.
+ * @param strings the strings.
+ * @param pattern the pattern.
+ * @param out the hits to append to.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+srch_find_strings(srch_t* search, const strs_t* strings, const char* pattern, srch_hits_t* out);
+
+/**
+ * @brief find every occurrence of a byte pattern.
+ *
+ * @param data the bytes to search.
+ * @param size the number of bytes.
+ * @param base the address of the first byte.
+ * @param needle the byte pattern.
+ * @param length the length of the byte pattern.
+ * @param out the hits to append to.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+srch_find_bytes(const uint8_t* data, size_t size, uint64_t base, const uint8_t* needle, \
+    size_t length, srch_hits_t* out);
+
+/**
+ * @brief append a hit to a list; past SRCH_MAX_HITS the list is truncated to the best ranked
+ *  ones, it is then kept as a heap with the worst one first (until it is ranked), and a hit
+ *  only goes in in place of that one.
+ *
+ * @param hits the list of hits.
+ * @param kind the kind of the hit.
+ * @param match how well it matched.
+ * @param address the address of the hit.
+ * @param index the index of the symbol or string.
+ * @param length the length of the text matched against.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+srch_hits_push(srch_hits_t* hits, srch_kind_t kind, srch_match_t match, uint64_t address, \
+    uint32_t index, size_t length);
+
+/**
+ * @brief order hits from the best to the worst; by score, then the shorter text, then the
+ *  lower address.
+ *
+ * @param hits the list of hits.
+ */
+void
+srch_rank(srch_hits_t* hits);
+#endif /* LZD_SRCH_H */
@@ -0,0 +1,362 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-13
+ */
+#include "stat.h"
+
+/*! @uses snprintf, fprintf, fflush, ferror. */
+#include <stdio.h>
+
+/*! @uses calloc. */
+#include <stdlib.h>
+
+/*! @uses memset. */
+#include <string.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses _Atomic, atomic_load, atomic_load_explicit, atomic_store_explicit. */
+#include <stdatomic.h>
+
+/*! @uses clock_gettime, timespec, CLOCK_MONOTONIC. */
+#include <time.h>
+
+/*! @uses internal. */
+#include "dyna.h"
+
+/*
+ * the counters and histograms of a single thread; only the thread that owns it writes it, so
+ *  a relaxed load and store is enough to add to it, and a snapshot reads it with relaxed loads
+ *  while it is being written. a shard outlives its thread, it is handed to the next thread that
+ *  starts recording so what it counted stays in the totals.
+ */
+typedef struct stat_shard {
+    _Atomic(uint64_t) counters[STAT_COUNTER_COUNT];
+    _Atomic(uint64_t) sums[STAT_HIST_COUNT];
+    _Atomic(uint64_t) buckets[STAT_HIST_COUNT][STAT_BUCKETS];
+    struct stat_shard* next; /* next shard in g_shards. */
+    bool owned; /* a live thread writes it (under g_lock). */
+} stat_shard_t;
+
+/* every shard that was ever made, and the lock for claiming and walking them. */
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static stat_shard_t* g_shards;
+
+/* shared by every thread that could not allocate a shard of its own, it may lose updates. */
+static stat_shard_t g_fallback;
+
+/* thread specific key, hands the shard of a thread back when it exits. */
+static pthread_key_t g_key;
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+
+/* the shard of the calling thread. */
+static _Thread_local stat_shard_t* t_shard;
+
+/* names of the counters and histograms, in the stats view and in json. */
+static const char* g_counter_names[STAT_COUNTER_COUNT] = {
+    "bytes_mapped", "ranges_scanned", "jobs_queued", "jobs_run", "jobs_stolen",
+    "bytes_decoded", "insns_decoded", "pages_posted", "locks_taken", "locks_contended",
+    "chunks_reused", "bytes_evicted",
+};
+static const char* g_hist_names[STAT_HIST_COUNT] = {
+    "load_ns", "scan_ns", "decode_ns_per_kib", "post_ns", "lock_wait_ns", "frame_ns",
+};
+
+/**
+ * @brief hand the shard of an exiting thread back, for the next thread to claim.
+ *
+ * @param p the shard.
+ */
+internal void
+shard_release(void* p) {
+    stat_shard_t* shard = p;
+    pthread_mutex_lock(&g_lock);
+    shard->owned = false;
+    pthread_mutex_unlock(&g_lock);
+}
+
+/**
+ * @brief initialize the thread key of the shards.
+ */
+internal void
+shard_init(void) { pthread_key_create(&g_key, shard_release); }
+
+/**
+ * @brief get the shard of the calling thread, claiming one that was handed back (or making a
+ *  new one) the first time.
+ *
+ * @return the shard of the calling thread.
+ */
+internal stat_shard_t*
+shard_get() {
+    if (t_shard) return t_shard;
+    pthread_once(&g_once, shard_init);
+    pthread_mutex_lock(&g_lock);
+    stat_shard_t* shard = g_shards;
+    while (shard && shard->owned) shard = shard->next;
+    if (!shard && (shard = calloc(1u, sizeof *shard))) {
+        shard->next = g_shards;
+        g_shards = shard;
+    }
+    if (shard) shard->owned = true;
+    pthread_mutex_unlock(&g_lock);
+    if (!shard) return &g_fallback;
+    pthread_setspecific(g_key, shard);
+    t_shard = shard;
+    return shard;
+}
+
+/**
+ * @brief add to a cell of a shard, only its owner writes it.
+ *
+ * @param cell the cell.
+ * @param amount the amount to add.
+ */
+internal void
+cell_add(_Atomic(uint64_t)* cell, uint64_t amount) {
+    atomic_store_explicit(cell, atomic_load_explicit(cell, memory_order_relaxed) + amount, \
+        memory_order_relaxed);
+}
+
+/**
+ * @brief get the time on the monotonic clock.
+ *
+ * @return the time in nanoseconds.
+ */
+uint64_t
+stat_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * @brief add to a counter, in the shard of the calling thread (without any atomic rmw).
+ *
+ * @param counter the counter.
+ * @param amount the amount to add.
+ */
+void
+stat_add(stat_counter_t counter, uint64_t amount) {
+    if (counter >= STAT_COUNTER_COUNT) return;
+    cell_add(&shard_get()->counters[counter], amount);
+}
+
+/**
+ * @brief record a value in a histogram, in the shard of the calling thread.
+ *
+ * @param hist the histogram.
+ * @param value the value (in nanoseconds).
+ */
+void
+stat_record(stat_hist_t hist, uint64_t value) {
+    if (hist >= STAT_HIST_COUNT) return;
+    size_t bucket = value ? 63u - (size_t) __builtin_clzll(value) : 0u;
+    if (bucket >= STAT_BUCKETS) bucket = STAT_BUCKETS - 1u;
+    stat_shard_t* shard = shard_get();
+    cell_add(&shard->buckets[hist][bucket], 1u);
+    cell_add(&shard->sums[hist], value);
+}
+
+/**
+ * @brief lock a mutex, and count (and time) it when another thread is holding it already.
+ *
+ * @param lock the mutex.
+ */
+void
+stat_lock(pthread_mutex_t* lock) {
+    stat_add(STAT_LOCKS_TAKEN, 1u);
+    if (pthread_mutex_trylock(lock) == 0) return;
+    uint64_t start = stat_now();
+    pthread_mutex_lock(lock);
+    stat_add(STAT_LOCKS_CONTENDED, 1u);
+    stat_record(STAT_HIST_LOCK, stat_now() - start);
+}
+
+/**
+ * @brief add up the shards of every thread (and read the gauges of a pool); a shard may be
+ *  written while it is read, so a snapshot is only consistent per counter.
+ *
+ * @param out the snapshot.
+ * @param pool the worker pool whose queue is read (or 0x0).
+ */
+void
+stat_snapshot(stat_snapshot_t* out, const wrk_pool_t* pool) {
+    if (!out) return;
+    memset(out, 0, sizeof *out);
+    out->ns = stat_now();
+
+    /* the fallback shard goes first, it is not in the list. */
+    pthread_mutex_lock(&g_lock);
+    for (stat_shard_t* shard = &g_fallback; shard; \
+        shard = shard == &g_fallback ? g_shards : shard->next) {
+        if (shard != &g_fallback) out->threads++;
+        for (size_t i = 0; i < STAT_COUNTER_COUNT; i++)
+            out->counters[i] += atomic_load_explicit(&shard->counters[i], memory_order_relaxed);
+        for (size_t h = 0; h < STAT_HIST_COUNT; h++) {
+            out->sums[h] += atomic_load_explicit(&shard->sums[h], memory_order_relaxed);
+            for (size_t b = 0; b < STAT_BUCKETS; b++) {
+                uint64_t count = atomic_load_explicit(&shard->buckets[h][b], memory_order_relaxed);
+                out->buckets[h][b] += count;
+                out->counts[h] += count;
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_lock);
+
+    /* the queue of the pool, its jobs that are not queued anymore are running. */
+    if (!pool) return;
+    size_t pending = atomic_load(&pool->pending), queued = atomic_load(&pool->queued);
+    out->workers = pool->count;
+    out->queued = queued;
+    out->active = pending > queued ? pending - queued : 0u;
+    out->sleeping = atomic_load(&pool->sleeping);
+}
+
+/**
+ * @brief estimate a quantile of a histogram, as the upper bound of the bucket it falls in.
+ *
+ * @param snapshot the snapshot.
+ * @param hist the histogram.
+ * @param q the quantile, in [0, 1].
+ * @return the estimate in nanoseconds, 0 if the histogram is empty.
+ */
+uint64_t
+stat_quantile(const stat_snapshot_t* snapshot, stat_hist_t hist, double q) {
+    if (!snapshot || hist >= STAT_HIST_COUNT || snapshot->counts[hist] == 0u) return 0u;
+    if (q < 0.0) q = 0.0;
+    if (q > 1.0) q = 1.0;
+
+    /* the first bucket the cumulative count reaches the rank in. */
+    uint64_t rank = (uint64_t) (q * (double) snapshot->counts[hist] + 0.5);
+    if (rank == 0u) rank = 1u;
+    uint64_t seen = 0u;
+    for (size_t b = 0; b < STAT_BUCKETS; b++) {
+        seen += snapshot->buckets[hist][b];
+        if (seen >= rank) return (uint64_t) 1u << (b + 1u);
+    }
+    return (uint64_t) 1u << STAT_BUCKETS;
+}
+
+/**
+ * @brief format a duration with a unit that keeps it short.
+ *
+ * @param ns the duration in nanoseconds.
+ * @param out the buffer to format into.
+ * @param size the size of the buffer.
+ */
+internal void
+format_ns(uint64_t ns, char* out, size_t size) {
+    if (ns < 1000u) snprintf(out, size, "%luns", (unsigned long) ns);
+    else if (ns < 1000000u) snprintf(out, size, "%.1fus", (double) ns / 1e3);
+    else if (ns < 1000000000u) snprintf(out, size, "%.1fms", (double) ns / 1e6);
+    else snprintf(out, size, "%.2fs", (double) ns / 1e9);
+}
+
+/**
+ * @brief format an amount with a (decimal) suffix that keeps it short.
+ *
+ * @param value the amount.
+ * @param out the buffer to format into.
+ * @param size the size of the buffer.
+ */
+internal void
+format_count(double value, char* out, size_t size) {
+    if (value < 1e3) snprintf(out, size, "%.0f", value);
+    else if (value < 1e6) snprintf(out, size, "%.1fk", value / 1e3);
+    else if (value < 1e9) snprintf(out, size, "%.1fM", value / 1e6);
+    else snprintf(out, size, "%.1fG", value / 1e9);
+}
+
+/**
+ * @brief format a row of the stats view; counters come with their rate since the last snapshot.
+ *
+ * @param now the latest snapshot.
+ * @param last the snapshot before it (or 0x0).
+ * @param row the row, less than STAT_ROWS.
+ * @param line the buffer to format into.
+ * @param size the size of the buffer.
+ */
+void
+stat_format(const stat_snapshot_t* now, const stat_snapshot_t* last, size_t row, char* line, \
+    size_t size) {
+    if (!line || size == 0u) return;
+    line[0] = '\0';
+    if (!now || row >= STAT_ROWS) return;
+
+    /* the pool first. */
+    if (row == 0u) {
+        snprintf(line, size, "%-18s %zu workers, %zu queued, %zu active, %zu sleeping (%zu threads " \
+            "recorded)", "pool", now->workers, now->queued, now->active, now->sleeping, now->threads);
+        return;
+    }
+
+    /* then the counters, with how fast they went up since the last snapshot. */
+    row--;
+    if (row < STAT_COUNTER_COUNT) {
+        char total[16], rate[16] = "-";
+        format_count((double) now->counters[row], total, sizeof total);
+        if (last && now->ns > last->ns && now->counters[row] >= last->counters[row])
+            format_count((double) (now->counters[row] - last->counters[row]) * 1e9 / \
+                (double) (now->ns - last->ns), rate, sizeof rate);
+        snprintf(line, size, "%-18s %10s  %10s/s", g_counter_names[row], total, rate);
+        return;
+    }
+
+    /* and every histogram. */
+    stat_hist_t hist = (stat_hist_t) (row - STAT_COUNTER_COUNT);
+    uint64_t count = now->counts[hist];
+    if (count == 0u) {
+        snprintf(line, size, "%-18s n=0", g_hist_names[hist]);
+        return;
+    }
+    char mean[16], p50[16], p90[16], p99[16], max[16];
+    format_ns(now->sums[hist] / count, mean, sizeof mean);
+    format_ns(stat_quantile(now, hist, 0.50), p50, sizeof p50);
+    format_ns(stat_quantile(now, hist, 0.90), p90, sizeof p90);
+    format_ns(stat_quantile(now, hist, 0.99), p99, sizeof p99);
+    format_ns(stat_quantile(now, hist, 1.0), max, sizeof max);
+    snprintf(line, size, "%-18s n=%-10lu mean %-8s p50 <%-8s p90 <%-8s p99 <%-8s max <%s", \
+        g_hist_names[hist], (unsigned long) count, mean, p50, p90, p99, max);
+}
+
+/**
+ * @brief write a snapshot as a single json object (and a newline).
+ *
+ * @param snapshot the snapshot.
+ * @param file the file to write to.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+stat_write_json(const stat_snapshot_t* snapshot, FILE* file) {
+    if (!snapshot || !file) return -1;
+    fprintf(file, "{\"threads\":%zu,\"workers\":%zu,\"queued\":%zu,\"active\":%zu,\"sleeping\":%zu," \
+        "\"counters\":{", snapshot->threads, snapshot->workers, snapshot->queued, snapshot->active, \
+        snapshot->sleeping);
+    for (size_t i = 0; i < STAT_COUNTER_COUNT; i++)
+        fprintf(file, "%s\"%s\":%lu", i ? "," : "", g_counter_names[i], \
+            (unsigned long) snapshot->counters[i]);
+
+    /* every histogram with its quantiles, and the buckets up to the last one that isn't empty
+     *  (bucket i holds [2^i, 2^(i+1)) ns). */
+    fprintf(file, "},\"histograms\":{");
+    for (size_t h = 0; h < STAT_HIST_COUNT; h++) {
+        uint64_t count = snapshot->counts[h];
+        fprintf(file, "%s\"%s\":{\"count\":%lu,\"sum\":%lu,\"mean\":%lu,\"p50\":%lu,\"p90\":%lu," \
+            "\"p99\":%lu,\"max\":%lu,\"buckets\":[", h ? "," : "", g_hist_names[h], \
+            (unsigned long) count, (unsigned long) snapshot->sums[h], \
+            (unsigned long) (count ? snapshot->sums[h] / count : 0u), \
+            (unsigned long) stat_quantile(snapshot, h, 0.50), \
+            (unsigned long) stat_quantile(snapshot, h, 0.90), \
+            (unsigned long) stat_quantile(snapshot, h, 0.99), \
+            (unsigned long) stat_quantile(snapshot, h, 1.0));
+        size_t used = STAT_BUCKETS;
+        while (used > 0u && snapshot->buckets[h][used - 1u] == 0u) used--;
+        for (size_t b = 0; b < used; b++)
+            fprintf(file, "%s%lu", b ? "," : "", (unsigned long) snapshot->buckets[h][b]);
+        fprintf(file, "]}");
+    }
+    fprintf(file, "}}\n");
+    return fflush(file) == 0 && !ferror(file) ? 0 : -1;
+}
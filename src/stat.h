@@ -0,0 +1,148 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-13
+ */
+#ifndef LZD_STAT_H
+#define LZD_STAT_H
+
+/*! @uses uint64_t. */
+#include <stdint.h>
+
+/*! @uses size_t, ssize_t. */
+#include <sys/types.h>
+
+/*! @uses FILE. */
+#include <stdio.h>
+
+/*! @uses pthread_mutex_t. */
+#include <pthread.h>
+
+/*! @uses wrk_pool_t. */
+#include "wrk.h"
+
+/* a counter of the decode pipeline, only ever goes up. */
+typedef enum {
+    STAT_BYTES_MAPPED = 0u, /* bytes of every binary mapped. */
+    STAT_RANGES_SCANNED, /* code ranges found by a scan (or a recursive descent). */
+    STAT_JOBS_QUEUED, /* jobs posted to a worker pool. */
+    STAT_JOBS_RUN, /* jobs run by a worker. */
+    STAT_JOBS_STOLEN, /* jobs a worker stole off of another worker's deque. */
+    STAT_BYTES_DECODED, /* bytes decoded with capstone. */
+    STAT_INSNS_DECODED, /* instructions decoded with capstone. */
+    STAT_PAGES_POSTED, /* pages handed to ux_post. */
+    STAT_LOCKS_TAKEN, /* times the model lock was taken. */
+    STAT_LOCKS_CONTENDED, /* times the model lock was held by another thread already. */
+    STAT_CHUNKS_REUSED, /* decoded chunks copied from an identical section of another binary. */
+    STAT_BYTES_EVICTED, /* bytes of decoded chunks unmapped to stay under the memory budget. */
+    STAT_COUNTER_COUNT,
+} stat_counter_t;
+
+/* a histogram of the decode pipeline, of nanoseconds. */
+typedef enum {
+    STAT_HIST_LOAD = 0u, /* mapping and parsing a binary. */
+    STAT_HIST_SCAN, /* scanning the regions of a binary for code ranges. */
+    STAT_HIST_DECODE, /* decoding a job, per KiB of it. */
+    STAT_HIST_POST, /* from ux_post until the page was installed. */
+    STAT_HIST_LOCK, /* waiting on the model lock, when it was contended. */
+    STAT_HIST_FRAME, /* rendering a frame of the tui. */
+    STAT_HIST_COUNT,
+} stat_hist_t;
+
+/* buckets of a histogram, bucket i holds the values in [2^i, 2^(i+1)) (and 0 is in bucket 0). */
+#define STAT_BUCKETS 48u
+
+/* rows of the stats view, the pool, then every counter, then every histogram. */
+#define STAT_ROWS (1u + STAT_COUNTER_COUNT + STAT_HIST_COUNT)
+
+/* shortest time between two snapshots of the stats view, in milliseconds. */
+#define STAT_PERIOD_MS 1000
+
+/* the counters and histograms of every thread added up, and the pool when it was taken. */
+typedef struct {
+    uint64_t ns; /* stat_now() when it was taken. */
+    uint64_t counters[STAT_COUNTER_COUNT];
+    uint64_t counts[STAT_HIST_COUNT]; /* number of values in every histogram. */
+    uint64_t sums[STAT_HIST_COUNT]; /* sum of the values in every histogram. */
+    uint64_t buckets[STAT_HIST_COUNT][STAT_BUCKETS];
+    size_t threads; /* threads that recorded anything, alive or not. */
+    size_t workers, queued, active, sleeping; /* of the pool, 0 without one. */
+} stat_snapshot_t;
+
+/**
+ * @brief get the time on the monotonic clock.
+ *
+ * @return the time in nanoseconds.
+ */
+uint64_t
+stat_now();
+
+/**
+ * @brief add to a counter, in the shard of the calling thread (without any atomic rmw).
+ *
+ * @param counter the counter.
+ * @param amount the amount to add.
+ */
+void
+stat_add(stat_counter_t counter, uint64_t amount);
+
+/**
+ * @brief record a value in a histogram, in the shard of the calling thread.
+ *
+ * @param hist the histogram.
+ * @param value the value (in nanoseconds).
+ */
+void
+stat_record(stat_hist_t hist, uint64_t value);
+
+/**
+ * @brief lock a mutex, and count (and time) it when another thread is holding it already.
+ *
+ * @param lock the mutex.
+ */
+void
+stat_lock(pthread_mutex_t* lock);
+
+/**
+ * @brief add up the shards of every thread (and read the gauges of a pool); a shard may be
+ *  written while it is read, so a snapshot is only consistent per counter.
+ *
+ * @param out the snapshot.
+ * @param pool the worker pool whose queue is read (or 0x0).
+ */
+void
+stat_snapshot(stat_snapshot_t* out, const wrk_pool_t* pool);
+
+/**
+ * @brief estimate a quantile of a histogram, as the upper bound of the bucket it falls in.
+ *
+ * @param snapshot the snapshot.
+ * @param hist the histogram.
+ * @param q the quantile, in [0, 1].
+ * @return the estimate in nanoseconds, 0 if the histogram is empty.
+ */
+uint64_t
+stat_quantile(const stat_snapshot_t* snapshot, stat_hist_t hist, double q);
+
+/**
+ * @brief format a row of the stats view; counters come with their rate since the last snapshot.
+ *
+ * @param now the latest snapshot.
+ * @param last the snapshot before it (or 0x0).
+ * @param row the row, less than STAT_ROWS.
+ * @param line the buffer to format into.
+ * @param size the size of the buffer.
+ */
+void
+stat_format(const stat_snapshot_t* now, const stat_snapshot_t* last, size_t row, char* line, \
+    size_t size);
+
+/**
+ * @brief write a snapshot as a single json object (and a newline).
+ *
+ * @param snapshot the snapshot.
+ * @param file the file to write to.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+stat_write_json(const stat_snapshot_t* snapshot, FILE* file);
+#endif /* LZD_STAT_H */
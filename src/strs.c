@@ -0,0 +1,470 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-04
+ */
+#include "strs.h"
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses calloc, realloc, free, qsort. */
+#include <stdlib.h>
+
+/*! @uses memcpy. */
+#include <string.h>
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses simd_class_t, simd_classify. */
+#include "simd.h"
+
+/*! @uses internal. */
+#include "dyna.h"
+
+/* how far back a scan looks for an ascii byte to resynchronize at, see scan_text. */
+#define STRS_REWIND 4096u
+
+/**
+ * @brief create an empty set of strings.
+ *
+ * @param image the mapping the entries will point into.
+ * @return a pointer to an allocated set if successful, 0x0 o.w.
+ */
+strs_t*
+strs_create(const mapf_t* image) {
+    strs_t* strings = calloc(1u, sizeof *strings);
+    if (!strings) {
+        fprintf(stderr, "lzd, strs_create; calloc failed; could not allocate memory for strings.\n");
+        return 0x0;
+    }
+    strings->image = image;
+    return strings;
+}
+
+/**
+ * @brief free a set of strings (the image is not touched).
+ *
+ * @param strings the set to be freed.
+ */
+void
+strs_free(strs_t* strings) {
+    if (!strings) return;
+    free(strings->entries);
+    free(strings);
+}
+
+/**
+ * @brief make sure a set of strings has room for more entries.
+ *
+ * @param strings the set of strings.
+ * @param extra the number of entries to make room for.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+strs_grow(strs_t* strings, size_t extra) {
+    if (strings->count + extra <= strings->capacity) return 0;
+    size_t capacity = strings->capacity ? strings->capacity : 256u;
+    while (capacity < strings->count + extra) capacity *= 2u;
+    strs_entry_t* entries = realloc(strings->entries, capacity * sizeof *entries);
+    if (!entries) {
+        fprintf(stderr, "lzd, strs_grow; realloc failed; could not grow strings.\n");
+        return -1;
+    }
+    strings->entries = entries;
+    strings->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief append an entry to a set of strings.
+ *
+ * @param strings the set of strings.
+ * @param entry the entry to be appended (copied).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+strs_push(strs_t* strings, const strs_entry_t* entry) {
+    if (!strings || !entry || strs_grow(strings, 1u) != 0) return -1;
+    strings->entries[strings->count++] = *entry;
+    return 0;
+}
+
+/**
+ * @brief append all entries of one set of strings to another.
+ *
+ * @param strings the set to append to.
+ * @param other the set to append.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+strs_append(strs_t* strings, const strs_t* other) {
+    if (!strings || !other) return -1;
+    if (other->count == 0u) return 0;
+    if (strs_grow(strings, other->count) != 0) return -1;
+    memcpy(strings->entries + strings->count, other->entries, other->count * sizeof *other->entries);
+    strings->count += other->count;
+    if (!strings->image) strings->image = other->image;
+    return 0;
+}
+
+/**
+ * @brief get the length of a valid multi-byte utf-8 character; overlong forms, surrogates,
+ *  code points past U+10FFFF and the C1 controls are not valid.
+ *
+ * @param data the bytes, starting at the lead byte.
+ * @param size the number of bytes available.
+ * @return the length of the character (2 to 4), 0 if it isn't valid.
+ */
+internal size_t
+utf8_char(const uint8_t* data, size_t size) {
+    uint8_t c = data[0];
+    if (c < 0xc2u || c > 0xf4u) return 0u;
+    size_t n = c < 0xe0u ? 2u : c < 0xf0u ? 3u : 4u;
+    if (n > size) return 0u;
+    for (size_t i = 1; i < n; i++)
+        if ((data[i] & 0xc0u) != 0x80u) return 0u;
+
+    /* the second byte narrows what the lead byte is allowed to encode. */
+    uint8_t d = data[1];
+    if (c == 0xc2u && d < 0xa0u) return 0u;
+    if ((c == 0xe0u && d < 0xa0u) || (c == 0xedu && d >= 0xa0u)) return 0u;
+    if ((c == 0xf0u && d < 0x90u) || (c == 0xf4u && d >= 0x90u)) return 0u;
+    return n;
+}
+
+/**
+ * @brief check if the counts of a string make it look like text.
+ *
+ * @param chars the number of characters.
+ * @param alnum the number of letters and digits.
+ * @param spaces the number of spaces.
+ * @param min_len minimum string length, in characters.
+ * @return if the string should be kept.
+ */
+internal bool
+looks_like_text(size_t chars, size_t alnum, size_t spaces, size_t min_len) {
+    /* require at least 50% alphanumeric, and not all spaces. */
+    return chars >= min_len && alnum * 2u >= chars && spaces < chars;
+}
+
+/**
+ * @brief record a string found in a section.
+ *
+ * @param strings the set of strings.
+ * @param section the section it was found in.
+ * @param start the offset of the string into the section.
+ * @param length the length of the string in bytes.
+ * @param encoding the encoding of the string.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+record(strs_t* strings, const strs_section_t* section, size_t start, size_t length, strs_enc_t encoding) {
+    strs_entry_t entry = {
+        .offset = section->offset + start,
+        .vaddr = section->vaddr ? section->vaddr + start : 0u,
+        .length = length > UINT32_MAX ? UINT32_MAX : (uint32_t) length,
+        .section = section->index,
+        .encoding = (uint8_t) encoding,
+    };
+    return strs_push(strings, &entry);
+}
+
+/* the classes of the 64-byte block a scan is in and of the one after it, every block is only
+ *  classified once. */
+typedef struct {
+    size_t base; /* offset of the block into the section (SIZE_MAX if there is none yet). */
+    simd_class_t c, next; /* classes of the block, and of the one after it. */
+} block_t;
+
+/**
+ * @brief move to the block an offset is in, classifying it if it isn't the current one.
+ *
+ * @param block the block.
+ * @param section the section being scanned.
+ * @param at the offset into the section.
+ * @return the position of the offset inside of the block.
+ */
+internal size_t
+block_seek(block_t* block, const strs_section_t* section, size_t at) {
+    size_t base = at & ~(size_t) 63u;
+    if (block->base != base) {
+        if (block->base != SIZE_MAX && block->base + 64u == base) block->c = block->next;
+        else simd_classify(section->data + base, section->size - base, &block->c);
+        block->base = base;
+        size_t ahead = section->size - base > 64u ? section->size - base - 64u : 0u;
+        simd_classify(section->data + base + 64u, ahead, &block->next);
+    }
+    return at - base;
+}
+
+/**
+ * @brief find where runs of set bits start in a 128-bit window, with a stride between bits.
+ *
+ * @param lo the low half of the window.
+ * @param hi the high half of the window.
+ * @param run the number of bits in a run (stride * (run - 1) has to be below 64).
+ * @param stride the distance between the bits of a run.
+ * @return a mask with bit p set iff bits p, p + stride, ... of the window are all set.
+ */
+internal uint64_t
+run_starts(uint64_t lo, uint64_t hi, size_t run, size_t stride) {
+    /* and the window with itself shifted by doubling amounts, like simd_find_run. */
+    for (size_t k = 1; k < run;) {
+        size_t n = k < run - k ? k : run - k, shift = n * stride;
+        lo &= lo >> shift | hi << (64u - shift);
+        hi &= hi >> shift;
+        k += n;
+    }
+    return lo;
+}
+
+/**
+ * @brief scan part of a section for ascii and utf-8 strings.
+ *
+ * @param strings the set the entries are appended to.
+ * @param section the section to be scanned.
+ * @param start the first offset a string may start at.
+ * @param end the offset no string may start at or after.
+ * @param min_len minimum string length, in characters.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+scan_text(strs_t* strings, const strs_section_t* section, size_t start, size_t end, size_t min_len) {
+    const uint8_t* data = section->data;
+    size_t size = section->size, i = start;
+    bool in_run = false, keep = false;
+
+    /**
+     * an ascii byte is always on a character boundary, and whether it is in a string doesn't
+     *  depend on anything before it; so resume at the last one before start, a string it is
+     *  part of belongs to the part before this one. multi-byte text longer than STRS_REWIND
+     *  without any ascii in it may be cut where parts meet.
+     */
+    if (start > 0u) {
+        size_t limit = start > STRS_REWIND ? start - STRS_REWIND : 0u, h = start;
+        while (h > limit && data[h - 1u] >= 0x80u) h--;
+        if (h > limit) {
+            in_run = data[h - 1u] >= 0x20u && data[h - 1u] <= 0x7eu;
+            i = h;
+        }
+        else if (limit == 0u) i = 0u;
+    }
+
+    size_t from = i, chars = 0u, alnum = 0u, spaces = 0u, multi = 0u;
+    size_t width = 0u;
+    uint8_t lead = 0u;
+    bool mixed = false;
+    block_t block = { SIZE_MAX, { 0 }, { 0 } };
+    while (i < size) {
+        if (!in_run) {
+            /**
+             * find the next byte that could start a string, a whole block at a time; a string
+             *  has at least min_len bytes, and any shorter run of printable (or high) bytes
+             *  can only hold strings that would be dropped, so skip those altogether.
+             */
+            if (i >= end) break;
+            size_t at = block_seek(&block, section, i);
+            uint64_t candidates = run_starts(block.c.print | block.c.high, block.next.print | \
+                block.next.high, min_len < 64u ? min_len : 64u, 1u) >> at;
+            if (!candidates) {
+                i = block.base + 64u;
+                continue;
+            }
+            i += (size_t) __builtin_ctzll(candidates);
+            if (i >= end) break;
+            if (data[i] >= 0x80u && utf8_char(data + i, size - i) == 0u) {
+                i++;
+                continue;
+            }
+            from = i;
+            chars = alnum = spaces = multi = 0u;
+            mixed = false;
+            keep = from >= start;
+            in_run = true;
+        }
+
+        /* extend over printable ascii, a whole block at a time (bits past size aren't set). */
+        size_t at = block_seek(&block, section, i);
+        uint64_t stop = ~block.c.print >> at;
+        size_t n = stop ? (size_t) __builtin_ctzll(stop) : 64u - at;
+        uint64_t mask = n == 64u ? ~0ull : (1ull << n) - 1u;
+        chars += n;
+        alnum += (size_t) __builtin_popcountll(block.c.alnum >> at & mask);
+        spaces += (size_t) __builtin_popcountll(block.c.space >> at & mask);
+        i += n;
+        if (at + n == 64u && i < size) continue;
+
+        /* a valid multi-byte character continues the string. */
+        size_t k = i < size && data[i] >= 0x80u ? utf8_char(data + i, size - i) : 0u;
+        if (k) {
+            /* text sticks to one script, so every character should be about the same. */
+            if (multi == 0u) {
+                lead = data[i];
+                width = k;
+            }
+            else if (k != width) mixed = true;
+            else if (k == 2u && (lead > data[i] ? lead - data[i] : data[i] - lead) > 1) mixed = true;
+            i += k;
+            chars++;
+            multi++;
+            continue;
+        }
+
+        /**
+         * the string ends here; multi-byte characters count as letters, but random bytes make a
+         *  valid one every few dozen bytes, so they have to be from one script and a lone one has
+         *  to come with enough ascii letters on its own.
+         */
+        bool text = multi == 0u || (!mixed && (multi >= 2u || alnum >= min_len));
+        if (keep && text && looks_like_text(chars, alnum + multi, spaces, min_len) && \
+            record(strings, section, from, i - from, multi ? STRS_UTF8 : STRS_ASCII) != 0)
+            return -1;
+        in_run = false;
+    }
+    return 0;
+}
+
+/**
+ * @brief check if a utf-16le code unit is printable ascii.
+ *
+ * @param data the section bytes.
+ * @param size the size of the section.
+ * @param at the offset of the code unit.
+ * @return if the code unit is printable.
+ */
+internal bool
+is_wide(const uint8_t* data, size_t size, size_t at) {
+    return at + 1u < size && data[at] >= 0x20u && data[at] <= 0x7eu && data[at + 1u] == 0x00u;
+}
+
+/**
+ * @brief scan part of a section for utf-16le strings.
+ *
+ * @param strings the set the entries are appended to.
+ * @param section the section to be scanned.
+ * @param start the first offset a string may start at.
+ * @param end the offset no string may start at or after.
+ * @param min_len minimum string length, in characters.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+scan_wide(strs_t* strings, const strs_section_t* section, size_t start, size_t end, size_t min_len) {
+    const uint8_t* data = section->data;
+    size_t size = section->size;
+
+    /**
+     * a printable code unit at p needs a nul at p + 1, so units at p and p + 1 can't both be
+     *  printable and a string is just a chain of them two bytes apart; it starts at p iff there
+     *  is no unit at p - 2, which makes every block independent of the others.
+     */
+    block_t block = { SIZE_MAX, { 0 }, { 0 } };
+    size_t run = min_len < 32u ? min_len : 32u;
+    for (size_t i = start; i < end; i = block.base + 64u) {
+        size_t at = block_seek(&block, section, i), base = block.base;
+        uint64_t nul = block.c.zero >> 1 | block.next.zero << 63;
+        uint64_t nul_ahead = block.next.zero >> 1 | \
+            (uint64_t) (base + 128u < size && data[base + 128u] == 0x00u) << 63;
+        uint64_t units = block.c.print & nul, ahead = block.next.print & nul_ahead;
+        uint64_t before = (uint64_t) (base >= 2u && is_wide(data, size, base - 2u)) | \
+            (uint64_t) (base >= 1u && is_wide(data, size, base - 1u)) << 1;
+
+        /* chains too short to keep are skipped right away. */
+        uint64_t starts = units & ~(units << 2 | before) & run_starts(units, ahead, run, 2u);
+        starts &= ~0ull << at;
+        if (end - base < 64u) starts &= (1ull << (end - base)) - 1u;
+
+        while (starts) {
+            size_t first = base + (size_t) __builtin_ctzll(starts), p = first;
+            starts &= starts - 1u;
+
+            size_t chars = 0u, alnum = 0u, spaces = 0u;
+            for (; is_wide(data, size, p); p += 2u) {
+                uint8_t u = data[p], l = u | 0x20u;
+                chars++;
+                if ((u >= '0' && u <= '9') || (l >= 'a' && l <= 'z')) alnum++;
+                else if (u == ' ') spaces++;
+            }
+            if (looks_like_text(chars, alnum, spaces, min_len) && \
+                record(strings, section, first, p - first, STRS_UTF16LE) != 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief compare two entries by offset, for qsort.
+ *
+ * @param a pointer to the first entry.
+ * @param b pointer to the second entry.
+ * @return < 0, 0 or > 0.
+ */
+internal int
+compare_entries(const void* a, const void* b) {
+    uint64_t x = ((const strs_entry_t*) a)->offset, y = ((const strs_entry_t*) b)->offset;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief scan part of a section for ascii, utf-8 and utf-16le strings; a string is kept if it
+ *  starts inside of [start, end), even if it runs past end, so neighbouring parts of the same
+ *  section can be scanned independently without splitting or repeating a string.
+ *
+ * @param strings the set the entries are appended to (ordered by offset).
+ * @param section the section to be scanned.
+ * @param start the first offset (into the section) a string may start at.
+ * @param end the offset (into the section) no string may start at or after.
+ * @param min_len minimum string length to keep, in characters.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+strs_scan(strs_t* strings, const strs_section_t* section, size_t start, size_t end, size_t min_len) {
+    if (!strings || !section || !section->data) return -1;
+    if (end > section->size) end = section->size;
+    if (start >= end) return 0;
+    if (min_len == 0u) min_len = 1u;
+
+    /* both passes append in order, merge them into a single order. */
+    size_t first = strings->count;
+    if (scan_text(strings, section, start, end, min_len) != 0) return -1;
+    size_t middle = strings->count;
+    if (scan_wide(strings, section, start, end, min_len) != 0) return -1;
+    if (strings->count > middle && middle > first)
+        qsort(strings->entries + first, strings->count - first, sizeof *strings->entries, compare_entries);
+    return 0;
+}
+
+/**
+ * @brief format an entry as a printable c string.
+ *
+ * @param strings the set of strings.
+ * @param index the index of the entry.
+ * @param out the buffer to write into.
+ * @param size the size of the buffer.
+ * @return the number of bytes written (excluding the terminator).
+ */
+size_t
+strs_format(const strs_t* strings, size_t index, char* out, size_t size) {
+    if (!out || size == 0u) return 0u;
+    out[0] = '\0';
+    if (!strings || index >= strings->count) return 0u;
+    const strs_entry_t* entry = &strings->entries[index];
+    const uint8_t* data = mapf_slice(strings->image, entry->offset, entry->length);
+    if (!data) return 0u;
+
+    size_t n = 0u;
+    if (entry->encoding == STRS_UTF16LE) {
+        /* every unit is printable ascii, keep the low bytes. */
+        for (size_t i = 0; i + 1u < entry->length && n + 1u < size; i += 2u)
+            out[n++] = (char) data[i];
+    } else {
+        /* copy as is, but don't cut a multi-byte character in half. */
+        n = entry->length < size - 1u ? entry->length : size - 1u;
+        if (n < entry->length)
+            while (n > 0u && (data[n] & 0xc0u) == 0x80u) n--;
+        memcpy(out, data, n);
+    }
+    out[n] = '\0';
+    return n;
+}
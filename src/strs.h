@@ -0,0 +1,112 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-04
+ */
+#ifndef LZD_STRS_H
+#define LZD_STRS_H
+
+/*! @uses uint64_t, uint32_t, uint16_t, uint8_t. */
+#include <stdint.h>
+
+/*! @uses size_t, ssize_t. */
+#include <sys/types.h>
+
+/*! @uses mapf_t. */
+#include "mapf.h"
+
+/* ... */
+typedef enum {
+    STRS_ASCII = 0u, /* printable ascii. */
+    STRS_UTF8, /* printable ascii with (valid) multi-byte utf-8 characters. */
+    STRS_UTF16LE, /* printable ascii as little-endian utf-16 code units. */
+} strs_enc_t;
+
+/* a string found in a binary, it points into the mapped image instead of holding a copy. */
+typedef struct {
+    uint64_t offset; /* file offset of the first byte. */
+    uint64_t vaddr; /* virtual address of the first byte (0x0 if its section isn't loaded). */
+    uint32_t length; /* length in bytes. */
+    uint16_t section; /* index of the section header it was found in. */
+    uint8_t encoding; /* strs_enc_t. */
+} strs_entry_t;
+
+/* ... */
+typedef struct {
+    const mapf_t* image; /* the mapping the entries point into (borrowed). */
+    strs_entry_t* entries; /* entries, ordered by offset. */
+    size_t count, capacity; /* count and capacity of entries. */
+} strs_t;
+
+/* a section to be scanned for strings. */
+typedef struct {
+    const uint8_t* data; /* section bytes (borrowed from the image). */
+    size_t size; /* size of the section. */
+    uint64_t offset; /* file offset of the section. */
+    uint64_t vaddr; /* virtual address of the section (0x0 if it isn't loaded). */
+    uint16_t index; /* index of the section header. */
+} strs_section_t;
+
+/**
+ * @brief create an empty set of strings.
+ *
+ * @param image the mapping the entries will point into.
+ * @return a pointer to an allocated set if successful, 0x0 o.w.
+ */
+strs_t*
+strs_create(const mapf_t* image);
+
+/**
+ * @brief free a set of strings (the image is not touched).
+ *
+ * @param strings the set to be freed.
+ */
+void
+strs_free(strs_t* strings);
+
+/**
+ * @brief append an entry to a set of strings.
+ *
+ * @param strings the set of strings.
+ * @param entry the entry to be appended (copied).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+strs_push(strs_t* strings, const strs_entry_t* entry);
+
+/**
+ * @brief append all entries of one set of strings to another.
+ *
+ * @param strings the set to append to.
+ * @param other the set to append.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+strs_append(strs_t* strings, const strs_t* other);
+
+/**
+ * @brief scan part of a section for ascii, utf-8 and utf-16le strings; a string is kept if it
+ *  starts inside of [start, end), even if it runs past end, so neighbouring parts of the same
+ *  section can be scanned independently without splitting or repeating a string.
+ *
+ * @param strings the set the entries are appended to (ordered by offset).
+ * @param section the section to be scanned.
+ * @param start the first offset (into the section) a string may start at.
+ * @param end the offset (into the section) no string may start at or after.
+ * @param min_len minimum string length to keep, in characters.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+strs_scan(strs_t* strings, const strs_section_t* section, size_t start, size_t end, size_t min_len);
+
+/**
+ * @brief format an entry as a printable c string.
+ *
+ * @param strings the set of strings.
+ * @param index the index of the entry.
+ * @param out the buffer to write into.
+ * @param size the size of the buffer.
+ * @return the number of bytes written (excluding the terminator).
+ */
+size_t
+strs_format(const strs_t* strings, size_t index, char* out, size_t size);
+#endif /* LZD_STRS_H */
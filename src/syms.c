@@ -0,0 +1,394 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-05
+ */
+#include "syms.h"
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses calloc, aligned_alloc, realloc, free, qsort. */
+#include <stdlib.h>
+
+/*! @uses strcmp, memset. */
+#include <string.h>
+
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses internal. */
+#include "dyna.h"
+
+/* a symbol that starts a span, sorted by start and then by how well it names the span. */
+typedef struct {
+    uint64_t start, size;
+    uint32_t symbol;
+    int32_t rank; /* see span_rank. */
+} span_key_t;
+
+/* the part of an index one job builds. */
+typedef struct {
+    syms_t* symbols;
+    bool failed;
+} index_job_t;
+
+/**
+ * @brief drop the address and name indices of a table of symbols.
+ *
+ * @param symbols the table of symbols.
+ */
+internal void
+index_free(syms_t* symbols) {
+    free(symbols->starts);
+    free(symbols->spans);
+    free(symbols->names);
+    free(symbols->hashes);
+    symbols->starts = 0x0;
+    symbols->spans = 0x0;
+    symbols->names = symbols->hashes = 0x0;
+    symbols->span_count = symbols->name_mask = 0u;
+}
+
+/**
+ * @brief create an empty table of symbols.
+ *
+ * @param image the mapping the names will point into.
+ * @param capacity the number of symbols to make room for up front.
+ * @return a pointer to an allocated table if successful, 0x0 o.w.
+ */
+syms_t*
+syms_create(const mapf_t* image, size_t capacity) {
+    syms_t* symbols = calloc(1u, sizeof *symbols);
+    if (!symbols) {
+        fprintf(stderr, "lzd, syms_create; calloc failed; could not allocate memory for symbols.\n");
+        return 0x0;
+    }
+    symbols->image = image;
+    if (capacity > 0u) {
+        symbols->symbols = calloc(capacity, sizeof *symbols->symbols);
+        if (!symbols->symbols) {
+            fprintf(stderr, "lzd, syms_create; calloc failed; could not allocate memory for symbols.\n");
+            free(symbols);
+            return 0x0;
+        }
+        symbols->capacity = capacity;
+    }
+    return symbols;
+}
+
+/**
+ * @brief free a table of symbols (the image is not touched).
+ *
+ * @param symbols the table to be freed.
+ */
+void
+syms_free(syms_t* symbols) {
+    if (!symbols) return;
+    index_free(symbols);
+    free(symbols->symbols);
+    free(symbols);
+}
+
+/**
+ * @brief append a symbol to a table.
+ *
+ * @param symbols the table of symbols.
+ * @param symbol the symbol to be appended (copied, its name has to point into the image).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+syms_push(syms_t* symbols, const elf_symbol_t* symbol) {
+    if (!symbols || !symbol) return -1;
+    if (symbols->count == symbols->capacity) {
+        size_t capacity = symbols->capacity ? symbols->capacity * 2u : 256u;
+        elf_symbol_t* grown = realloc(symbols->symbols, capacity * sizeof *grown);
+        if (!grown) {
+            fprintf(stderr, "lzd, syms_push; realloc failed; could not grow symbols.\n");
+            return -1;
+        }
+        symbols->symbols = grown;
+        symbols->capacity = capacity;
+    }
+    symbols->symbols[symbols->count++] = *symbol;
+    return 0;
+}
+
+/**
+ * @brief get the offset of a string table's last terminator, any name that starts before it
+ *  is terminated inside of the table.
+ *
+ * @param table the string table bytes.
+ * @param size the size of the string table.
+ * @return the offset one past the last nul byte, 0 if there is none.
+ */
+size_t
+syms_names_bound(const uint8_t* table, size_t size) {
+    if (!table) return 0u;
+
+    /* a well-formed table ends with a nul, so this is a single compare. */
+    while (size > 0u && table[size - 1u] != 0u) size--;
+    return size;
+}
+
+/**
+ * @brief check if a symbol names code or data at an address of the image.
+ *
+ * @param symbol the symbol.
+ * @return true if it starts a span, false o.w.
+ */
+internal bool
+is_located(const elf_symbol_t* symbol) {
+    if (!symbol->value || symbol->shndx == ELF_SHN_UNDEF || symbol->shndx >= ELF_SHN_LORESERVE)
+        return false;
+
+    /* arm mapping symbols ($x, $d, ...) only mark where code and data start. */
+    if (symbol->name[0] == '$') return false;
+    return symbol->type == ELF_STT_FUNC || symbol->type == ELF_STT_GNU_IFUNC || \
+        symbol->type == ELF_STT_OBJECT || symbol->type == ELF_STT_NOTYPE;
+}
+
+/**
+ * @brief rank a symbol among the ones starting at the same address, the highest names the span.
+ *
+ * @param symbol the symbol.
+ * @return the rank, functions over objects over labels and then global over weak over local.
+ */
+internal int32_t
+span_rank(const elf_symbol_t* symbol) {
+    int32_t rank = symbol->type == ELF_STT_FUNC || symbol->type == ELF_STT_GNU_IFUNC ? 8 : \
+        symbol->type == ELF_STT_OBJECT ? 4 : 0;
+    return rank + (symbol->bind == ELF_STB_GLOBAL ? 2 : symbol->bind == ELF_STB_WEAK ? 1 : 0);
+}
+
+/**
+ * @brief compare two span keys for qsort.
+ *
+ * @param a the first key.
+ * @param b the second key.
+ * @return the ordering of a and b.
+ */
+internal int
+span_compare(const void* a, const void* b) {
+    const span_key_t* x = a;
+    const span_key_t* y = b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    if (x->rank != y->rank) return x->rank > y->rank ? -1 : 1;
+    if (x->size != y->size) return x->size > y->size ? -1 : 1;
+    return x->symbol < y->symbol ? -1 : x->symbol > y->symbol ? 1 : 0;
+}
+
+/**
+ * @brief lay sorted span keys out in eytzinger order (an in-order walk of the implicit tree).
+ *
+ * @param symbols the table of symbols.
+ * @param keys the span keys, sorted and one per start.
+ * @param i the next key to be placed.
+ * @param k the slot of the subtree.
+ * @return the next key to be placed after the subtree.
+ */
+internal size_t
+eytzinger(syms_t* symbols, const span_key_t* keys, size_t i, size_t k) {
+    if (k > symbols->span_count) return i;
+    i = eytzinger(symbols, keys, i, 2u * k);
+
+    /* a symbol without a size runs up to the next one. */
+    uint64_t end = keys[i].start + keys[i].size;
+    if (!keys[i].size) end = i + 1u < symbols->span_count ? keys[i + 1u].start : keys[i].start + 1u;
+    symbols->spans[k] = (syms_span_t){ keys[i].start, end, keys[i].symbol };
+    symbols->starts[k] = keys[i].start;
+    return eytzinger(symbols, keys, i + 1u, 2u * k + 1u);
+}
+
+/**
+ * @brief build the address index of a table of symbols (job entry point).
+ *
+ * @param arg the index_job_t.
+ */
+internal void
+build_spans(void* arg) {
+    index_job_t* job = arg;
+    syms_t* symbols = job->symbols;
+
+    /* sort the symbols that are somewhere by address, the best one of every address first. */
+    span_key_t* keys = calloc(symbols->count ? symbols->count : 1u, sizeof *keys);
+    if (!keys) {
+        fprintf(stderr, "lzd, build_spans; calloc failed; could not allocate memory for spans.\n");
+        job->failed = true;
+        return;
+    }
+    size_t count = 0u;
+    for (size_t i = 0; i < symbols->count; i++) {
+        const elf_symbol_t* symbol = &symbols->symbols[i];
+        if (!is_located(symbol)) continue;
+        keys[count++] = (span_key_t){ symbol->value, symbol->size, (uint32_t) i, span_rank(symbol) };
+    }
+    qsort(keys, count, sizeof *keys, span_compare);
+    size_t unique = 0u;
+    for (size_t i = 0; i < count; i++)
+        if (!unique || keys[unique - 1u].start != keys[i].start) keys[unique++] = keys[i];
+
+    /* the starts are aligned to a cache line, so every group of eight siblings shares one. */
+    size_t bytes = ((unique + 1u) * sizeof *symbols->starts + 63u) & ~(size_t) 63u;
+    symbols->starts = aligned_alloc(64u, bytes);
+    symbols->spans = calloc(unique + 1u, sizeof *symbols->spans);
+    if (!symbols->starts || !symbols->spans) {
+        fprintf(stderr, "lzd, build_spans; alloc failed; could not allocate memory for spans.\n");
+        free(keys);
+        job->failed = true;
+        return;
+    }
+    symbols->span_count = unique;
+    eytzinger(symbols, keys, 0u, 1u);
+    free(keys);
+}
+
+/**
+ * @brief hash a symbol name (fnv-1a).
+ *
+ * @param name the name.
+ * @return the 64-bit hash.
+ */
+internal uint64_t
+name_hash(const char* name) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (; *name; name++) h = (h ^ (uint8_t) *name) * 0x100000001b3ull;
+    return h;
+}
+
+/**
+ * @brief find the slot of a name, or the empty slot it would go in.
+ *
+ * @param symbols the table of symbols.
+ * @param name the name.
+ * @param hash the hash of the name.
+ * @return the slot.
+ */
+internal size_t
+name_slot(const syms_t* symbols, const char* name, uint64_t hash) {
+    uint32_t tag = (uint32_t) (hash >> 32);
+    size_t slot = (size_t) hash & symbols->name_mask;
+    while (symbols->names[slot] != UINT32_MAX) {
+        if (symbols->hashes[slot] == tag && !strcmp(symbols->symbols[symbols->names[slot]].name, name))
+            break;
+        slot = (slot + 1u) & symbols->name_mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief check if a symbol is defined in the image, so it has an address to go to.
+ *
+ * @param symbol the symbol.
+ * @return true if it is defined, false o.w.
+ */
+internal bool
+is_defined(const elf_symbol_t* symbol) {
+    return symbol->value && symbol->shndx != ELF_SHN_UNDEF;
+}
+
+/**
+ * @brief build the name index of a table of symbols (job entry point).
+ *
+ * @param arg the index_job_t.
+ */
+internal void
+build_names(void* arg) {
+    index_job_t* job = arg;
+    syms_t* symbols = job->symbols;
+
+    /* at most half full, so a probe sequence stays short. */
+    size_t slots = 16u;
+    while (slots < symbols->count * 2u) slots *= 2u;
+    symbols->names = calloc(slots, sizeof *symbols->names);
+    symbols->hashes = calloc(slots, sizeof *symbols->hashes);
+    if (!symbols->names || !symbols->hashes) {
+        fprintf(stderr, "lzd, build_names; calloc failed; could not allocate memory for names.\n");
+        job->failed = true;
+        return;
+    }
+    memset(symbols->names, 0xff, slots * sizeof *symbols->names);
+    symbols->name_mask = slots - 1u;
+
+    /* a name that is both imported and defined (.dynsym and .symtab) goes to the definition. */
+    for (size_t i = 0; i < symbols->count; i++) {
+        const elf_symbol_t* symbol = &symbols->symbols[i];
+        uint64_t hash = name_hash(symbol->name);
+        size_t slot = name_slot(symbols, symbol->name, hash);
+        if (symbols->names[slot] != UINT32_MAX) {
+            if (!is_defined(&symbols->symbols[symbols->names[slot]]) && is_defined(symbol))
+                symbols->names[slot] = (uint32_t) i;
+            continue;
+        }
+        symbols->names[slot] = (uint32_t) i;
+        symbols->hashes[slot] = (uint32_t) (hash >> 32);
+    }
+}
+
+/**
+ * @brief build the address and name indices of a table of symbols, replacing older ones; the
+ *  two are built in parallel, this waits for its own jobs to finish.
+ *
+ * @param symbols the table of symbols.
+ * @param pool the worker pool to build on (or 0x0 to build on the calling thread).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+syms_index(syms_t* symbols, wrk_pool_t* pool) {
+    if (!symbols || symbols->count >= UINT32_MAX) return -1;
+    index_free(symbols);
+
+    /* the two indices share nothing but the (read-only) symbols. */
+    index_job_t parts[2] = { { symbols, false }, { symbols, false } };
+    job_t jobs[2] = { { build_spans, &parts[0] }, { build_names, &parts[1] } };
+    if (!pool || wrk_pool_run_batch(pool, jobs, 2u, WRK_PRIO_HIGH) != 0) {
+        build_spans(&parts[0]);
+        build_names(&parts[1]);
+    }
+    if (parts[0].failed || parts[1].failed) {
+        index_free(symbols);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief find the symbol an address falls in, in O(log n).
+ *
+ * @param symbols the (indexed) table of symbols.
+ * @param address the address to look up.
+ * @param offset output for the offset of address into the symbol (or 0x0).
+ * @return the symbol if there is one, 0x0 o.w.
+ */
+const elf_symbol_t*
+syms_at(const syms_t* symbols, uint64_t address, uint64_t* offset) {
+    if (!symbols || !symbols->span_count) return 0x0;
+
+    /* descend the implicit tree, going right whenever a start is at or before the address; the
+     *  last right turn is the last start at or before it. the eight slots three levels down
+     *  share a cache line, so they are fetched while this level is compared. */
+    size_t k = 1u;
+    while (k <= symbols->span_count) {
+        if ((k << 3u) <= symbols->span_count) __builtin_prefetch(symbols->starts + (k << 3u));
+        k = 2u * k + (symbols->starts[k] <= address);
+    }
+    k >>= __builtin_ctzll((unsigned long long) k) + 1;
+    if (!k || address >= symbols->spans[k].end) return 0x0;
+    if (offset) *offset = address - symbols->spans[k].start;
+    return &symbols->symbols[symbols->spans[k].symbol];
+}
+
+/**
+ * @brief find a defined symbol by name, in O(1).
+ *
+ * @param symbols the (indexed) table of symbols.
+ * @param name the name of the symbol.
+ * @return the symbol if there is one, 0x0 o.w.
+ */
+const elf_symbol_t*
+syms_find(const syms_t* symbols, const char* name) {
+    if (!symbols || !symbols->names || !name) return 0x0;
+    size_t slot = name_slot(symbols, name, name_hash(name));
+    if (symbols->names[slot] == UINT32_MAX) return 0x0;
+    const elf_symbol_t* symbol = &symbols->symbols[symbols->names[slot]];
+    return is_defined(symbol) ? symbol : 0x0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-05
+ */
+#ifndef LZD_SYMS_H
+#define LZD_SYMS_H
+
+/*! @uses size_t, ssize_t. */
+#include <sys/types.h>
+
+/*! @uses uint64_t, uint32_t. */
+#include <stdint.h>
+
+/*! @uses elf_symbol_t. */
+#include "elfx.h"
+
+/*! @uses mapf_t. */
+#include "mapf.h"
+
+/*! @uses wrk_pool_t. */
+#include "wrk.h"
+
+/* the address range a symbol covers. */
+typedef struct {
+    uint64_t start, end; /* [start, end) of the symbol. */
+    uint32_t symbol; /* index of the symbol. */
+} syms_span_t;
+
+/* a flat table of symbols, their names point into the mapped string tables of the image. */
+typedef struct {
+    const mapf_t* image; /* the mapping the names point into (borrowed). */
+    elf_symbol_t* symbols; /* symbols, in symbol table order. */
+    size_t count, capacity; /* count and capacity of symbols. */
+
+    /* address index, the spans (one per start address) in eytzinger order; slot 0 is unused
+     *  and the children of slot k are 2k and 2k + 1. */
+    uint64_t* starts; /* start of every span, searched on its own to keep the probes dense. */
+    syms_span_t* spans; /* the spans, in the same order as starts. */
+    size_t span_count; /* number of spans. */
+
+    /* name index, an open-addressed hash of symbol indices (UINT32_MAX if empty). */
+    uint32_t* names; /* symbol of every slot. */
+    uint32_t* hashes; /* low half of the name hash of every slot. */
+    size_t name_mask; /* number of slots - 1 (a power of two). */
+} syms_t;
+
+/**
+ * @brief create an empty table of symbols.
+ *
+ * @param image the mapping the names will point into.
+ * @param capacity the number of symbols to make room for up front.
+ * @return a pointer to an allocated table if successful, 0x0 o.w.
+ */
+syms_t*
+syms_create(const mapf_t* image, size_t capacity);
+
+/**
+ * @brief free a table of symbols (the image is not touched).
+ *
+ * @param symbols the table to be freed.
+ */
+void
+syms_free(syms_t* symbols);
+
+/**
+ * @brief append a symbol to a table.
+ *
+ * @param symbols the table of symbols.
+ * @param symbol the symbol to be appended (copied, its name has to point into the image).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+syms_push(syms_t* symbols, const elf_symbol_t* symbol);
+
+/**
+ * @brief get the offset of a string table's last terminator, any name that starts before it
+ *  is terminated inside of the table.
+ *
+ * @param table the string table bytes.
+ * @param size the size of the string table.
+ * @return the offset one past the last nul byte, 0 if there is none.
+ */
+size_t
+syms_names_bound(const uint8_t* table, size_t size);
+
+/**
+ * @brief build the address and name indices of a table of symbols, replacing older ones; the
+ *  two are built in parallel, this waits for its own jobs to finish.
+ *
+ * @param symbols the table of symbols.
+ * @param pool the worker pool to build on (or 0x0 to build on the calling thread).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+syms_index(syms_t* symbols, wrk_pool_t* pool);
+
+/**
+ * @brief find the symbol an address falls in, in O(log n).
+ *
+ * @param symbols the (indexed) table of symbols.
+ * @param address the address to look up.
+ * @param offset output for the offset of address into the symbol (or 0x0).
+ * @return the symbol if there is one, 0x0 o.w.
+ */
+const elf_symbol_t*
+syms_at(const syms_t* symbols, uint64_t address, uint64_t* offset);
+
+/**
+ * @brief find a defined symbol by name, in O(1).
+ *
+ * @param symbols the (indexed) table of symbols.
+ * @param name the name of the symbol.
+ * @return the symbol if there is one, 0x0 o.w.
+ */
+const elf_symbol_t*
+syms_find(const syms_t* symbols, const char* name);
+#endif /* LZD_SYMS_H */
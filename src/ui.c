@@ -4,27 +4,45 @@
  */
 #include "ui.h"
 
-/*! @uses ux_insn_t, ux_handle_key. */
+/*! @uses ux_insn_t, ux_handle_key, ux_stats, ux_loaded, ux_reclaim. */
 #include "ux.h"
 
 /*! @uses ncurses. */
 #include <ncurses.h>
 
-/*! @uses calloc, free. */
+/*! @uses calloc, malloc, free, qsort. */
 #include <stdlib.h>
 
-/*! @uses strncpy, strnlen. */
+/*! @uses strncpy, strnlen, strlen, memcpy, memset. */
 #include <string.h>
 
-/*! @uses fprintf, stderr. */
+/*! @uses fprintf, stderr, snprintf. */
 #include <stdio.h>
 
+/*! @uses eventfd, EFD_NONBLOCK, EFD_CLOEXEC. */
+#include <sys/eventfd.h>
+
+/*! @uses poll, pollfd, POLLIN. */
+#include <poll.h>
+
+/*! @uses read, write, close, STDIN_FILENO. */
+#include <unistd.h>
+
+/*! @uses clock_gettime, timespec. */
+#include <time.h>
+
 /*! @uses internal. */
 #include "dyna.h"
 
 /*! @uses elf_symbol_t. */
 #include "elfx.h"
 
+/*! @uses stat_now, stat_record, stat_lock, stat_format. */
+#include "stat.h"
+
+/* number of rows fetched from a row provider at once, while drawing. */
+#define FETCH_ROWS 32u
+
 /**
  * @brief clamp an integer to a range.
  *
@@ -40,6 +58,84 @@ clampi(int v, int lo, int hi) {
     return v;
 }
 
+/**
+ * @brief clamp a row (or a row count) to a range.
+ *
+ * @param v the value to clamp.
+ * @param lo the lower bound.
+ * @param hi the upper bound.
+ * @return the clamped value.
+ */
+internal ssize_t
+clampz(ssize_t v, ssize_t lo, ssize_t hi) {
+    if (v < lo) return lo;
+    if (v > hi) return hi;
+    return v;
+}
+
+/**
+ * @brief get the name of a view.
+ *
+ * @param mode the view mode.
+ * @return the name of the view.
+ */
+internal const char*
+view_label(ui_view_mode_t mode) {
+    switch (mode) {
+        case UI_VIEW_STRINGS: return "strings";
+        case UI_VIEW_SYMBOLS: return "symbols";
+        case UI_VIEW_XREFS: return "xrefs";
+        case UI_VIEW_FIND: return "find";
+        case UI_VIEW_STATS: return "stats";
+        case UI_VIEW_DIFF: return "diff";
+        default: return "instructions";
+    }
+}
+
+/**
+ * @brief get the time on the monotonic clock.
+ *
+ * @return the time in milliseconds.
+ */
+internal int64_t
+now_ms() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief wake the ui loop up, after something was marked dirty.
+ *
+ * @param model the ui model.
+ */
+internal void
+model_wake(ui_model_t* model) {
+    if (model->wakeup < 0) return;
+    uint64_t one = 1u;
+    ssize_t written = write(model->wakeup, &one, sizeof one);
+    (void) written; /* a full counter is already a pending wakeup. */
+}
+
+/**
+ * @brief free a message that will not be installed, and whatever it carries.
+ *
+ * @param node the link of the message.
+ */
+internal void
+msg_free(msgq_node_t* node) {
+    if (node->kind == UI_MSG_PAGE) {
+        ux_page_msg_t* page = (ux_page_msg_t*) node;
+        insn_chunk_free(page->chunk);
+        free(page);
+    } else if (node->kind == UI_MSG_LOADED) free(node); /* the binary is left to its workspace. */
+    else {
+        ui_finds_msg_t* finds = (ui_finds_msg_t*) node;
+        free(finds->finds);
+        free(finds);
+    }
+}
+
 /**
  * @brief draw a box around a window.
  *
@@ -72,14 +168,694 @@ draw_header(WINDOW* w, ui_model_t* m) {
     }
 
     /* subtitle line inside box. */
-    if (m->subtitle) {
-        mvwprintw(w, 1, 2, "%.*s", wd - 4, m->subtitle);
+    mvwprintw(w, 1, 2, "%.*s", wd - 4, m->tab->subtitle);
+
+    /* the tab bar, on the top border after the title; the active tab is drawn reversed. */
+    int x = 2 + (m->title ? (int) strlen(m->title) + 3 : 0);
+    for (size_t i = 0; i < UI_MAX_TABS && x < wd - 4; i++) {
+        if (!m->tabs[i].open) continue;
+        char label[80];
+        int n = snprintf(label, sizeof label, " %zu:%s ", i + 1u, m->tabs[i].name);
+        if (n < 0) continue;
+        if (&m->tabs[i] == m->tab) wattron(w, A_REVERSE);
+        mvwprintw(w, 0, x, "%.*s", wd - 2 - x, label);
+        if (&m->tabs[i] == m->tab) wattroff(w, A_REVERSE);
+        x += n + 1;
+    }
+    wnoutrefresh(w);
+}
+
+/* a formatter of the rows of a view, into a line of LINE_WIDTH bytes. */
+typedef void (*row_format_t)(ui_model_t* m, size_t row, char* line);
+
+/* a getter of the address of a row of a view. */
+typedef bool (*row_address_t)(ui_model_t* m, size_t row, uint64_t* address);
+
+/**
+ * @brief copy the line of a row out of the line cache, formatting it into the cache first if it
+ *  isn't there.
+ *
+ * @param m the ui model.
+ * @param key the key of the line in the current view (an address, or the row).
+ * @param row the row, for the formatter.
+ * @param format the formatter of the current view.
+ * @param line the buffer of LINE_WIDTH bytes to copy it into.
+ */
+internal void
+line_fetch(ui_model_t* m, uint64_t key, size_t row, row_format_t format, char* line) {
+    const char* cached = line_cache_get(m->lines, m->tab->view_mode, key);
+    if (!cached) {
+        char* slot = line_cache_put(m->lines, m->tab->view_mode, key);
+        slot[0] = '\0';
+        format(m, row, slot);
+        cached = slot;
+    }
+    memcpy(line, cached, LINE_WIDTH);
+}
+
+/**
+ * @brief fetch rows [first, first + count) of a view whose lines are keyed by row.
+ *
+ * @param m the ui model.
+ * @param first the first row.
+ * @param count the number of rows wanted.
+ * @param lines the buffers to format them into.
+ * @param total the number of rows of the view.
+ * @param format the formatter of the view.
+ * @return the number of rows fetched.
+ */
+internal size_t
+fetch_rows(ui_model_t* m, size_t first, size_t count, char (*lines)[LINE_WIDTH], size_t total, \
+    row_format_t format) {
+    if (first >= total) return 0u;
+    if (count > total - first) count = total - first;
+    for (size_t i = 0; i < count; i++) line_fetch(m, first + i, first + i, format, lines[i]);
+    return count;
+}
+
+/**
+ * @brief find the row of a view at an address, or else the closest after it, by going through
+ *  every row; only if its address index could not be built.
+ *
+ * @param m the ui model.
+ * @param target the address.
+ * @param total the number of rows of the view.
+ * @param address the address getter of the view.
+ * @return -1 if no row lies at or after the address, the row o.w.
+ */
+internal ssize_t
+scan_row(ui_model_t* m, uint64_t target, size_t total, row_address_t address) {
+    ssize_t best = -1;
+    uint64_t closest = UINT64_MAX;
+    for (size_t row = 0; row < total; row++) {
+        uint64_t at = 0u;
+        if (!address(m, row, &at) || at < target || at >= closest) continue;
+        best = (ssize_t) row;
+        closest = at;
+        if (at == target) break;
+    }
+    return best;
+}
+
+/**
+ * @brief compare two row keys by address, then by row, for qsort.
+ *
+ * @param a the first key.
+ * @param b the second key.
+ * @return < 0, 0, or > 0.
+ */
+internal int
+row_key_compare(const void* a, const void* b) {
+    const ui_row_key_t* x = a, *y = b;
+    if (x->address != y->address) return x->address < y->address ? -1 : 1;
+    return (x->row > y->row) - (x->row < y->row);
+}
+
+/**
+ * @brief drop the address index of a tab if it was built for a view whose rows are replaced.
+ *
+ * @param tab the tab.
+ * @param view the view.
+ */
+internal void
+rows_forget(ui_tab_t* tab, ui_view_mode_t view) {
+    if (!tab->rows.built || tab->rows.view != view) return;
+    free(tab->rows.keys);
+    memset(&tab->rows, 0, sizeof tab->rows);
+}
+
+/**
+ * @brief find the row of a view at an address, or else the closest after it, with a binary
+ *  search over the address index of the tab (built over every row first, if it is for another
+ *  view).
+ *
+ * @param m the ui model.
+ * @param view the view.
+ * @param target the address.
+ * @param total the number of rows of the view.
+ * @param address the address getter of the view.
+ * @return -1 if no row lies at or after the address, the row o.w.
+ */
+internal ssize_t
+index_row(ui_model_t* m, ui_view_mode_t view, uint64_t target, size_t total, row_address_t address) {
+    ui_row_index_t* index = &m->tab->rows;
+    if (!index->built || index->view != view || index->total != total) {
+        free(index->keys);
+        memset(index, 0, sizeof *index);
+        ui_row_key_t* keys = total ? malloc(total * sizeof *keys) : 0x0;
+        if (total && !keys) {
+            fprintf(stderr, "lzd, index_row; malloc failed; could not allocate memory for index.\n");
+            return scan_row(m, target, total, address);
+        }
+        size_t count = 0u;
+        for (size_t row = 0; row < total; row++)
+            if (address(m, row, &keys[count].address)) keys[count++].row = row;
+        qsort(keys, count, sizeof *keys, row_key_compare);
+        *index = (ui_row_index_t){ keys, count, total, view, true };
+    }
+
+    /* the first key at or after the address, the lowest row of the closest address. */
+    size_t lo = 0u, hi = index->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2u;
+        if (index->keys[mid].address < target) lo = mid + 1u;
+        else hi = mid;
+    }
+    return lo < index->count ? (ssize_t) index->keys[lo].row : -1;
+}
+
+/**
+ * @brief format the instruction at a row, an instruction that is decoded.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param line the buffer to format into.
+ */
+internal void
+format_insn(ui_model_t* m, size_t row, char* line) {
+    ux_insn_t insn;
+    if (insn_store_at(m->tab->instructions, row, &insn) == 0)
+        ux_format_insn(&insn, m->tab->symbols, line, LINE_WIDTH);
+}
+
+/**
+ * @brief format the string at a row.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param line the buffer to format into.
+ */
+internal void
+format_string(ui_model_t* m, size_t row, char* line) {
+    const strs_entry_t* entry = &m->tab->strings->entries[row];
+    char text[LINE_WIDTH - 32u]; /* leaves room for the address. */
+    strs_format(m->tab->strings, row, text, sizeof text);
+    if (entry->vaddr) snprintf(line, LINE_WIDTH, "%p:\t%s", (void*) (entry->vaddr), text);
+    else snprintf(line, LINE_WIDTH, "(file+%#lx):\t%s", (unsigned long) entry->offset, text);
+}
+
+/**
+ * @brief format the symbol at a row.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param line the buffer to format into.
+ */
+internal void
+format_symbol(ui_model_t* m, size_t row, char* line) {
+    const elf_symbol_t* sym = &m->tab->symbols->symbols[row];
+    if (sym->value) snprintf(line, LINE_WIDTH, "%p:\t%s", (void*) (sym->value), sym->name);
+    else snprintf(line, LINE_WIDTH, "(lib./ext.):\t%s", sym->name);
+}
+
+/**
+ * @brief format the reference at a row, with the referring instruction as it is shown in the
+ *  instructions view.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param line the buffer to format into.
+ */
+internal void
+format_xref(ui_model_t* m, size_t row, char* line) {
+    const xref_hit_t* ref = &m->tab->refs[row];
+    static const char* kinds[] = { "jump", "call", "data" };
+    const char* kind = ref->kind <= INSN_XREF_DATA ? kinds[ref->kind] : "?";
+    ssize_t at = insn_store_find(m->tab->instructions, ref->from);
+    ux_insn_t from;
+    char text[LINE_WIDTH - 64u]; /* leaves room for the kind and the symbol. */
+    if (at < 0 || insn_store_at(m->tab->instructions, (size_t) at, &from) != 0 || \
+        from.address != ref->from)
+        snprintf(text, sizeof text, "0x%08lx:  (not decoded)", ref->from);
+    else ux_format_insn(&from, m->tab->symbols, text, sizeof text);
+    uint64_t into = 0u;
+    const elf_symbol_t* symbol = syms_at(m->tab->symbols, ref->from, &into);
+    if (symbol) snprintf(line, LINE_WIDTH, "%s  %s  ; in %s+%#lx", kind, text, symbol->name, into);
+    else snprintf(line, LINE_WIDTH, "%s  %s", kind, text);
+}
+
+/**
+ * @brief format the hit of the last find at a row.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param line the buffer to format into.
+ */
+internal void
+format_find(ui_model_t* m, size_t row, char* line) {
+    const srch_hit_t* hit = &m->tab->finds[row];
+    char text[LINE_WIDTH - 64u]; /* leaves room for the kind and the symbol. */
+    switch (hit->kind) {
+        case SRCH_HIT_SYMBOL: {
+            if (!m->tab->symbols || hit->index >= m->tab->symbols->count) break;
+            const elf_symbol_t* sym = &m->tab->symbols->symbols[hit->index];
+            if (sym->value) snprintf(line, LINE_WIDTH, "sym    %p:\t%s", (void*) (sym->value), sym->name);
+            else snprintf(line, LINE_WIDTH, "sym    (lib./ext.):\t%s", sym->name);
+            break;
+        }
+        case SRCH_HIT_STRING: {
+            if (!m->tab->strings || hit->index >= m->tab->strings->count) break;
+            const strs_entry_t* entry = &m->tab->strings->entries[hit->index];
+            strs_format(m->tab->strings, hit->index, text, sizeof text);
+            if (entry->vaddr) snprintf(line, LINE_WIDTH, "str    %p:\t%s", (void*) (entry->vaddr), text);
+            else snprintf(line, LINE_WIDTH, "str    (file+%#lx):\t%s", (unsigned long) entry->offset, text);
+            break;
+        }
+        default: {
+            /* the instruction at the hit as it is shown in the instructions view, a byte
+             *  pattern may start inside of one (or in code that isn't decoded yet). */
+            ssize_t at = insn_store_find(m->tab->instructions, hit->address);
+            ux_insn_t found;
+            if (at < 0 || insn_store_at(m->tab->instructions, (size_t) at, &found) != 0 || \
+                found.address != hit->address)
+                snprintf(text, sizeof text, "0x%08lx:", hit->address);
+            else ux_format_insn(&found, m->tab->symbols, text, sizeof text);
+            uint64_t into = 0u;
+            const elf_symbol_t* symbol = syms_at(m->tab->symbols, hit->address, &into);
+            const char* kind = hit->kind == SRCH_HIT_INSN ? "insn " : "bytes";
+            if (symbol) snprintf(line, LINE_WIDTH, "%s  %s  ; in %s+%#lx", kind, text, symbol->name, into);
+            else snprintf(line, LINE_WIDTH, "%s  %s", kind, text);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief format the function that changed (or was added, or removed) at a row of the diff.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param line the buffer to format into.
+ */
+internal void
+format_diff(ui_model_t* m, size_t row, char* line) {
+    const diff_entry_t* entry = &m->tab->diff->entries[row];
+    const char* name = m->tab->diff->names + entry->name;
+    switch (entry->kind) {
+        case DIFF_CHANGED:
+            snprintf(line, LINE_WIDTH, "~  0x%08lx (%5lu)  ->  0x%08lx (%5lu)  %s", entry->old_address, \
+                entry->old_size, entry->new_address, entry->new_size, name);
+            break;
+        case DIFF_ADDED:
+            snprintf(line, LINE_WIDTH, "+  %-20s  ->  0x%08lx (%5lu)  %s", "", entry->new_address, \
+                entry->new_size, name);
+            break;
+        default:
+            snprintf(line, LINE_WIDTH, "-  0x%08lx (%5lu)  ->  %-20s  %s", entry->old_address, \
+                entry->old_size, "", name);
+            break;
+    }
+}
+
+/* the instructions view, straight out of the (chunked, lazily decoded) store; lines are keyed by
+ *  address, so they stay cached while placeholders in front of them get decoded. */
+/**
+ * @brief get the number of rows of the instructions view.
+ *
+ * @param m the ui model.
+ * @return the number of rows.
+ */
+internal size_t
+insns_count(ui_model_t* m) { return m->tab->instructions ? m->tab->instructions->rows : 0u; }
+
+/**
+ * @brief fetch rows [first, first + count) of the instructions view.
+ *
+ * @param m the ui model.
+ * @param first the first row.
+ * @param count the number of rows wanted.
+ * @param lines the buffers to format them into.
+ * @return the number of rows fetched.
+ */
+internal size_t
+insns_fetch(ui_model_t* m, size_t first, size_t count, char (*lines)[LINE_WIDTH]) {
+    size_t fetched = 0u;
+    for (; fetched < count; fetched++) {
+        ux_insn_t insn;
+        ssize_t state = insn_store_at(m->tab->instructions, first + fetched, &insn);
+        if (state < 0) break;
+        if (state > 0) snprintf(lines[fetched], LINE_WIDTH, "..."); /* its chunk is still being decoded. */
+        else line_fetch(m, insn.address, first + fetched, format_insn, lines[fetched]);
     }
-    wrefresh(w);
+    return fetched;
+}
+
+/**
+ * @brief get the address of a row of the instructions view.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param address output for the address.
+ * @return true if the row has an address, false o.w.
+ */
+internal bool
+insns_address(ui_model_t* m, size_t row, uint64_t* address) {
+    ux_insn_t insn;
+    if (insn_store_at(m->tab->instructions, row, &insn) < 0) return false;
+    *address = insn.address;
+    return true;
+}
+
+/**
+ * @brief find the row of the instructions view at an address, or else the closest after it.
+ *
+ * @param m the ui model.
+ * @param address the address.
+ * @return -1 if there is none, the row o.w.
+ */
+internal ssize_t
+insns_row(ui_model_t* m, uint64_t address) { return insn_store_find(m->tab->instructions, address); }
+
+/* the strings view. */
+/**
+ * @brief get the number of rows of the strings view.
+ *
+ * @param m the ui model.
+ * @return the number of rows.
+ */
+internal size_t
+strings_count(ui_model_t* m) { return m->tab->strings ? m->tab->strings->count : 0u; }
+
+/**
+ * @brief fetch rows [first, first + count) of the strings view.
+ *
+ * @param m the ui model.
+ * @param first the first row.
+ * @param count the number of rows wanted.
+ * @param lines the buffers to format them into.
+ * @return the number of rows fetched.
+ */
+internal size_t
+strings_fetch(ui_model_t* m, size_t first, size_t count, char (*lines)[LINE_WIDTH]) {
+    return fetch_rows(m, first, count, lines, strings_count(m), format_string);
+}
+
+/**
+ * @brief get the address of a row of the strings view.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param address output for the address.
+ * @return true if the row has an address, false o.w.
+ */
+internal bool
+strings_address(ui_model_t* m, size_t row, uint64_t* address) {
+    if (row >= strings_count(m) || !m->tab->strings->entries[row].vaddr) return false;
+    *address = m->tab->strings->entries[row].vaddr;
+    return true;
+}
+
+/**
+ * @brief find the row of the strings view at an address, or else the closest after it.
+ *
+ * @param m the ui model.
+ * @param address the address.
+ * @return -1 if there is none, the row o.w.
+ */
+internal ssize_t
+strings_row(ui_model_t* m, uint64_t address) {
+    return index_row(m, UI_VIEW_STRINGS, address, strings_count(m), strings_address);
+}
+
+/* the symbols view, an address inside of a symbol goes to that symbol. */
+/**
+ * @brief get the number of rows of the symbols view.
+ *
+ * @param m the ui model.
+ * @return the number of rows.
+ */
+internal size_t
+symbols_count(ui_model_t* m) { return m->tab->symbols ? m->tab->symbols->count : 0u; }
+
+/**
+ * @brief fetch rows [first, first + count) of the symbols view.
+ *
+ * @param m the ui model.
+ * @param first the first row.
+ * @param count the number of rows wanted.
+ * @param lines the buffers to format them into.
+ * @return the number of rows fetched.
+ */
+internal size_t
+symbols_fetch(ui_model_t* m, size_t first, size_t count, char (*lines)[LINE_WIDTH]) {
+    return fetch_rows(m, first, count, lines, symbols_count(m), format_symbol);
+}
+
+/**
+ * @brief get the address of a row of the symbols view.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param address output for the address.
+ * @return true if the row has an address, false o.w.
+ */
+internal bool
+symbols_address(ui_model_t* m, size_t row, uint64_t* address) {
+    if (row >= symbols_count(m) || !m->tab->symbols->symbols[row].value) return false;
+    *address = m->tab->symbols->symbols[row].value;
+    return true;
+}
+
+/**
+ * @brief find the row of the symbols view at an address, or else the closest after it.
+ *
+ * @param m the ui model.
+ * @param address the address.
+ * @return -1 if there is none, the row o.w.
+ */
+internal ssize_t
+symbols_row(ui_model_t* m, uint64_t address) {
+    const elf_symbol_t* symbol = syms_at(m->tab->symbols, address, 0x0);
+    if (symbol) return symbol - m->tab->symbols->symbols;
+    return index_row(m, UI_VIEW_SYMBOLS, address, symbols_count(m), symbols_address);
+}
+
+/* the xrefs view, a reference is at the instruction it is made from. */
+/**
+ * @brief get the number of rows of the xrefs view.
+ *
+ * @param m the ui model.
+ * @return the number of rows.
+ */
+internal size_t
+xrefs_count(ui_model_t* m) { return m->tab->refs ? m->tab->ref_count : 0u; }
+
+/**
+ * @brief fetch rows [first, first + count) of the xrefs view.
+ *
+ * @param m the ui model.
+ * @param first the first row.
+ * @param count the number of rows wanted.
+ * @param lines the buffers to format them into.
+ * @return the number of rows fetched.
+ */
+internal size_t
+xrefs_fetch(ui_model_t* m, size_t first, size_t count, char (*lines)[LINE_WIDTH]) {
+    return fetch_rows(m, first, count, lines, xrefs_count(m), format_xref);
+}
+
+/**
+ * @brief get the address of a row of the xrefs view.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param address output for the address.
+ * @return true if the row has an address, false o.w.
+ */
+internal bool
+xrefs_address(ui_model_t* m, size_t row, uint64_t* address) {
+    if (row >= xrefs_count(m)) return false;
+    *address = m->tab->refs[row].from;
+    return true;
+}
+
+/**
+ * @brief find the row of the xrefs view at an address, or else the closest after it.
+ *
+ * @param m the ui model.
+ * @param address the address.
+ * @return -1 if there is none, the row o.w.
+ */
+internal ssize_t
+xrefs_row(ui_model_t* m, uint64_t address) {
+    return index_row(m, UI_VIEW_XREFS, address, xrefs_count(m), xrefs_address);
+}
+
+/* the find view, a hit is at the symbol, string or instruction (or bytes) it found. */
+/**
+ * @brief get the number of rows of the find view.
+ *
+ * @param m the ui model.
+ * @return the number of rows.
+ */
+internal size_t
+finds_count(ui_model_t* m) { return m->tab->finds ? m->tab->find_count : 0u; }
+
+/**
+ * @brief fetch rows [first, first + count) of the find view.
+ *
+ * @param m the ui model.
+ * @param first the first row.
+ * @param count the number of rows wanted.
+ * @param lines the buffers to format them into.
+ * @return the number of rows fetched.
+ */
+internal size_t
+finds_fetch(ui_model_t* m, size_t first, size_t count, char (*lines)[LINE_WIDTH]) {
+    return fetch_rows(m, first, count, lines, finds_count(m), format_find);
+}
+
+/**
+ * @brief get the address of a row of the find view.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param address output for the address.
+ * @return true if the row has an address, false o.w.
+ */
+internal bool
+finds_address(ui_model_t* m, size_t row, uint64_t* address) {
+    if (row >= finds_count(m)) return false;
+    const srch_hit_t* hit = &m->tab->finds[row];
+    if (hit->kind == SRCH_HIT_SYMBOL)
+        return hit->index < symbols_count(m) && symbols_address(m, hit->index, address);
+    if (hit->kind == SRCH_HIT_STRING)
+        return hit->index < strings_count(m) && strings_address(m, hit->index, address);
+    *address = hit->address;
+    return true;
+}
+
+/**
+ * @brief find the row of the find view at an address, or else the closest after it.
+ *
+ * @param m the ui model.
+ * @param address the address.
+ * @return -1 if there is none, the row o.w.
+ */
+internal ssize_t
+finds_row(ui_model_t* m, uint64_t address) {
+    return index_row(m, UI_VIEW_FIND, address, finds_count(m), finds_address);
+}
+
+/* the stats view, formatted out of the latest snapshot every frame instead of cached. */
+/**
+ * @brief get the number of rows of the stats view.
+ *
+ * @param m the ui model.
+ * @return the number of rows.
+ */
+internal size_t
+stats_count(ui_model_t* m) { (void) m; return STAT_ROWS; }
+
+/**
+ * @brief fetch rows [first, first + count) of the stats view.
+ *
+ * @param m the ui model.
+ * @param first the first row.
+ * @param count the number of rows wanted.
+ * @param lines the buffers to format them into.
+ * @return the number of rows fetched.
+ */
+internal size_t
+stats_fetch(ui_model_t* m, size_t first, size_t count, char (*lines)[LINE_WIDTH]) {
+    size_t fetched = 0u;
+    for (; fetched < count && first + fetched < STAT_ROWS; fetched++)
+        stat_format(&m->stats, &m->stats_last, first + fetched, lines[fetched], LINE_WIDTH);
+    return fetched;
+}
+
+/**
+ * @brief get the address of a row of the stats view.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param address output for the address.
+ * @return true if the row has an address, false o.w.
+ */
+internal bool
+stats_address(ui_model_t* m, size_t row, uint64_t* address) {
+    (void) m, (void) row, (void) address;
+    return false;
+}
+
+/**
+ * @brief find the row of the stats view at an address, or else the closest after it.
+ *
+ * @param m the ui model.
+ * @param address the address.
+ * @return -1 if there is none, the row o.w.
+ */
+internal ssize_t
+stats_row(ui_model_t* m, uint64_t address) {
+    (void) m, (void) address;
+    return -1;
 }
 
+/* the diff view, a changed or added function is at its address in this binary. */
 /**
- * @brief draw the instruction list section of the ui.
+ * @brief get the number of rows of the diff view.
+ *
+ * @param m the ui model.
+ * @return the number of rows.
+ */
+internal size_t
+diffs_count(ui_model_t* m) { return m->tab->diff ? m->tab->diff->count : 0u; }
+
+/**
+ * @brief fetch rows [first, first + count) of the diff view.
+ *
+ * @param m the ui model.
+ * @param first the first row.
+ * @param count the number of rows wanted.
+ * @param lines the buffers to format them into.
+ * @return the number of rows fetched.
+ */
+internal size_t
+diffs_fetch(ui_model_t* m, size_t first, size_t count, char (*lines)[LINE_WIDTH]) {
+    return fetch_rows(m, first, count, lines, diffs_count(m), format_diff);
+}
+
+/**
+ * @brief get the address of a row of the diff view, a removed function has none in this binary.
+ *
+ * @param m the ui model.
+ * @param row the row.
+ * @param address output for the address.
+ * @return true if the row has an address, false o.w.
+ */
+internal bool
+diffs_address(ui_model_t* m, size_t row, uint64_t* address) {
+    if (row >= diffs_count(m) || m->tab->diff->entries[row].kind == DIFF_REMOVED) return false;
+    *address = m->tab->diff->entries[row].new_address;
+    return true;
+}
+
+/**
+ * @brief find the row of the diff view at an address, or else the closest after it.
+ *
+ * @param m the ui model.
+ * @param address the address.
+ * @return -1 if there is none, the row o.w.
+ */
+internal ssize_t
+diffs_row(ui_model_t* m, uint64_t address) {
+    return index_row(m, UI_VIEW_DIFF, address, diffs_count(m), diffs_address);
+}
+
+/* the row provider of every view, by view mode. */
+static const ui_rows_t g_rows[UI_VIEW_COUNT] = {
+    [UI_VIEW_INSTRUCTIONS] = { insns_count, insns_fetch, insns_address, insns_row },
+    [UI_VIEW_STRINGS] = { strings_count, strings_fetch, strings_address, strings_row },
+    [UI_VIEW_SYMBOLS] = { symbols_count, symbols_fetch, symbols_address, symbols_row },
+    [UI_VIEW_XREFS] = { xrefs_count, xrefs_fetch, xrefs_address, xrefs_row },
+    [UI_VIEW_FIND] = { finds_count, finds_fetch, finds_address, finds_row },
+    [UI_VIEW_STATS] = { stats_count, stats_fetch, stats_address, stats_row },
+    [UI_VIEW_DIFF] = { diffs_count, diffs_fetch, diffs_address, diffs_row },
+};
+
+/**
+ * @brief draw the instruction list section of the ui; only the visible rows are fetched from
+ *  the row provider of the view, so a frame costs the same at any row count.
  *
  * @param w the window.
  * @param m the ui model.
@@ -94,59 +870,66 @@ draw_list(WINDOW* w, ui_model_t* m) {
     int inner_h = h - 2;
     int inner_w = wd - 2;
 
-    /* lock for thread safety. */
-    pthread_mutex_lock(&m->lock);
-
-    /* determine what to display based on view mode. */
-    dyna_t* items = (m->view_mode == UI_VIEW_STRINGS) ? m->strings : m->view_mode == UI_VIEW_SYMBOLS ? \
-        m->symbols : m->instructions;
-    ssize_t item_count = items ? items->length : 0;
-    const char* view_name = (m->view_mode == UI_VIEW_STRINGS) ? "strings" : \
-        m->view_mode == UI_VIEW_SYMBOLS ? "symbols" : "instructions";
+    /* the model is only written on this thread, so it is read without the lock; rows are
+     *  counted in ssize_t, a view may have more of them than an int holds. */
+    const ui_rows_t* rows = ui_model_provider(m);
+    ssize_t item_count = (ssize_t) rows->count(m), page = inner_h > 1 ? inner_h : 1;
+    const char* view_name = view_label(m->tab->view_mode);
+    m->page = (size_t) page;
 
     /* keep scroll/selected sane. */
-    m->selected = clampi((int)m->selected, 0, (int)(item_count > 0 ? item_count - 1 : 0));
-    m->scroll = clampi((int)m->scroll, 0, (int)(item_count > inner_h ? item_count - inner_h : 0));
+    m->tab->selected = clampz(m->tab->selected, 0, item_count > 0 ? item_count - 1 : 0);
+    m->tab->scroll = clampz(m->tab->scroll, 0, item_count > page ? item_count - page : 0);
 
     /* ensure selected is visible. */
-    if (m->selected < m->scroll) m->scroll = m->selected;
-    if (m->selected >= m->scroll + inner_h) m->scroll = m->selected - inner_h + 1;
-
-    /* header label. */
-    mvwprintw(w, 0, 2, " %s (%zd) ", view_name, item_count);
-
-    /* draw visible items. */
-    for (int row = 0; row < inner_h; row++) {
-        ssize_t idx = m->scroll + row;
-        if (idx >= item_count) break;
-
-        int sel = (idx == m->selected);
-        if (sel) wattron(w, A_REVERSE);
-
-        /* get item based on view mode. */
-        const char* s = "";
-        if (m->view_mode == UI_VIEW_STRINGS || m->view_mode == UI_VIEW_SYMBOLS) {
-            char* str = _get(items, char*, idx);
-            s = str ? str : "";
-        } else {
-            ux_insn_t* insn = _get(items, ux_insn_t*, idx);
-            s = (insn && insn->full_string) ? insn->full_string : "";
-        }
-        mvwprintw(w, 1 + row, 1, " %.*s", inner_w - 2, s);
+    if (m->tab->selected < m->tab->scroll) m->tab->scroll = m->tab->selected;
+    if (m->tab->selected >= m->tab->scroll + page) m->tab->scroll = m->tab->selected - page + 1;
 
-        if (sel) wattroff(w, A_REVERSE);
+    /* lazily decode what is (about to be) on screen. */
+    if (m->tab->view_mode == UI_VIEW_INSTRUCTIONS) {
+        int direction = m->tab->scroll > m->tab->drawn_scroll ? 1 : m->tab->scroll < m->tab->drawn_scroll ? -1 : 0;
+        stat_lock(&m->lock);
+        ux_request_rows(m, (size_t) m->tab->scroll, (size_t) page, direction);
+        pthread_mutex_unlock(&m->lock);
+        m->tab->drawn_scroll = m->tab->scroll;
     }
 
-    /* scrollbar-ish marker. */
-    if (item_count > inner_h) {
-        int bar_h = inner_h;
-        int pos = (int)((long long)m->scroll * bar_h / (item_count - inner_h));
-        pos = clampi(pos, 0, bar_h - 1);
-        mvwaddch(w, 1 + pos, wd - 2, ACS_CKBOARD);
+    /* header label, the row count is an estimate while placeholders are left; instructions
+     *  also say which symbol the selected one is in. */
+    bool estimate = m->tab->view_mode == UI_VIEW_INSTRUCTIONS && m->tab->instructions->pending > 0u;
+    char where[128u] = { 0 };
+    ux_insn_t at;
+    uint64_t into = 0u;
+    const elf_symbol_t* symbol = m->tab->view_mode == UI_VIEW_INSTRUCTIONS && \
+        insn_store_at(m->tab->instructions, (size_t) m->tab->selected, &at) == 0 ? \
+        syms_at(m->tab->symbols, at.address, &into) : 0x0;
+    if (symbol && into) snprintf(where, sizeof where, " in %s+%#lx", symbol->name, into);
+    else if (symbol) snprintf(where, sizeof where, " in %s", symbol->name);
+    mvwprintw(w, 0, 2, " %s (%s%zd)%.*s ", view_name, estimate ? "~" : "", item_count, \
+        inner_w > 32 ? inner_w - 32 : 0, where);
+
+    /* draw the visible rows, fetched FETCH_ROWS at a time. */
+    char lines[FETCH_ROWS][LINE_WIDTH];
+    for (int row = 0; row < inner_h;) {
+        size_t want = (size_t) (inner_h - row) < FETCH_ROWS ? (size_t) (inner_h - row) : FETCH_ROWS;
+        size_t got = rows->fetch(m, (size_t) (m->tab->scroll + row), want, lines);
+        for (size_t i = 0; i < got; i++, row++) {
+            int sel = (m->tab->scroll + row == m->tab->selected);
+            if (sel) wattron(w, A_REVERSE);
+            mvwprintw(w, 1 + row, 1, " %.*s", inner_w - 2, lines[i]);
+            if (sel) wattroff(w, A_REVERSE);
+        }
+        if (got < want) break;
     }
 
-    pthread_mutex_unlock(&m->lock);
-    wrefresh(w);
+    /* scrollbar, its thumb covers the share of the rows that is visible, at where they are. */
+    if (item_count > page) {
+        uint64_t thumb = (uint64_t) page * (uint64_t) page / (uint64_t) item_count;
+        if (thumb == 0u) thumb = 1u;
+        uint64_t pos = (uint64_t) m->tab->scroll * ((uint64_t) page - thumb) / (uint64_t) (item_count - page);
+        for (uint64_t i = 0; i < thumb; i++) mvwaddch(w, 1 + (int) (pos + i), wd - 2, ACS_CKBOARD);
+    }
+    wnoutrefresh(w);
 }
 
 /**
@@ -181,7 +964,7 @@ draw_footer(WINDOW* w, ui_model_t* m) {
     int curx = 3 + (int)strnlen(m->cmd, sizeof(m->cmd) - 1);
     curx = clampi(curx, 3, wd - 2);
     wmove(w, 2, curx);
-    wrefresh(w);
+    wnoutrefresh(w);
 }
 
 /**
@@ -202,11 +985,74 @@ layout(int term_h, int term_w, int* hdr_h, int* ftr_h, int* lst_h) {
     if (*lst_h < 3) *lst_h = 3;
 }
 
+/**
+ * @brief set up an empty tab in a slot, with a store and indices of its own.
+ *
+ * @param tab the tab, its slot is free.
+ * @param name the name shown in the tab bar.
+ * @param subtitle the subtitle.
+ * @return -1 if a failure occurs (and the slot stays free), 0 o.w.
+ */
+internal ssize_t
+tab_init(ui_tab_t* tab, const char* name, const char* subtitle) {
+    tab->instructions = insn_store_create();
+    tab->xrefs = xref_index_create();
+    tab->search = srch_create();
+    if (!tab->instructions || !tab->xrefs || !tab->search) {
+        fprintf(stderr, "lzd, tab_init; calloc failed; could not allocate memory for tab.\n");
+        insn_store_free(tab->instructions);
+        xref_index_free(tab->xrefs);
+        srch_free(tab->search);
+        memset(tab, 0, sizeof *tab);
+        return -1;
+    }
+    snprintf(tab->name, sizeof tab->name, "%s", name ? name : "");
+    snprintf(tab->subtitle, sizeof tab->subtitle, "%s", subtitle ? subtitle : "");
+    atomic_init(&tab->owner, 0x0);
+    tab->view_mode = UI_VIEW_INSTRUCTIONS;
+    tab->open = true;
+    return 0;
+}
+
+/**
+ * @brief free everything in a tab, and leave its slot free.
+ *
+ * @param tab the tab.
+ */
+internal void
+tab_free(ui_tab_t* tab) {
+    if (!tab->open) return;
+    insn_store_free(tab->instructions);
+    strs_free(tab->strings);
+    syms_free(tab->symbols);
+    xref_index_free(tab->xrefs);
+    free(tab->refs);
+    srch_free(tab->search);
+    free(tab->finds);
+    diff_free(tab->diff);
+    free(tab->rows.keys);
+    memset(tab, 0, sizeof *tab);
+}
+
+/**
+ * @brief find the tab the pages of a binary go to.
+ *
+ * @param model the ui model.
+ * @param owner the token of the binary.
+ * @return the tab if there is one, 0x0 o.w.
+ */
+internal ui_tab_t*
+tab_of(ui_model_t* model, const void* owner) {
+    for (size_t i = 0; owner && i < UI_MAX_TABS; i++)
+        if (atomic_load(&model->tabs[i].owner) == owner) return &model->tabs[i];
+    return 0x0;
+}
+
 /**
  * @brief create a new ui model.
  *
  * @param title the title string (will be copied).
- * @param subtitle the subtitle string (will be copied).
+ * @param subtitle the subtitle string of the first tab (will be copied).
  * @return a pointer to an allocated ui model if successful, 0x0 o.w.
  */
 ui_model_t*
@@ -217,23 +1063,25 @@ ui_model_create(const char* title, const char* subtitle) {
         return 0x0;
     }
 
-    /* copy title and subtitle. */
+    /* copy title, the subtitle goes to the first tab (an empty one until something is opened). */
     if (title) {
         model->title = calloc(1u, strlen(title) + 1);
         strncpy(model->title, title, strlen(title));
     }
-    if (subtitle) {
-        size_t n = strlen(subtitle);
-        if (n > 256u) n = 256u;
-        model->subtitle = calloc(1u, 256u + 1u);
-        strncpy(model->subtitle, subtitle, n);
+    if (tab_init(&model->tabs[0], "-", subtitle) != 0) {
+        free(model->title);
+        free(model);
+        return 0x0;
     }
+    model->tab = &model->tabs[0];
 
-    /* initialize dynamic arrays. */
-    model->instructions = dyna_create();
-    model->strings = dyna_create();
-    model->symbols = dyna_create();
-    model->view_mode = UI_VIEW_INSTRUCTIONS;
+    /* initialize the line cache and the inbox. */
+    model->lines = line_cache_create(512u);
+    model->dirty = UI_DIRTY_ALL;
+    model->wakeup = eventfd(0u, EFD_NONBLOCK | EFD_CLOEXEC);
+    msgq_init(&model->inbox);
+    if (model->wakeup < 0)
+        fprintf(stderr, "lzd, ui_model_create; eventfd failed; decoded chunks show up on the next key.\n");
     pthread_mutex_init(&model->lock, 0x0);
     return model;
 }
@@ -248,102 +1096,445 @@ ui_model_free(ui_model_t* model) {
     if (!model) return;
 
     free(model->title);
-    free(model->subtitle);
-
-    /* free all instructions and their strings. */
-    if (model->instructions) {
-        _foreach(model->instructions, ux_insn_t*, insn)
-            free(insn->full_string);
-            free(insn);
-        _endforeach;
-        dyna_free(model->instructions);
+
+    /* messages nobody drained, the workers are done by now. */
+    for (msgq_node_t* node = msgq_pop(&model->inbox); node; node = msgq_pop(&model->inbox))
+        msg_free(node);
+
+    /* free every tab, with its instructions, strings and symbols. */
+    for (size_t i = 0; i < UI_MAX_TABS; i++) tab_free(&model->tabs[i]);
+    line_cache_free(model->lines);
+    if (model->wakeup >= 0) close(model->wakeup);
+    pthread_mutex_destroy(&model->lock);
+    free(model);
+}
+
+/**
+ * @brief install a chunk into the store of a tab, keeping the selected row of the active one
+ *  where it is on screen; on the ui thread, the indices have it already.
+ *
+ * @param model the ui model.
+ * @param tab the tab.
+ * @param chunk the sealed chunk of instructions (ownership is taken).
+ */
+internal void
+model_install(ui_model_t* model, ui_tab_t* tab, insn_chunk_t* chunk) {
+    stat_lock(&model->lock);
+
+    /* remember what is selected, rows before it may grow or shrink when the chunk lands. */
+    ux_insn_t anchor;
+    bool anchored = tab->view_mode == UI_VIEW_INSTRUCTIONS && \
+        insn_store_at(tab->instructions, (size_t) tab->selected, &anchor) >= 0;
+    ssize_t offset = tab->selected - tab->scroll;
+    if (tab->goto_pending && tab->view_mode == UI_VIEW_INSTRUCTIONS && \
+        tab->goto_address >= chunk->base && tab->goto_address < chunk->base + chunk->length) {
+        anchor.address = tab->goto_address;
+        anchored = true;
+        tab->goto_pending = false;
     }
+    if (insn_store_insert(tab->instructions, chunk) != 0)
+        insn_chunk_free(chunk);
 
-    /* free all strings. */
-    if (model->strings) {
-        dyna_free(model->strings);
+    /* keep the same address selected, at the same spot on screen. */
+    ssize_t row = anchored ? insn_store_find(tab->instructions, anchor.address) : -1;
+    if (row >= 0) {
+        tab->selected = row;
+        tab->scroll = row - offset < 0 ? 0 : row - offset;
+        tab->drawn_scroll = tab->scroll;
     }
-    if (model->symbols) {
-        dyna_free(model->symbols);
+    pthread_mutex_unlock(&model->lock);
+    if (tab == model->tab) model->dirty |= UI_DIRTY_LIST;
+}
+
+/**
+ * @brief put a placeholder whose job went stale back to pending, unless it was requested again
+ *  since; on the ui thread. the viewport requests it again if it is still around.
+ *
+ * @param model the ui model.
+ * @param tab the tab.
+ * @param base the base address of the placeholder.
+ * @param generation the generation the stale job was posted in.
+ */
+internal void
+model_unrequest(ui_model_t* model, ui_tab_t* tab, uint64_t base, uint64_t generation) {
+    stat_lock(&model->lock);
+    ssize_t at = insn_store_index(tab->instructions, base);
+    insn_chunk_t* chunk = at >= 0 ? tab->instructions->chunks[at] : 0x0;
+    if (chunk && chunk->state == INSN_CHUNK_REQUESTED && chunk->requested == generation) {
+        chunk->state = INSN_CHUNK_PENDING;
+        chunk->urgent = false;
     }
-    pthread_mutex_destroy(&model->lock);
-    free(model);
+    pthread_mutex_unlock(&model->lock);
+    if (tab == model->tab) model->dirty |= UI_DIRTY_LIST;
+}
+
+/**
+ * @brief install the hits of a find, unless another find was started since; on the ui thread.
+ *
+ * @param model the ui model.
+ * @param message the hits (freed).
+ */
+internal void
+model_install_finds(ui_model_t* model, ui_finds_msg_t* message) {
+    if (message->generation != model->find_generation) {
+        msg_free(&message->node);
+        return;
+    }
+    stat_lock(&model->lock);
+    free(model->tab->finds);
+    rows_forget(model->tab, UI_VIEW_FIND);
+    model->tab->finds = message->finds;
+    model->tab->find_count = message->finds ? message->count : 0u;
+    pthread_mutex_unlock(&model->lock);
+    line_cache_clear(model->lines);
+    snprintf(model->status, sizeof(model->status), "%s", message->status);
+    model->dirty |= UI_DIRTY_LIST | UI_DIRTY_FOOTER;
+    free(message);
+}
+
+/**
+ * @brief add a decoded chunk of instructions to a tab of the ui model, on the ui thread.
+ *
+ * @param model the ui model.
+ * @param tab the tab.
+ * @param chunk the sealed chunk of instructions (ownership is taken).
+ */
+void
+ui_model_add_insns(ui_model_t* model, ui_tab_t* tab, insn_chunk_t* chunk) {
+    if (!model || !tab || !chunk) return;
+
+    /* the references and mnemonics go into their indices first, each has a lock of its own. */
+    xref_index_add(tab->xrefs, chunk);
+    srch_add_insns(tab->search, chunk);
+    model_install(model, tab, chunk);
+}
+
+/**
+ * @brief post a message to the inbox of the ui model from any thread, without blocking; the
+ *  references and mnemonics of a page go into the indices of its tab right away (on the
+ *  calling thread), and its chunk is installed when the ui thread drains the inbox. a page of
+ *  a binary that has no tab is dropped.
+ *
+ * @param model the ui model.
+ * @param node the link of a ux_page_msg_t, ui_finds_msg_t or ui_loaded_msg_t (ownership is
+ *  taken).
+ */
+void
+ui_model_post(ui_model_t* model, msgq_node_t* node) {
+    if (!node) return;
+    ux_page_msg_t* page = node->kind == UI_MSG_PAGE ? (ux_page_msg_t*) node : 0x0;
+    ui_tab_t* tab = model && page ? tab_of(model, page->owner) : 0x0;
+    if (!model || (page && !tab)) {
+        msg_free(node);
+        return;
+    }
+
+    /* the tab stays open until every job of its binary is drained, and this one isn't yet. */
+    if (page && page->chunk) {
+        xref_index_add(tab->xrefs, page->chunk);
+        srch_add_insns(tab->search, page->chunk);
+    }
+    msgq_push(&model->inbox, node);
+    model_wake(model);
+}
+
+/**
+ * @brief install every message in the inbox of the ui model, on the ui thread.
+ *
+ * @param model the ui model.
+ * @return the number of messages installed.
+ */
+size_t
+ui_model_drain(ui_model_t* model) {
+    if (!model) return 0u;
+    size_t count = 0u;
+    for (msgq_node_t* node = msgq_pop(&model->inbox); node; node = msgq_pop(&model->inbox)) {
+        if (node->kind == UI_MSG_PAGE) {
+            ux_page_msg_t* page = (ux_page_msg_t*) node;
+            ui_tab_t* tab = tab_of(model, page->owner);
+            stat_record(STAT_HIST_POST, stat_now() - page->posted);
+            if (!tab) insn_chunk_free(page->chunk);
+            else if (page->chunk) model_install(model, tab, page->chunk);
+            else model_unrequest(model, tab, page->base, page->generation);
+            free(page);
+        } else if (node->kind == UI_MSG_LOADED) {
+            ux_loaded(model, ((ui_loaded_msg_t*) node)->binary);
+            free(node);
+        } else model_install_finds(model, (ui_finds_msg_t*) node);
+        count++;
+    }
+    return count;
 }
 
 /**
- * @brief add instructions to the ui model.
+ * @brief reserve a placeholder for a code range that is decoded lazily.
  *
  * @param model the ui model.
- * @param insns dynamic array of ux_insn_t*.
+ * @param tab the tab.
+ * @param base the base address of the code range.
+ * @param length the length of the code range.
+ * @param rows the number of rows it decodes into, 0 to estimate it.
  */
 void
-ui_model_add_insns(ui_model_t* model, dyna_t* insns) {
-    if (!model || !insns) return;
-    pthread_mutex_lock(&model->lock);
-    _foreach(insns, ux_insn_t*, insn)
-        dyna_push(model->instructions, insn);
-    _endforeach;
+ui_model_reserve(ui_model_t* model, ui_tab_t* tab, uint64_t base, size_t length, size_t rows) {
+    if (!model || !tab) return;
+    stat_lock(&model->lock);
+    insn_store_reserve(tab->instructions, base, length, rows);
     pthread_mutex_unlock(&model->lock);
+    if (tab == model->tab) model->dirty |= UI_DIRTY_LIST;
 }
 
 /**
- * @brief clear all instructions from the ui model.
+ * @brief get the number of rows in the current view.
  *
  * @param model the ui model.
+ * @return the number of rows in the current view.
+ */
+size_t
+ui_model_rows(ui_model_t* model) {
+    if (!model) return 0u;
+    return ui_model_provider(model)->count(model);
+}
+
+/**
+ * @brief get the row provider of the current view.
+ *
+ * @param model the ui model.
+ * @return the row provider.
+ */
+const ui_rows_t*
+ui_model_provider(const ui_model_t* model) {
+    return &g_rows[model && model->tab->view_mode < UI_VIEW_COUNT ? model->tab->view_mode : UI_VIEW_INSTRUCTIONS];
+}
+
+/**
+ * @brief clear all instructions (and their references, and the hits shown of them) from a tab.
+ *
+ * @param model the ui model.
+ * @param tab the tab.
+ */
+void
+ui_model_clear(ui_model_t* model, ui_tab_t* tab) {
+    if (!model || !tab) return;
+    stat_lock(&model->lock);
+    insn_store_clear(tab->instructions);
+    xref_index_clear(tab->xrefs);
+    free(tab->refs);
+    tab->refs = 0x0;
+    tab->ref_count = 0u;
+    srch_clear(tab->search);
+    free(tab->finds);
+    tab->finds = 0x0;
+    tab->find_count = 0u;
+    rows_forget(tab, UI_VIEW_XREFS);
+    rows_forget(tab, UI_VIEW_FIND);
+    tab->goto_pending = false;
+    if (tab == model->tab) line_cache_clear(model->lines);
+    pthread_mutex_unlock(&model->lock);
+}
+
+/**
+ * @brief set the strings of a tab, replacing (and freeing) the previous ones; they have to be
+ *  replaced before the image they point into is unmapped.
+ *
+ * @param model the ui model.
+ * @param tab the tab.
+ * @param strings the strings (ownership is taken), or 0x0 to remove them.
  */
 void
-ui_model_clear(ui_model_t* model) {
+ui_model_set_strings(ui_model_t* model, ui_tab_t* tab, strs_t* strings) {
+    if (!model || !tab) return;
+
+    /* the string rows are cached by index, and the indices now mean other strings. */
+    stat_lock(&model->lock);
+    strs_free(tab->strings);
+    tab->strings = strings;
+    rows_forget(tab, UI_VIEW_STRINGS);
+    rows_forget(tab, UI_VIEW_FIND);
+    srch_drop_texts(tab->search);
+    if (tab == model->tab) line_cache_clear(model->lines);
+    pthread_mutex_unlock(&model->lock);
+}
+
+/**
+ * @brief set the references shown in the xrefs view, replacing (and freeing) the previous ones.
+ *
+ * @param model the ui model.
+ * @param refs the references (ownership is taken), or 0x0 to remove them.
+ * @param count the number of references.
+ */
+void
+ui_model_set_refs(ui_model_t* model, xref_hit_t* refs, size_t count) {
     if (!model) return;
-    pthread_mutex_lock(&model->lock);
-    if (model->instructions) {
-        _foreach(model->instructions, ux_insn_t*, insn)
-            free(insn->full_string);
-            free(insn);
-        _endforeach;
-        dyna_free(model->instructions);
-        model->instructions = dyna_create();
+
+    /* the xref rows are cached by index, and the indices now mean other references. */
+    stat_lock(&model->lock);
+    free(model->tab->refs);
+    rows_forget(model->tab, UI_VIEW_XREFS);
+    model->tab->refs = refs;
+    model->tab->ref_count = refs ? count : 0u;
+    line_cache_clear(model->lines);
+    pthread_mutex_unlock(&model->lock);
+}
+
+/**
+ * @brief hand the hits of a find to the find view from any thread; they replace (and free) the
+ *  previous ones when the inbox is drained, unless another find was started since.
+ *
+ * @param model the ui model.
+ * @param generation the find_generation the search was started at.
+ * @param finds the ranked hits (ownership is taken).
+ * @param count the number of hits.
+ * @param status the status to show with them.
+ * @return true if they were posted, false if they could not be (and are freed).
+ */
+bool
+ui_model_set_finds(ui_model_t* model, uint64_t generation, srch_hit_t* finds, size_t count, \
+    const char* status) {
+    ui_finds_msg_t* message = model ? calloc(1u, sizeof *message) : 0x0;
+    if (!message) {
+        if (model) fprintf(stderr, "lzd, ui_model_set_finds; calloc failed; could not allocate memory for message.\n");
+        free(finds);
+        return false;
     }
-    model->selected = 0;
-    model->scroll = 0;
+    message->node.kind = UI_MSG_FINDS;
+    message->generation = generation;
+    message->finds = finds;
+    message->count = count;
+    if (status) snprintf(message->status, sizeof(message->status), "%s", status);
+    ui_model_post(model, &message->node);
+    return true;
+}
+
+/**
+ * @brief set the diff of a tab against another binary, replacing (and freeing) the previous one,
+ *  and show it in the diff view of the tab.
+ *
+ * @param model the ui model.
+ * @param tab the tab.
+ * @param diff the diff (ownership is taken), or 0x0 to remove it.
+ */
+void
+ui_model_set_diff(ui_model_t* model, ui_tab_t* tab, diff_t* diff) {
+    if (!model || !tab) {
+        diff_free(diff);
+        return;
+    }
+
+    /* the diff rows are cached by index, and the indices now mean other functions. */
+    stat_lock(&model->lock);
+    diff_free(tab->diff);
+    rows_forget(tab, UI_VIEW_DIFF);
+    tab->diff = diff;
+    tab->view_mode = UI_VIEW_DIFF;
+    tab->selected = 0;
+    tab->scroll = 0;
+    tab->drawn_scroll = 0;
+    if (tab == model->tab) line_cache_clear(model->lines);
     pthread_mutex_unlock(&model->lock);
+    if (tab == model->tab) model->dirty |= UI_DIRTY_ALL;
 }
 
 /**
- * @brief add strings to the ui model.
+ * @brief set the symbols of a tab, replacing (and freeing) the previous ones; they are
+ *  formatted when drawn, and have to be replaced before the image they point into is unmapped.
  *
  * @param model the ui model.
- * @param strings dynamic array of char* strings.
+ * @param tab the tab.
+ * @param symbols the symbols (ownership is taken), or 0x0 to remove them.
  */
 void
-ui_model_add_strings(ui_model_t* model, dyna_t* strings) {
-    if (!model || !strings) return;
+ui_model_set_symbols(ui_model_t* model, ui_tab_t* tab, syms_t* symbols) {
+    if (!model || !tab) return;
 
-    pthread_mutex_lock(&model->lock);
-    _foreach(strings, char*, str)
-        dyna_push(model->strings, str);
-    _endforeach;
+    /* the symbol rows are cached by index, and the indices now mean other symbols. */
+    stat_lock(&model->lock);
+    syms_free(tab->symbols);
+    tab->symbols = symbols;
+    rows_forget(tab, UI_VIEW_SYMBOLS);
+    rows_forget(tab, UI_VIEW_FIND);
+    srch_drop_texts(tab->search);
+    if (tab == model->tab) line_cache_clear(model->lines);
     pthread_mutex_unlock(&model->lock);
 }
 
 /**
- * @brief add elf symbol strings to the ui model.
+ * @brief open an empty tab in a free slot, without switching to it.
  *
  * @param model the ui model.
- * @param symbols dynamic array of elf_symbol_t*.
+ * @param name the name shown in the tab bar (copied).
+ * @return the slot if successful, -1 if every slot is taken or it could not be allocated.
+ */
+ssize_t
+ui_model_open_tab(ui_model_t* model, const char* name) {
+    if (!model) return -1;
+    for (size_t i = 0; i < UI_MAX_TABS; i++) {
+        if (model->tabs[i].open) continue;
+        if (tab_init(&model->tabs[i], name, name) != 0) return -1;
+        model->dirty |= UI_DIRTY_HEADER;
+        return (ssize_t) i;
+    }
+    return -1;
+}
+
+/**
+ * @brief point the pages of a binary at a tab, from then on they are routed to it.
+ *
+ * @param tab the tab.
+ * @param owner the token of the binary (see ux_page_msg_t).
  */
 void
-ui_model_add_symbols(ui_model_t* model, dyna_t* symbols) {
-    if (!model || !symbols) return;
-
-    pthread_mutex_lock(&model->lock);
-    _foreach(symbols, elf_symbol_t*, sym)
-        char* string = calloc(1u, 256u + 1u);
-        if (sym->value) snprintf(string, 256u, "%p:\t%s", (void*) (sym->value), sym->name);
-        else snprintf(string, 256u, "(lib./ext.):\t%s", sym->name);
-        dyna_push(model->symbols, string);
-    _endforeach;
+ui_model_bind_tab(ui_tab_t* tab, const void* owner) {
+    if (tab) atomic_store(&tab->owner, owner);
+}
+
+/**
+ * @brief close a tab and free everything in it; no page of its binary may still be on its way
+ *  (its jobs are drained, and so is the inbox). the active tab moves to another open one, and
+ *  closing the last one leaves an empty tab in its place.
+ *
+ * @param model the ui model.
+ * @param slot the slot of the tab.
+ */
+void
+ui_model_close_tab(ui_model_t* model, size_t slot) {
+    if (!model || slot >= UI_MAX_TABS || !model->tabs[slot].open) return;
+
+    /* the tab to its left takes over (or else the one to its right), the renderer never sees a
+     *  freed one. */
+    size_t next = slot;
+    for (size_t i = 1; next == slot && i < UI_MAX_TABS; i++) {
+        if (slot >= i && model->tabs[slot - i].open) next = slot - i;
+        else if (slot + i < UI_MAX_TABS && model->tabs[slot + i].open) next = slot + i;
+    }
+    stat_lock(&model->lock);
+    tab_free(&model->tabs[slot]);
+    if (next == slot && tab_init(&model->tabs[slot], "-", "? | ?") != 0)
+        fprintf(stderr, "lzd, ui_model_close_tab; could not open an empty tab.\n");
     pthread_mutex_unlock(&model->lock);
-};
+    if (model->active == slot || next == slot) ui_model_switch_tab(model, next);
+    model->dirty = UI_DIRTY_ALL;
+}
+
+/**
+ * @brief make a tab the active one; a find still running for the old one is dropped.
+ *
+ * @param model the ui model.
+ * @param slot the slot of an open tab.
+ */
+void
+ui_model_switch_tab(ui_model_t* model, size_t slot) {
+    if (!model || slot >= UI_MAX_TABS || !model->tabs[slot].open) return;
+
+    /* the line cache is keyed by row, and the rows now belong to another binary. */
+    stat_lock(&model->lock);
+    model->tab = &model->tabs[slot];
+    model->active = slot;
+    model->find_generation++;
+    line_cache_clear(model->lines);
+    pthread_mutex_unlock(&model->lock);
+    model->dirty = UI_DIRTY_ALL;
+}
 
 /**
  * @brief set the view mode.
@@ -355,13 +1546,12 @@ void
 ui_model_set_view(ui_model_t* model, ui_view_mode_t mode) {
     if (!model) return;
 
-    pthread_mutex_lock(&model->lock);
-    model->view_mode = mode;
-    model->selected = 0;
-    model->scroll = 0;
-    snprintf(model->status, sizeof(model->status), "switched to %s view", \
-             mode == UI_VIEW_STRINGS ? "strings" : mode == UI_VIEW_SYMBOLS ? \
-             "symbols" : "instructions");
+    stat_lock(&model->lock);
+    model->tab->view_mode = mode;
+    model->tab->selected = 0;
+    model->tab->scroll = 0;
+    model->tab->drawn_scroll = 0;
+    snprintf(model->status, sizeof(model->status), "switched to %s view", view_label(mode));
     pthread_mutex_unlock(&model->lock);
 }
 
@@ -373,70 +1563,102 @@ ui_model_set_view(ui_model_t* model, ui_view_mode_t mode) {
  */
 ui_act_t
 ui_run(ui_model_t* model) {
-    /* initialize everything. */
+    /* initialize everything, keys are read without blocking once poll says there are some. */
     initscr();
     cbreak();
     noecho();
     keypad(stdscr, TRUE);
     curs_set(1);
-    nodelay(stdscr, FALSE);
+    nodelay(stdscr, TRUE);
+    refresh();
     ui_act_t last_act = TUI_ACT_NONE;
 
-    /* initial draw before loop. */
-    {
-        int term_h, term_w;
-        getmaxyx(stdscr, term_h, term_w);
-        int hdr_h, ftr_h, lst_h;
-        layout(term_h, term_w, &hdr_h, &ftr_h, &lst_h);
-
-        WINDOW* hdr = newwin(hdr_h, term_w, 0, 0);
-        WINDOW* lst = newwin(lst_h, term_w, hdr_h, 0);
-        WINDOW* ftr = newwin(ftr_h, term_w, hdr_h + lst_h, 0);
-
-        draw_header(hdr, model);
-        draw_list(lst, model);
-        draw_footer(ftr, model);
-        doupdate();
-
-        delwin(hdr);
-        delwin(lst);
-        delwin(ftr);
-    }
+    /* the windows live across frames, they are only made again when the terminal resizes. */
+    WINDOW* hdr = 0x0, *lst = 0x0, *ftr = 0x0;
+    bool resized = true, input = false;
+    int64_t last_frame = 0;
+    while (last_act != TUI_ACT_QUIT) {
+        if (resized) {
+            int term_h, term_w, hdr_h, ftr_h, lst_h;
+            getmaxyx(stdscr, term_h, term_w);
+            layout(term_h, term_w, &hdr_h, &ftr_h, &lst_h);
+            if (hdr) delwin(hdr);
+            if (lst) delwin(lst);
+            if (ftr) delwin(ftr);
+            hdr = newwin(hdr_h, term_w, 0, 0);
+            lst = newwin(lst_h, term_w, hdr_h, 0);
+            ftr = newwin(ftr_h, term_w, hdr_h + lst_h, 0);
+            model->dirty = UI_DIRTY_ALL;
+            resized = false;
+        }
+
+        /* the stats view takes a snapshot every STAT_PERIOD_MS while it is shown. */
+        int64_t period = -1;
+        if (model->tab->view_mode == UI_VIEW_STATS) {
+            uint64_t due = model->stats.ns + STAT_PERIOD_MS * 1000000ull;
+            if (stat_now() >= due) {
+                model->stats_last = model->stats;
+                ux_stats(&model->stats);
+                model->dirty |= UI_DIRTY_LIST;
+                due = model->stats.ns + STAT_PERIOD_MS * 1000000ull;
+            }
+            uint64_t now = stat_now();
+            period = now < due ? (int64_t) ((due - now) / 1000000u) + 1 : 0;
+        }
+
+        /* paint what is dirty, right away after input; chunks that keep arriving are capped
+         *  to a frame every UI_FRAME_MS. */
+        if (ui_model_drain(model) > 0u) ux_reclaim(model);
+        uint32_t dirty = model->dirty;
+        int64_t wait = dirty && !input ? last_frame + UI_FRAME_MS - now_ms() : 0;
+        if (dirty && wait <= 0) {
+            uint64_t frame = stat_now();
+            model->dirty = 0u;
+            if (dirty & UI_DIRTY_HEADER) draw_header(hdr, model);
+            if (dirty & UI_DIRTY_LIST) draw_list(lst, model);
 
-    while (1) {
-        int term_h, term_w;
-        getmaxyx(stdscr, term_h, term_w);
-
-        /* get the layout of the terminal. */
-        int hdr_h, ftr_h, lst_h;
-        layout(term_h, term_w, &hdr_h, &ftr_h, &lst_h);
-
-        /* create new windows. */
-        WINDOW* hdr = newwin(hdr_h, term_w, 0, 0);
-        WINDOW* lst = newwin(lst_h, term_w, hdr_h, 0);
-        WINDOW* ftr = newwin(ftr_h, term_w, hdr_h + lst_h, 0);
-
-        /* draw everything. */
-        draw_header(hdr, model);
-        draw_list(lst, model);
-        draw_footer(ftr, model);
-        doupdate();
-
-        /* ux handler. */
-        int ch = getch();
-        if (ch == KEY_RESIZE) {
-            /* just loop and redraw. */
-            last_act = TUI_ACT_NONE;
-        } else {
-            last_act = ux_handle_key(model, ch);
+            /* the footer goes last either way, the cursor is left where it was put. */
+            if (dirty & UI_DIRTY_FOOTER) draw_footer(ftr, model);
+            else wnoutrefresh(ftr);
+            doupdate();
+            last_frame = now_ms();
+            stat_record(STAT_HIST_FRAME, stat_now() - frame);
         }
+        input = false;
 
-        /* delete each window for a new render cycle. */
-        delwin(hdr);
-        delwin(lst);
-        delwin(ftr);
-        if (last_act == TUI_ACT_QUIT) break;
+        /* sleep until a key comes in, a chunk arrives, or the next frame (or snapshot) is due. */
+        struct pollfd fds[2] = { { STDIN_FILENO, POLLIN, 0 }, { model->wakeup, POLLIN, 0 } };
+        int64_t timeout = dirty && wait > 0 ? wait : -1;
+        if (period >= 0 && (timeout < 0 || period < timeout)) timeout = period;
+        poll(fds, model->wakeup >= 0 ? 2u : 1u, (int) timeout);
+        if (model->wakeup >= 0 && (fds[1].revents & POLLIN)) {
+            uint64_t count;
+            ssize_t got = read(model->wakeup, &count, sizeof count);
+            (void) got;
+        }
+
+        /* handle every key that came in, and mark what each one may have changed. */
+        int ch;
+        while (last_act != TUI_ACT_QUIT && (ch = getch()) != ERR) {
+            uint32_t changed = UI_DIRTY_ALL;
+            if (ch == KEY_RESIZE) {
+                resized = true;
+                last_act = TUI_ACT_NONE;
+            } else {
+                last_act = ux_handle_key(model, ch);
+                if (ch == KEY_UP || ch == KEY_DOWN || ch == KEY_PPAGE || ch == KEY_NPAGE || \
+                    ch == KEY_HOME || ch == KEY_END || ch == KEY_SPREVIOUS || ch == KEY_SNEXT)
+                    changed = UI_DIRTY_LIST;
+                else if ((ch >= 32 && ch <= 126) || ch == KEY_BACKSPACE || ch == 127 || ch == 8)
+                    changed = UI_DIRTY_FOOTER;
+            }
+            model->dirty |= changed;
+            input = true;
+        }
     }
+    delwin(hdr);
+    delwin(lst);
+    delwin(ftr);
     endwin();
     return last_act;
 }
@@ -8,12 +8,45 @@
 /*! @uses ssize_t. */
 #include <sys/types.h>
 
+/*! @uses bool. */
+#include <stdbool.h>
+
 /*! @uses dyna_t. */
 #include "dyna.h"
 
+/*! @uses insn_store_t. */
+#include "insn.h"
+
+/*! @uses line_cache_t. */
+#include "line.h"
+
+/*! @uses strs_t. */
+#include "strs.h"
+
+/*! @uses syms_t. */
+#include "syms.h"
+
+/*! @uses xref_index_t, xref_hit_t. */
+#include "xref.h"
+
+/*! @uses srch_t, srch_hit_t. */
+#include "srch.h"
+
+/*! @uses diff_t. */
+#include "diff.h"
+
+/*! @uses msgq_t, msgq_node_t. */
+#include "msgq.h"
+
+/*! @uses stat_snapshot_t. */
+#include "stat.h"
+
 /*! @uses pthread_mutex_t. */
 #include <pthread.h>
 
+/*! @uses _Atomic. */
+#include <stdatomic.h>
+
 /* ... */
 typedef enum {
     TUI_ACT_NONE = 0x0,
@@ -28,23 +61,133 @@ typedef enum {
     UI_VIEW_INSTRUCTIONS = 0u, /* show disassembly. */
     UI_VIEW_STRINGS, /* show strings. */
     UI_VIEW_SYMBOLS, /* show symbols. */
+    UI_VIEW_XREFS, /* show the references to an address. */
+    UI_VIEW_FIND, /* show the hits of the last find. */
+    UI_VIEW_STATS, /* show the counters and histograms of the decode pipeline. */
+    UI_VIEW_DIFF, /* show the functions that changed against another binary. */
+    UI_VIEW_COUNT,
 } ui_view_mode_t;
 
-/* ... */
+/* shortest time between two frames that aren't caused by input, in milliseconds. */
+#define UI_FRAME_MS 16
+
+/* parts of the screen that changed since the last frame. */
+typedef enum {
+    UI_DIRTY_HEADER = 0x1u, /* title or subtitle. */
+    UI_DIRTY_LIST = 0x2u, /* rows, the selection, or the row count. */
+    UI_DIRTY_FOOTER = 0x4u, /* status or command bar. */
+    UI_DIRTY_ALL = 0x7u,
+} ui_dirty_t;
+
+/* kind of a message in the inbox of the model. */
+typedef enum {
+    UI_MSG_PAGE = 0u, /* a decoded chunk (ux_page_msg_t). */
+    UI_MSG_FINDS, /* the hits of a find (ui_finds_msg_t). */
+    UI_MSG_LOADED, /* a binary that finished loading (ui_loaded_msg_t). */
+} ui_msg_kind_t;
+
+/* the hits of a find, handed to the ui thread. */
 typedef struct {
-    char* title; /* e.g. "lzd - lazy disassembler". */
-    char* subtitle; /* e.g. "x86_64 | ELF64 | ./example_binary". */
-    dyna_t* instructions; /* dynamic array of ux_insn_t* from disassembly. */
-    dyna_t* strings; /* dynamic array of char* strings extracted from binary. */
-    dyna_t* symbols; /* dynamic array of elf symbols from the executable. */
+    msgq_node_t node; /* link in the inbox (UI_MSG_FINDS), the first member. */
+    uint64_t generation; /* find_generation the search was started at. */
+    srch_hit_t* finds; /* the ranked hits (owned). */
+    size_t count; /* number of hits. */
+    char status[256]; /* status to show with them. */
+} ui_finds_msg_t;
+
+/* a binary that finished loading in the background, handed to the ui thread. */
+typedef struct {
+    msgq_node_t node; /* link in the inbox (UI_MSG_LOADED), the first member. */
+    void* binary; /* the binary of the workspace, installed by ux_loaded. */
+} ui_loaded_msg_t;
+
+/* the most binaries that can be open at once, each in a tab of its own. */
+#define UI_MAX_TABS 8u
+
+/* a row of a view that has an address, as an entry of its address index. */
+typedef struct {
+    uint64_t address; /* the address of the row. */
+    size_t row; /* the row. */
+} ui_row_key_t;
+
+/*
+ * the rows of one view sorted by address (then by row), so a goto finds its row in O(log n)
+ *  in a view that isn't ordered by address; built on the first goto, and dropped whenever the
+ *  rows of that view are replaced.
+ */
+typedef struct {
+    ui_row_key_t* keys; /* every row that has an address, ascending. */
+    size_t count; /* number of keys. */
+    size_t total; /* rows of the view it was built over. */
+    ui_view_mode_t view; /* the view it was built for. */
+    bool built; /* keys are there (a view without addresses has none). */
+} ui_row_index_t;
+
+/**
+ * everything the model shows of one opened binary; the active tab is the one on screen, every
+ *  other one keeps its rows, its indices and where it was scrolled to (and goes on decoding)
+ *  until it is switched back to. pages are routed to a tab by the token of their binary.
+ */
+typedef struct {
+    bool open; /* the slot holds a tab. */
+    _Atomic(const void*) owner; /* token of its binary (see ux_page_msg_t), 0x0 until loaded. */
+    char name[64]; /* shown in the tab bar, e.g. "libc.so.6". */
+    char subtitle[257]; /* e.g. "./example_binary | x86_64". */
+    insn_store_t* instructions; /* address-ordered store of decoded chunks. */
+    strs_t* strings; /* strings extracted from the binary, they point into its image (owned). */
+    syms_t* symbols; /* symbols of the binary, their names point into its image (owned). */
+    xref_index_t* xrefs; /* references out of every decoded chunk, keyed by target. */
+    xref_hit_t* refs; /* references shown in the xrefs view (owned). */
+    size_t ref_count; /* number of references shown. */
+    srch_t* search; /* mnemonic postings of every decoded chunk, and the trigram indices. */
+    srch_hit_t* finds; /* ranked hits shown in the find view (owned). */
+    size_t find_count; /* number of hits shown. */
+    diff_t* diff; /* functions that differ from the binary it was diffed against (owned). */
+    ui_row_index_t rows; /* address index of the rows of the last view a goto went through. */
     ui_view_mode_t view_mode; /* current view mode. */
     ssize_t selected; /* which line is "selected". */
     ssize_t scroll; /* first visible line. */
+    ssize_t drawn_scroll; /* scroll of the last frame, gives the scroll direction. */
+    uint64_t goto_address; /* address of a goto that landed in a placeholder. */
+    bool goto_pending; /* reselect goto_address once its chunk is decoded. */
+} ui_tab_t;
+
+/* ... */
+typedef struct {
+    char* title; /* e.g. "lzd - lazy disassembler". */
+    ui_tab_t tabs[UI_MAX_TABS]; /* every tab by slot, at least one is always open. */
+    ui_tab_t* tab; /* the active tab, shown on screen. */
+    size_t active; /* slot of the active tab. */
+    uint64_t find_generation; /* bumped by every find (and switch), older hits are dropped. */
+    stat_snapshot_t stats; /* shown in the stats view, taken every STAT_PERIOD_MS while it is. */
+    stat_snapshot_t stats_last; /* the one before it, counters show their rate since. */
+    line_cache_t* lines; /* lru of formatted lines for the rows that were recently visible. */
+    size_t page; /* rows that fit in the list on the last frame, a page up or down moves by it. */
     char cmd[256]; /* command bar text (editable). */
     char status[256]; /* status text (read-only). */
-    pthread_mutex_t lock; /* protect concurrent access. */
+    uint32_t dirty; /* ui_dirty_t of everything that changed since the last frame. */
+    int wakeup; /* eventfd the ui loop waits on next to stdin, written on every post. */
+
+    /* the model is only written on the ui thread, workers post what they made to the inbox and
+     *  the ui thread installs it between frames; so the renderer reads without a lock. the lock
+     *  is taken around every write, for the jobs that read the store off of the ui thread. */
+    msgq_t inbox; /* messages from the workers, drained by the ui thread. */
+    pthread_mutex_t lock; /* writes on the ui thread against reads on the workers. */
 } ui_model_t;
 
+/*
+ * a view as a virtual list of rows; only the rows on screen are ever fetched (and formatted),
+ *  so no view has to hold a line for every row, and every view maps its rows to addresses and
+ *  back. the model is only read on the ui thread.
+ */
+typedef struct {
+    size_t (*count)(ui_model_t* model); /* number of rows. */
+    size_t (*fetch)(ui_model_t* model, size_t first, size_t count, char (*lines)[LINE_WIDTH]);
+        /* format rows [first, first + count) into lines, gives how many of them there are. */
+    bool (*address)(ui_model_t* model, size_t row, uint64_t* address); /* false without one. */
+    ssize_t (*row)(ui_model_t* model, uint64_t address); /* at, or else closest after (or -1). */
+} ui_rows_t;
+
 /**
  * @brief create a new ui model.
  *
@@ -64,39 +207,172 @@ void
 ui_model_free(ui_model_t* model);
 
 /**
- * @brief add instructions to the ui model.
+ * @brief add a decoded chunk of instructions to a tab of the ui model, on the ui thread.
+ *
+ * @param model the ui model.
+ * @param tab the tab.
+ * @param chunk the sealed chunk of instructions (ownership is taken).
+ */
+void
+ui_model_add_insns(ui_model_t* model, ui_tab_t* tab, insn_chunk_t* chunk);
+
+/**
+ * @brief post a message to the inbox of the ui model from any thread, without blocking; the
+ *  references and mnemonics of a page go into the indices of its tab right away (on the
+ *  calling thread), and its chunk is installed when the ui thread drains the inbox. a page of
+ *  a binary that has no tab is dropped.
+ *
+ * @param model the ui model.
+ * @param node the link of a ux_page_msg_t, ui_finds_msg_t or ui_loaded_msg_t (ownership is
+ *  taken).
+ */
+void
+ui_model_post(ui_model_t* model, msgq_node_t* node);
+
+/**
+ * @brief install every message in the inbox of the ui model, on the ui thread.
+ *
+ * @param model the ui model.
+ * @return the number of messages installed.
+ */
+size_t
+ui_model_drain(ui_model_t* model);
+
+/**
+ * @brief reserve a placeholder for a code range that is decoded lazily.
+ *
+ * @param model the ui model.
+ * @param tab the tab.
+ * @param base the base address of the code range.
+ * @param length the length of the code range.
+ * @param rows the number of rows it decodes into, 0 to estimate it.
+ */
+void
+ui_model_reserve(ui_model_t* model, ui_tab_t* tab, uint64_t base, size_t length, size_t rows);
+
+/**
+ * @brief get the number of rows in the current view.
+ *
+ * @param model the ui model.
+ * @return the number of rows in the current view.
+ */
+size_t
+ui_model_rows(ui_model_t* model);
+
+/**
+ * @brief get the row provider of the current view.
+ *
+ * @param model the ui model.
+ * @return the row provider.
+ */
+const ui_rows_t*
+ui_model_provider(const ui_model_t* model);
+
+/**
+ * @brief clear all instructions (and their references, and the hits shown of them) from a tab.
+ *
+ * @param model the ui model.
+ * @param tab the tab.
+ */
+void
+ui_model_clear(ui_model_t* model, ui_tab_t* tab);
+
+/**
+ * @brief set the strings of a tab, replacing (and freeing) the previous ones; they have to be
+ *  replaced before the image they point into is unmapped.
+ *
+ * @param model the ui model.
+ * @param tab the tab.
+ * @param strings the strings (ownership is taken), or 0x0 to remove them.
+ */
+void
+ui_model_set_strings(ui_model_t* model, ui_tab_t* tab, strs_t* strings);
+
+/**
+ * @brief set the references shown in the xrefs view, replacing (and freeing) the previous ones.
+ *
+ * @param model the ui model.
+ * @param refs the references (ownership is taken), or 0x0 to remove them.
+ * @param count the number of references.
+ */
+void
+ui_model_set_refs(ui_model_t* model, xref_hit_t* refs, size_t count);
+
+/**
+ * @brief hand the hits of a find to the find view from any thread; they replace (and free) the
+ *  previous ones when the inbox is drained, unless another find was started since.
+ *
+ * @param model the ui model.
+ * @param generation the find_generation the search was started at.
+ * @param finds the ranked hits (ownership is taken).
+ * @param count the number of hits.
+ * @param status the status to show with them.
+ * @return true if they were posted, false if they could not be (and are freed).
+ */
+bool
+ui_model_set_finds(ui_model_t* model, uint64_t generation, srch_hit_t* finds, size_t count, \
+    const char* status);
+
+/**
+ * @brief set the diff of a tab against another binary, replacing (and freeing) the previous one,
+ *  and show it in the diff view of the tab.
  *
  * @param model the ui model.
- * @param insns dynamic array of ux_insn_t*.
+ * @param tab the tab.
+ * @param diff the diff (ownership is taken), or 0x0 to remove it.
  */
 void
-ui_model_add_insns(ui_model_t* model, dyna_t* insns);
+ui_model_set_diff(ui_model_t* model, ui_tab_t* tab, diff_t* diff);
 
 /**
- * @brief clear all instructions from the ui model.
+ * @brief set the symbols of a tab, replacing (and freeing) the previous ones; they are
+ *  formatted when drawn, and have to be replaced before the image they point into is unmapped.
  *
  * @param model the ui model.
+ * @param tab the tab.
+ * @param symbols the symbols (ownership is taken), or 0x0 to remove them.
+ */
+void
+ui_model_set_symbols(ui_model_t* model, ui_tab_t* tab, syms_t* symbols);
+
+/**
+ * @brief open an empty tab in a free slot, without switching to it.
+ *
+ * @param model the ui model.
+ * @param name the name shown in the tab bar (copied).
+ * @return the slot if successful, -1 if every slot is taken or it could not be allocated.
+ */
+ssize_t
+ui_model_open_tab(ui_model_t* model, const char* name);
+
+/**
+ * @brief point the pages of a binary at a tab, from then on they are routed to it.
+ *
+ * @param tab the tab.
+ * @param owner the token of the binary (see ux_page_msg_t).
  */
 void
-ui_model_clear(ui_model_t* model);
+ui_model_bind_tab(ui_tab_t* tab, const void* owner);
 
 /**
- * @brief add strings to the ui model.
+ * @brief close a tab and free everything in it; no page of its binary may still be on its way
+ *  (its jobs are drained, and so is the inbox). the active tab moves to another open one, and
+ *  closing the last one leaves an empty tab in its place.
  *
  * @param model the ui model.
- * @param strings dynamic array of char* strings.
+ * @param slot the slot of the tab.
  */
 void
-ui_model_add_strings(ui_model_t* model, dyna_t* strings);
+ui_model_close_tab(ui_model_t* model, size_t slot);
 
 /**
- * @brief add elf symbol strings to the ui model.
+ * @brief make a tab the active one; a find still running for the old one is dropped.
  *
  * @param model the ui model.
- * @param symbols dynamic array of elf_symbol_t*.
+ * @param slot the slot of an open tab.
  */
 void
-ui_model_add_symbols(ui_model_t* model, dyna_t* symbols);
+ui_model_switch_tab(ui_model_t* model, size_t slot);
 
 /**
  * @brief set the view mode.
@@ -108,7 +384,9 @@ void
 ui_model_set_view(ui_model_t* model, ui_view_mode_t mode);
 
 /**
- * @brief run the ui event loop (blocking).
+ * @brief run the ui event loop (blocking); it sleeps on stdin and the wakeup fd, redraws only
+ *  the windows that are dirty, right away after input and at most once per UI_FRAME_MS o.w.;
+ *  the stats view is refreshed every STAT_PERIOD_MS.
  *
  * @param model the ui model.
  * @return the action that caused the loop to exit.
@@ -7,12 +7,18 @@
 /*! @uses fprintf, stderr, snprintf. */
 #include <stdio.h>
 
-/*! @uses calloc, free. */
+/*! @uses calloc, free, getenv, strtoul, strtoull. */
 #include <stdlib.h>
 
-/*! @uses strnlen. */
+/*! @uses strnlen, strstr, strcasestr, strchr, strrchr, strcspn, memcpy. */
 #include <string.h>
 
+/*! @uses clock_gettime, timespec. */
+#include <time.h>
+
+/*! @uses atomic_size_t, atomic_load, atomic_fetch_add, atomic_fetch_sub. */
+#include <stdatomic.h>
+
 /*! @uses ncurses. */
 #include <ncurses.h>
 
@@ -22,72 +28,207 @@
 /*! @uses internal. */
 #include "dyna.h"
 
-/*! @uses wrk_pool_t, wrk_pool_create, wrk_pool_drain. */
+/*! @uses wrk_pool_t, job_t, wrk_prio_t, wrk_pool_create, wrk_pool_post_latched, wrk_pool_drain,
+ *  wrk_pool_pin, wrk_cpu_count. */
 #include "wrk.h"
 
-/*! @uses emit_ctx_t, emit_load, emit_scan_text, emit_all. */
+/*! @uses emit_ctx_t, emit_range. */
 #include "emit.h"
 
+/*! @uses elf_t, elf_shdr_t, elf_section, ELF_SHF_ALLOC. */
+#include "elfx.h"
+
+/*! @uses disj_token_bump. */
+#include "disj.h"
+
+/*! @uses wksp_t, wksp_bin_t, wksp_open, wksp_install, wksp_close, wksp_active, wksp_twin. */
+#include "wksp.h"
+
+/*! @uses srch_hits_t, srch_find_symbols, srch_find_strings, srch_find_mnemonic, srch_rank. */
+#include "srch.h"
+
+/*! @uses stat_snapshot_t, stat_snapshot, stat_now, stat_add, stat_lock. */
+#include "stat.h"
+
+/* number of parts a find is split into, every part runs as a job of its own; a text is
+ *  searched for in the symbols, the instructions and the strings, a byte pattern in a piece of
+ *  every executable region per part. */
+#define FIND_PARTS 4u
+
+/* number of instruction hits checked against the store per lock. */
+#define FIND_BATCH 1024u
+
+/* rows a page up or down moves by before the list was ever drawn. */
+#define UX_PAGE_ROWS 10
+
+/* a find in flight; every job takes the next part, and the last one to finish ranks the hits
+ *  of every part and hands them to the model. */
+typedef struct {
+    ui_model_t* model;
+    ui_tab_t* tab; /* the tab it was started in, its hits land in whatever tab is active. */
+    uint64_t generation; /* find_generation of the model when it was started. */
+    char pattern[256]; /* the text, or the hex of a byte pattern. */
+    char mnemonic[32]; /* first word of the text, lowercase. */
+    const char* operands; /* rest of the text (inside of pattern), "" if there is none. */
+    uint8_t needle[128]; /* the byte pattern. */
+    size_t needle_length; /* length of the byte pattern, 0 when searching for a text. */
+    const emit_region_t* regions; /* executable regions (borrowed, closing waits for the find). */
+    size_t region_count;
+    srch_hits_t hits[FIND_PARTS]; /* hits of every part. */
+    bool failed[FIND_PARTS]; /* a part that ran out of memory. */
+    atomic_size_t next; /* hands every job its part. */
+    atomic_size_t remaining; /* parts that have not finished yet. */
+    struct timespec started;
+} find_query_t;
+
 /* a reference to the work pool. */
 static wrk_pool_t* g_wrk_pool;
 
-/* a reference to a global emit context. */
-static emit_ctx_t* g_ctx;
+/* every binary that is open, one per tab. */
+static wksp_t g_wksp;
+
+/* the sink pages go to instead of the ui model, if there is one. */
+static ux_sink_t g_sink;
+static void* g_sink_arg;
+
+/* lookup table for hex digits. */
+static const char g_hex[] = "0123456789abcdef";
 
 /**
- * @brief format a single instruction into a string for display.
+ * @brief get the address an operand refers to, either a lone immediate (a branch or call
+ *  target, e.g. "0x401136" or "#0x401136") or an x86 rip-relative memory operand.
  *
- * @param insn the instruction to format.
- * @return formatted string (caller must free), or 0x0 on failure.
+ * @param insn the instruction.
+ * @param target output for the address.
+ * @return true if there is one, false o.w.
  */
-internal char*
-format_insn(ux_insn_t* insn) {
-    if (!insn) return 0x0;
-
-    /* allocate buffer for formatted line. */
-    char* line = calloc(1u, 512u);
-    if (!line) {
-        fprintf(stderr, "lzd, format_insn; calloc failed; could not allocate memory for line.\n");
-        return 0x0;
+internal bool
+operand_target(const ux_insn_t* insn, uint64_t* target) {
+    const char* op_str = insn->op_str;
+    if (!op_str || !op_str[0]) return false;
+
+    /* a lone immediate. */
+    const char* digits = op_str[0] == '#' ? op_str + 1 : op_str;
+    char* end = 0x0;
+    if (digits[0] == '0' && digits[1] == 'x') {
+        *target = strtoull(digits, &end, 16);
+        return end && !*end;
     }
 
-    /* format: 0x401000: 48 89 e5 48 83 ec 20          mov rbp, rsp */
-    size_t offset = 0;
+    /* [rip + disp] is relative to the next instruction. */
+    const char* rip = strstr(op_str, "[rip ");
+    if (!rip || (rip[5] != '+' && rip[5] != '-') || rip[6] != ' ') return false;
+    uint64_t disp = strtoull(rip + 7, &end, 0);
+    if (!end || *end != ']') return false;
+    uint64_t next = insn->address + insn->size;
+    *target = rip[5] == '+' ? next + disp : next - disp;
+    return true;
+}
 
-    /* address column (12 chars). */
-    offset += snprintf(line + offset, 512u - offset, "0x%08lx:  ", insn->address);
+/**
+ * @brief format a single instruction into a line for display, an operand that is an address
+ *  inside of a symbol is annotated with it (e.g. "call 0x401136 <main>").
+ *
+ * @param insn the instruction to format.
+ * @param symbols the (indexed) symbols to annotate with (or 0x0).
+ * @param line the buffer to format into.
+ * @param size the size of the buffer.
+ * @return the length of the formatted line.
+ */
+size_t
+ux_format_insn(const ux_insn_t* insn, const syms_t* symbols, char* line, size_t size) {
+    if (!insn || !line || size == 0u) return 0u;
 
-    /* bytes column (max 16 bytes = 48 chars for hex + spaces). */
-    for (uint8_t i = 0; i < 16; i++) {
-        if (i < insn->size)
-            offset += snprintf(line + offset, 512u - offset, "%02x ", insn->bytes[i]);
-        else
-            offset += snprintf(line + offset, 512u - offset, "   ");
-    }
+    /* format: 0x401000: 48 89 e5 48 83 ec 20          mov rbp, rsp */
+    int n = snprintf(line, size, "0x%08lx:  ", insn->address);
+    size_t offset = n < 0 ? 0u : (size_t) n;
+    if (offset >= size) return size - 1u;
 
-    /* separator between bytes and mnemonic. */
-    offset += snprintf(line + offset, 512u - offset, " ");
+    /* bytes column (max 16 bytes = 48 chars for hex + spaces), plus a separator. */
+    if (offset + 49u < size) {
+        for (uint8_t i = 0; i < 16; i++) {
+            if (i < insn->size && insn->bytes) {
+                line[offset++] = g_hex[insn->bytes[i] >> 4];
+                line[offset++] = g_hex[insn->bytes[i] & 0xf];
+            } else {
+                line[offset++] = ' ';
+                line[offset++] = ' ';
+            }
+            line[offset++] = ' ';
+        }
+        line[offset++] = ' ';
+        line[offset] = '\0';
+    }
 
     /* mnemonic and operands. */
-    if (insn->mnemonic[0])
-        offset += snprintf(line + offset, 512u - offset, "%s", insn->mnemonic);
-    if (insn->op_str[0])
-        offset += snprintf(line + offset, 512u - offset, " %s", insn->op_str);
+    const char* op_str = insn->op_str ? insn->op_str : "";
+    n = snprintf(line + offset, size - offset, "%s%s%s", insn->mnemonic ? insn->mnemonic : "", \
+        op_str[0] ? " " : "", op_str);
+    offset += n < 0 ? 0u : (size_t) n;
+    if (offset >= size) return size - 1u;
 
-    return line;
+    /* the symbol the operand points into. */
+    uint64_t target = 0u, into = 0u;
+    const elf_symbol_t* symbol = symbols && operand_target(insn, &target) ? \
+        syms_at(symbols, target, &into) : 0x0;
+    if (symbol) {
+        n = into ? snprintf(line + offset, size - offset, " <%s+%#lx>", symbol->name, into) : \
+            snprintf(line + offset, size - offset, " <%s>", symbol->name);
+        offset += n < 0 ? 0u : (size_t) n;
+    }
+    return offset < size ? offset : size - 1u;
 }
 
-/** @brief initialize the ux module, more specifically the worker pool. */
+/**
+ * @brief create the worker pool; one worker per usable cpu unless LZD_THREADS says otherwise,
+ *  and pinned to a cpu each if LZD_PIN is set.
+ *
+ * @param count the number of worker threads (0 for one per usable cpu).
+ * @param pin true if every worker should be pinned to its own cpu.
+ * @return the worker pool if successful, 0x0 o.w.
+ */
+internal wrk_pool_t*
+pool_make(size_t count, bool pin) {
+    wrk_pool_t* pool = wrk_pool_create(count > 0u ? count : wrk_cpu_count());
+    if (pool && pin) wrk_pool_pin(pool);
+    return pool;
+}
+
+/**
+ * @brief initialize the ux module, more specifically the worker pool and the budget of the
+ *  workspace (LZD_BUDGET, in MiB).
+ */
 void
 ux_init() {
-    g_wrk_pool = wrk_pool_create(4); /* max of 4 worker threads. */
+    const char* threads = getenv("LZD_THREADS");
+    const char* pin = getenv("LZD_PIN");
+    const char* budget = getenv("LZD_BUDGET");
+    size_t count = threads ? (size_t) strtoul(threads, 0x0, 10) : 0u;
+    size_t mib = budget ? (size_t) strtoul(budget, 0x0, 10) : 0u;
+    g_wrk_pool = pool_make(count, pin && pin[0] && strcmp(pin, "0") != 0);
+    g_wksp.budget = mib > 0u ? mib << 20 : WKSP_BUDGET;
 };
 
 /** @brief shutdown the ux module. */
 void
 ux_shutdown() {
-    wrk_pool_drain(g_wrk_pool);
-    emit_free(g_ctx);
+    /* every binary is closed with its tab; one that is still loading is waited for, and may be
+     *  installed along the way (closing drains the model). */
+    for (size_t i = 0; i < UI_MAX_TABS; i++)
+        wksp_close(&g_wksp, g_wrk_pool, i);
+}
+
+/**
+ * @brief hand every page posted from now on to a sink instead of the ui model (e.g. in batch
+ *  mode); set it before any job is posted and clear it once the pool is drained.
+ *
+ * @param sink the sink (ownership of each message is handed to it), or 0x0 for the ui model.
+ * @param arg the argument passed to the sink.
+ */
+void
+ux_set_sink(ux_sink_t sink, void* arg) {
+    g_sink = sink;
+    g_sink_arg = arg;
 }
 
 /**
@@ -98,25 +239,472 @@ ux_shutdown() {
 void
 ux_post(ux_page_msg_t* message) {
     if (!message) return;
+    message->posted = stat_now();
+    stat_add(STAT_PAGES_POSTED, 1u);
+    if (g_sink) {
+        g_sink(message, g_sink_arg);
+        return;
+    }
+
+    /* hand it to the ui thread through the inbox of the model, it installs the chunk between
+     *  frames (and frees the message); lines are formatted when drawn. */
+    extern ui_model_t* g_ui_model;
+    message->node.kind = UI_MSG_PAGE;
+    ui_model_post(g_ui_model, &message->node);
+}
+
+/**
+ * @brief take a snapshot of the stats of every thread, and of the queue of the worker pool.
+ *
+ * @param out the snapshot.
+ */
+void
+ux_stats(stat_snapshot_t* out) {
+    stat_snapshot(out, g_wrk_pool);
+}
 
-    /* format each instruction into a display string. */
-    _foreach(message->insns, ux_insn_t*, insn)
-        insn->full_string = format_insn(insn);
-        if (!insn->full_string) {
-            fprintf(stderr, "lzd, ux_post; format_insn failed for address 0x%lx.\n", insn->address);
+/**
+ * @brief look a name up as a symbol, or else (with an elf) as a loaded section.
+ *
+ * @param symbols the (indexed) symbols.
+ * @param elf the elf the sections are looked up in (or 0x0 for symbols only).
+ * @param name the name.
+ * @param address output for the address.
+ * @return true if the name is known, false o.w.
+ */
+internal bool
+resolve_name(const syms_t* symbols, elf_t* elf, const char* name, uint64_t* address) {
+    const elf_symbol_t* symbol = syms_find(symbols, name);
+    if (symbol) {
+        *address = symbol->value;
+        return true;
+    }
+    const elf_shdr_t* section = elf ? elf_section(elf, name) : 0x0;
+    if (!section || !(section->flags & ELF_SHF_ALLOC)) return false;
+    *address = section->addr;
+    return true;
+}
+
+/**
+ * @brief resolve a symbol (or section) name, optionally followed by "+<offset>", to an address.
+ *
+ * @param symbols the (indexed) symbols.
+ * @param elf the elf the sections are looked up in (or 0x0 for symbols only).
+ * @param text the name (and offset).
+ * @param address output for the address.
+ * @return true if the name is known, false o.w.
+ */
+internal bool
+resolve_symbol(const syms_t* symbols, elf_t* elf, const char* text, uint64_t* address) {
+    if (resolve_name(symbols, elf, text, address)) return true;
+
+    /* the name is everything before the last '+', the offset any number after it. */
+    const char* plus = strrchr(text, '+');
+    char name[256];
+    if (!plus || plus == text || (size_t) (plus - text) >= sizeof name) return false;
+    char* end = 0x0;
+    uint64_t offset = strtoull(plus + 1, &end, 0);
+    if (!end || end == plus + 1 || *end) return false;
+    memcpy(name, text, (size_t) (plus - text));
+    name[plus - text] = '\0';
+    if (!resolve_name(symbols, elf, name, address)) return false;
+    *address += offset;
+    return true;
+}
+
+/**
+ * @brief parse the target of an xrefs command, an address or a symbol (with an optional
+ *  offset); a data object stands for every address inside of it.
+ *
+ * @param model the ui model.
+ * @param text the address or symbol.
+ * @param lo output for the first address.
+ * @param hi output for the address past the last one.
+ * @return true if the target is known, false o.w.
+ */
+internal bool
+xrefs_range(ui_model_t* model, const char* text, uint64_t* lo, uint64_t* hi) {
+    int base = text[0] == '0' && (text[1] == 'x' || text[1] == 'X') ? 16 : 10;
+    char* end = 0x0;
+    uint64_t address = strtoull(text, &end, base);
+    if (end && end != text && !*end) {
+        *lo = address;
+        *hi = address + 1u;
+        return true;
+    }
+    stat_lock(&model->lock);
+    bool found = resolve_symbol(model->tab->symbols, 0x0, text, &address);
+    const elf_symbol_t* symbol = syms_find(model->tab->symbols, text);
+    pthread_mutex_unlock(&model->lock);
+    if (!found) return false;
+    *lo = address;
+    *hi = symbol && symbol->type == ELF_STT_OBJECT && symbol->size ? address + symbol->size : \
+        address + 1u;
+    return true;
+}
+
+/**
+ * @brief request decoding of a single placeholder chunk through emit_range, or copy it from
+ *  another binary that has decoded the same bytes already.
+ *
+ * @param bin the binary the store is of.
+ * @param store the instruction store.
+ * @param index the chunk index.
+ * @param prio the priority of the request.
+ * @param generation the generation of the token of the binary to request it in, 0 if only
+ *  closing the binary drops it.
+ */
+internal void
+request_chunk(wksp_bin_t* bin, insn_store_t* store, size_t index, wrk_prio_t prio, uint64_t generation) {
+    insn_chunk_t* chunk = store->chunks[index];
+    if (chunk->state == INSN_CHUNK_DECODED) return;
+    if (chunk->state == INSN_CHUNK_REQUESTED) {
+        /* it is on its way already; post it again only if that went stale, to move it ahead of
+         *  the prefetch, or so that a jump can't drop it ('decode all'). */
+        uint64_t current = atomic_load(&bin->ctx->token.generation);
+        bool stale = chunk->requested && chunk->requested != current;
+        bool sooner = prio == WRK_PRIO_HIGH && !chunk->urgent;
+        bool keep = generation == 0u && chunk->requested != 0u;
+        if (!stale && !sooner && !keep) return;
+        if (chunk->requested == 0u) generation = 0u;
+    }
+
+    /* a byte-identical region of another binary may have it decoded already, the copy is
+     *  installed like any decoded page (the model is locked, so it can't be posted directly). */
+    insn_chunk_t* copy = chunk->state == INSN_CHUNK_PENDING ? wksp_twin(&g_wksp, bin, chunk) : 0x0;
+    ux_page_msg_t* message = copy ? calloc(1u, sizeof *message) : 0x0;
+    if (message) {
+        message->base = chunk->base;
+        message->length = chunk->length;
+        message->read = chunk->length;
+        message->generation = generation;
+        message->owner = &bin->ctx->token;
+        message->chunk = copy;
+        ux_post(message);
+        chunk->state = INSN_CHUNK_REQUESTED;
+        chunk->requested = generation;
+        chunk->urgent = prio == WRK_PRIO_HIGH;
+        return;
+    }
+    if (emit_range(bin->ctx, g_wrk_pool, chunk->base, chunk->base + chunk->length, prio, \
+        generation) == 0) {
+        chunk->state = INSN_CHUNK_REQUESTED;
+        chunk->requested = generation;
+        chunk->urgent = prio == WRK_PRIO_HIGH;
+    }
+}
+
+/**
+ * @brief parse a byte pattern written in hex, pairs of digits with optional spaces in between
+ *  (e.g. "48 89 e5" or "4889e5").
+ *
+ * @param text the hex.
+ * @param out the buffer for the bytes.
+ * @param size the size of the buffer.
+ * @return the number of bytes, 0 if the hex is malformed or too long.
+ */
+internal size_t
+parse_hex(const char* text, uint8_t* out, size_t size) {
+    size_t length = 0u;
+    for (const char* p = text; *p;) {
+        if (*p == ' ') {
+            p++;
             continue;
         }
-    _endforeach;
+        const char* hi = strchr(g_hex, p[0] | 0x20);
+        const char* lo = p[1] ? strchr(g_hex, p[1] | 0x20) : 0x0;
+        if (!hi || !lo || length == size) return 0u;
+        out[length++] = (uint8_t) (((hi - g_hex) << 4) | (lo - g_hex));
+        p += 2;
+    }
+    return length;
+}
 
-    /* store in global ui model. */
-    extern ui_model_t* g_ui_model;
-    if (g_ui_model) {
-        ui_model_add_insns(g_ui_model, message->insns);
+/**
+ * @brief find every decoded instruction with the mnemonic of a find, and operands that contain
+ *  the rest of it; the postings are checked against the store a batch at a time, so the ui is
+ *  not held up for long.
+ *
+ * @param query the find.
+ * @param hits the hits to append to.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+find_insns(find_query_t* query, srch_hits_t* hits) {
+    ui_model_t* model = query->model;
+    ui_tab_t* tab = query->tab;
+    uint64_t* addresses = 0x0;
+    ssize_t found = srch_find_mnemonic(tab->search, query->mnemonic, &addresses);
+    if (found < 0) return -1;
+    ssize_t result = 0;
+    for (size_t i = 0; i < (size_t) found && result == 0; i += FIND_BATCH) {
+        stat_lock(&model->lock);
+        for (size_t j = i; j < (size_t) found && j < i + FIND_BATCH && result == 0; j++) {
+            ux_insn_t insn;
+            ssize_t row = insn_store_find(tab->instructions, addresses[j]);
+            if (row < 0 || insn_store_at(tab->instructions, (size_t) row, &insn) != 0 || \
+                insn.address != addresses[j]) continue;
+            if (query->operands[0] && (!insn.op_str || !strcasestr(insn.op_str, query->operands)))
+                continue;
+            result = srch_hits_push(hits, SRCH_HIT_INSN, SRCH_MATCH_EXACT, insn.address, 0u, \
+                strlen(insn.op_str ? insn.op_str : ""));
+        }
+        pthread_mutex_unlock(&model->lock);
+    }
+    free(addresses);
+    return result;
+}
+
+/**
+ * @brief rank the hits of every part of a find and hand them to the model, then free it.
+ *
+ * @param query the find, every part of it has finished.
+ */
+internal void
+find_finish(find_query_t* query) {
+    size_t total = 0u, counts[FIND_PARTS];
+    bool truncated = false, failed = false;
+    for (size_t i = 0; i < FIND_PARTS; i++) {
+        counts[i] = query->hits[i].count;
+        total += counts[i];
+        truncated |= query->hits[i].truncated;
+        failed |= query->failed[i];
+    }
+
+    /* one list over every part, ranked and cut to the most a find keeps. */
+    srch_hits_t ranked = { calloc(total ? total : 1u, sizeof *ranked.hits), 0u, total, truncated };
+    for (size_t i = 0; ranked.hits && i < FIND_PARTS; i++) {
+        if (counts[i]) memcpy(ranked.hits + ranked.count, query->hits[i].hits, counts[i] * sizeof *ranked.hits);
+        ranked.count += counts[i];
+    }
+    for (size_t i = 0; i < FIND_PARTS; i++) free(query->hits[i].hits);
+    if (!ranked.hits) {
+        fprintf(stderr, "lzd, find_finish; calloc failed; could not allocate memory for hits.\n");
+        failed = true;
+        ranked.count = 0u;
+    }
+    srch_rank(&ranked);
+    if (ranked.count > SRCH_MAX_HITS) {
+        ranked.count = SRCH_MAX_HITS;
+        truncated = true;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double ms = (double) (now.tv_sec - query->started.tv_sec) * 1e3 + \
+        (double) (now.tv_nsec - query->started.tv_nsec) / 1e6;
+    char status[256];
+    if (query->needle_length)
+        snprintf(status, sizeof status, "%zu%s hits for bytes %.96s in code (%.1f ms)%s", \
+            ranked.count, truncated ? "+" : "", query->pattern, ms, failed ? ", out of memory" : "");
+    else
+        snprintf(status, sizeof status, "%zu%s hits for '%.96s': %zu symbols, %zu instructions, " \
+            "%zu strings (%.1f ms)%s", ranked.count, truncated ? "+" : "", query->pattern, counts[0], \
+            counts[1], counts[2], ms, failed ? ", out of memory" : "");
+    ui_model_set_finds(query->model, query->generation, ranked.hits, ranked.count, status);
+    free(query);
+}
+
+/**
+ * @brief run the next part of a find (a job), the last part to finish ranks the hits.
+ *
+ * @param arg the find_query_t.
+ */
+internal void
+find_job(void* arg) {
+    find_query_t* query = arg;
+    size_t part = atomic_fetch_add(&query->next, 1u);
+    srch_hits_t* hits = &query->hits[part];
+    ui_tab_t* tab = query->tab;
+    ssize_t result = 0;
+    if (query->needle_length) {
+        /* a piece of every region per part, every piece reads on into the next one by the
+         *  length of the pattern less one, so a match that crosses into it is found exactly once. */
+        for (size_t r = 0; r < query->region_count && result == 0; r++) {
+            const emit_region_t* region = &query->regions[r];
+            size_t piece = (region->size + FIND_PARTS - 1u) / FIND_PARTS;
+            size_t lo = part * piece < region->size ? part * piece : region->size;
+            size_t hi = lo + piece < region->size ? lo + piece : region->size;
+            size_t end = hi + query->needle_length - 1u;
+            if (hi > lo) result = srch_find_bytes(region->data + lo, (end < region->size ? end : \
+                region->size) - lo, region->vaddr + lo, query->needle, query->needle_length, hits);
+        }
+    } else {
+        switch (part) {
+            case 0u: result = srch_find_symbols(tab->search, tab->symbols, query->pattern, hits); break;
+            case 1u: result = query->mnemonic[0] ? find_insns(query, hits) : 0; break;
+            case 2u: result = srch_find_strings(tab->search, tab->strings, query->pattern, hits); break;
+            default: break;
+        }
     }
+    query->failed[part] = result != 0;
+    if (atomic_fetch_sub(&query->remaining, 1u) == 1u) find_finish(query);
+}
 
-    /* free the message (instructions now owned by model). */
-    dyna_free(message->insns);
-    free(message);
+/**
+ * @brief start a find on the pool (or on the calling thread if there is none), its hits show up
+ *  in the find view when every part is done.
+ *
+ * @param model the ui model.
+ * @param pattern the text, or "bytes <hex>" for a byte pattern in the executable regions.
+ * @return -1 if the find could not be started, 0 o.w.
+ */
+internal ssize_t
+find_start(ui_model_t* model, const char* pattern) {
+    find_query_t* query = calloc(1u, sizeof *query);
+    if (!query) {
+        fprintf(stderr, "lzd, find_start; calloc failed; could not allocate memory for find.\n");
+        snprintf(model->status, sizeof(model->status), "could not start find.");
+        return -1;
+    }
+    /* a tab that is still loading has nothing to search yet, and a find holds on to the tab (and
+     *  its regions) until it is done; it counts as a job of the binary, closing waits for it. */
+    wksp_bin_t* bin = wksp_active(&g_wksp, model);
+    if (!bin) {
+        if (g_wksp.bins[model->active])
+            snprintf(model->status, sizeof(model->status), "%s is still loading.", model->tab->name);
+        else snprintf(model->status, sizeof(model->status), "no binary opened.");
+        free(query);
+        return -1;
+    }
+    query->model = model;
+    query->tab = model->tab;
+    clock_gettime(CLOCK_MONOTONIC, &query->started);
+    if (!strncmp(pattern, "bytes ", 6u)) {
+        query->needle_length = parse_hex(pattern + 6, query->needle, sizeof query->needle);
+        if (query->needle_length == 0u) {
+            snprintf(model->status, sizeof(model->status), \
+                "usage: find bytes <hex> (e.g. find bytes 48 89 e5)");
+            free(query);
+            return -1;
+        }
+        snprintf(query->pattern, sizeof query->pattern, "%s", pattern + 6);
+        query->regions = bin->ctx->regions;
+        query->region_count = bin->ctx->region_count;
+    } else {
+        /* the first word may be a mnemonic, and the rest a part of its operands. */
+        snprintf(query->pattern, sizeof query->pattern, "%s", pattern);
+        size_t length = strcspn(query->pattern, " ");
+        for (size_t i = 0; i < length && i < sizeof query->mnemonic - 1u; i++)
+            query->mnemonic[i] = (char) (query->pattern[i] | (query->pattern[i] >= 'A' && \
+                query->pattern[i] <= 'Z' ? 0x20 : 0x0));
+        if (length >= sizeof query->mnemonic) query->mnemonic[0] = '\0';
+        query->operands = query->pattern + length;
+        while (*query->operands == ' ') query->operands++;
+    }
+    if (!query->operands) query->operands = "";
+
+    /* drop the hits of the last find, the ones of any find still running will be dropped too. */
+    stat_lock(&model->lock);
+    query->generation = ++model->find_generation;
+    free(model->tab->finds);
+    model->tab->finds = 0x0;
+    model->tab->find_count = 0u;
+    line_cache_clear(model->lines);
+    pthread_mutex_unlock(&model->lock);
+    ui_model_set_view(model, UI_VIEW_FIND);
+    stat_lock(&model->lock);
+    snprintf(model->status, sizeof(model->status), "searching for %s%.128s...", \
+        query->needle_length ? "bytes " : "", query->pattern);
+    pthread_mutex_unlock(&model->lock);
+
+    /* every part is a job of its own, the query is freed by the last one. */
+    size_t parts = query->needle_length ? FIND_PARTS : 3u;
+    atomic_init(&query->next, 0u);
+    atomic_init(&query->remaining, parts);
+    job_t jobs[FIND_PARTS];
+    for (size_t i = 0; i < parts; i++) jobs[i] = (job_t){ find_job, query };
+    if (!g_wrk_pool || wrk_pool_post_latched(g_wrk_pool, jobs, parts, WRK_PRIO_HIGH, \
+        &bin->ctx->token.inflight) != 0)
+        for (size_t i = 0; i < parts; i++) find_job(query);
+    return 0;
+}
+
+/**
+ * @brief request decoding of every placeholder around the visible rows, with prefetch ahead of
+ *  the scroll direction (lazy mode); the model must be locked by the caller.
+ *
+ * @param model the ui model.
+ * @param first the first visible row.
+ * @param count the number of visible rows.
+ * @param direction < 0 if scrolling up, > 0 if scrolling down, 0 o.w.
+ */
+void
+ux_request_rows(ui_model_t* model, size_t first, size_t count, int direction) {
+    wksp_bin_t* bin = wksp_active(&g_wksp, model);
+    insn_store_t* store = model ? model->tab->instructions : 0x0;
+    if (!bin || !g_wrk_pool || !store || store->pending == 0u || store->rows == 0u) return;
+
+    /* prefetch two screens ahead of where we are scrolling, and half a screen behind. */
+    size_t ahead = count * 2u, behind = count / 2u;
+    size_t before = direction < 0 ? ahead : behind;
+    size_t after = direction < 0 ? behind : ahead;
+    size_t lo = first > before ? first - before : 0u;
+    size_t hi = first + count + after;
+    if (hi >= store->rows) hi = store->rows - 1u;
+
+    /* the visible placeholders go first, the rest is prefetch; both are dropped after a jump. */
+    size_t last = first + count > 0u ? first + count - 1u : 0u;
+    ssize_t a = insn_store_chunk(store, lo), b = insn_store_chunk(store, hi);
+    ssize_t c = insn_store_chunk(store, first < store->rows ? first : store->rows - 1u);
+    ssize_t d = insn_store_chunk(store, last < store->rows ? last : store->rows - 1u);
+    if (a < 0 || b < 0 || c < 0 || d < 0) return;
+    uint64_t generation = atomic_load(&bin->ctx->token.generation);
+    for (ssize_t i = c; i <= d; i++)
+        request_chunk(bin, store, (size_t) i, WRK_PRIO_HIGH, generation);
+    for (ssize_t i = a; i <= b; i++)
+        if (i < c || i > d) request_chunk(bin, store, (size_t) i, WRK_PRIO_LOW, generation);
+}
+
+/**
+ * @brief install a binary that finished loading in the background into its tab, on the ui
+ *  thread (once its UI_MSG_LOADED is drained); one that was closed (or installed) since is skipped.
+ *
+ * @param model the ui model.
+ * @param binary the binary of the workspace that was loaded.
+ */
+void
+ux_loaded(ui_model_t* model, void* binary) {
+    wksp_bin_t* bin = 0x0;
+    for (size_t i = 0; i < UI_MAX_TABS; i++)
+        if (g_wksp.bins[i] == binary) bin = g_wksp.bins[i];
+    if (!bin) return;
+    int state = atomic_load(&bin->state);
+    if (state != WKSP_LOADED && state != WKSP_FAILED) return;
+    wksp_install(&g_wksp, bin, model->status, sizeof(model->status));
+    model->dirty = UI_DIRTY_ALL;
+}
+
+/**
+ * @brief keep the decoded chunks of every open binary under the memory budget, evicting the
+ *  ones of the tabs that were shown least recently first; on the ui thread, between frames.
+ *
+ * @param model the ui model.
+ */
+void
+ux_reclaim(ui_model_t* model) {
+    size_t freed = wksp_reclaim(&g_wksp, g_wrk_pool);
+    if (freed == 0u) return;
+    snprintf(model->status, sizeof(model->status), "over the budget of %zu MiB, evicted %zu MiB of " \
+        "decoded chunks from inactive tabs", g_wksp.budget >> 20, freed >> 20);
+    model->dirty |= UI_DIRTY_FOOTER;
+}
+
+/**
+ * @brief move the selection of the current view by a number of rows, within its bounds; the
+ *  list scrolls along when it is drawn.
+ *
+ * @param model the ui model.
+ * @param delta the number of rows to move by (< 0 is up).
+ * @return TUI_ACT_NONE.
+ */
+internal ui_act_t
+move_selection(ui_model_t* model, ssize_t delta) {
+    ssize_t rows = (ssize_t) ui_model_rows(model), selected = model->tab->selected + delta;
+    if (selected >= rows) selected = rows - 1;
+    if (selected < 0) selected = 0;
+    model->tab->selected = selected;
+    return TUI_ACT_NONE;
 }
 
 /**
@@ -132,25 +720,18 @@ ux_handle_key(ui_model_t* model, int character) {
 
     /* iterate through each character. */
     switch (character) {
-        case KEY_UP: {
-            if (model->selected > 0) model->selected--;
-            return TUI_ACT_NONE;
-        }
-        case KEY_DOWN: {
-            if (model->selected < (ssize_t)model->instructions->length - 1) model->selected++;
-            return TUI_ACT_NONE;
-        }
-        case KEY_PPAGE: /* page up. */ {
-            model->selected -= 10;
-            if (model->selected < 0) model->selected = 0;
-            return TUI_ACT_NONE;
-        }
-        case KEY_NPAGE: /* page down. */ {
-            model->selected += 10;
-            if (model->selected >= (ssize_t)model->instructions->length)
-                model->selected = (ssize_t)model->instructions->length - 1;
-            return TUI_ACT_NONE;
-        }
+        case KEY_UP: return move_selection(model, -1);
+        case KEY_DOWN: return move_selection(model, 1);
+        case KEY_PPAGE: /* page up, by as many rows as the list shows. */
+            return move_selection(model, -(model->page ? (ssize_t) model->page : UX_PAGE_ROWS));
+        case KEY_NPAGE: /* page down. */
+            return move_selection(model, model->page ? (ssize_t) model->page : UX_PAGE_ROWS);
+        case KEY_SPREVIOUS: /* shift + page up, a tenth of the view (a jump on the scrollbar). */
+            return move_selection(model, -(ssize_t) (ui_model_rows(model) / 10u + 1u));
+        case KEY_SNEXT: /* shift + page down. */
+            return move_selection(model, (ssize_t) (ui_model_rows(model) / 10u + 1u));
+        case KEY_HOME: return move_selection(model, -(ssize_t) ui_model_rows(model));
+        case KEY_END: return move_selection(model, (ssize_t) ui_model_rows(model));
         case '\n':
         case KEY_ENTER: /* perform action. */ {
             if (!strcmp(model->cmd, "quit"))
@@ -174,74 +755,305 @@ ux_handle_key(ui_model_t* model, int character) {
                 memset(model->cmd, 0, sizeof(model->cmd));
                 return TUI_ACT_NONE;
             }
+            if (!strcmp(model->cmd, "view xrefs")) {
+                ui_model_set_view(model, UI_VIEW_XREFS);
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_NONE;
+            }
+            if (!strncmp(model->cmd, "xrefs ", 6u)) {
+                /* look the target up in the xref index, only decoded code has references. */
+                const char* target = model->cmd + 6;
+                uint64_t lo = 0u, hi = 0u;
+                xref_hit_t* hits = 0x0;
+                ssize_t found = xrefs_range(model, target, &lo, &hi) ? \
+                    xref_index_query(model->tab->xrefs, lo, hi, &hits) : -1;
+                if (found < 0) {
+                    snprintf(model->status, sizeof(model->status), "unknown address or symbol: %s", target);
+                    memset(model->cmd, 0, sizeof(model->cmd));
+                    return TUI_ACT_NONE;
+                }
+
+                /* keep the ones whose instruction is still in the store (seams drop some). */
+                stat_lock(&model->lock);
+                size_t kept = 0u, pending = model->tab->instructions->pending;
+                for (size_t i = 0; i < (size_t) found; i++) {
+                    ux_insn_t from;
+                    ssize_t row = insn_store_find(model->tab->instructions, hits[i].from);
+                    if (row >= 0 && insn_store_at(model->tab->instructions, (size_t) row, &from) == 0 && \
+                        from.address == hits[i].from) hits[kept++] = hits[i];
+                }
+                pthread_mutex_unlock(&model->lock);
+                ui_model_set_refs(model, hits, kept);
+                ui_model_set_view(model, UI_VIEW_XREFS);
+                snprintf(model->status, sizeof(model->status), "%zu xrefs to %s%s", kept, target, \
+                    pending ? " (some code is not decoded yet, 'decode all' finds every one)" : "");
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_NONE;
+            }
+            if (!strcmp(model->cmd, "view find")) {
+                ui_model_set_view(model, UI_VIEW_FIND);
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_NONE;
+            }
+            if (!strcmp(model->cmd, "view stats")) {
+                ui_model_set_view(model, UI_VIEW_STATS);
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_NONE;
+            }
+            if (!strcmp(model->cmd, "view diff")) {
+                ui_model_set_view(model, UI_VIEW_DIFF);
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_NONE;
+            }
+            if (!strncmp(model->cmd, "diff ", 5u)) {
+                /* the new binary is opened in a tab of its own and diffed while it loads. */
+                const char* filename = model->cmd + 5;
+                while (*filename == ' ') filename++;
+                wksp_bin_t* base = wksp_active(&g_wksp, model);
+                FILE* file = *filename ? fopen(filename, "rb") : 0x0;
+                if (!*filename) snprintf(model->status, sizeof(model->status), "usage: diff <path>");
+                else if (!file) snprintf(model->status, sizeof(model->status), \
+                    "file could not be found of path: %s", filename);
+                else if (!base) snprintf(model->status, sizeof(model->status), \
+                    "no binary opened to diff against.");
+                else {
+                    wksp_bin_t* bin = wksp_open(&g_wksp, model, g_wrk_pool, filename, false, base);
+                    if (!bin) snprintf(model->status, sizeof(model->status), \
+                        "could not open %s, the workspace is full (%u tabs), close one first.", \
+                        filename, UI_MAX_TABS);
+                    else {
+                        base->shown = stat_now();
+                        ui_model_switch_tab(model, bin->slot);
+                        snprintf(model->status, sizeof(model->status), "diffing %.100s against %.100s...", \
+                            filename, base->path);
+                    }
+                }
+                if (file) fclose(file);
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_OPEN;
+            }
+            if (!strncmp(model->cmd, "find ", 5u)) {
+                /* the search runs on the pool, its hits land in the find view when it is done. */
+                const char* pattern = model->cmd + 5;
+                while (*pattern == ' ') pattern++;
+                if (!*pattern) snprintf(model->status, sizeof(model->status), "usage: find <text>|bytes <hex>");
+                else find_start(model, pattern);
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_NONE;
+            }
+            if (!strcmp(model->cmd, "decode all")) {
+                /* leave lazy mode, decode every code range that is still a placeholder; in the
+                 *  background, and without a generation so that a jump doesn't drop any of it. */
+                size_t requested = 0u;
+                wksp_bin_t* bin = wksp_active(&g_wksp, model);
+                stat_lock(&model->lock);
+                for (size_t i = 0; bin && i < model->tab->instructions->count; i++) {
+                    if (model->tab->instructions->chunks[i]->state == INSN_CHUNK_DECODED) continue;
+                    request_chunk(bin, model->tab->instructions, i, WRK_PRIO_LOW, 0u);
+                    requested++;
+                }
+                pthread_mutex_unlock(&model->lock);
+                snprintf(model->status, sizeof(model->status), "decoding %zu code ranges", requested);
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_NONE;
+            }
+            if (!strncmp(model->cmd, "threads", 7u) && (model->cmd[7] == ' ' || !model->cmd[7])) {
+                /* "threads" reports the pool, "threads <n|auto> [pin]" rebuilds it. */
+                char mode[16] = { 0 }, pin[8] = { 0 };
+                int fields = sscanf(model->cmd + 7, "%15s %7s", mode, pin);
+                if (fields >= 1 && wksp_loading(&g_wksp)) {
+                    /* a binary that is loading runs its parallel parts on the pool. */
+                    snprintf(model->status, sizeof(model->status), \
+                        "a binary is still loading, resize the pool once it is done.");
+                    memset(model->cmd, 0, sizeof(model->cmd));
+                    return TUI_ACT_NONE;
+                }
+                if (fields >= 1) {
+                    char* end = 0x0;
+                    size_t count = strcmp(mode, "auto") ? (size_t) strtoul(mode, &end, 10) : 0u;
+                    if ((end && (*end || count == 0u)) || (fields == 2 && strcmp(pin, "pin"))) {
+                        snprintf(model->status, sizeof(model->status), \
+                            "usage: threads [<n>|auto] [pin]");
+                        memset(model->cmd, 0, sizeof(model->cmd));
+                        return TUI_ACT_NONE;
+                    }
+
+                    /* let every job finish before the workers go away. */
+                    wrk_pool_drain(g_wrk_pool);
+                    wrk_pool_destroy(g_wrk_pool);
+                    g_wrk_pool = pool_make(count, fields == 2);
+                }
+                if (g_wrk_pool)
+                    snprintf(model->status, sizeof(model->status), "%zu worker threads%s", \
+                        g_wrk_pool->count, g_wrk_pool->pinned ? " (pinned)" : "");
+                else
+                    snprintf(model->status, sizeof(model->status), "could not create worker pool.");
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_NONE;
+            }
+            if (!strcmp(model->cmd, "tabs")) {
+                /* every tab as "<n>:<name>", the one that is shown in brackets. */
+                size_t offset = (size_t) snprintf(model->status, sizeof(model->status), "tabs:");
+                for (size_t i = 0; i < UI_MAX_TABS && offset < sizeof(model->status); i++) {
+                    if (!model->tabs[i].open) continue;
+                    wksp_bin_t* bin = g_wksp.bins[i];
+                    int n = snprintf(model->status + offset, sizeof(model->status) - offset, \
+                        i == model->active ? " [%zu:%s%s]" : " %zu:%s%s", i + 1u, model->tabs[i].name, \
+                        !bin ? "" : bin->joinable ? " (loading)" : bin->evicted ? " (evicted)" : "");
+                    offset += n < 0 ? 0u : (size_t) n;
+                }
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_NONE;
+            }
+            if (!strncmp(model->cmd, "tab ", 4u)) {
+                char* end = 0x0;
+                size_t slot = (size_t) strtoul(model->cmd + 4, &end, 10) - 1u;
+                if (!end || *end || slot >= UI_MAX_TABS || !model->tabs[slot].open) {
+                    snprintf(model->status, sizeof(model->status), "no such tab: %s ('tabs' lists them)", \
+                        model->cmd + 4);
+                    memset(model->cmd, 0, sizeof(model->cmd));
+                    return TUI_ACT_NONE;
+                }
+                /* what was requested around the old viewport is stale, and that tab is the
+                 *  first to be evicted from now on (it was shown least recently). */
+                wksp_bin_t* old = wksp_active(&g_wksp, model);
+                if (old) {
+                    disj_token_bump(&old->ctx->token);
+                    old->shown = stat_now();
+                }
+                ui_model_switch_tab(model, slot);
+                wksp_bin_t* bin = wksp_active(&g_wksp, model);
+                if (bin) bin->shown = stat_now();
+                snprintf(model->status, sizeof(model->status), "tab %zu: %.200s", slot + 1u, model->tab->subtitle);
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_NONE;
+            }
+            if (!strcmp(model->cmd, "close")) {
+                /* drops what is still queued for it, writes its decode cache and unmaps it. */
+                wksp_bin_t* bin = g_wksp.bins[model->active];
+                bool based = false;
+                for (size_t i = 0; bin && i < UI_MAX_TABS; i++)
+                    based |= g_wksp.bins[i] && g_wksp.bins[i]->against == bin;
+                if (bin && bin->joinable)
+                    snprintf(model->status, sizeof(model->status), "%s is still loading.", model->tab->name);
+                else if (based)
+                    snprintf(model->status, sizeof(model->status), "%s is still being diffed against.", \
+                        model->tab->name);
+                else if (!bin) snprintf(model->status, sizeof(model->status), "no binary opened.");
+                else {
+                    snprintf(model->status, sizeof(model->status), "closed %.200s", bin->path);
+                    wksp_close(&g_wksp, g_wrk_pool, model->active);
+                    bin = wksp_active(&g_wksp, model);
+                    if (bin) bin->shown = stat_now();
+                }
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_NONE;
+            }
+            if (!strncmp(model->cmd, "budget", 6u) && (model->cmd[6] == ' ' || !model->cmd[6])) {
+                /* "budget" reports what every binary maps, "budget <MiB>" sets how much they may. */
+                if (model->cmd[6]) {
+                    char* end = 0x0;
+                    size_t mib = (size_t) strtoul(model->cmd + 7, &end, 10);
+                    if (!end || *end || mib == 0u) {
+                        snprintf(model->status, sizeof(model->status), "usage: budget [<MiB>]");
+                        memset(model->cmd, 0, sizeof(model->cmd));
+                        return TUI_ACT_NONE;
+                    }
+                    g_wksp.budget = mib << 20;
+                }
+                size_t freed = wksp_reclaim(&g_wksp, g_wrk_pool);
+                snprintf(model->status, sizeof(model->status), "%zu of %zu MiB of decoded chunks mapped%s", \
+                    wksp_mapped(&g_wksp) >> 20, g_wksp.budget >> 20, freed ? " (evicted inactive tabs)" : "");
+                memset(model->cmd, 0, sizeof(model->cmd));
+                return TUI_ACT_NONE;
+            }
             if (strstr(model->cmd, "goto ")) {
                 char* space = strchr(model->cmd, ' ');
                 if (space) {
                     char* address = space + 1;
-                    if (model->instructions->length == 0) {
+                    wksp_bin_t* bin = wksp_active(&g_wksp, model);
+                    if (model->tab->view_mode == UI_VIEW_INSTRUCTIONS && (!bin || model->tab->instructions->rows == 0)) {
                         snprintf(model->status, sizeof(model->status), "no instructions loaded.");
                         memset(model->cmd, 0, sizeof(model->cmd));
                         return TUI_ACT_NONE;
                     }
-                    if (model->view_mode != UI_VIEW_INSTRUCTIONS) {
-                        snprintf(model->status, sizeof(model->status), "must be in instructions view to goto address.");
-                        memset(model->cmd, 0, sizeof(model->cmd));
-                        return TUI_ACT_NONE;
-                    }
 
-                    /* parse address. */
+                    /* parse address, anything that isn't a number is a symbol (or section) name. */
                     int base = 10;
                     if (address[0] == '0' && (address[1] == 'x' || address[1] == 'X')) base = 16;
                     char* end = 0x0;
                     unsigned long long addr = strtoull(address, &end, base);
-                    if (!end || end == address) {
-                        snprintf(model->status, sizeof(model->status), "invalid address: %s", address);
-                        memset(model->cmd, 0, sizeof(model->cmd));
-                        return TUI_ACT_NONE;
+                    if (!end || end == address || *end) {
+                        uint64_t value = 0u;
+                        stat_lock(&model->lock);
+                        bool found = resolve_symbol(model->tab->symbols, bin ? bin->ctx->elf : 0x0, \
+                            address, &value);
+                        pthread_mutex_unlock(&model->lock);
+                        addr = (unsigned long long) value;
+                        if (!found) {
+                            snprintf(model->status, sizeof(model->status), \
+                                "unknown symbol or section: %s", address);
+                            memset(model->cmd, 0, sizeof(model->cmd));
+                            return TUI_ACT_NONE;
+                        }
                     }
-                    ux_insn_t* first = _get(model->instructions, ux_insn_t*, 0);
-                    ux_insn_t* last = _get(model->instructions, ux_insn_t*, model->instructions->length - 1);
-                    if (!first || !last) {
-                        snprintf(model->status, sizeof(model->status), "no instructions loaded.");
+
+                    /* any other view goes to its row at the address (or else the closest after). */
+                    if (model->tab->view_mode != UI_VIEW_INSTRUCTIONS) {
+                        ssize_t row = ui_model_provider(model)->row(model, (uint64_t) addr);
+                        if (row < 0) snprintf(model->status, sizeof(model->status), \
+                            "nothing at or after 0x%llx in this view.", addr);
+                        else {
+                            model->tab->selected = row;
+                            model->tab->scroll = row;
+                            snprintf(model->status, sizeof(model->status), "goto 0x%llx", addr);
+                        }
                         memset(model->cmd, 0, sizeof(model->cmd));
                         return TUI_ACT_NONE;
                     }
-                    if (addr < (unsigned long long)first->address || addr > (unsigned long long)last->address) {
+                    /* find nearest instruction at/after addr (the store is address-ordered),
+                     *  bounded by the code ranges whether they are decoded yet or not. */
+                    stat_lock(&model->lock);
+                    insn_store_t* store = model->tab->instructions;
+                    insn_chunk_t* first = store->chunks[0];
+                    insn_chunk_t* last = store->chunks[store->count - 1u];
+                    if (addr < (unsigned long long)first->base || \
+                        addr >= (unsigned long long)(last->base + last->length)) {
+                        pthread_mutex_unlock(&model->lock);
                         snprintf(model->status, sizeof(model->status), "invalid address: %s", address);
                         memset(model->cmd, 0, sizeof(model->cmd));
                         return TUI_ACT_NONE;
                     }
+                    ssize_t best = insn_store_find(store, (uint64_t) addr);
+                    if (best < 0) best = (ssize_t) store->rows - 1;
 
-                    /* find nearest instruction at/after addr. */
-                    ssize_t lo = 0;
-                    ssize_t hi = (ssize_t)model->instructions->length - 1;
-                    ssize_t best = hi;
-                    while (lo <= hi) {
-                        ssize_t mid = lo + (hi - lo) / 2;
-                        ux_insn_t* insn = _get(model->instructions, ux_insn_t*, mid);
-                        if (!insn) break;
-
-                        if ((unsigned long long)insn->address >= addr) {
-                            best = mid;
-                            hi = mid - 1;
-                        } else {
-                            lo = mid + 1;
-                        }
+                    /* whatever was requested around the old viewport is stale now. */
+                    uint64_t generation = disj_token_bump(&bin->ctx->token);
+
+                    /* landed in a placeholder, decode it now and reselect when it arrives. */
+                    ssize_t at = insn_store_chunk(store, (size_t) best);
+                    if (at >= 0 && store->chunks[at]->state != INSN_CHUNK_DECODED) {
+                        request_chunk(bin, store, (size_t) at, WRK_PRIO_HIGH, generation);
+                        model->tab->goto_address = (uint64_t) addr;
+                        model->tab->goto_pending = true;
                     }
-                    model->selected = best;
-                    model->scroll = best;
+                    pthread_mutex_unlock(&model->lock);
+                    model->tab->selected = best;
+                    model->tab->scroll = best;
                     snprintf(model->status, sizeof(model->status), "goto 0x%llx", addr);
                     memset(model->cmd, 0, sizeof(model->cmd));
                     return TUI_ACT_NONE;
                 }
             }
             if (strstr(model->cmd, "open ")) {
-                /* get the inputted file name. */
+                /* get the inputted file name, after -r only reachable code is disassembled. */
                 char* space = strchr(model->cmd, ' ');
+                bool descent = space && !strncmp(space + 1, "-r ", 3u);
+                if (descent) space = strchr(space + 1, ' ');
                 if (space) {
                     char* filename = space + 1;
 
-                    /* tell the emitter to load the ENTIRE .text section. */
+                    /* tell the emitter to load every executable region. */
                     FILE* file = fopen(filename, "rb");
                     if (!file) {
                         snprintf(model->status, sizeof(model->status), \
@@ -250,68 +1062,16 @@ ux_handle_key(ui_model_t* model, int character) {
                     }
                     fclose(file);
 
-                    /* remove all the old instructions and put in the new. */
-                    for (size_t i = 0; i < model->instructions->length; i++) {
-                        ux_insn_t* insn = _get(model->instructions, ux_insn_t*, i);
-                        free(insn->full_string);
-                        free(insn);
-                    }
-                    dyna_free(model->instructions);
-                    model->instructions = dyna_create();
-
-                    /* remove all the old strings and put in the new. */
-                    // _foreach(model->strings, char*, str)
-                    //     if (str != NULL) free(str);
-                    // _endforeach
-                    dyna_free(model->strings);
-                    model->strings = dyna_create();
-
-                    /* remove all the old symbols. */
-                    _foreach(model->symbols, elf_symbol_t*, sym)
-                        free(sym);
-                    _endforeach
-                    dyna_free(model->symbols);
-                    model->symbols = dyna_create();
-
-                    /* call the emitter to load the entire section of .text */
-                    g_ctx = emit_load(filename, (tup_arch_t){ 0, 0 });
-                    emit_scan_text(g_ctx);
-                    emit_all(g_ctx, g_wrk_pool);
-
-                    /* extract strings from elf and add to model. */
-                    dyna_t* extracted = emit_extract_strings(g_ctx, 4);
-                    if (extracted) ui_model_add_strings(model, extracted);
-                    dyna_free(extracted);
-
-                    /* extract symbols from elf and add to model. */
-                    dyna_t* symbols = emit_extract_symbols(g_ctx);
-                    if (extracted) ui_model_add_symbols(model, symbols);
-
-                    /* update status and subtitle. */
-                    snprintf(model->status, sizeof(model->status), \
-                        "successfully disassembled: %s", filename);
-
-                    /* get the architecture string. */
-                    char arch[16u];
-                    switch (g_ctx->tuple.arch) {
-                        case CS_ARCH_X86: {
-                            snprintf(arch, sizeof(arch), "x86");
-                            if (g_ctx->tuple.mode == CS_MODE_64)
-                                strcat(arch, "_64");
-                            break;
-                        }
-                        case CS_ARCH_AARCH64: {
-                            snprintf(arch, sizeof(arch), "aarch64");
-                            break;
-                        }
-                        case CS_ARCH_ARM: {
-                            snprintf(arch, sizeof(arch), "arm");
-                            break;
-                        }
-                        default: break;
+                    /* it loads in the background, in a tab of its own; the old binaries stay
+                     *  open (and keep decoding) next to it. */
+                    wksp_bin_t* bin = wksp_open(&g_wksp, model, g_wrk_pool, filename, descent, 0x0);
+                    if (!bin) snprintf(model->status, sizeof(model->status), \
+                        "could not open %s, the workspace is full (%u tabs), close one first.", \
+                        filename, UI_MAX_TABS);
+                    else {
+                        ui_model_switch_tab(model, bin->slot);
+                        snprintf(model->status, sizeof(model->status), "loading %s...", filename);
                     }
-                    snprintf(model->subtitle, 128u, \
-                        "%s | %s", filename, arch);
                     memset(model->cmd, 0, sizeof(model->cmd));
                     return TUI_ACT_OPEN;
                 }
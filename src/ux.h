@@ -12,28 +12,36 @@
 /*! @uses dyna_t. */
 #include "dyna.h"
 
-/* ... */
-typedef struct {
-    uint64_t address;
-    uint8_t size;
-    uint8_t bytes[16];
+/*! @uses ux_insn_t, insn_chunk_t. */
+#include "insn.h"
+
+/*! @uses syms_t. */
+#include "syms.h"
 
-    /* used in the tui. */
-    char mnemonic[32];
-    char op_str[128];
-    char* full_string;
-} ux_insn_t;
+/*! @uses msgq_node_t. */
+#include "msgq.h"
+
+/*! @uses stat_snapshot_t. */
+#include "stat.h"
 
 /* ... */
 typedef struct {
+    msgq_node_t node; /* link in the model's inbox (UI_MSG_PAGE), the first member. */
     uint64_t base; /* chunk base address */
     size_t length; /* visible bytes */
     size_t read; /* bytes read (length + overlap) */
     pid_t pid;
-    dyna_t* insns; /* dyna of ux_insn_t (owned by ux thread after post). */
+    uint64_t generation; /* generation the job was posted in (see disj_token_t). */
+    const void* owner; /* token of the binary it was decoded from, picks the tab it goes to. */
+    uint64_t posted; /* stat_now() when it was posted, for the post latency. */
+    insn_chunk_t* chunk; /* packed decoded instructions (owned by ux thread after post), 0x0 if
+                          *  the job went stale. */
 } ux_page_msg_t;
 
-/** @brief initialize the ux module, more specifically the worker pool. */
+/**
+ * @brief initialize the ux module, more specifically the worker pool and the budget of the
+ *  workspace (LZD_BUDGET, in MiB).
+ */
 void ux_init();
 
 /** @brief shutdown the ux module. */
@@ -47,6 +55,74 @@ void ux_shutdown();
 void
 ux_post(ux_page_msg_t* message);
 
+/* a consumer of decoded pages other than the ui model, called on the worker threads. */
+typedef void (*ux_sink_t)(ux_page_msg_t* message, void* arg);
+
+/**
+ * @brief hand every page posted from now on to a sink instead of the ui model (e.g. in batch
+ *  mode); set it before any job is posted and clear it once the pool is drained.
+ *
+ * @param sink the sink (ownership of each message is handed to it), or 0x0 for the ui model.
+ * @param arg the argument passed to the sink.
+ */
+void
+ux_set_sink(ux_sink_t sink, void* arg);
+
+/**
+ * @brief format a single instruction into a line for display, an operand that is an address
+ *  inside of a symbol is annotated with it (e.g. "call 0x401136 <main>").
+ *
+ * @param insn the instruction to format.
+ * @param symbols the (indexed) symbols to annotate with (or 0x0).
+ * @param line the buffer to format into.
+ * @param size the size of the buffer.
+ * @return the length of the formatted line.
+ */
+size_t
+ux_format_insn(const ux_insn_t* insn, const syms_t* symbols, char* line, size_t size);
+
+/**
+ * @brief take a snapshot of the stats of every thread, and of the queue of the worker pool.
+ *
+ * @param out the snapshot.
+ */
+void
+ux_stats(stat_snapshot_t* out);
+
+/*! @uses ui_model_t, ui_act_t. */
+#include "ui.h"
+
+/**
+ * @brief install a binary that finished loading in the background into its tab, on the ui
+ *  thread (once its UI_MSG_LOADED is drained).
+ *
+ * @param model the ui model.
+ * @param binary the binary of the workspace that was loaded.
+ */
+void
+ux_loaded(ui_model_t* model, void* binary);
+
+/**
+ * @brief keep the decoded chunks of every open binary under the memory budget, evicting the
+ *  ones of the tabs that were shown least recently first; on the ui thread, between frames.
+ *
+ * @param model the ui model.
+ */
+void
+ux_reclaim(ui_model_t* model);
+
+/**
+ * @brief request decoding of every placeholder around the visible rows, with prefetch ahead of
+ *  the scroll direction (lazy mode); the model must be locked by the caller.
+ *
+ * @param model the ui model.
+ * @param first the first visible row.
+ * @param count the number of visible rows.
+ * @param direction < 0 if scrolling up, > 0 if scrolling down, 0 o.w.
+ */
+void
+ux_request_rows(ui_model_t* model, size_t first, size_t count, int direction);
+
 /**
  * @brief handle keyboard input for the ux.
  *
@@ -54,7 +130,6 @@ ux_post(ux_page_msg_t* message);
  * @param character the character input.
  * @return the action to take.
  */
-#include "ui.h"
 ui_act_t
 ux_handle_key(ui_model_t* model, int character);
 #endif /* LZD_UX_H */
\ No newline at end of file
@@ -0,0 +1,501 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-14
+ */
+#include "wksp.h"
+
+/*! @uses fprintf, stderr, snprintf. */
+#include <stdio.h>
+
+/*! @uses calloc, free. */
+#include <stdlib.h>
+
+/*! @uses strrchr, memcmp. */
+#include <string.h>
+
+/*! @uses internal, _foreach, _endforeach. */
+#include "dyna.h"
+
+/*! @uses disj_token_open, disj_token_close. */
+#include "disj.h"
+
+/*! @uses flow_t, flow_create, flow_explore, flow_code_ranges, flow_free. */
+#include "flow.h"
+
+/*! @uses stat_now, stat_add, stat_lock. */
+#include "stat.h"
+
+/*! @uses aren_mapped. */
+#include "aren.h"
+
+/**
+ * @brief get the name of the architecture of a binary.
+ *
+ * @param tuple the architecture tuple.
+ * @return the name, "?" if it isn't known.
+ */
+internal const char*
+arch_name(tup_arch_t tuple) {
+    switch (tuple.arch) {
+        case CS_ARCH_X86: return tuple.mode == CS_MODE_64 ? "x86_64" : "x86";
+        case CS_ARCH_AARCH64: return "aarch64";
+        case CS_ARCH_ARM: return "arm";
+        default: return "?";
+    }
+}
+
+/**
+ * @brief load a binary (a thread of its own); everything but the installing is done here, the
+ *  parallel parts on the shared pool, and the ui thread is handed it with a UI_MSG_LOADED.
+ *
+ * @param arg the wksp_bin_t.
+ * @return 0x0.
+ */
+internal void*
+load_thread(void* arg) {
+    wksp_bin_t* bin = arg;
+    emit_ctx_t* ctx = emit_load(bin->path, (tup_arch_t){ 0, 0 });
+    if (ctx) {
+        /* an unchanged binary comes straight out of its decode cache; it holds what the sweep
+         *  decoded, so a recursive descent neither reads nor writes it. */
+        bin->keyed = !bin->descent && cach_key(ctx, &bin->key) == 0;
+        bin->cache = bin->keyed ? cach_open(&bin->key) : 0x0;
+
+        /* extract symbols from elf, function starts are where big ranges get split. */
+        syms_t* symbols = bin->cache ? cach_symbols(bin->cache, ctx->elf->image) : 0x0;
+        if (!symbols) symbols = emit_extract_symbols(ctx, bin->pool);
+
+        /* follow control flow from the entry point and the function symbols, and sweep instead
+         *  if nothing is reachable. */
+        if (bin->descent) {
+            flow_t* flow = flow_create(ctx);
+            if (flow && flow_explore(flow, bin->pool, symbols) == 0 && flow_code_ranges(flow, ctx) > 0)
+                bin->blocks = atomic_load(&flow->blocks);
+            else bin->descent = false;
+            flow_free(flow);
+        }
+
+        /* scan for code ranges (split into balanced pieces), the length decoder counts the rows
+         *  of every one up front so placeholders hardly move once decoded. */
+        bool cached = bin->cache && cach_ranges(bin->cache, ctx) == 0;
+        if (!bin->descent && !cached) emit_scan_text(ctx);
+        if (!cached) emit_split_ranges(ctx, symbols, EMIT_SPLIT_TARGET);
+        emit_count_rows(ctx, bin->pool);
+
+        /* a region that hashes the same as one of another binary may share its chunks. */
+        bin->hashes = calloc(ctx->region_count ? ctx->region_count : 1u, sizeof *bin->hashes);
+        if (!bin->hashes)
+            fprintf(stderr, "lzd, load_thread; calloc failed; regions will not be shared.\n");
+        for (size_t i = 0; bin->hashes && i < ctx->region_count; i++)
+            bin->hashes[i] = cach_hash(ctx->regions[i].data, ctx->regions[i].size);
+
+        /* extract strings from elf (in parallel), symbols are indexed by address and by name. */
+        bin->strings = bin->cache ? cach_strings(bin->cache, ctx->elf->image) : 0x0;
+        if (!bin->strings) bin->strings = emit_extract_strings(ctx, bin->pool, 4);
+        if (symbols) syms_index(symbols, bin->pool);
+        bin->symbols = symbols;
+        bin->ctx = ctx;
+
+        /* the binary it is diffed against can't be closed or evicted while this one loads, its
+         *  symbols stay in its tab; what either decode cache holds isn't decoded again. */
+        wksp_bin_t* against = bin->against;
+        if (against) {
+            const ui_tab_t* tab = &bin->model->tabs[against->slot];
+            bin->diff = diff_binaries(against->ctx, tab->symbols, against->cache, ctx, symbols, \
+                bin->cache, bin->pool);
+        }
+    }
+    atomic_store(&bin->state, ctx ? WKSP_LOADED : WKSP_FAILED);
+
+    /* the ui thread installs it (or closes it) when it drains the message. */
+    ui_loaded_msg_t* message = calloc(1u, sizeof *message);
+    if (!message) {
+        fprintf(stderr, "lzd, load_thread; calloc failed; could not allocate memory for message.\n");
+        return 0x0;
+    }
+    message->node.kind = UI_MSG_LOADED;
+    message->binary = bin;
+    ui_model_post(bin->model, &message->node);
+    return 0x0;
+}
+
+/**
+ * @brief reserve a placeholder for every code range of a binary in its tab, and replace the
+ *  ones its decode cache holds; on the ui thread.
+ *
+ * @param bin the binary.
+ */
+internal void
+bin_fill(wksp_bin_t* bin) {
+    ui_model_t* model = bin->model;
+    ui_tab_t* tab = &model->tabs[bin->slot];
+    _foreach(bin->ctx->code_ranges, code_range_t*, range)
+        ui_model_reserve(model, tab, range->vaddr, range->length, range->rows);
+    _endforeach;
+
+    /* cached chunks replace their placeholders, borrowing the cache mapping. */
+    bin->cached = 0u;
+    for (size_t i = 0; bin->cache && i < bin->cache->header->chunk_count; i++) {
+        insn_chunk_t* chunk = cach_chunk(bin->cache, i, bin->ctx);
+        if (!chunk) continue;
+        ui_model_add_insns(model, tab, chunk);
+        bin->cached++;
+    }
+    bin->filled = aren_mapped(bin->ctx->chunks);
+}
+
+/**
+ * @brief tell if a binary that is still loading is diffed against another one.
+ *
+ * @param workspace the workspace.
+ * @param bin the binary.
+ * @return true if one is, false o.w.
+ */
+internal bool
+bin_based(const wksp_t* workspace, const wksp_bin_t* bin) {
+    for (size_t i = 0; i < UI_MAX_TABS; i++)
+        if (workspace->bins[i] && workspace->bins[i]->against == bin) return true;
+    return false;
+}
+
+/**
+ * @brief free a binary that is closed, and whatever its tab doesn't hold; it must not be
+ *  loading anymore.
+ *
+ * @param bin the binary.
+ */
+internal void
+bin_free(wksp_bin_t* bin) {
+    cach_close(bin->cache);
+    strs_free(bin->strings);
+    syms_free(bin->symbols);
+    diff_free(bin->diff);
+    emit_free(bin->ctx);
+    free(bin->hashes);
+    free(bin);
+}
+
+/**
+ * @brief open a binary in the workspace and start loading it in the background, into the active
+ *  tab if it is empty and into a new one o.w. (the caller switches to it); it is installed once
+ *  its UI_MSG_LOADED is drained. a binary opened against another one is diffed with it by its
+ *  loader, the other one is neither evicted nor closed until then.
+ *
+ * @param workspace the workspace.
+ * @param model the ui model.
+ * @param pool the worker pool (it must not be replaced while anything loads).
+ * @param path the path to the elf binary.
+ * @param descent true to only disassemble reachable code (recursive descent).
+ * @param against the (installed) binary to diff it against, or 0x0.
+ * @return the binary if it is loading, 0x0 if every tab is taken or a failure occurs.
+ */
+wksp_bin_t*
+wksp_open(wksp_t* workspace, ui_model_t* model, wrk_pool_t* pool, const char* path, bool descent, \
+    wksp_bin_t* against) {
+    if (!workspace || !model || !path) return 0x0;
+    if (against && atomic_load(&against->state) != WKSP_READY) return 0x0;
+    wksp_bin_t* bin = calloc(1u, sizeof *bin);
+    if (!bin) {
+        fprintf(stderr, "lzd, wksp_open; calloc failed; could not allocate memory for binary.\n");
+        return 0x0;
+    }
+
+    /* an empty active tab is taken over, a new one is opened o.w. */
+    const char* slash = strrchr(path, '/');
+    const char* name = slash && slash[1] ? slash + 1 : path;
+    bool empty = !workspace->bins[model->active];
+    ssize_t slot = empty ? (ssize_t) model->active : ui_model_open_tab(model, name);
+    if (slot < 0) {
+        free(bin);
+        return 0x0;
+    }
+    ui_tab_t* tab = &model->tabs[slot];
+    snprintf(bin->path, sizeof bin->path, "%s", path);
+    bin->descent = descent;
+    bin->slot = (size_t) slot;
+    bin->pool = pool;
+    bin->model = model;
+    bin->against = against;
+    if (against) snprintf(bin->base, sizeof bin->base, "%s", against->path);
+    atomic_init(&bin->state, WKSP_LOADING);
+    if (pthread_create(&bin->loader, 0x0, load_thread, bin) != 0) {
+        fprintf(stderr, "lzd, wksp_open; pthread_create failed; could not start loading %s.\n", path);
+        if (!empty) ui_model_close_tab(model, (size_t) slot);
+        free(bin);
+        return 0x0;
+    }
+    bin->joinable = true;
+    workspace->bins[slot] = bin;
+    snprintf(tab->name, sizeof tab->name, "%s", name);
+    snprintf(tab->subtitle, sizeof tab->subtitle, "%s | loading...", path);
+    model->dirty |= UI_DIRTY_HEADER;
+    return bin;
+}
+
+/**
+ * @brief install a binary that finished loading into its tab, on the ui thread; a binary that
+ *  failed to load is closed.
+ *
+ * @param workspace the workspace.
+ * @param bin the binary.
+ * @param status the buffer for the status of the load.
+ * @param size the size of the buffer.
+ * @return -1 if it failed to load, 0 o.w.
+ */
+ssize_t
+wksp_install(wksp_t* workspace, wksp_bin_t* bin, char* status, size_t size) {
+    if (!workspace || !bin) return -1;
+    if (bin->joinable) pthread_join(bin->loader, 0x0);
+    bin->joinable = false;
+    ui_model_t* model = bin->model;
+    ui_tab_t* tab = &model->tabs[bin->slot];
+    if (atomic_load(&bin->state) == WKSP_FAILED) {
+        snprintf(status, size, "could not load elf of path: %s", bin->path);
+        wksp_close(workspace, bin->pool, bin->slot);
+        return -1;
+    }
+
+    /* its pages are routed to the tab from now on, the placeholders are requested once shown. */
+    ui_model_bind_tab(tab, &bin->ctx->token);
+    bin_fill(bin);
+    ui_model_set_strings(model, tab, bin->strings);
+    ui_model_set_symbols(model, tab, bin->symbols);
+    bin->strings = 0x0;
+    bin->symbols = 0x0;
+    bin->against = 0x0;
+    if (bin->diff) {
+        /* the diff view is shown in its tab, the rest is still there to look the functions up. */
+        const diff_t* diff = bin->diff;
+        size_t kinds[3] = { 0u, 0u, 0u };
+        for (size_t i = 0u; i < diff->count; i++) kinds[diff->entries[i].kind]++;
+        snprintf(status, size, "diffed %.96s against %.96s: %zu changed, %zu added, %zu removed " \
+            "(%zu same, %zu renamed) in %.1f ms, %zu hashed out of the decode cache", bin->path, bin->base, \
+            kinds[DIFF_CHANGED], kinds[DIFF_ADDED], kinds[DIFF_REMOVED], diff->same, diff->renamed, \
+            (double) diff->ns / 1e6, diff->cached);
+        ui_model_set_diff(model, tab, bin->diff);
+        bin->diff = 0x0;
+    } else if (bin->base[0])
+        snprintf(status, size, "could not diff %.96s against %.96s", bin->path, bin->base);
+    else if (bin->descent)
+        snprintf(status, size, "opened: %s (%zu reachable code ranges, %zu blocks, decoded on demand)", \
+            bin->path, bin->ctx->code_ranges->length, bin->blocks);
+    else
+        snprintf(status, size, "opened: %s (%zu code ranges, %zu cached, decoded on demand)", \
+            bin->path, bin->ctx->code_ranges->length, bin->cached);
+    snprintf(tab->subtitle, sizeof tab->subtitle, "%.240s | %s", bin->path, arch_name(bin->ctx->tuple));
+    bin->shown = stat_now();
+    atomic_store(&bin->state, WKSP_READY);
+    model->dirty = UI_DIRTY_ALL;
+    return 0;
+}
+
+/**
+ * @brief close the binary of a tab, and the tab; waits for it to finish loading, drops what is
+ *  still queued for it and writes its decode cache.
+ *
+ * @param workspace the workspace.
+ * @param pool the worker pool.
+ * @param slot the slot of its tab.
+ */
+void
+wksp_close(wksp_t* workspace, wrk_pool_t* pool, size_t slot) {
+    if (!workspace || slot >= UI_MAX_TABS || !workspace->bins[slot]) return;
+    wksp_bin_t* bin = workspace->bins[slot];
+    ui_model_t* model = bin->model;
+    if (bin->joinable) pthread_join(bin->loader, 0x0);
+    bin->joinable = false;
+
+    /* a binary diffed against it reads its image, symbols and decode cache until it is loaded. */
+    for (size_t i = 0; i < UI_MAX_TABS; i++) {
+        wksp_bin_t* other = workspace->bins[i];
+        if (!other || other->against != bin) continue;
+        if (other->joinable) pthread_join(other->loader, 0x0);
+        other->joinable = false;
+        other->against = 0x0;
+    }
+
+    /* jobs (and decoded chunks) borrow bytes from its mapping; close its token so what is still
+     *  queued is dropped without decoding, let what is running finish (the jobs of every other
+     *  binary are left alone), install what they posted, and drop its tab (with its strings and
+     *  symbols) before it is unmapped. */
+    if (bin->ctx) {
+        disj_token_close(&bin->ctx->token);
+        wrk_latch_wait(pool, &bin->ctx->token.inflight);
+        ui_model_drain(model);
+        wksp_save(bin);
+    }
+    workspace->bins[slot] = 0x0;
+    ui_model_bind_tab(&model->tabs[slot], 0x0);
+    ui_model_close_tab(model, slot);
+    bin_free(bin);
+}
+
+/**
+ * @brief get the binary of the active tab, if it is installed.
+ *
+ * @param workspace the workspace.
+ * @param model the ui model.
+ * @return the binary if there is one that is ready, 0x0 o.w.
+ */
+wksp_bin_t*
+wksp_active(const wksp_t* workspace, const ui_model_t* model) {
+    if (!workspace || !model) return 0x0;
+    wksp_bin_t* bin = workspace->bins[model->active];
+    return bin && atomic_load(&bin->state) == WKSP_READY ? bin : 0x0;
+}
+
+/**
+ * @brief tell if any binary of the workspace is still loading.
+ *
+ * @param workspace the workspace.
+ * @return true if one is, false o.w.
+ */
+bool
+wksp_loading(const wksp_t* workspace) {
+    for (size_t i = 0; workspace && i < UI_MAX_TABS; i++)
+        if (workspace->bins[i] && workspace->bins[i]->joinable) return true;
+    return false;
+}
+
+/**
+ * @brief get the bytes of decoded chunks mapped by every binary of the workspace.
+ *
+ * @param workspace the workspace.
+ * @return the bytes mapped.
+ */
+size_t
+wksp_mapped(const wksp_t* workspace) {
+    size_t mapped = 0u;
+    for (size_t i = 0; workspace && i < UI_MAX_TABS; i++) {
+        wksp_bin_t* bin = workspace->bins[i];
+        if (bin && atomic_load(&bin->state) == WKSP_READY) mapped += aren_mapped(bin->ctx->chunks);
+    }
+    return mapped;
+}
+
+/**
+ * @brief unmap the decoded chunks of the binaries that were shown least recently until the
+ *  workspace is under its budget; the active one is never evicted, and an evicted one is back
+ *  to placeholders (and what its decode cache holds). this waits for the jobs of the evicted
+ *  ones to finish.
+ *
+ * @param workspace the workspace.
+ * @param pool the worker pool.
+ * @return the bytes that were unmapped.
+ */
+size_t
+wksp_reclaim(wksp_t* workspace, wrk_pool_t* pool) {
+    size_t mapped = wksp_mapped(workspace);
+    if (!workspace || mapped <= workspace->budget) return 0u;
+
+    /* pick the victims, least recently shown first, until what is left fits. */
+    wksp_bin_t* victims[UI_MAX_TABS];
+    size_t count = 0u;
+    while (mapped > workspace->budget) {
+        wksp_bin_t* oldest = 0x0;
+        for (size_t i = 0; i < UI_MAX_TABS; i++) {
+            wksp_bin_t* bin = workspace->bins[i];
+            if (!bin || atomic_load(&bin->state) != WKSP_READY || i == bin->model->active || \
+                aren_mapped(bin->ctx->chunks) <= bin->filled || bin_based(workspace, bin)) continue;
+            bool picked = false;
+            for (size_t j = 0; j < count; j++) picked |= victims[j] == bin;
+            if (!picked && (!oldest || bin->shown < oldest->shown)) oldest = bin;
+        }
+        if (!oldest) break;
+        mapped -= aren_mapped(oldest->ctx->chunks) - oldest->filled;
+        victims[count++] = oldest;
+    }
+    if (count == 0u) return 0u;
+
+    /* nothing may decode into their arenas anymore, and nothing of theirs may be left to
+     *  install; every victim is closed at once, so their stale jobs are dropped side by side. */
+    for (size_t i = 0; i < count; i++) disj_token_close(&victims[i]->ctx->token);
+    for (size_t i = 0; i < count; i++) wrk_latch_wait(pool, &victims[i]->ctx->token.inflight);
+    ui_model_drain(victims[0]->model);
+    size_t freed = 0u;
+    for (size_t i = 0; i < count; i++) {
+        wksp_bin_t* bin = victims[i];
+        ui_model_t* model = bin->model;
+
+        /* what it decoded goes to its decode cache first, and comes back out of it for free. */
+        wksp_save(bin);
+        ui_model_clear(model, &model->tabs[bin->slot]);
+        cach_close(bin->cache);
+        bin->cache = bin->keyed ? cach_open(&bin->key) : 0x0;
+        ssize_t dropped = emit_drop_chunks(bin->ctx);
+        if (dropped > 0) freed += (size_t) dropped;
+        disj_token_open(&bin->ctx->token);
+        bin_fill(bin);
+        bin->evicted++;
+    }
+    stat_add(STAT_BYTES_EVICTED, freed);
+    return freed;
+}
+
+/**
+ * @brief copy a chunk another binary has decoded already for a placeholder, from a region that
+ *  is byte-identical and at the same address in both; on the ui thread.
+ *
+ * @param workspace the workspace.
+ * @param bin the binary the placeholder is of.
+ * @param placeholder the placeholder.
+ * @return the copy, packed into the chunk arena of the binary, if there is one; 0x0 o.w.
+ */
+insn_chunk_t*
+wksp_twin(const wksp_t* workspace, const wksp_bin_t* bin, const insn_chunk_t* placeholder) {
+    const emit_region_t* region = bin && bin->hashes ? emit_region_at(bin->ctx, placeholder->base) : 0x0;
+    if (!workspace || !region) return 0x0;
+    uint64_t hash = bin->hashes[region - bin->ctx->regions];
+    size_t offset = (size_t) (placeholder->base - region->vaddr);
+    for (size_t i = 0; i < UI_MAX_TABS; i++) {
+        const wksp_bin_t* other = workspace->bins[i];
+        if (!other || other == bin || atomic_load(&other->state) != WKSP_READY || !other->hashes || \
+            other->ctx->tuple.arch != bin->ctx->tuple.arch || other->ctx->tuple.mode != bin->ctx->tuple.mode)
+            continue;
+
+        /* the same bytes at the same address decode into the same text, operands and all. */
+        const emit_region_t* twin = emit_region_at(other->ctx, region->vaddr);
+        if (!twin || twin->vaddr != region->vaddr || twin->size != region->size || \
+            other->hashes[twin - other->ctx->regions] != hash || \
+            offset + placeholder->length > twin->size || \
+            memcmp(twin->data + offset, region->data + offset, placeholder->length) != 0)
+            continue;
+        const insn_store_t* store = other->model->tabs[other->slot].instructions;
+        ssize_t at = insn_store_index((insn_store_t*) store, placeholder->base);
+        const insn_chunk_t* chunk = at >= 0 ? store->chunks[at] : 0x0;
+        if (!chunk || chunk->state != INSN_CHUNK_DECODED || chunk->length != placeholder->length)
+            continue;
+
+        /* the copy reads its raw bytes out of its own image; it may have been stitched to the
+         *  chunk before it over there, so it is stitched again over here. */
+        insn_chunk_t* copy = insn_chunk_pack(chunk, chunk->xrefs, chunk->xref_count, bin->ctx->chunks);
+        if (!copy) return 0x0;
+        copy->bytes = region->data + offset;
+        copy->seam = true;
+        copy->requested = 0u;
+        copy->urgent = false;
+        stat_add(STAT_CHUNKS_REUSED, 1u);
+        return copy;
+    }
+    return 0x0;
+}
+
+/**
+ * @brief write the decode cache of a binary that is installed, if it wasn't cached yet or more
+ *  of it has been decoded since; the pool must be drained by the caller.
+ *
+ * @param bin the binary.
+ */
+void
+wksp_save(wksp_bin_t* bin) {
+    if (!bin || !bin->ctx || !bin->keyed || atomic_load(&bin->state) != WKSP_READY) return;
+    ui_model_t* model = bin->model;
+    const ui_tab_t* tab = &model->tabs[bin->slot];
+    stat_lock(&model->lock);
+    size_t decoded = 0u;
+    for (size_t i = 0; i < tab->instructions->count; i++)
+        if (tab->instructions->chunks[i]->state == INSN_CHUNK_DECODED) decoded++;
+    if (!bin->cache || decoded > bin->cached)
+        cach_save(&bin->key, bin->ctx, tab->instructions, tab->strings, tab->symbols);
+    pthread_mutex_unlock(&model->lock);
+}
@@ -0,0 +1,191 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-14
+ */
+#ifndef LZD_WKSP_H
+#define LZD_WKSP_H
+
+/*! @uses uint64_t. */
+#include <stdint.h>
+
+/*! @uses size_t, ssize_t. */
+#include <sys/types.h>
+
+/*! @uses bool. */
+#include <stdbool.h>
+
+/*! @uses pthread_t. */
+#include <pthread.h>
+
+/*! @uses atomic_int. */
+#include <stdatomic.h>
+
+/*! @uses wrk_pool_t. */
+#include "wrk.h"
+
+/*! @uses emit_ctx_t. */
+#include "emit.h"
+
+/*! @uses cach_t, cach_key_t. */
+#include "cach.h"
+
+/*! @uses diff_t. */
+#include "diff.h"
+
+/*! @uses ui_model_t, ui_tab_t, UI_MAX_TABS. */
+#include "ui.h"
+
+/* bytes of decoded chunks every open binary may map together, unless LZD_BUDGET says otherwise. */
+#define WKSP_BUDGET (1024ull << 20)
+
+/* where a binary of the workspace is at. */
+typedef enum {
+    WKSP_LOADING = 0, /* being loaded on a thread of its own. */
+    WKSP_LOADED, /* loaded, waiting for the ui thread to install it. */
+    WKSP_READY, /* installed into its tab. */
+    WKSP_FAILED, /* could not be loaded. */
+} wksp_state_t;
+
+/* a binary of the workspace, in a tab of the model. */
+typedef struct wksp_bin {
+    char path[256]; /* path it was opened from. */
+    bool descent; /* only its reachable code is disassembled (recursive descent). */
+    atomic_int state; /* wksp_state_t, set by the loader and read by the ui thread. */
+    size_t slot; /* slot of its tab in the model. */
+    emit_ctx_t* ctx; /* its emit context (owned), 0x0 until loaded. */
+    cach_t* cache; /* its decode cache if there was one (owned). */
+    cach_key_t key; /* key of its decode cache. */
+    bool keyed; /* key was built, the decode cache is written when it is closed. */
+    size_t cached; /* chunks that came out of its decode cache. */
+    size_t blocks; /* basic blocks found by a recursive descent. */
+    syms_t* symbols; /* made by the loader, handed to its tab when it is installed. */
+    strs_t* strings; /* made by the loader, handed to its tab when it is installed. */
+    uint64_t* hashes; /* content hash of every executable region, to find identical ones. */
+    struct wksp_bin* against; /* the binary it is diffed against once loaded (borrowed), 0x0 if none. */
+    char base[256]; /* path of the binary it is diffed against, "" if none. */
+    diff_t* diff; /* made by the loader, handed to its tab when it is installed. */
+    uint64_t shown; /* stat_now() when it was last the active tab, the oldest is evicted first. */
+    size_t filled; /* bytes its chunk arena mapped once its tab was filled, evicting frees the rest. */
+    size_t evicted; /* times its decoded chunks were unmapped to stay under the budget. */
+    pthread_t loader; /* the thread it is loaded on, joined once it has posted. */
+    bool joinable; /* the loader has not been joined yet. */
+    wrk_pool_t* pool; /* the pool it is loaded on, it must outlive the loader. */
+    ui_model_t* model; /* the model its tab is in. */
+} wksp_bin_t;
+
+/**
+ * several binaries open at once, one per tab of the model; every one is loaded on a thread of
+ *  its own next to the ui (its parallel parts run on the shared pool), and the decoded chunks
+ *  of every one of them are held under one budget. an executable region that is byte-identical
+ *  (and at the same address) in two binaries is found by its hash, and the chunks one of them
+ *  decoded are copied into the other instead of being decoded again.
+ */
+typedef struct {
+    wksp_bin_t* bins[UI_MAX_TABS]; /* binary of every tab slot, 0x0 for an empty tab. */
+    size_t budget; /* bytes of decoded chunks every binary may map together. */
+} wksp_t;
+
+/**
+ * @brief open a binary in the workspace and start loading it in the background, into the active
+ *  tab if it is empty and into a new one o.w. (the caller switches to it); it is installed once
+ *  its UI_MSG_LOADED is drained. a binary opened against another one is diffed with it by its
+ *  loader, the other one is neither evicted nor closed until then.
+ *
+ * @param workspace the workspace.
+ * @param model the ui model.
+ * @param pool the worker pool (it must not be replaced while anything loads).
+ * @param path the path to the elf binary.
+ * @param descent true to only disassemble reachable code (recursive descent).
+ * @param against the (installed) binary to diff it against, or 0x0.
+ * @return the binary if it is loading, 0x0 if every tab is taken or a failure occurs.
+ */
+wksp_bin_t*
+wksp_open(wksp_t* workspace, ui_model_t* model, wrk_pool_t* pool, const char* path, bool descent, \
+    wksp_bin_t* against);
+
+/**
+ * @brief install a binary that finished loading into its tab, on the ui thread; a binary that
+ *  failed to load is closed.
+ *
+ * @param workspace the workspace.
+ * @param bin the binary.
+ * @param status the buffer for the status of the load.
+ * @param size the size of the buffer.
+ * @return -1 if it failed to load, 0 o.w.
+ */
+ssize_t
+wksp_install(wksp_t* workspace, wksp_bin_t* bin, char* status, size_t size);
+
+/**
+ * @brief close the binary of a tab, and the tab; waits for it (and every binary that is diffed
+ *  against it) to finish loading, drops what is still queued for it and writes its decode cache.
+ *
+ * @param workspace the workspace.
+ * @param pool the worker pool.
+ * @param slot the slot of its tab.
+ */
+void
+wksp_close(wksp_t* workspace, wrk_pool_t* pool, size_t slot);
+
+/**
+ * @brief get the binary of the active tab, if it is installed.
+ *
+ * @param workspace the workspace.
+ * @param model the ui model.
+ * @return the binary if there is one that is ready, 0x0 o.w.
+ */
+wksp_bin_t*
+wksp_active(const wksp_t* workspace, const ui_model_t* model);
+
+/**
+ * @brief tell if any binary of the workspace is still loading.
+ *
+ * @param workspace the workspace.
+ * @return true if one is, false o.w.
+ */
+bool
+wksp_loading(const wksp_t* workspace);
+
+/**
+ * @brief get the bytes of decoded chunks mapped by every binary of the workspace.
+ *
+ * @param workspace the workspace.
+ * @return the bytes mapped.
+ */
+size_t
+wksp_mapped(const wksp_t* workspace);
+
+/**
+ * @brief unmap the decoded chunks of the binaries that were shown least recently until the
+ *  workspace is under its budget; the active one is never evicted, and an evicted one is back
+ *  to placeholders (and what its decode cache holds). this waits for the jobs of the evicted
+ *  ones to finish.
+ *
+ * @param workspace the workspace.
+ * @param pool the worker pool.
+ * @return the bytes that were unmapped.
+ */
+size_t
+wksp_reclaim(wksp_t* workspace, wrk_pool_t* pool);
+
+/**
+ * @brief copy a chunk another binary has decoded already for a placeholder, from a region that
+ *  is byte-identical and at the same address in both; on the ui thread.
+ *
+ * @param workspace the workspace.
+ * @param bin the binary the placeholder is of.
+ * @param placeholder the placeholder.
+ * @return the copy, packed into the chunk arena of the binary, if there is one; 0x0 o.w.
+ */
+insn_chunk_t*
+wksp_twin(const wksp_t* workspace, const wksp_bin_t* bin, const insn_chunk_t* placeholder);
+
+/**
+ * @brief write the decode cache of a binary that is installed, if it wasn't cached yet or more
+ *  of it has been decoded since; the pool must be drained by the caller.
+ *
+ * @param bin the binary.
+ */
+void
+wksp_save(wksp_bin_t* bin);
+#endif /* LZD_WKSP_H */
@@ -4,75 +4,485 @@
  */
 #include "wrk.h"
 
-/*! @uses fprintf, stderr. */
+/*! @uses fprintf, stderr, fopen, fscanf, fclose. */
 #include <stdio.h>
 
-/*! @uses calloc, free. */
+/*! @uses calloc, malloc, aligned_alloc, free, strtoll. */
 #include <stdlib.h>
 
 /*! @uses size_t. */
 #include <stddef.h>
 
+/*! @uses memset, strcmp. */
+#include <string.h>
+
+/*! @uses sched_yield, sched_getaffinity, cpu_set_t, CPU_COUNT, CPU_ISSET, CPU_SET, CPU_ZERO. */
+#include <sched.h>
+
+/*! @uses sysconf, _SC_NPROCESSORS_ONLN. */
+#include <unistd.h>
+
 /*! @uses internal. */
 #include "dyna.h"
 
+/*! @uses stat_add. */
+#include "stat.h"
+
+/* initial capacity of every deque, and of every injector (must be powers of two). */
+#define DEQUE_CAPACITY 256u
+#define INJECT_CAPACITY 64u
+
+/* most jobs a worker moves from the injector into its own deque in one go. */
+#define INJECT_GRAB 32u
+
+/* the pool (and deque index) of the calling thread, if it is a worker. */
+static _Thread_local wrk_pool_t* t_pool;
+static _Thread_local size_t t_self;
+
+/* the latch of the job the calling thread is running, jobs it posts count against it too. */
+static _Thread_local wrk_latch_t* t_latch;
+
+/**
+ * @brief write a job into a deque slot.
+ *
+ * @param slot the slot.
+ * @param task the job.
+ */
+internal void
+slot_put(wrk_slot_t* slot, wrk_task_t task) {
+	atomic_store_explicit(&slot->fn, task.job.fn, memory_order_relaxed);
+	atomic_store_explicit(&slot->arg, task.job.arg, memory_order_relaxed);
+	atomic_store_explicit(&slot->latch, task.latch, memory_order_relaxed);
+}
+
+/**
+ * @brief read a job out of a deque slot.
+ *
+ * @param slot the slot.
+ * @return the job.
+ */
+internal wrk_task_t
+slot_get(wrk_slot_t* slot) {
+	wrk_task_t task = { { atomic_load_explicit(&slot->fn, memory_order_relaxed), \
+		atomic_load_explicit(&slot->arg, memory_order_relaxed) }, \
+		atomic_load_explicit(&slot->latch, memory_order_relaxed) };
+	return task;
+}
+
+/**
+ * @brief allocate a circular job array for a deque.
+ *
+ * @param capacity the capacity (a power of two).
+ * @return a new array if successful, 0x0 o.w.
+ */
+internal wrk_buf_t*
+buf_make(size_t capacity) {
+	wrk_buf_t* buf = calloc(1, sizeof *buf + capacity * sizeof(wrk_slot_t));
+	if (!buf) {
+		fprintf(stderr, "lzd, buf_make; calloc failed; could not allocate memory for deque.\n");
+		return 0x0;
+	}
+	buf->mask = capacity - 1u;
+	return buf;
+}
+
+/**
+ * @brief push a job onto the bottom of the calling worker's own deque.
+ *
+ * @param deque the deque (owned by the caller).
+ * @param job the job to be pushed.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+deque_push(wrk_deque_t* deque, wrk_task_t job) {
+	int64_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+	int64_t t = atomic_load_explicit(&deque->top, memory_order_acquire);
+	wrk_buf_t* buf = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+
+	/* full, copy the live jobs into an array twice the size and retire the old one. */
+	if ((size_t) (b - t) > buf->mask) {
+		wrk_buf_t* grown = buf_make((buf->mask + 1u) * 2u);
+		if (!grown) return -1;
+		for (int64_t i = t; i < b; i++)
+			slot_put(&grown->jobs[(size_t) i & grown->mask], \
+				slot_get(&buf->jobs[(size_t) i & buf->mask]));
+		grown->retired = buf;
+		atomic_store_explicit(&deque->buffer, grown, memory_order_release);
+		buf = grown;
+	}
+	slot_put(&buf->jobs[(size_t) b & buf->mask], job);
+	atomic_thread_fence(memory_order_release);
+	atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+	return 0;
+}
+
+/**
+ * @brief take a job from the bottom of the calling worker's own deque (newest first).
+ *
+ * @param deque the deque (owned by the caller).
+ * @param out the job taken.
+ * @return true if a job was taken, false if the deque is empty.
+ */
+internal bool
+deque_take(wrk_deque_t* deque, wrk_task_t* out) {
+	int64_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+	wrk_buf_t* buf = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+	atomic_store_explicit(&deque->bottom, b, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	int64_t t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+	if (t > b) {
+		/* empty, put bottom back. */
+		atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+		return false;
+	}
+	*out = slot_get(&buf->jobs[(size_t) b & buf->mask]);
+	if (t == b) {
+		/* the last job, race the thieves for it. */
+		bool won = atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, \
+			memory_order_seq_cst, memory_order_relaxed);
+		atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+		return won;
+	}
+	return true;
+}
+
+/**
+ * @brief steal a job from the top of another worker's deque (oldest first).
+ *
+ * @param deque the deque to steal from.
+ * @param out the job stolen.
+ * @return 1 if a job was stolen, 0 if the deque is empty, -1 if another thread won the race.
+ */
+internal int
+deque_steal(wrk_deque_t* deque, wrk_task_t* out) {
+	int64_t t = atomic_load_explicit(&deque->top, memory_order_acquire);
+	atomic_thread_fence(memory_order_seq_cst);
+	int64_t b = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+	if (t >= b) return 0;
+
+	/* the slot can only be reused once top moves past it, in which case the cas fails and the
+	 *  (possibly mixed) copy is dropped. */
+	wrk_buf_t* buf = atomic_load_explicit(&deque->buffer, memory_order_acquire);
+	wrk_task_t job = slot_get(&buf->jobs[(size_t) t & buf->mask]);
+	if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, \
+		memory_order_seq_cst, memory_order_relaxed))
+		return -1;
+	*out = job;
+	return 1;
+}
+
+/**
+ * @brief grab jobs from an injector; one is returned to run and up to INJECT_GRAB - 1 more move
+ *  into the calling worker's deque, so the next few jobs don't touch the lock.
+ *
+ * @param pool the worker pool.
+ * @param prio the priority of the injector.
+ * @param self the deque index of the calling worker.
+ * @param out the job to run.
+ * @return true if a job was grabbed, false o.w.
+ */
+internal bool
+inject_grab(wrk_pool_t* pool, wrk_prio_t prio, size_t self, wrk_task_t* out) {
+	wrk_inject_t* inject = &pool->inject[prio];
+	if (atomic_load(&inject->count) == 0u) return false;
+	pthread_mutex_lock(&pool->lock);
+	size_t count = atomic_load(&inject->count);
+	if (count == 0u) {
+		pthread_mutex_unlock(&pool->lock);
+		return false;
+	}
+
+	/* take a fair share so the other workers get some of the batch too. */
+	size_t grab = count / pool->count + 1u;
+	if (grab > INJECT_GRAB) grab = INJECT_GRAB;
+	if (grab > count) grab = count;
+	size_t mask = inject->capacity - 1u;
+	*out = inject->jobs[inject->head];
+	size_t moved = 1u;
+	for (; moved < grab; moved++)
+		if (deque_push(&pool->deques[self], inject->jobs[(inject->head + moved) & mask]) != 0)
+			break;
+	inject->head = (inject->head + moved) & mask;
+	atomic_fetch_sub(&inject->count, moved);
+	pthread_mutex_unlock(&pool->lock);
+
+	/* only the job to run leaves the queues, the rest are still queued (in our deque). */
+	atomic_fetch_sub(&pool->queued, 1u);
+	return true;
+}
+
+/**
+ * @brief find a job for a worker; the high priority injector first, then its own deque, then
+ *  steal from the other workers, and only then the low priority injector.
+ *
+ * @param pool the worker pool.
+ * @param self the deque index of the calling worker.
+ * @param out the job found.
+ * @return true if a job was found, false if every queue looked empty.
+ */
+internal bool
+job_find(wrk_pool_t* pool, size_t self, wrk_task_t* out) {
+	/* a high priority job jumps ahead of whatever low priority ones we grabbed before it. */
+	if (inject_grab(pool, WRK_PRIO_HIGH, self, out)) return true;
+	if (deque_take(&pool->deques[self], out)) {
+		atomic_fetch_sub(&pool->queued, 1u);
+		return true;
+	}
+
+	/* steal around the ring of workers, retry if we only lost races. */
+	for (;;) {
+		bool contended = false;
+		for (size_t i = 1; i < pool->count; i++) {
+			int stolen = deque_steal(&pool->deques[(self + i) % pool->count], out);
+			if (stolen > 0) {
+				atomic_fetch_sub(&pool->queued, 1u);
+				stat_add(STAT_JOBS_STOLEN, 1u);
+				return true;
+			}
+			if (stolen < 0) contended = true;
+		}
+		if (!contended) break;
+	}
+	return inject_grab(pool, WRK_PRIO_LOW, self, out);
+}
+
 /**
- * @brief make a new job_t structure for a worker thread to execute.
+ * @brief mark a job as finished, waking anyone draining the pool after the last one.
  *
- * @param fn the function for the worker to execute.
- * @param arg the paramter for the job.
- * @return a new pointer to a job made for the function.
+ * @param pool the worker pool.
  */
-internal job_t*
-job_make(wrk_fn_t fn, void* arg) {
-	/* allocate and copy. */
-    job_t* job = calloc(1, sizeof *job);
-    if (!job) {
-    	fprintf(stderr, "lzd, job_make; calloc failed; could not allocate memory for job.");
-        return 0x0;
-    }
-    job->fn = fn;
-    job->arg = arg;
-    return job;
+internal void
+job_done(wrk_pool_t* pool) {
+	if (atomic_fetch_sub(&pool->pending, 1u) != 1u) return;
+	pthread_mutex_lock(&pool->lock);
+	pthread_cond_broadcast(&pool->idle);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief mark jobs of a latch as finished, waking anyone waiting on it after the last one; the
+ *  latch is only touched under its lock, so the waiter may destroy it as soon as it wakes.
+ *
+ * @param latch the latch.
+ * @param count the number of jobs finished.
+ */
+internal void
+latch_release(wrk_latch_t* latch, size_t count) {
+	pthread_mutex_lock(&latch->lock);
+	if (atomic_fetch_sub(&latch->pending, count) == count) pthread_cond_broadcast(&latch->done);
+	pthread_mutex_unlock(&latch->lock);
+}
+
+/**
+ * @brief run a job on the calling thread, and mark it as finished.
+ *
+ * @param pool the worker pool.
+ * @param task the job.
+ */
+internal void
+task_run(wrk_pool_t* pool, wrk_task_t task) {
+	wrk_latch_t* outer = t_latch;
+	t_latch = task.latch;
+	if (task.job.fn) task.job.fn(task.job.arg);
+	t_latch = outer;
+	stat_add(STAT_JOBS_RUN, 1u);
+	if (task.latch) latch_release(task.latch, 1u);
+	job_done(pool);
+}
+
+/**
+ * @brief take every job of a latch out of the injectors (up to a capacity), keeping the order of
+ *  the rest.
+ *
+ * @param pool the worker pool.
+ * @param latch the latch.
+ * @param out the jobs taken.
+ * @param capacity the most jobs to take.
+ * @return the number of jobs taken.
+ */
+internal size_t
+inject_claim(wrk_pool_t* pool, wrk_latch_t* latch, wrk_task_t* out, size_t capacity) {
+	size_t taken = 0u;
+	pthread_mutex_lock(&pool->lock);
+	for (size_t p = 0; p < WRK_PRIO_COUNT; p++) {
+		wrk_inject_t* inject = &pool->inject[p];
+		size_t count = atomic_load(&inject->count), kept = 0u, mask = inject->capacity - 1u;
+		for (size_t i = 0; i < count; i++) {
+			wrk_task_t task = inject->jobs[(inject->head + i) & mask];
+			if (task.latch == latch && taken < capacity) out[taken++] = task;
+			else inject->jobs[(inject->head + kept++) & mask] = task;
+		}
+		atomic_store(&inject->count, kept);
+	}
+	atomic_fetch_sub(&pool->queued, taken);
+	pthread_mutex_unlock(&pool->lock);
+	return taken;
+}
+
+/**
+ * @brief wake sleeping workers after jobs were queued.
+ *
+ * @param pool the worker pool.
+ * @param count the number of jobs queued.
+ */
+internal void
+wake(wrk_pool_t* pool, size_t count) {
+	/* queued was bumped before this load, and sleepers re-check queued after bumping sleeping,
+	 *  so either they see the job or we see them. */
+	if (atomic_load(&pool->sleeping) == 0u) return;
+	pthread_mutex_lock(&pool->lock);
+	if (count == 1u) pthread_cond_signal(&pool->has_work);
+	else pthread_cond_broadcast(&pool->has_work);
+	pthread_mutex_unlock(&pool->lock);
 }
 
 /**
- * @brief the main code executor for a worker thread; grab a job and execute outside of lock.
+ * @brief the main code executor for a worker thread; find a job and execute it, sleeping when
+ *  there is nothing left anywhere.
  *
  * @param arg a pointer to the worker pool.
  * @return 0x0.
  */
 internal void*
 wrk_main(void* arg) {
-    wrk_pool_t* pool = arg;
-    for (;;) {
-        pthread_mutex_lock(&pool->lock);
-        while (!pool->shutting_down && pool->job_queue->count == 0u) {
+	wrk_pool_t* pool = arg;
+	size_t self = atomic_fetch_add(&pool->started, 1u);
+	t_pool = pool;
+	t_self = self;
+	for (;;) {
+		wrk_task_t task;
+		if (job_find(pool, self, &task)) {
+			task_run(pool, task);
+			continue;
+		}
+
+		/* something is queued but not takeable yet (a push or steal in flight). */
+		if (atomic_load(&pool->queued) != 0u) {
+			sched_yield();
+			continue;
+		}
+
+		/* nothing anywhere, sleep until something gets queued. */
+		pthread_mutex_lock(&pool->lock);
+		atomic_fetch_add(&pool->sleeping, 1u);
+		while (!pool->shutting_down && atomic_load(&pool->queued) == 0u)
 			pthread_cond_wait(&pool->has_work, &pool->lock);
-        }
-        if (pool->shutting_down && pool->job_queue->count == 0u) {
-			pthread_mutex_unlock(&pool->lock);
-			break;
-        }
+		atomic_fetch_sub(&pool->sleeping, 1u);
+		bool done = pool->shutting_down && atomic_load(&pool->queued) == 0u;
+		pthread_mutex_unlock(&pool->lock);
+		if (done) break;
+	}
+	return 0x0;
+}
+
+/**
+ * @brief read the cpu quota of the cgroup we are in, rounded up to whole cpus.
+ *
+ * @return the quota in cpus, 0 if there is none (or no cgroup fs).
+ */
+internal size_t
+cgroup_quota() {
+	long long quota = -1, period = 0;
 
-    	/* grab a job and starting executing it. */
-        job_t* job = ring_pop(pool->job_queue);
-        pool->active++;
-        pthread_mutex_unlock(&pool->lock);
+	/* cgroup v2: "max 100000" or "<quota> <period>". */
+	FILE* file = fopen("/sys/fs/cgroup/cpu.max", "r");
+	if (file) {
+		char max[32] = { 0 };
+		if (fscanf(file, "%31s %lld", max, &period) == 2 && strcmp(max, "max") != 0)
+			quota = strtoll(max, 0x0, 10);
+		fclose(file);
+	} else {
+		/* cgroup v1: a quota of -1 means unlimited. */
+		file = fopen("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", "r");
+		if (file) {
+			if (fscanf(file, "%lld", &quota) != 1) quota = -1;
+			fclose(file);
+		}
+		file = fopen("/sys/fs/cgroup/cpu/cpu.cfs_period_us", "r");
+		if (file) {
+			if (fscanf(file, "%lld", &period) != 1) period = 0;
+			fclose(file);
+		}
+	}
+	if (quota <= 0 || period <= 0) return 0u;
+	return (size_t) ((quota + period - 1) / period);
+}
 
-        /* run outside lock. */
-        if (job && job->fn)
-			job->fn(job->arg);
-        free(job);
-        pthread_mutex_lock(&pool->lock);
-        pool->active--;
+/**
+ * @brief count the cpus this process can actually run on; the affinity mask, further bounded
+ *  by the cgroup cpu quota (v2 cpu.max, or v1 cfs quota / period) when there is one.
+ *
+ * @return the number of usable cpus (at least 1).
+ */
+size_t
+wrk_cpu_count() {
+	size_t count = 0u;
+	cpu_set_t set;
+	if (sched_getaffinity(0, sizeof set, &set) == 0)
+		count = (size_t) CPU_COUNT(&set);
+	if (count == 0u) {
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		count = online > 0 ? (size_t) online : 1u;
+	}
 
-    	/* if there are no jobs queued or active, we broadcast that we are idle. */
-        if (pool->job_queue->count == 0u && pool->active == 0u)
-			pthread_cond_broadcast(&pool->idle);
-        pthread_mutex_unlock(&pool->lock);
-    }
-    return 0x0;
+	/* a quota of 2.5 cpus on a 64 core host should not get 64 threads. */
+	size_t quota = cgroup_quota();
+	if (quota > 0u && quota < count) count = quota;
+	return count;
+}
+
+/**
+ * @brief pin every worker thread of a pool to its own cpu (round-robin over the affinity mask),
+ *  so each worker's thread-local state stays warm in one core's caches.
+ *
+ * @param pool the pool to be pinned.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+wrk_pool_pin(wrk_pool_t* pool) {
+	if (!pool) return -1;
+	cpu_set_t set;
+	if (sched_getaffinity(0, sizeof set, &set) != 0) return -1;
+
+	/* collect the cpus we are allowed on, in order. */
+	int cpus[CPU_SETSIZE];
+	size_t count = 0u;
+	for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+		if (CPU_ISSET(cpu, &set)) cpus[count++] = cpu;
+	if (count == 0u) return -1;
+
+	for (size_t i = 0; i < pool->count; i++) {
+		cpu_set_t one;
+		CPU_ZERO(&one);
+		CPU_SET(cpus[i % count], &one);
+		if (pthread_setaffinity_np(pool->threads[i], sizeof one, &one) != 0) {
+			fprintf(stderr, "lzd, wrk_pool_pin; pthread_setaffinity_np failed; could not pin worker.\n");
+			return -1;
+		}
+	}
+	pool->pinned = true;
+	return 0;
+}
+
+/**
+ * @brief free the deques and injectors of a pool (but not the pool).
+ *
+ * @param pool the worker pool.
+ */
+internal void
+pool_release(wrk_pool_t* pool) {
+	for (size_t i = 0; pool->deques && i < pool->count; i++) {
+		wrk_buf_t* buf = atomic_load(&pool->deques[i].buffer);
+		while (buf) {
+			wrk_buf_t* retired = buf->retired;
+			free(buf);
+			buf = retired;
+		}
+	}
+	free(pool->deques);
+	for (size_t i = 0; i < WRK_PRIO_COUNT; i++)
+		free(pool->inject[i].jobs);
+	free(pool->threads);
 }
 
 /**
@@ -83,58 +493,71 @@ wrk_main(void* arg) {
  */
 wrk_pool_t*
 wrk_pool_create(size_t count) {
-    if (count == 0) count = 1;
+	if (count == 0) count = 1;
+	if (count > WRK_MAX_THREADS) count = WRK_MAX_THREADS;
 
 	/* initialize the pool as well as the threads, mutex lock, and conditions. */
-    wrk_pool_t* pool = calloc(1, sizeof *pool);
-    if (!pool) {
-    	fprintf(stderr, "lzd, wrk_pool_create; calloc failed; could not allocate memory for pool.");
-	    return 0x0;
-    }
-    pool->threads = (pthread_t*) calloc(count, sizeof(pthread_t));
-    if (!pool->threads) {
-    	fprintf(stderr, "lzd, wrk_pool_create; calloc failed; could not allocate memory for threads.");
-        free(pool);
-        return 0x0;
-    }
-    pool->count = count;
-    pthread_mutex_init(&pool->lock, 0x0);
-    pthread_cond_init(&pool->has_work, 0x0);
-    pthread_cond_init(&pool->idle, 0x0);
-
-	/* queue cap of 8 jobs, we don't need more than this. */
-	if ((pool->job_queue = ring_init()) == 0x0) {
-		pthread_cond_destroy(&pool->idle);
-		pthread_cond_destroy(&pool->has_work);
-		pthread_mutex_destroy(&pool->lock);
-		free(pool->threads);
+	wrk_pool_t* pool = calloc(1, sizeof *pool);
+	if (!pool) {
+		fprintf(stderr, "lzd, wrk_pool_create; calloc failed; could not allocate memory for pool.");
+		return 0x0;
+	}
+	pool->count = count;
+	pool->threads = (pthread_t*) calloc(count, sizeof(pthread_t));
+	pool->deques = aligned_alloc(_Alignof(wrk_deque_t), count * sizeof(wrk_deque_t));
+	bool injectors = true;
+	for (size_t i = 0; i < WRK_PRIO_COUNT; i++) {
+		pool->inject[i].jobs = calloc(INJECT_CAPACITY, sizeof(wrk_task_t));
+		pool->inject[i].capacity = INJECT_CAPACITY;
+		injectors &= pool->inject[i].jobs != 0x0;
+	}
+	if (!pool->threads || !pool->deques || !injectors) {
+		fprintf(stderr, "lzd, wrk_pool_create; calloc failed; could not allocate memory for threads.");
+		free(pool->deques);
+		pool->deques = 0x0;
+		pool_release(pool);
 		free(pool);
-		return NULL;
+		return 0x0;
+	}
+
+	/* every worker gets its own deque. */
+	memset(pool->deques, 0, count * sizeof(wrk_deque_t));
+	for (size_t i = 0; i < count; i++) {
+		wrk_buf_t* buf = buf_make(DEQUE_CAPACITY);
+		if (!buf) {
+			pool_release(pool);
+			free(pool);
+			return 0x0;
+		}
+		atomic_store(&pool->deques[i].buffer, buf);
 	}
+	pthread_mutex_init(&pool->lock, 0x0);
+	pthread_cond_init(&pool->has_work, 0x0);
+	pthread_cond_init(&pool->idle, 0x0);
 
 	/* iterate and create a thread, if one cannot be created, destroy the entire pool and report
 	 *  the error. */
-    for (size_t i = 0; i < count; i++) {
-        int retval = pthread_create(&pool->threads[i], 0x0, wrk_main, pool);
-        if (retval != 0) {
-            /* if partial create, shut down the ones created. */
-        	fprintf(stderr, "lzd, wrk_pool_create; fatal pthread_create failed; could not create "
+	for (size_t i = 0; i < count; i++) {
+		int retval = pthread_create(&pool->threads[i], 0x0, wrk_main, pool);
+		if (retval != 0) {
+			/* if partial create, shut down the ones created. */
+			fprintf(stderr, "lzd, wrk_pool_create; fatal pthread_create failed; could not create "
 							"worker thread(s).");
-            pthread_mutex_lock(&pool->lock);
-            pool->shutting_down = 1;
-            pthread_cond_broadcast(&pool->has_work);
-            pthread_mutex_unlock(&pool->lock);
-            for (size_t j = 0; j < i; j++)
-            	pthread_join(pool->threads[j], 0x0);
-            pthread_cond_destroy(&pool->idle);
-            pthread_cond_destroy(&pool->has_work);
-            pthread_mutex_destroy(&pool->lock);
-            free(pool->threads);
-            free(pool);
-            return 0x0;
-        }
-    }
-    return pool;
+			pthread_mutex_lock(&pool->lock);
+			pool->shutting_down = 1;
+			pthread_cond_broadcast(&pool->has_work);
+			pthread_mutex_unlock(&pool->lock);
+			for (size_t j = 0; j < i; j++)
+				pthread_join(pool->threads[j], 0x0);
+			pthread_cond_destroy(&pool->idle);
+			pthread_cond_destroy(&pool->has_work);
+			pthread_mutex_destroy(&pool->lock);
+			pool_release(pool);
+			free(pool);
+			return 0x0;
+		}
+	}
+	return pool;
 }
 
 /**
@@ -148,26 +571,175 @@ wrk_pool_create(size_t count) {
 ssize_t
 wrk_pool_post(wrk_pool_t* pool, const wrk_fn_t fn, void* arg) {
 	if (!pool || !fn) return -1;
+	job_t job = { fn, arg };
+
+	/* a worker posting into its own pool pushes onto its own deque, no lock at all. */
+	if (t_pool == pool) {
+		atomic_fetch_add(&pool->pending, 1u);
+		if (t_latch) atomic_fetch_add(&t_latch->pending, 1u);
+
+		/* queued is bumped before the push, a thief can take the job (and drop queued) right
+		 *  after it lands in the deque. */
+		atomic_fetch_add(&pool->queued, 1u);
+		if (deque_push(&pool->deques[t_self], (wrk_task_t){ job, t_latch }) != 0) {
+			atomic_fetch_sub(&pool->queued, 1u);
+			if (t_latch) latch_release(t_latch, 1u);
+			job_done(pool);
+			return -1;
+		}
+		stat_add(STAT_JOBS_QUEUED, 1u);
+		wake(pool, 1u);
+		return 0;
+	}
+	return wrk_pool_post_latched(pool, &job, 1u, WRK_PRIO_HIGH, t_latch);
+}
+
+/**
+ * @brief 'post' a batch of jobs to the worker pool at once; either every job is posted or none.
+ *
+ * @param pool the pool to post the jobs to.
+ * @param jobs the jobs to be posted (copied).
+ * @param count the number of jobs.
+ * @param prio the priority of the jobs.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+wrk_pool_post_batch(wrk_pool_t* pool, const job_t* jobs, size_t count, wrk_prio_t prio) {
+	return wrk_pool_post_latched(pool, jobs, count, prio, t_latch);
+}
 
-	/* make a new job given the function and argument. */
-	job_t* job = job_make(fn, arg);
-	if (!job) return -1;
+/**
+ * @brief 'post' a batch of jobs to the worker pool at once, every job (and every job it posts)
+ *  counting against a latch; either every job is posted or none.
+ *
+ * @param pool the pool to post the jobs to.
+ * @param jobs the jobs to be posted (copied).
+ * @param count the number of jobs.
+ * @param prio the priority of the jobs.
+ * @param latch the latch the jobs count against (or 0x0).
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+wrk_pool_post_latched(wrk_pool_t* pool, const job_t* jobs, size_t count, wrk_prio_t prio, \
+	wrk_latch_t* latch) {
+	if (!pool || !jobs || prio >= WRK_PRIO_COUNT) return -1;
+	if (count == 0u) return 0;
+	wrk_inject_t* inject = &pool->inject[prio];
 	pthread_mutex_lock(&pool->lock);
 	if (pool->shutting_down) {
 		pthread_mutex_unlock(&pool->lock);
-		free(job);
 		return -1;
 	}
 
-	/* push the job onto the ring queue and we are done. */
-	ring_push(pool->job_queue, job);
-	pthread_cond_signal(&pool->has_work);
+	/* grow the injector (linearizing it) if the batch doesn't fit. */
+	size_t used = atomic_load(&inject->count);
+	if (used + count > inject->capacity) {
+		size_t capacity = inject->capacity;
+		while (used + count > capacity) capacity *= 2u;
+		wrk_task_t* grown = calloc(capacity, sizeof(wrk_task_t));
+		if (!grown) {
+			pthread_mutex_unlock(&pool->lock);
+			fprintf(stderr, "lzd, wrk_pool_post_latched; calloc failed; could not grow injector.\n");
+			return -1;
+		}
+		for (size_t i = 0; i < used; i++)
+			grown[i] = inject->jobs[(inject->head + i) & (inject->capacity - 1u)];
+		free(inject->jobs);
+		inject->jobs = grown;
+		inject->capacity = capacity;
+		inject->head = 0u;
+	}
+
+	/* copy the batch in, every job is accounted for before any worker can finish it. */
+	size_t mask = inject->capacity - 1u;
+	for (size_t i = 0; i < count; i++)
+		inject->jobs[(inject->head + used + i) & mask] = (wrk_task_t){ jobs[i], latch };
+	if (latch) atomic_fetch_add(&latch->pending, count);
+	atomic_fetch_add(&pool->pending, count);
+	atomic_fetch_add(&inject->count, count);
+	atomic_fetch_add(&pool->queued, count);
 	pthread_mutex_unlock(&pool->lock);
-	return 0u;
+	stat_add(STAT_JOBS_QUEUED, count);
+	wake(pool, count);
+	return 0;
+}
+
+/**
+ * @brief post a batch of jobs and wait for just those jobs (and every job they posted) to
+ *  finish, helping with whatever of them is still queued.
+ *
+ * @param pool the pool to run the jobs on.
+ * @param jobs the jobs to be run (copied).
+ * @param count the number of jobs.
+ * @param prio the priority of the jobs.
+ * @return -1 if the jobs could not be posted (none of them ran), 0 o.w.
+ */
+ssize_t
+wrk_pool_run_batch(wrk_pool_t* pool, const job_t* jobs, size_t count, wrk_prio_t prio) {
+	wrk_latch_t latch;
+	wrk_latch_init(&latch);
+	ssize_t result = wrk_pool_post_latched(pool, jobs, count, prio, &latch);
+	if (result == 0) wrk_latch_wait(pool, &latch);
+	wrk_latch_destroy(&latch);
+	return result;
 }
 
 /**
- * @brief drain a worker pool of all jobs.
+ * @brief initialize a latch, with nothing pending.
+ *
+ * @param latch the latch.
+ */
+void
+wrk_latch_init(wrk_latch_t* latch) {
+	if (!latch) return;
+	atomic_init(&latch->pending, 0u);
+	pthread_mutex_init(&latch->lock, 0x0);
+	pthread_cond_init(&latch->done, 0x0);
+}
+
+/**
+ * @brief wait until every job posted with a latch has finished; whatever of them still sits in
+ *  an injector is taken out and run on the calling thread, so the wait doesn't queue up behind
+ *  the jobs of anyone else.
+ *
+ * @param pool the pool the jobs were posted to.
+ * @param latch the latch.
+ */
+void
+wrk_latch_wait(wrk_pool_t* pool, wrk_latch_t* latch) {
+	if (!latch) return;
+
+	/* what a worker picked up already is waited for, the jobs they post are swept up next. */
+	while (pool && atomic_load(&latch->pending) != 0u) {
+		size_t queued = 0u;
+		for (size_t p = 0; p < WRK_PRIO_COUNT; p++) queued += atomic_load(&pool->inject[p].count);
+		wrk_task_t* tasks = queued ? malloc(queued * sizeof *tasks) : 0x0;
+		size_t taken = tasks ? inject_claim(pool, latch, tasks, queued) : 0u;
+		for (size_t i = 0; i < taken; i++) task_run(pool, tasks[i]);
+		free(tasks);
+		if (taken == 0u) break;
+	}
+	pthread_mutex_lock(&latch->lock);
+	while (atomic_load(&latch->pending) != 0u)
+		pthread_cond_wait(&latch->done, &latch->lock);
+	pthread_mutex_unlock(&latch->lock);
+}
+
+/**
+ * @brief destroy a latch, nothing may be pending on it anymore.
+ *
+ * @param latch the latch.
+ */
+void
+wrk_latch_destroy(wrk_latch_t* latch) {
+	if (!latch) return;
+	pthread_cond_destroy(&latch->done);
+	pthread_mutex_destroy(&latch->lock);
+}
+
+/**
+ * @brief drain a worker pool of all jobs; returns once every job posted so far (and every job
+ *  those jobs posted) has finished.
  *
  * @param pool the pool to be drained.
  */
@@ -177,7 +749,7 @@ wrk_pool_drain(wrk_pool_t* pool) {
 
 	/* wait until each worker thread is done, then continue. */
 	pthread_mutex_lock(&pool->lock);
-	while (pool->job_queue->count != 0 || pool->active != 0)
+	while (atomic_load(&pool->pending) != 0u)
 		pthread_cond_wait(&pool->idle, &pool->lock);
 	pthread_mutex_unlock(&pool->lock);
 }
@@ -193,13 +765,15 @@ wrk_pool_shutdown(wrk_pool_t* pool) {
 
 	/* change the condition. */
 	pthread_mutex_lock(&pool->lock);
+	bool joined = pool->shutting_down;
 	if (!pool->shutting_down) {
 		pool->shutting_down = true;
 		pthread_cond_broadcast(&pool->has_work);
 	}
 	pthread_mutex_unlock(&pool->lock);
 
-	/* join each worker thread. */
+	/* join each worker thread (once), they finish every queued job first. */
+	if (joined) return;
 	for (size_t i = 0; i < pool->count; i++)
 		pthread_join(pool->threads[i], 0x0);
 }
@@ -211,24 +785,14 @@ wrk_pool_shutdown(wrk_pool_t* pool) {
  */
 void
 wrk_pool_destroy(wrk_pool_t* pool) {
-	/* shutdown the pool. */
+	/* shutdown the pool, every queue is empty once the workers are joined. */
 	if (!pool) return;
 	wrk_pool_shutdown(pool);
 
-	/* free any queued jobs (should be none, but be safe) */
-	for (;;) {
-		job_t* job = 0x0;
-		pthread_mutex_lock(&pool->lock);
-		job = ring_pop(pool->job_queue);
-		pthread_mutex_unlock(&pool->lock);
-		if (!job) break;
-		free(job);
-	}
-
 	/* destroy thread conditions and mutex lock. */
 	pthread_cond_destroy(&pool->idle);
 	pthread_cond_destroy(&pool->has_work);
 	pthread_mutex_destroy(&pool->lock);
-	free(pool->threads);
+	pool_release(pool);
 	free(pool);
-}
\ No newline at end of file
+}
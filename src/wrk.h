@@ -11,14 +11,20 @@
 /*! @uses bool, true, false. */
 #include <stdbool.h>
 
-/*! @uses ring_t, ring_push, ring_pop. */
-#include "ring.h"
+/*! @uses atomic_size_t, _Atomic. */
+#include <stdatomic.h>
+
+/*! @uses int64_t. */
+#include <stdint.h>
+
+/*! @uses ssize_t. */
+#include <sys/types.h>
 
 /* ... */
 typedef void (*wrk_fn_t)(void*);
 
 /*
- * ...
+ * a job is stored inline (by value) in whichever queue holds it, posting never allocates.
  */
 typedef struct {
 	wrk_fn_t fn;
@@ -26,20 +32,106 @@ typedef struct {
 } job_t;
 
 /*
- * ...
+ * a latch counts the jobs of a batch that have not finished yet, and every job those jobs
+ *  posted; waiting on it waits for that batch only, not for the whole pool.
+ */
+typedef struct wrk_latch {
+	atomic_size_t pending; /* number of jobs posted with the latch that have not finished yet. */
+	pthread_mutex_t lock; /* every job finishes under it, so a waiter may destroy the latch. */
+	pthread_cond_t done;
+} wrk_latch_t;
+
+/*
+ * a queued job, and the latch it counts against (or 0x0).
+ */
+typedef struct {
+	job_t job;
+	wrk_latch_t* latch;
+} wrk_task_t;
+
+/*
+ * a job slot inside of a deque, a thief may read a slot while its owner overwrites it (the
+ *  thief then loses the cas and drops what it read), so every part is a relaxed atomic.
+ */
+typedef struct {
+	_Atomic(wrk_fn_t) fn;
+	_Atomic(void*) arg;
+	_Atomic(wrk_latch_t*) latch;
+} wrk_slot_t;
+
+/*
+ * a power-of-two circular array of jobs backing a deque; when a deque grows the old array is
+ *  retired instead of freed, a thief may still be reading out of it.
+ */
+typedef struct wrk_buf {
+	size_t mask; /* capacity - 1. */
+	struct wrk_buf* retired; /* the array this one replaced (freed with the pool). */
+	wrk_slot_t jobs[];
+} wrk_buf_t;
+
+/*
+ * a chase-lev work-stealing deque, the owning worker pushes and takes at the bottom without
+ *  any lock and every other worker steals from the top with a single cas.
+ */
+typedef struct {
+	_Alignas(64) _Atomic(int64_t) top; /* steal end, contended by thieves. */
+	_Alignas(64) _Atomic(int64_t) bottom; /* owner end. */
+	_Atomic(wrk_buf_t*) buffer;
+} wrk_deque_t;
+
+/*
+ * priority of a batch of jobs posted from outside of the pool; every worker looks for a high
+ *  priority job before anything else, and picks up a low priority one only when there is
+ *  nothing else to run.
+ */
+typedef enum {
+	WRK_PRIO_HIGH = 0u, /* the viewport, a goto, or anything the ui is waiting on. */
+	WRK_PRIO_LOW, /* prefetch and background work. */
+	WRK_PRIO_COUNT,
+} wrk_prio_t;
+
+/*
+ * an injector, a circular array of jobs posted from outside of the pool (under the pool lock).
+ */
+typedef struct {
+	wrk_task_t* jobs;
+	size_t head, capacity;
+	atomic_size_t count; /* number of jobs in the injector. */
+} wrk_inject_t;
+
+/*
+ * a work-stealing pool; every worker owns a deque, jobs posted from outside of the pool go
+ *  through a shared injector queue per priority (one lock per batch) that idle workers pull
+ *  from in bulk.
  */
 typedef struct {
 	pthread_t *threads;
 	size_t count;
-	pthread_mutex_t lock;
+	wrk_deque_t* deques; /* one deque per worker thread. */
+	atomic_size_t started; /* hands each worker its deque index. */
+	pthread_mutex_t lock; /* guards the injectors, sleeping, and shutting_down. */
 	pthread_cond_t has_work;
 	pthread_cond_t idle;
-	ring_t* job_queue;
-	size_t queued;
-	size_t active;
+	wrk_inject_t inject[WRK_PRIO_COUNT]; /* one injector per priority. */
+	atomic_size_t queued; /* number of jobs sitting in any queue. */
+	atomic_size_t pending; /* number of jobs posted that have not finished yet. */
+	atomic_size_t sleeping; /* number of workers waiting on has_work. */
 	bool shutting_down;
+	bool pinned; /* every worker is pinned to a single cpu. */
 } wrk_pool_t;
 
+/* upper bound on the number of worker threads in a pool. */
+#define WRK_MAX_THREADS 256u
+
+/**
+ * @brief count the cpus this process can actually run on; the affinity mask, further bounded
+ *  by the cgroup cpu quota (v2 cpu.max, or v1 cfs quota / period) when there is one.
+ *
+ * @return the number of usable cpus (at least 1).
+ */
+size_t
+wrk_cpu_count();
+
 /**
  * @brief create a new worker pool with a set number of threads.
  *
@@ -50,7 +142,9 @@ wrk_pool_t*
 wrk_pool_create(size_t count);
 
 /**
- * @brief 'post' or submit a new job to the worker pool.
+ * @brief 'post' or submit a new job to the worker pool; from a worker it goes onto the worker's
+ *  own deque, o.w. it is posted at high priority. a job posted by a job counts against the
+ *  latch of that job.
  *
  * @param pool the pool to post a new job to.
  * @param fn the function to be executed.
@@ -61,7 +155,85 @@ ssize_t
 wrk_pool_post(wrk_pool_t* pool, wrk_fn_t fn, void* arg);
 
 /**
- * @brief drain a worker pool of all jobs.
+ * @brief 'post' a batch of jobs to the worker pool at once; either every job is posted or none.
+ *
+ * @param pool the pool to post the jobs to.
+ * @param jobs the jobs to be posted (copied).
+ * @param count the number of jobs.
+ * @param prio the priority of the jobs.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+wrk_pool_post_batch(wrk_pool_t* pool, const job_t* jobs, size_t count, wrk_prio_t prio);
+
+/**
+ * @brief 'post' a batch of jobs to the worker pool at once, every job (and every job it posts)
+ *  counting against a latch; either every job is posted or none.
+ *
+ * @param pool the pool to post the jobs to.
+ * @param jobs the jobs to be posted (copied).
+ * @param count the number of jobs.
+ * @param prio the priority of the jobs.
+ * @param latch the latch the jobs count against.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+wrk_pool_post_latched(wrk_pool_t* pool, const job_t* jobs, size_t count, wrk_prio_t prio, \
+	wrk_latch_t* latch);
+
+/**
+ * @brief post a batch of jobs and wait for just those jobs (and every job they posted) to
+ *  finish, helping with whatever of them is still queued.
+ *
+ * @param pool the pool to run the jobs on.
+ * @param jobs the jobs to be run (copied).
+ * @param count the number of jobs.
+ * @param prio the priority of the jobs.
+ * @return -1 if the jobs could not be posted (none of them ran), 0 o.w.
+ */
+ssize_t
+wrk_pool_run_batch(wrk_pool_t* pool, const job_t* jobs, size_t count, wrk_prio_t prio);
+
+/**
+ * @brief initialize a latch, with nothing pending.
+ *
+ * @param latch the latch.
+ */
+void
+wrk_latch_init(wrk_latch_t* latch);
+
+/**
+ * @brief wait until every job posted with a latch has finished; whatever of them still sits in
+ *  an injector is taken out and run on the calling thread, so the wait doesn't queue up behind
+ *  the jobs of anyone else.
+ *
+ * @param pool the pool the jobs were posted to.
+ * @param latch the latch.
+ */
+void
+wrk_latch_wait(wrk_pool_t* pool, wrk_latch_t* latch);
+
+/**
+ * @brief destroy a latch, nothing may be pending on it anymore.
+ *
+ * @param latch the latch.
+ */
+void
+wrk_latch_destroy(wrk_latch_t* latch);
+
+/**
+ * @brief pin every worker thread of a pool to its own cpu (round-robin over the affinity mask),
+ *  so each worker's thread-local state stays warm in one core's caches.
+ *
+ * @param pool the pool to be pinned.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+wrk_pool_pin(wrk_pool_t* pool);
+
+/**
+ * @brief drain a worker pool of all jobs; returns once every job posted so far (and every job
+ *  those jobs posted) has finished.
  *
  * @param pool the pool to be drained.
  */
@@ -0,0 +1,242 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-12
+ */
+#include "xlen.h"
+
+/*! @uses bool, true, false. */
+#include <stdbool.h>
+
+/*! @uses internal. */
+#include "dyna.h"
+
+/* what follows an opcode, one entry per opcode of a map. */
+#define M 0x01u /* a modrm byte (and the sib byte and displacement it implies). */
+#define B 0x02u /* an 8-bit immediate. */
+#define W 0x04u /* a 16-bit immediate. */
+#define Z 0x08u /* a 16 or 32-bit immediate, by operand size. */
+#define V 0x10u /* a 16, 32 or 64-bit immediate, by operand size and rex.w. */
+#define O 0x20u /* a memory offset, by address size. */
+#define G 0x40u /* the immediate is only there if modrm.reg is 0 or 1 (test in f6 and f7). */
+#define X 0x80u /* invalid in 64-bit mode, or a prefix or escape (handled before the lookup). */
+
+/* every prefix byte (legacy and rex), one bit per byte value. */
+static const uint64_t g_prefixes[4] = {
+    (1ull << 0x26) | (1ull << 0x2e) | (1ull << 0x36) | (1ull << 0x3e), /* segments. */
+    0xffffull | (0xfull << 0x24), /* rex, fs, gs, operand and address size. */
+    0u,
+    (1ull << 0x30) | (1ull << 0x32) | (1ull << 0x33), /* lock, repne, rep. */
+};
+
+/* the one-byte opcode map. */
+static const uint8_t g_one[256] = {
+    /*  0       1       2       3       4       5       6       7  */
+    /*  8       9       a       b       c       d       e       f  */
+    M,      M,      M,      M,      B,      Z,      X,      X,      /* 00 */
+    M,      M,      M,      M,      B,      Z,      X,      X,
+    M,      M,      M,      M,      B,      Z,      X,      X,      /* 10 */
+    M,      M,      M,      M,      B,      Z,      X,      X,
+    M,      M,      M,      M,      B,      Z,      X,      X,      /* 20 */
+    M,      M,      M,      M,      B,      Z,      X,      X,
+    M,      M,      M,      M,      B,      Z,      X,      X,      /* 30 */
+    M,      M,      M,      M,      B,      Z,      X,      X,
+    X,      X,      X,      X,      X,      X,      X,      X,      /* 40 */
+    X,      X,      X,      X,      X,      X,      X,      X,
+    0,      0,      0,      0,      0,      0,      0,      0,      /* 50 */
+    0,      0,      0,      0,      0,      0,      0,      0,
+    X,      X,      X,      M,      X,      X,      X,      X,      /* 60 */
+    Z,      M | Z,  B,      M | B,  0,      0,      0,      0,
+    B,      B,      B,      B,      B,      B,      B,      B,      /* 70 */
+    B,      B,      B,      B,      B,      B,      B,      B,
+    M | B,  M | Z,  X,      M | B,  M,      M,      M,      M,      /* 80 */
+    M,      M,      M,      M,      M,      M,      M,      M,
+    0,      0,      0,      0,      0,      0,      0,      0,      /* 90 */
+    0,      0,      X,      0,      0,      0,      0,      0,
+    O,      O,      O,      O,      0,      0,      0,      0,      /* a0 */
+    B,      Z,      0,      0,      0,      0,      0,      0,
+    B,      B,      B,      B,      B,      B,      B,      B,      /* b0 */
+    V,      V,      V,      V,      V,      V,      V,      V,
+    M | B,  M | B,  W,      0,      X,      X,      M | B,  M | Z,  /* c0 */
+    W | B,  0,      W,      0,      0,      B,      X,      0,
+    M,      M,      M,      M,      X,      X,      X,      0,      /* d0 */
+    M,      M,      M,      M,      M,      M,      M,      M,
+    B,      B,      B,      B,      B,      B,      B,      B,      /* e0 */
+    Z,      Z,      X,      B,      0,      0,      0,      0,
+    X,      0,      X,      X,      0,      0,      M | B | G, M | Z | G, /* f0 */
+    0,      0,      0,      0,      0,      0,      M,      M,
+};
+
+/* the two-byte opcode map (0f). */
+static const uint8_t g_two[256] = {
+    /*  0       1       2       3       4       5       6       7  */
+    /*  8       9       a       b       c       d       e       f  */
+    M,      M,      M,      M,      X,      0,      0,      0,      /* 00 */
+    0,      0,      X,      0,      X,      M,      0,      M | B,
+    M,      M,      M,      M,      M,      M,      M,      M,      /* 10 */
+    M,      M,      M,      M,      M,      M,      M,      M,
+    M,      M,      M,      M,      X,      X,      X,      X,      /* 20 */
+    M,      M,      M,      M,      M,      M,      M,      M,
+    0,      0,      0,      0,      0,      0,      X,      0,      /* 30 */
+    X,      X,      X,      X,      X,      X,      X,      X,
+    M,      M,      M,      M,      M,      M,      M,      M,      /* 40 */
+    M,      M,      M,      M,      M,      M,      M,      M,
+    M,      M,      M,      M,      M,      M,      M,      M,      /* 50 */
+    M,      M,      M,      M,      M,      M,      M,      M,
+    M,      M,      M,      M,      M,      M,      M,      M,      /* 60 */
+    M,      M,      M,      M,      M,      M,      M,      M,
+    M | B,  M | B,  M | B,  M | B,  M,      M,      M,      0,      /* 70 */
+    M,      M,      X,      X,      M,      M,      M,      M,
+    Z,      Z,      Z,      Z,      Z,      Z,      Z,      Z,      /* 80 */
+    Z,      Z,      Z,      Z,      Z,      Z,      Z,      Z,
+    M,      M,      M,      M,      M,      M,      M,      M,      /* 90 */
+    M,      M,      M,      M,      M,      M,      M,      M,
+    0,      0,      0,      M,      M | B,  M,      X,      X,      /* a0 */
+    0,      0,      0,      M,      M | B,  M,      M,      M,
+    M,      M,      M,      M,      M,      M,      M,      M,      /* b0 */
+    M,      M,      M | B,  M,      M,      M,      M,      M,
+    M,      M,      M | B,  M,      M | B,  M | B,  M | B,  M,      /* c0 */
+    0,      0,      0,      0,      0,      0,      0,      0,
+    M,      M,      M,      M,      M,      M,      M,      M,      /* d0 */
+    M,      M,      M,      M,      M,      M,      M,      M,
+    M,      M,      M,      M,      M,      M,      M,      M,      /* e0 */
+    M,      M,      M,      M,      M,      M,      M,      M,
+    M,      M,      M,      M,      M,      M,      M,      M,      /* f0 */
+    M,      M,      M,      M,      M,      M,      M,      M,
+};
+
+/**
+ * @brief get the number of bytes a modrm byte (itself included) takes, with its sib byte and
+ *  displacement; 64-bit mode only has the 32 and 64-bit forms, which are laid out alike.
+ *
+ * @param code the bytes from the modrm byte on.
+ * @param size the number of bytes available.
+ * @return 0 if it is truncated, its length in bytes o.w.
+ */
+internal size_t
+modrm_length(const uint8_t* code, size_t size) {
+    if (size == 0u) return 0u;
+    uint8_t mod = code[0] >> 6u, rm = code[0] & 7u;
+    if (mod == 3u) return 1u;
+    size_t length = 1u;
+    if (rm == 4u) {
+        /* a sib byte, its base 5 means a 32-bit displacement without a base. */
+        if (size < 2u) return 0u;
+        length++;
+        if (mod == 0u && (code[1] & 7u) == 5u) length += 4u;
+    }
+    else if (mod == 0u && rm == 5u) length += 4u; /* rip-relative. */
+    if (mod == 1u) length += 1u;
+    else if (mod == 2u) length += 4u;
+    return length;
+}
+
+/**
+ * @brief get the length of the x86_64 instruction at the start of a buffer, without decoding
+ *  its operands; prefixes, rex, vex, evex and xop are walked, then a lookup table per opcode
+ *  map says whether a modrm byte and which immediate follow.
+ *
+ * @param code the bytes of the instruction.
+ * @param size the number of bytes available.
+ * @return 0 if it is invalid in 64-bit mode (or truncated), its length in bytes o.w.
+ */
+size_t
+xlen_insn(const uint8_t* code, size_t size) {
+    if (size > XLEN_MAX) size = XLEN_MAX;
+
+    /* legacy prefixes in any order, a rex prefix only counts right before the opcode. */
+    size_t at = 0u;
+    bool operand16 = false, address32 = false, rex_w = false;
+    while (at < size && (g_prefixes[code[at] >> 6u] >> (code[at] & 63u)) & 1u) {
+        uint8_t byte = code[at++];
+        if ((byte & 0xf0u) == 0x40u) {
+            rex_w = (byte & 0x08u) != 0u;
+            continue;
+        }
+        operand16 |= byte == 0x66u;
+        address32 |= byte == 0x67u;
+        rex_w = false;
+    }
+    if (at >= size) return 0u;
+
+    /* the opcode, through whichever escape (or vex, evex and xop prefix) leads to its map. */
+    uint8_t opcode = code[at++], flags;
+    bool one = false;
+    if (opcode == 0x0fu) {
+        if (at >= size) return 0u;
+        opcode = code[at++];
+        if (opcode == 0x38u || opcode == 0x3au) {
+            if (at++ >= size) return 0u;
+            flags = opcode == 0x38u ? M : M | B;
+        }
+        else flags = g_two[opcode];
+    }
+    else if (opcode == 0xc4u || opcode == 0xc5u || opcode == 0x62u || \
+        (opcode == 0x8fu && at < size && (code[at] & 0x1fu) >= 8u)) {
+        /* vex (two or three bytes), evex (four) or xop (three); they pick a map and hold the
+         *  operand size themselves, every opcode behind them has a modrm byte. */
+        uint8_t kind = opcode;
+        size_t prefix = kind == 0xc5u ? 1u : kind == 0x62u ? 3u : 2u;
+        if (at + prefix >= size) return 0u;
+        uint8_t map = kind == 0xc5u ? 1u : code[at] & (kind == 0x62u ? 0x07u : 0x1fu);
+        at += prefix;
+        opcode = code[at++];
+        operand16 = rex_w = false;
+        if (kind == 0x8fu) flags = map == 8u ? M | B : map == 9u ? M : map == 10u ? M | Z : X;
+        else if (map == 1u) flags = opcode == 0x77u && kind != 0x62u ? 0u : M | (g_two[opcode] & B);
+        else if (map == 3u) flags = M | B;
+        else flags = map == 2u || (kind == 0x62u && (map == 5u || map == 6u)) ? M : X;
+    }
+    else {
+        flags = g_one[opcode];
+        one = true;
+    }
+    if (flags & X) return 0u;
+
+    /* the modrm byte (and the sib byte and displacement it implies). */
+    uint8_t reg = 0u;
+    if (flags & M) {
+        size_t length = modrm_length(code + at, size - at);
+        if (length == 0u) return 0u;
+        reg = (code[at] >> 3u) & 7u;
+
+        /* the one-byte groups with holes in them, a linear decode stops there too. */
+        bool hole = one && ((opcode == 0x8du && code[at] >= 0xc0u) || (opcode == 0xfeu && reg > 1u) || \
+            (opcode == 0xffu && reg == 7u) || (opcode == 0x8fu && reg != 0u) || \
+            ((opcode == 0xc6u || opcode == 0xc7u) && reg != 0u && code[at] != 0xf8u));
+        if (hole) return 0u;
+        at += length;
+    }
+
+    /* the immediate, sized by the operand (or address) size. */
+    size_t immediate = 0u;
+    if (!(flags & G) || reg <= 1u) {
+        if (flags & B) immediate += 1u;
+        if (flags & W) immediate += 2u;
+        if (flags & Z) immediate += operand16 && !rex_w ? 2u : 4u;
+        if (flags & V) immediate += rex_w ? 8u : operand16 ? 2u : 4u;
+    }
+    if (flags & O) immediate += address32 ? 4u : 8u;
+    return at + immediate <= size ? at + immediate : 0u;
+}
+
+/**
+ * @brief count the x86_64 instructions of a code range the way a linear decode would, from
+ *  its start until its end or the first invalid instruction.
+ *
+ * @param code the bytes of the code range.
+ * @param length the length of the code range, only instructions starting before it count.
+ * @param available the number of bytes that can be read (>= length, the last instruction may
+ *  run past the end).
+ * @return the number of instructions.
+ */
+size_t
+xlen_count(const uint8_t* code, size_t length, size_t available) {
+    size_t count = 0u, at = 0u;
+    while (at < length) {
+        size_t size = xlen_insn(code + at, available - at);
+        if (size == 0u) break;
+        at += size;
+        count++;
+    }
+    return count;
+}
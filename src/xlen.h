@@ -0,0 +1,41 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-12
+ */
+#ifndef LZD_XLEN_H
+#define LZD_XLEN_H
+
+/*! @uses uint8_t. */
+#include <stdint.h>
+
+/*! @uses size_t. */
+#include <stddef.h>
+
+/* longest x86 instruction, in bytes; anything longer is invalid. */
+#define XLEN_MAX 15u
+
+/**
+ * @brief get the length of the x86_64 instruction at the start of a buffer, without decoding
+ *  its operands; prefixes, rex, vex, evex and xop are walked, then a lookup table per opcode
+ *  map says whether a modrm byte and which immediate follow.
+ *
+ * @param code the bytes of the instruction.
+ * @param size the number of bytes available.
+ * @return 0 if it is invalid in 64-bit mode (or truncated), its length in bytes o.w.
+ */
+size_t
+xlen_insn(const uint8_t* code, size_t size);
+
+/**
+ * @brief count the x86_64 instructions of a code range the way a linear decode would, from
+ *  its start until its end or the first invalid instruction.
+ *
+ * @param code the bytes of the code range.
+ * @param length the length of the code range, only instructions starting before it count.
+ * @param available the number of bytes that can be read (>= length, the last instruction may
+ *  run past the end).
+ * @return the number of instructions.
+ */
+size_t
+xlen_count(const uint8_t* code, size_t length, size_t available);
+#endif /* LZD_XLEN_H */
@@ -0,0 +1,240 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-06
+ */
+#include "xref.h"
+
+/*! @uses fprintf, stderr. */
+#include <stdio.h>
+
+/*! @uses calloc, free, qsort. */
+#include <stdlib.h>
+
+/*! @uses memset. */
+#include <string.h>
+
+/*! @uses internal. */
+#include "dyna.h"
+
+/**
+ * @brief allocate the columns of a run.
+ *
+ * @param run the run to be filled.
+ * @param count the number of references.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+run_alloc(xref_run_t* run, size_t count) {
+    run->targets = calloc(count ? count : 1u, sizeof *run->targets);
+    run->froms = calloc(count ? count : 1u, sizeof *run->froms);
+    run->kinds = calloc(count ? count : 1u, sizeof *run->kinds);
+    run->count = count;
+    if (run->targets && run->froms && run->kinds) return 0;
+    fprintf(stderr, "lzd, run_alloc; calloc failed; could not allocate memory for xref run.\n");
+    free(run->targets);
+    free(run->froms);
+    free(run->kinds);
+    memset(run, 0, sizeof *run);
+    return -1;
+}
+
+/**
+ * @brief free the columns of a run.
+ *
+ * @param run the run to be freed.
+ */
+internal void
+run_free(xref_run_t* run) {
+    free(run->targets);
+    free(run->froms);
+    free(run->kinds);
+    memset(run, 0, sizeof *run);
+}
+
+/**
+ * @brief merge two runs into a new one, both stay untouched.
+ *
+ * @param a the first run.
+ * @param b the second run.
+ * @param out the merged run to be filled.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+internal ssize_t
+run_merge(const xref_run_t* a, const xref_run_t* b, xref_run_t* out) {
+    if (run_alloc(out, a->count + b->count) != 0) return -1;
+    size_t i = 0u, j = 0u, k = 0u;
+    while (i < a->count || j < b->count) {
+        bool left = j >= b->count || (i < a->count && a->targets[i] <= b->targets[j]);
+        const xref_run_t* from = left ? a : b;
+        size_t at = left ? i++ : j++;
+        out->targets[k] = from->targets[at];
+        out->froms[k] = from->froms[at];
+        out->kinds[k] = from->kinds[at];
+        k++;
+    }
+    return 0;
+}
+
+/**
+ * @brief find the first reference in a run at or after a target.
+ *
+ * @param run the run.
+ * @param target the target.
+ * @return the index of the reference, run->count if there is none.
+ */
+internal size_t
+run_lower_bound(const xref_run_t* run, uint64_t target) {
+    size_t lo = 0u, hi = run->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2u;
+        if (run->targets[mid] < target) lo = mid + 1u;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief create a new empty xref index.
+ *
+ * @return an allocated xref index if successful, 0x0 o.w.
+ */
+xref_index_t*
+xref_index_create() {
+    xref_index_t* index = calloc(1u, sizeof *index);
+    if (!index) {
+        fprintf(stderr, "lzd, xref_index_create; calloc failed; could not allocate memory for index.\n");
+        return 0x0;
+    }
+    pthread_mutex_init(&index->lock, 0x0);
+    return index;
+}
+
+/**
+ * @brief free an xref index.
+ *
+ * @param index the index to be freed.
+ */
+void
+xref_index_free(xref_index_t* index) {
+    if (!index) return;
+    xref_index_clear(index);
+    pthread_mutex_destroy(&index->lock);
+    free(index);
+}
+
+/**
+ * @brief drop every reference in an xref index.
+ *
+ * @param index the index to be cleared.
+ */
+void
+xref_index_clear(xref_index_t* index) {
+    if (!index) return;
+    pthread_mutex_lock(&index->lock);
+    for (size_t i = 0; i < index->count; i++) run_free(&index->runs[i]);
+    index->count = 0u;
+    index->total = 0u;
+    pthread_mutex_unlock(&index->lock);
+}
+
+/**
+ * @brief add the references of a decoded chunk to an xref index.
+ *
+ * @param index the xref index.
+ * @param chunk the chunk, its references sorted by target.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+xref_index_add(xref_index_t* index, const insn_chunk_t* chunk) {
+    if (!index || !chunk) return -1;
+    if (chunk->xref_count == 0u) return 0;
+
+    /* the new run is built before the index is locked. */
+    xref_run_t run;
+    if (run_alloc(&run, chunk->xref_count) != 0) return -1;
+    for (size_t i = 0; i < chunk->xref_count; i++) {
+        run.targets[i] = chunk->xrefs[i].target;
+        run.froms[i] = chunk->base + chunk->xrefs[i].from;
+        run.kinds[i] = chunk->xrefs[i].kind;
+    }
+
+    /* fold it into the smaller runs at the end, until the one before it is more than twice as
+     *  large; a failed merge leaves it as a run of its own. */
+    pthread_mutex_lock(&index->lock);
+    while (index->count > 0u && index->runs[index->count - 1u].count <= run.count * 2u) {
+        xref_run_t merged;
+        if (run_merge(&index->runs[index->count - 1u], &run, &merged) != 0) break;
+        run_free(&index->runs[--index->count]);
+        run_free(&run);
+        run = merged;
+    }
+    if (index->count == XREF_MAX_RUNS) {
+        pthread_mutex_unlock(&index->lock);
+        run_free(&run);
+        return -1;
+    }
+    index->runs[index->count++] = run;
+    index->total += chunk->xref_count;
+    pthread_mutex_unlock(&index->lock);
+    return 0;
+}
+
+/**
+ * @brief compare two hits by from (then by target) for qsort.
+ *
+ * @param a the first hit.
+ * @param b the second hit.
+ * @return the ordering of a and b.
+ */
+internal int
+hit_compare(const void* a, const void* b) {
+    const xref_hit_t* x = a;
+    const xref_hit_t* y = b;
+    if (x->from != y->from) return x->from < y->from ? -1 : 1;
+    return x->target < y->target ? -1 : x->target > y->target ? 1 : 0;
+}
+
+/**
+ * @brief find every reference to an address range.
+ *
+ * @param index the xref index.
+ * @param lo the first address referred to.
+ * @param hi the address past the last one referred to.
+ * @param out output for the hits (allocated, freed by the caller), ordered by from and without
+ *  repeats.
+ * @return -1 if a failure occurs, the number of hits o.w.
+ */
+ssize_t
+xref_index_query(xref_index_t* index, uint64_t lo, uint64_t hi, xref_hit_t** out) {
+    if (out) *out = 0x0;
+    if (!index || !out || hi < lo) return -1;
+    pthread_mutex_lock(&index->lock);
+
+    /* count the hits of every run first, so they are copied out in one allocation. */
+    size_t first[XREF_MAX_RUNS], count = 0u;
+    for (size_t i = 0; i < index->count; i++) {
+        first[i] = run_lower_bound(&index->runs[i], lo);
+        count += run_lower_bound(&index->runs[i], hi) - first[i];
+    }
+    xref_hit_t* hits = calloc(count ? count : 1u, sizeof *hits);
+    if (!hits) {
+        pthread_mutex_unlock(&index->lock);
+        fprintf(stderr, "lzd, xref_index_query; calloc failed; could not allocate memory for hits.\n");
+        return -1;
+    }
+    size_t n = 0u;
+    for (size_t i = 0; i < index->count; i++) {
+        const xref_run_t* run = &index->runs[i];
+        for (size_t j = first[i]; j < run->count && run->targets[j] < hi; j++)
+            hits[n++] = (xref_hit_t){ run->froms[j], run->targets[j], run->kinds[j] };
+    }
+    pthread_mutex_unlock(&index->lock);
+
+    /* a chunk that was decoded twice adds the same references twice. */
+    qsort(hits, n, sizeof *hits, hit_compare);
+    size_t unique = 0u;
+    for (size_t i = 0; i < n; i++)
+        if (!unique || hit_compare(&hits[unique - 1u], &hits[i]) != 0) hits[unique++] = hits[i];
+    *out = hits;
+    return (ssize_t) unique;
+}
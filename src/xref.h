@@ -0,0 +1,99 @@
+/**
+ * @author Sean Hobeck
+ * @date 2026-03-06
+ */
+#ifndef LZD_XREF_H
+#define LZD_XREF_H
+
+/*! @uses uint64_t, uint8_t. */
+#include <stdint.h>
+
+/*! @uses size_t, ssize_t. */
+#include <sys/types.h>
+
+/*! @uses pthread_mutex_t. */
+#include <pthread.h>
+
+/*! @uses insn_chunk_t, insn_xref_t. */
+#include "insn.h"
+
+/* maximum number of runs, every run holds more than twice as many references as the next. */
+#define XREF_MAX_RUNS 64u
+
+/* a run of references sorted by target, packed column-wise. */
+typedef struct {
+    uint64_t* targets; /* address every reference points at, ascending. */
+    uint64_t* froms; /* address of the referring instruction. */
+    uint8_t* kinds; /* insn_xref_kind_t of every reference. */
+    size_t count; /* number of references. */
+} xref_run_t;
+
+/**
+ * a log-structured index of cross-references keyed by target address; the references of every
+ *  decoded chunk arrive as a small sorted run, and a run is merged into the one before it while
+ *  that one isn't more than twice as large. so there are O(log n) runs, every reference is
+ *  merged O(log n) times over the whole decode, and a lookup is a binary search per run. a
+ *  reference is never removed, the instructions it came from may have been dropped since (a
+ *  stitched seam, or a chunk that was decoded twice), so hits are checked by the caller.
+ */
+typedef struct {
+    xref_run_t runs[XREF_MAX_RUNS]; /* runs, from the largest to the smallest. */
+    size_t count; /* number of runs. */
+    size_t total; /* number of references over every run. */
+    pthread_mutex_t lock; /* chunks arrive on the worker threads. */
+} xref_index_t;
+
+/* a reference found in the index. */
+typedef struct {
+    uint64_t from; /* address of the referring instruction. */
+    uint64_t target; /* address referred to. */
+    uint8_t kind; /* insn_xref_kind_t. */
+} xref_hit_t;
+
+/**
+ * @brief create a new empty xref index.
+ *
+ * @return an allocated xref index if successful, 0x0 o.w.
+ */
+xref_index_t*
+xref_index_create();
+
+/**
+ * @brief free an xref index.
+ *
+ * @param index the index to be freed.
+ */
+void
+xref_index_free(xref_index_t* index);
+
+/**
+ * @brief drop every reference in an xref index.
+ *
+ * @param index the index to be cleared.
+ */
+void
+xref_index_clear(xref_index_t* index);
+
+/**
+ * @brief add the references of a decoded chunk to an xref index.
+ *
+ * @param index the xref index.
+ * @param chunk the chunk, its references sorted by target.
+ * @return -1 if a failure occurs, 0 o.w.
+ */
+ssize_t
+xref_index_add(xref_index_t* index, const insn_chunk_t* chunk);
+
+/**
+ * @brief find every reference to an address range.
+ *
+ * @param index the xref index.
+ * @param lo the first address referred to.
+ * @param hi the address past the last one referred to.
+ * @param out output for the hits (allocated, freed by the caller), ordered by from and without
+ *  repeats.
+ * @return -1 if a failure occurs, the number of hits o.w.
+ */
+ssize_t
+xref_index_query(xref_index_t* index, uint64_t lo, uint64_t hi, xref_hit_t** out);
+#endif /* LZD_XREF_H */